@@ -37,6 +37,7 @@ list (APPEND MAIN_SOURCE_FILES
   opm/grid/cpgrid/processEclipseFormat.cpp
   opm/grid/cpgrid/readSintefLegacyFormat.cpp
   opm/grid/cpgrid/writeSintefLegacyFormat.cpp
+  opm/grid/cpgrid/binaryCacheFormat.cpp
   opm/grid/common/GeometryHelpers.cpp
   opm/grid/common/GridPartitioning.cpp
   opm/grid/common/WellConnections.cpp
@@ -84,7 +85,9 @@ list (APPEND ATTIC_FILES
 # find tests -name '*.cpp' -a ! -wholename '*/not-unit/*' -printf '\t%p\n' | sort
 list (APPEND TEST_SOURCE_FILES
   tests/test_cartgrid.cpp
+  tests/test_celllocator.cpp
   tests/test_column_extract.cpp
+  tests/cpgrid/binary_cache_test.cpp
   tests/cpgrid/distribution_test.cpp
   tests/cpgrid/entityrep_test.cpp
   tests/cpgrid/entity_test.cpp
@@ -92,10 +95,13 @@ list (APPEND TEST_SOURCE_FILES
   tests/cpgrid/geometry_test.cpp
   tests/cpgrid/orientedentitytable_test.cpp
   tests/cpgrid/partition_iterator_test.cpp
+  tests/cpgrid/renumbering_test.cpp
   tests/cpgrid/zoltan_test.cpp
   tests/test_geom2d.cpp
   tests/test_gridutilities.cpp
   tests/test_minpvprocessor.cpp
+  tests/test_polyhedralgrid.cpp
+  tests/test_polyhedralgrid_distribution.cpp
 #	tests/grid_test.cc
   tests/p2pcommunicator_test.cc
   tests/test_repairzcorn.cpp
@@ -106,6 +112,7 @@ list (APPEND TEST_SOURCE_FILES
 
 if(HAVE_ECL_INPUT)
   list(APPEND TEST_SOURCE_FILES
+		tests/test_pinchprocessor.cpp
 		tests/test_regionmapping.cpp
 		tests/test_ug.cpp
 		tests/test_compressedpropertyaccess.cpp
@@ -150,6 +157,7 @@ list (APPEND PUBLIC_HEADER_FILES
   opm/grid/common/p2pcommunicator.hh
   opm/grid/common/p2pcommunicator_impl.hh
   opm/grid/cpgrid/CartesianIndexMapper.hpp
+  opm/grid/cpgrid/CellConnections.hpp
   opm/grid/cpgrid/CpGridData.hpp
   opm/grid/cpgrid/DefaultGeometryPolicy.hpp
   opm/grid/cpgrid/dgfparser.hh
@@ -159,6 +167,7 @@ list (APPEND PUBLIC_HEADER_FILES
   opm/grid/cpgrid/Geometry.hpp
   opm/grid/cpgrid/GlobalIdMapping.hpp
   opm/grid/cpgrid/GridHelpers.hpp
+  opm/grid/cpgrid/HaloExchangePlan.hpp
   opm/grid/CpGrid.hpp
   opm/grid/cpgrid/Indexsets.hpp
   opm/grid/cpgrid/Intersection.hpp
@@ -166,8 +175,10 @@ list (APPEND PUBLIC_HEADER_FILES
   opm/grid/cpgrid/OrientedEntityTable.hpp
   opm/grid/cpgrid/PartitionIteratorRule.hpp
   opm/grid/cpgrid/PartitionTypeIndicator.hpp
+  opm/grid/cpgrid/PendingCommunication.hpp
   opm/grid/cpgrid/PersistentContainer.hpp
   opm/grid/common/CartesianIndexMapper.hpp
+  opm/grid/common/CellLocator.hpp
   opm/grid/common/WellConnections.hpp
   opm/grid/common/ZoltanGraphFunctions.hpp
   opm/grid/common/ZoltanPartition.hpp
@@ -38,6 +38,7 @@
 #ifndef OPM_CPGRID_HEADER
 #define OPM_CPGRID_HEADER
 
+#include <cstdint>
 #include <string>
 #include <map>
 #include <array>
@@ -206,6 +207,14 @@ namespace Dune
         logTransEdgeWgt=2
     };
 
+    /// \brief enum for choosing the ordering of the cells in CpGrid::renumber().
+    enum CellOrdering {
+        /// \brief Reverse Cuthill-McKee ordering of the cell graph (small bandwidth)
+        reverseCuthillMcKeeOrdering=0,
+        /// \brief Ordering along a Hilbert curve through the cell centroids
+        hilbertCurveOrdering=1
+    };
+
     ////////////////////////////////////////////////////////////////////////
     //
     //   CpGridFamily
@@ -257,6 +266,42 @@ namespace Dune
         void writeSintefLegacyFormat(const std::string& grid_prefix) const;
 
 
+        /// Write a binary snapshot of the processed grid, which can be
+        /// loaded much faster than processing the input again.
+        /// \param filename the name of the cache file.
+        /// \param input_hash hash of the input the grid was built from, see inputHash().
+        void writeBinaryCache(const std::string& filename, std::uint64_t input_hash) const;
+
+
+        /// Read a binary snapshot written by writeBinaryCache().
+        /// \param filename the name of the cache file.
+        /// \param input_hash hash of the input the grid should be built from.
+        /// \return false, leaving the grid untouched, if the file does not
+        ///         exist or is stale, i.e. was written for another input
+        ///         or by another version of the format.
+        bool readBinaryCache(const std::string& filename, std::uint64_t input_hash);
+
+
+        /// Compute a content hash of the COORD, ZCORN and ACTNUM data of
+        /// a corner-point specification, to be used with the binary cache.
+        /// The options passed to processEclipseFormat() and the version of
+        /// the cache format are part of the hash, such that a cache written
+        /// for other options is rejected.
+        static std::uint64_t inputHash(const grdecl& input_data, double z_tolerance = 0.0,
+                                       bool remove_ij_boundary = false,
+                                       bool turn_normals = false);
+
+
+        /// Set a binary cache file for processEclipseFormat().
+        /// If the file was written for the same input and processing options
+        /// (for an EclipseGrid including MINPV, PINCH, NNCs, clipping and the
+        /// periodic extension), the grid is read from it. Otherwise the input
+        /// is processed and the result written to the file. The row-wise
+        /// processing does not use the cache.
+        /// \param filename the name of the cache file, or empty to disable it.
+        void setBinaryCacheFile(const std::string& filename);
+
+
 #if HAVE_ECL_INPUT
         /// Read the Eclipse grid format ('grdecl').
         /// \param ecl_grid the high-level object from opm-parser which represents the simulation's grid
@@ -278,6 +323,15 @@ namespace Dune
         /// \param remove_ij_boundary if true, will remove (i, j) boundaries. Used internally.
         void processEclipseFormat(const grdecl& input_data, double z_tolerance, bool remove_ij_boundary, bool turn_normals = false);
 
+        /// Read the Eclipse grid format ('grdecl') one row of corners at a time.
+        /// Only a few rows of ZCORN and ACTNUM are held in memory at once,
+        /// which allows processing decks whose corner arrays do not fit in memory.
+        /// \param input_data the row-wise reader of the grid, declared in preprocess.h.
+        /// \param z_tolerance points along a pillar that are closer together in z
+        ///        coordinate than this parameter, will be replaced by a single point.
+        /// \param remove_ij_boundary if true, will remove (i, j) boundaries. Used internally.
+        void processEclipseFormat(const grdecl_rows& input_data, double z_tolerance, bool remove_ij_boundary, bool turn_normals = false);
+
         //@}
 
         /// \name Cartesian grid extensions.
@@ -605,15 +659,50 @@ namespace Dune
         }
 
 
+        /// \brief Set whether loadBalance partitions the grid in parallel.
+        ///
+        /// By default the graph of the grid is partitioned with Zoltan on process 0 only.
+        /// If set, the grid is first distributed in slabs of the logical cartesian grid,
+        /// also if it is only present on process 0. Then each process provides only the
+        /// cells and edges of its slab to Zoltan, which partitions the graph in parallel,
+        /// and the cells are moved to their new owners directly (see repartition()).
+        /// Only the partition numbers of cells perforated by wells are gathered on
+        /// process 0 to keep each well on one process. The edges of the graph have
+        /// uniform weights, i.e. transmissibilities passed to loadBalance are ignored
+        /// with a warning, and loadBalance throws on all processes if more than one
+        /// layer of overlap cells is requested.
+        /// This has no effect without Zoltan or with the geometric partitioner.
+        void setParallelPartitioning(bool parallel)
+        {
+            parallel_partitioning_ = parallel;
+        }
+
+        /// \brief Set whether loadBalance uses a geometric partitioner.
+        ///
+        /// If set, the cells are partitioned by recursive coordinate bisection of
+        /// their centroids (see Dune::partitionGeometric) instead of partitioning the
+        /// graph with Zoltan. This is much faster and balances the (weighted) number
+        /// of active cells, but yields larger interfaces between the processes. Cells
+        /// perforated by the same well are still kept on one process.
+        void setGeometricPartitioning(bool geometric)
+        {
+            geometric_partitioning_ = geometric;
+        }
+
         // loadbalance is not part of the grid interface therefore we skip it.
 
         /// \brief Distributes this grid over the available nodes in a distributed machine
+        ///
+        /// The global grid either has to be present on all processes or only on
+        /// process 0 with all other processes holding an empty grid. The latter
+        /// avoids storing the whole grid on every process.
         /// \param overlapLayers The number of layers of cells of the overlap region (default: 1).
+        ///            Has to be 1 if the grid is partitioned in parallel (see setParallelPartitioning()).
         /// \warning May only be called once.
         bool loadBalance(int overlapLayers=1)
         {
             using std::get;
-            return get<0>(scatterGrid(defaultTransEdgeWgt, nullptr, nullptr, overlapLayers ));
+            return get<0>(scatterGrid(defaultTransEdgeWgt, nullptr, nullptr, {}, overlapLayers ));
         }
 
         // loadbalance is not part of the grid interface therefore we skip it.
@@ -630,14 +719,16 @@ namespace Dune
         ///            adding an edge with a very high edge weight for all
         ///            possible pairs of cells in the completion set of a well.
         /// \param transmissibilities The transmissibilities used as the edge weights.
+        ///            Ignored if the grid is partitioned in parallel.
         /// \param overlapLayers The number of layers of cells of the overlap region (default: 1).
+        ///            Has to be 1 if the grid is partitioned in parallel (see setParallelPartitioning()).
         /// \warning May only be called once.
         std::pair<bool, std::unordered_set<std::string> >
         loadBalance(const std::vector<cpgrid::OpmWellType> * wells,
                     const double* transmissibilities = nullptr,
                     int overlapLayers=1)
         {
-            return scatterGrid(defaultTransEdgeWgt, wells, transmissibilities, overlapLayers);
+            return scatterGrid(defaultTransEdgeWgt, wells, transmissibilities, {}, overlapLayers);
         }
 
         // loadbalance is not part of the grid interface therefore we skip it.
@@ -656,14 +747,48 @@ namespace Dune
         ///            adding an edge with a very high edge weight for all
         ///            possible pairs of cells in the completion set of a well.
         /// \param transmissibilities The transmissibilities used to calculate the edge weights.
-        /// \param The number of layers of cells of the overlap region (default: 1).
+        ///            Ignored if the grid is partitioned in parallel.
+        /// \param overlapLayers The number of layers of cells of the overlap region (default: 1).
+        ///            Has to be 1 if the grid is partitioned in parallel (see setParallelPartitioning()).
+        /// \warning May only be called once.
+        std::pair<bool, std::unordered_set<std::string> >
+        loadBalance(EdgeWeightMethod method, const std::vector<cpgrid::OpmWellType> * wells,
+                    const double* transmissibilities = nullptr,
+                    int overlapLayers=1)
+        {
+            return scatterGrid(method, wells, transmissibilities, {}, overlapLayers);
+        }
+
+        // loadbalance is not part of the grid interface therefore we skip it.
+
+        /// \brief Distributes this grid over the available nodes in a distributed machine,
+        ///        balancing the computational cost of the cells.
+        ///
+        /// Like the overload above, but each cell additionally has one or more weights
+        /// (e.g. its expected cost in the linear and non-linear solvers). The partitioner
+        /// balances all of them at the same time (multi-constraint partitioning) instead
+        /// of only the number of cells per process.
+        /// \param method The edge-weighting method to be used on the Zoltan partitioner.
+        /// \param wells The wells of the eclipse If null wells will be neglected.
+        ///            If this is not null then complete well information of
+        ///            of the last scheduler step of the eclipse state will be
+        ///            used to make sure that all the possible completion cells
+        ///            of each well are stored on one process.
+        /// \param cellWeights One vector per constraint with a non-negative weight for
+        ///            each cell of the global grid. If the global grid is only present
+        ///            on process 0, the weights are only needed there.
+        /// \param transmissibilities The transmissibilities used to calculate the edge weights.
+        ///            Ignored if the grid is partitioned in parallel.
+        /// \param overlapLayers The number of layers of cells of the overlap region (default: 1).
+        ///            Has to be 1 if the grid is partitioned in parallel (see setParallelPartitioning()).
         /// \warning May only be called once.
         std::pair<bool, std::unordered_set<std::string> >
         loadBalance(EdgeWeightMethod method, const std::vector<cpgrid::OpmWellType> * wells,
+                    const std::vector<std::vector<double> >& cellWeights,
                     const double* transmissibilities = nullptr,
                     int overlapLayers=1)
         {
-            return scatterGrid(method, wells, transmissibilities, overlapLayers);
+            return scatterGrid(method, wells, transmissibilities, cellWeights, overlapLayers);
         }
 
         /// \brief Distributes this grid and data over the available nodes in a distributed machine.
@@ -676,8 +801,9 @@ namespace Dune
         ///            adding an edge with a very high edge weight for all
         ///            possible pairs of cells in the completion set of a well.
         /// \param transmissibilities The transmissibilities used to calculate the edge weights.
+        ///            Ignored if the grid is partitioned in parallel.
         /// \param overlapLayers The number of layers of overlap cells to be added
-        ///        (default: 1)
+        ///        (default: 1). Has to be 1 if the grid is partitioned in parallel.
         /// \tparam DataHandle The type implementing DUNE's DataHandle interface.
         /// \warning May only be called once.
         template<class DataHandle>
@@ -696,7 +822,7 @@ namespace Dune
         /// \brief Distributes this grid and data over the available nodes in a distributed machine.
         /// \param data A data handle describing how to distribute attached data.
         /// \param overlapLayers The number of layers of overlap cells to be added
-        ///        (default: 1)
+        ///        (default: 1). Has to be 1 if the grid is partitioned in parallel.
         /// \tparam DataHandle The type implementing DUNE's DataHandle interface.
         /// \warning May only be called once.
         template<class DataHandle>
@@ -708,6 +834,69 @@ namespace Dune
             return ret;
         }
 
+        /// \brief Compute a new partitioning of the distributed grid.
+        ///
+        /// The partitioning is computed in parallel from the distributed grid
+        /// only. With Zoltan its repartitioning approach is used, which tries
+        /// to keep the amount of migrated cells small. Without Zoltan the
+        /// current partitioning is returned. Wells are not taken into account.
+        /// This is a collective operation.
+        /// \param cellWeights One vector per constraint with a non-negative weight
+        ///        for each cell of the distributed grid (may be empty).
+        /// \return For each cell of the distributed grid its new owner. Only the
+        ///         entries of interior cells are meaningful.
+        std::vector<int>
+        computeRepartitioning(const std::vector<std::vector<double> >& cellWeights =
+                              std::vector<std::vector<double> >()) const;
+
+        /// \brief Move the cells of the distributed grid to new processes.
+        ///
+        /// In contrast to loadBalance this works on the distributed grid and
+        /// does not need the global grid on any process. The cells, faces,
+        /// points, and their geometry are sent from their current owners to
+        /// their new ones directly. Afterwards the overlap consists of one
+        /// layer of cells. The global view, if present, stays unchanged.
+        /// This is a collective operation.
+        /// \param cellPart For each cell of the distributed grid the rank of its
+        ///        new owner, e.g. as computed by computeRepartitioning(). Only the
+        ///        entries of interior cells are used. Each process has to keep
+        ///        at least one cell.
+        /// \return Whether the grid was repartitioned.
+        bool repartition(const std::vector<int>& cellPart);
+
+        /// \brief Move the cells of the distributed grid and attached data to new processes.
+        /// \param cellPart For each cell of the distributed grid the rank of its
+        ///        new owner. See repartition(const std::vector<int>&).
+        /// \param data A data handle describing the data to move. Only cell data
+        ///        is supported. The data of each cell of the new grid, including
+        ///        the overlap, is taken from the current owner of the cell.
+        /// \tparam DataHandle The type implementing DUNE's DataHandle interface.
+        /// \return Whether the grid was repartitioned.
+        template<class DataHandle>
+        bool repartition(const std::vector<int>& cellPart, DataHandle& data)
+        {
+#if HAVE_MPI
+            InterfaceMap migration;
+            std::vector<std::pair<int,int> > local_moves;
+            auto old_data = repartitionGrid(cellPart, migration, local_moves);
+            if(!old_data)
+                return false;
+            distributed_data_->migrateData(data, old_data.get(), distributed_data_.get(),
+                                           migration, local_moves);
+            for(auto& interface: migration)
+            {
+                interface.second.first.free();
+                interface.second.second.free();
+            }
+            return true;
+#else
+            // Suppress warnings for unused arguments.
+            (void) cellPart;
+            (void) data;
+            return false;
+#endif
+        }
+
         /// The new communication interface.
         /// \brief communicate objects for all codims on a given level
         /// \param data The data handle describing the data. Has to adhere to the
@@ -734,6 +923,53 @@ namespace Dune
             current_view_data_->communicate(data, iftype, dir);
         }
 
+        /// \brief Start communicating objects for all codims.
+        ///
+        /// Split-phase variant of communicate(): gathers the data to send
+        /// and posts non-blocking messages. Work that does not depend on
+        /// the received entities, e.g. on interiorCellsNotTouchingOverlap(),
+        /// can be done before calling communicateEnd(). Only one
+        /// split-phase communication may be pending at a time. Data handles
+        /// with a variable size are communicated completely here.
+        /// \param data The data handle describing the data. Has to adhere to the Dune::DataHandleIF interface.
+        /// \param iftype The interface to use for the communication.
+        /// \param dir The direction of the communication along the interface (forward or backward).
+        template<class DataHandle>
+        void communicateBegin(DataHandle& data, InterfaceType iftype, CommunicationDirection dir) const
+        {
+            current_view_data_->communicateBegin(data, iftype, dir);
+        }
+
+        /// \brief Finish a communication started by communicateBegin().
+        ///
+        /// Must be called with the same arguments as communicateBegin().
+        template<class DataHandle>
+        void communicateEnd(DataHandle& data, InterfaceType iftype, CommunicationDirection dir) const
+        {
+            current_view_data_->communicateEnd(data, iftype, dir);
+        }
+
+        /// \brief Create a reusable plan for exchanging fixed-size data.
+        ///
+        /// Use this instead of communicate() for data that is exchanged
+        /// repeatedly, e.g. in every linear solver iteration. The plan
+        /// keeps its index lists, buffers and persistent MPI requests
+        /// between exchanges. The data is stored in a contiguous array
+        /// with values_per_entity values for each cell (codim 0) or
+        /// point (codim 3). Creating the plan is a collective operation.
+        /// \param iftype The interface to use for the communication.
+        /// \param codim The codimension of the entities (0 or 3).
+        /// \param values_per_entity The number of values for each entity.
+        /// \param dir The direction of the communication along the interface.
+        template<class T>
+        std::unique_ptr<cpgrid::HaloExchangePlan<T> >
+        haloExchangePlan(InterfaceType iftype, int codim = 0, std::size_t values_per_entity = 1,
+                         CommunicationDirection dir = ForwardCommunication) const
+        {
+            return current_view_data_->template haloExchangePlan<T>(iftype, codim,
+                                                                    values_per_entity, dir);
+        }
+
         /// \brief Get the collective communication object.
         const CollectiveCommunication& comm () const
         {
@@ -800,6 +1036,49 @@ namespace Dune
         {
             return current_view_data_->cell_to_face_[cpgrid::EntityRep<0>(cell, true)];
         }
+        /// \brief Get the connections between the cells of the grid in
+        ///        compressed row format.
+        ///
+        /// For each cell this lists the neighbouring cells, the faces
+        /// connecting them and the face orientations, covering all faces
+        /// between two cells of the current view, including NNCs and
+        /// connections to overlap cells. The list is built on the first
+        /// call and cached; that first call must not race with other calls.
+        const cpgrid::CellConnections& cellConnections() const
+        {
+            return current_view_data_->cellConnections();
+        }
+
+        /// \brief Renumber the cells and faces for a better memory locality.
+        ///
+        /// The cells of the logical cartesian order are up to nx*ny apart
+        /// from their neighbours. This reorders the cells, orders the faces
+        /// by their first cell, and permutes all topology and geometry in
+        /// place. Data attached to cells or faces by the user has to be
+        /// reordered with the returned permutations. Only a grid that is not
+        /// (yet) distributed can be renumbered.
+        /// \param ordering The ordering of the cells.
+        /// \param facePermutation If not null, filled with the old index of
+        ///        each face in the new order.
+        /// \return The old index of each cell in the new order.
+        std::vector<int> renumber(CellOrdering ordering = reverseCuthillMcKeeOrdering,
+                                  std::vector<int>* facePermutation = nullptr);
+
+        /// \brief The interior cells without overlap neighbours, in ascending order.
+        ///
+        /// Computations on these cells may overlap with a communication
+        /// of the overlap between communicateBegin() and communicateEnd().
+        /// For a serial grid this contains all cells.
+        const std::vector<int>& interiorCellsNotTouchingOverlap() const
+        {
+            return current_view_data_->interiorCellsNotTouchingOverlap();
+        }
+
+        /// \brief The interior cells with at least one overlap neighbour, in ascending order.
+        const std::vector<int>& interiorCellsTouchingOverlap() const
+        {
+            return current_view_data_->interiorCellsTouchingOverlap();
+        }
         /// \brief Get the index identifying a cell attached to a face.
         ///
         /// Note that a face here is always oriented. If there are two
@@ -1016,6 +1295,72 @@ namespace Dune
             return current_view_data_->geomVector<0>()[cpgrid::EntityRep<0>(cell, true)].center();
         }
 
+        /// \name Contiguous geometry arrays
+        ///
+        /// The cell and face geometry stored as one array per quantity
+        /// (structure of arrays), indexed by cell or face index. Meant for
+        /// loops over all cells or faces that only need some of the quantities.
+        //@{
+        /// \brief The volumes of all cells.
+        const std::vector<double>& cellVolumes() const
+        {
+            return current_view_data_->geometry_.cellVolumes();
+        }
+        /// \brief The x-coordinates of the centroids of all cells.
+        const std::vector<double>& cellCentroidsX() const
+        {
+            return current_view_data_->geometry_.cellCentroids(0);
+        }
+        /// \brief The y-coordinates of the centroids of all cells.
+        const std::vector<double>& cellCentroidsY() const
+        {
+            return current_view_data_->geometry_.cellCentroids(1);
+        }
+        /// \brief The z-coordinates of the centroids of all cells.
+        const std::vector<double>& cellCentroidsZ() const
+        {
+            return current_view_data_->geometry_.cellCentroids(2);
+        }
+        /// \brief The areas of all faces.
+        const std::vector<double>& faceAreas() const
+        {
+            return current_view_data_->geometry_.faceAreas();
+        }
+        /// \brief The x-coordinates of the centroids of all faces.
+        const std::vector<double>& faceCentroidsX() const
+        {
+            return current_view_data_->geometry_.faceCentroids(0);
+        }
+        /// \brief The y-coordinates of the centroids of all faces.
+        const std::vector<double>& faceCentroidsY() const
+        {
+            return current_view_data_->geometry_.faceCentroids(1);
+        }
+        /// \brief The z-coordinates of the centroids of all faces.
+        const std::vector<double>& faceCentroidsZ() const
+        {
+            return current_view_data_->geometry_.faceCentroids(2);
+        }
+        /// \brief The x-components of the unit normals of all faces.
+        /// \see faceNormal
+        const std::vector<double>& faceNormalsX() const
+        {
+            return current_view_data_->geometry_.faceNormals(0);
+        }
+        /// \brief The y-components of the unit normals of all faces.
+        /// \see faceNormal
+        const std::vector<double>& faceNormalsY() const
+        {
+            return current_view_data_->geometry_.faceNormals(1);
+        }
+        /// \brief The z-components of the unit normals of all faces.
+        /// \see faceNormal
+        const std::vector<double>& faceNormalsZ() const
+        {
+            return current_view_data_->geometry_.faceNormals(2);
+        }
+        //@}
+
         /// \brief An iterator over the centroids of the geometry of the entities.
         /// \tparam codim The co-dimension of the entities.
         template<int codim>
@@ -1322,6 +1667,11 @@ namespace Dune
 
     private:
         /// \brief Scatter a global grid to all processors.
+        ///
+        /// If the global grid was only set up on process 0 and all other
+        /// processes hold an empty grid, then it is partitioned there and
+        /// each process only receives its part. Point data cannot be scattered
+        /// afterwards in that case.
         /// \param method The edge-weighting method to be used on the Zoltan partitioner.
         /// \param ecl Pointer to the eclipse state information. Default: null
         ///            If this is not null then complete well information of
@@ -1330,12 +1680,31 @@ namespace Dune
         ///            of each well are stored on one process. This done by
         ///            adding an edge with a very high edge weight for all
         ///            possible pairs of cells in the completion set of a well.
+        /// \param transmissibilities The transmissibilities used to calculate the edge weights.
+        ///            Ignored if the grid is partitioned in parallel.
+        /// \param cellWeights The weights of the cells to balance (may be empty).
+        /// \param overlapLayers The number of layers of cells of the overlap region.
         std::pair<bool, std::unordered_set<std::string> >
         scatterGrid(EdgeWeightMethod method,
                     const std::vector<cpgrid::OpmWellType> * wells,
                     const double* transmissibilities,
+                    const std::vector<std::vector<double> >& cellWeights,
                     int overlapLayers);
 
+#if HAVE_MPI
+        /// \brief Repartition the distributed grid without moving any data.
+        ///
+        /// Afterwards distributed_data_ holds the new grid and the
+        /// scatter/gather interface is updated.
+        /// \param cellPart The new owner of each cell of the distributed grid.
+        /// \param migration Filled with the cells sent to and received from other processes.
+        /// \param localMoves Filled with the old and new index of the cells staying.
+        /// \return The distributed grid before repartitioning.
+        std::shared_ptr<cpgrid::CpGridData>
+        repartitionGrid(const std::vector<int>& cellPart, InterfaceMap& migration,
+                        std::vector<std::pair<int,int> >& localMoves);
+#endif
+
         /** @brief The data stored in the grid.
          *
          * All the data of the grid is stored there and
@@ -1351,6 +1720,10 @@ namespace Dune
          * @warning Will only update owner cells
          */
         std::shared_ptr<InterfaceMap> cell_scatter_gather_interfaces_;
+        /// \brief Whether loadBalance partitions a grid present on all processes in parallel.
+        bool parallel_partitioning_;
+        /// \brief Whether loadBalance uses a geometric partitioner instead of Zoltan.
+        bool geometric_partitioning_;
     }; // end Class CpGrid
 
 
@@ -24,7 +24,11 @@
 #include <opm/grid/utility/ErrorMacros.hpp>
 #include <opm/grid/utility/OpmParserIncludes.hpp>
 
+#include <algorithm>
 #include <array>
+#include <map>
+#include <utility>
+#include <vector>
 
 namespace Opm
 {
@@ -59,6 +63,18 @@ namespace Opm
                     const bool mergeMinPVCells,
                     double* zcorn) const;
     private:
+        /// Process the cells of column (ii, jj) from top to bottom,
+        /// appending its non-neighbor connections to nnc.
+        void processColumn(const int ii, const int jj,
+                           const std::vector<double>& thickness,
+                           const double z_tolerance,
+                           const std::vector<double>& pv,
+                           const std::vector<double>& minpvv,
+                           const std::vector<int>& actnum,
+                           const bool mergeMinPVCells,
+                           double* zcorn,
+                           std::vector<double>& column_zcorn,
+                           std::vector<std::pair<int,int>>& nnc) const;
         std::array<int,8> cornerIndices(const int i, const int j, const int k) const;
         std::array<double, 8> getCellZcorn(const int i, const int j, const int k, const double* z) const;
         void setCellZcorn(const int i, const int j, const int k, const std::array<double, 8>& cellz, double* z) const;
@@ -102,9 +118,6 @@ namespace Opm
         //    are bypassed.
 
 
-        // return a list of the non-neighbor connection.
-        std::map<int,int> nnc;
-
         // Check for sane input sizes.
         const size_t log_size = dims_[0] * dims_[1] * dims_[2];
         if (pv.size() != log_size) {
@@ -114,91 +127,150 @@ namespace Opm
             OPM_THROW(std::runtime_error, "Wrong size of ACTNUM input, must have one element per logical cartesian cell.");
         }
 
-        // Main loop.
-        for (int kk = 0; kk < dims_[2]; ++kk) {
-            for (int jj = 0; jj < dims_[1]; ++jj) {
-                for (int ii = 0; ii < dims_[0]; ++ii) {
-                    const int c = ii + dims_[0] * (jj + dims_[1] * kk);
-                    if (pv[c] < minpvv[c] && (actnum.empty() || actnum[c])) {
-                        // Move deeper (higher k) coordinates to lower k coordinates.
-                        // i.e remove the cell
-                        std::array<double, 8> cz = getCellZcorn(ii, jj, kk, zcorn);
-                        for (int count = 0; count < 4; ++count) {
-                            cz[count + 4] = cz[count];
-                        }
-                        setCellZcorn(ii, jj, kk, cz, zcorn);
-
-                        // Find the next cell
-                        int kk_iter = kk + 1;
-                        if (kk_iter == dims_[2]) // we are at the end of the pillar.
-                            continue;
-
-                        int c_below = ii + dims_[0] * (jj + dims_[1] * (kk_iter));
-                        // bypass inactive cells with thickness less then the tolerance
-                        while ( ((actnum.empty() || !actnum[c_below]) && (thickness[c_below] <= z_tolerance))  ){
-                            // move these cell to the posistion of the first cell to make the
-                            // coordinates strictly sorted
-                            setCellZcorn(ii, jj, kk_iter, cz, zcorn);
-                            kk_iter ++;
-                            if (kk_iter == dims_[2])
-                                break;
+        // The columns only touch their own zcorn values and cell data,
+        // so they are processed in parallel. Each thread collects its
+        // non-neighbor connections in a vector of its own.
+        std::vector<std::pair<int,int>> nnc_list;
+        const int num_columns = dims_[0] * dims_[1];
+#pragma omp parallel
+        {
+            std::vector<double> column_zcorn(8 * dims_[2]);
+            std::vector<std::pair<int,int>> column_nnc;
+#pragma omp for schedule(static)
+            for (int column = 0; column < num_columns; ++column) {
+                processColumn(column % dims_[0], column / dims_[0], thickness, z_tolerance, pv, minpvv,
+                              actnum, mergeMinPVCells, zcorn, column_zcorn, column_nnc);
+            }
+#pragma omp critical
+            nnc_list.insert(nnc_list.end(), column_nnc.begin(), column_nnc.end());
+        }
 
-                            c_below = ii + dims_[0] * (jj + dims_[1] * (kk_iter));
-                        }
+        // All connections of a cell above come from the same column, in
+        // the order of processing. Keep the first one, as the map did.
+        std::stable_sort(nnc_list.begin(), nnc_list.end(),
+                         [](const std::pair<int,int>& a, const std::pair<int,int>& b)
+                         { return a.first < b.first; });
+        nnc_list.erase(std::unique(nnc_list.begin(), nnc_list.end(),
+                                   [](const std::pair<int,int>& a, const std::pair<int,int>& b)
+                                   { return a.first == b.first; }),
+                       nnc_list.end());
 
-                        if (kk_iter == dims_[2]) // we have come to the end of the pillar.
-                            continue;
+        // return a list of the non-neighbor connection.
+        return std::map<int,int>(nnc_list.begin(), nnc_list.end());
+    }
 
-                        // create nnc if false or merge the cells if true
-                        if (!mergeMinPVCells) {
 
-                            // We are at the top, so no nnc is created.
-                            if (kk == 0)
-                                continue;
 
-                            int c_above = ii + dims_[0] * (jj + dims_[1] * (kk - 1));
+    inline void MinpvProcessor::processColumn(const int ii, const int jj,
+                                              const std::vector<double>& thickness,
+                                              const double z_tolerance,
+                                              const std::vector<double>& pv,
+                                              const std::vector<double>& minpvv,
+                                              const std::vector<int>& actnum,
+                                              const bool mergeMinPVCells,
+                                              double* zcorn,
+                                              std::vector<double>& column_zcorn,
+                                              std::vector<std::pair<int,int>>& nnc) const
+    {
+        const int c0 = ii + dims_[0] * jj;
+        const int layer = dims_[0] * dims_[1];
+
+        // Most columns have no cells to remove; leave their zcorn alone.
+        bool any_removed = false;
+        for (int kk = 0; kk < dims_[2] && !any_removed; ++kk) {
+            const int c = c0 + layer * kk;
+            any_removed = pv[c] < minpvv[c] && (actnum.empty() || actnum[c]);
+        }
+        if (!any_removed) {
+            return;
+        }
 
-                            // Bypass inactive cells with thickness below tolerance and active cells with volume below minpv
-                            if (((actnum.empty() || !actnum[c_above]) && thickness[c_above] < z_tolerance) || ((actnum.empty() || actnum[c_above]) && pv[c_above] < minpvv[c_above]) ) {
-                                for (int topk = kk - 2; topk > 0; --topk) {
-                                    c_above = ii + dims_[0] * (jj + dims_[1] * (topk));
-                                    if ( ((actnum.empty() || actnum[c_above]) && pv[c_above] > minpvv[c_above]) || ((actnum.empty() || !actnum[c_above]) && thickness[c_above] > z_tolerance)) {
-                                        break;
-                                    }
-                                }
-                            }
+        // Work on a contiguous copy of the zcorn values of the column,
+        // eight consecutive values per cell as in getCellZcorn().
+        for (int kk = 0; kk < dims_[2]; ++kk) {
+            const std::array<double, 8> cz = getCellZcorn(ii, jj, kk, zcorn);
+            std::copy(cz.begin(), cz.end(), column_zcorn.begin() + 8 * kk);
+        }
 
-                            // Bypass inactive cells with thickness below tolerance and active cells with volume below minpv
-                            if (((actnum.empty() || (!actnum[c_below])) && thickness[c_below] < z_tolerance) || ((actnum.empty() || actnum[c_below]) && pv[c_below] < minpvv[c]) ) {
-                                for (int botk = kk_iter + 1; botk <  dims_[2]; ++botk) {
-                                    c_below = ii + dims_[0] * (jj + dims_[1] * (botk));
-                                    if ( ((actnum.empty() || actnum[c_below]) && pv[c_below] > minpvv[c_below]) || ((actnum.empty() || !actnum[c_below]) && thickness[c_below] > z_tolerance)) {
-                                        break;
-                                    }
-                                }
-                            }
+        for (int kk = 0; kk < dims_[2]; ++kk) {
+            const int c = c0 + layer * kk;
+            if (pv[c] < minpvv[c] && (actnum.empty() || actnum[c])) {
+                // Move deeper (higher k) coordinates to lower k coordinates.
+                // i.e remove the cell
+                double* cz = column_zcorn.data() + 8 * kk;
+                for (int count = 0; count < 4; ++count) {
+                    cz[count + 4] = cz[count];
+                }
+
+                // Find the next cell
+                int kk_iter = kk + 1;
+                if (kk_iter == dims_[2]) // we are at the end of the pillar.
+                    continue;
+
+                int c_below = c0 + layer * kk_iter;
+                // bypass inactive cells with thickness less then the tolerance
+                while ( ((actnum.empty() || !actnum[c_below]) && (thickness[c_below] <= z_tolerance))  ){
+                    // move these cell to the posistion of the first cell to make the
+                    // coordinates strictly sorted
+                    std::copy(cz, cz + 8, column_zcorn.begin() + 8 * kk_iter);
+                    kk_iter ++;
+                    if (kk_iter == dims_[2])
+                        break;
+
+                    c_below = c0 + layer * kk_iter;
+                }
+
+                if (kk_iter == dims_[2]) // we have come to the end of the pillar.
+                    continue;
 
-                            // Add a connection if the cell above and below is active and has porv > minpv
-                            if ((actnum.empty() || (actnum[c_above] && actnum[c_below])) && pv[c_above] > minpvv[c_above] && pv[c_below] > minpvv[c_below]) {
-                                nnc.insert(std::make_pair(c_above, c_below));
+                // create nnc if false or merge the cells if true
+                if (!mergeMinPVCells) {
+
+                    // We are at the top, so no nnc is created.
+                    if (kk == 0)
+                        continue;
+
+                    int c_above = c0 + layer * (kk - 1);
+
+                    // Bypass inactive cells with thickness below tolerance and active cells with volume below minpv
+                    if (((actnum.empty() || !actnum[c_above]) && thickness[c_above] < z_tolerance) || ((actnum.empty() || actnum[c_above]) && pv[c_above] < minpvv[c_above]) ) {
+                        for (int topk = kk - 2; topk > 0; --topk) {
+                            c_above = c0 + layer * topk;
+                            if ( ((actnum.empty() || actnum[c_above]) && pv[c_above] > minpvv[c_above]) || ((actnum.empty() || !actnum[c_above]) && thickness[c_above] > z_tolerance)) {
+                                break;
                             }
-                        } else {
+                        }
+                    }
 
-                            // Set lower k coordinates of cell below to upper cells's coordinates.
-                            // i.e fill the void using the cell below
-                            std::array<double, 8> cz_below = getCellZcorn(ii, jj, kk_iter, zcorn);
-                            for (int count = 0; count < 4; ++count) {
-                                cz_below[count] = cz[count];
+                    // Bypass inactive cells with thickness below tolerance and active cells with volume below minpv
+                    if (((actnum.empty() || (!actnum[c_below])) && thickness[c_below] < z_tolerance) || ((actnum.empty() || actnum[c_below]) && pv[c_below] < minpvv[c]) ) {
+                        for (int botk = kk_iter + 1; botk <  dims_[2]; ++botk) {
+                            c_below = c0 + layer * botk;
+                            if ( ((actnum.empty() || actnum[c_below]) && pv[c_below] > minpvv[c_below]) || ((actnum.empty() || !actnum[c_below]) && thickness[c_below] > z_tolerance)) {
+                                break;
                             }
-                            setCellZcorn(ii, jj, kk_iter, cz_below, zcorn);
                         }
+                    }
 
+                    // Add a connection if the cell above and below is active and has porv > minpv
+                    if ((actnum.empty() || (actnum[c_above] && actnum[c_below])) && pv[c_above] > minpvv[c_above] && pv[c_below] > minpvv[c_below]) {
+                        nnc.emplace_back(c_above, c_below);
                     }
+                } else {
+
+                    // Set lower k coordinates of cell below to upper cells's coordinates.
+                    // i.e fill the void using the cell below
+                    std::copy(cz, cz + 4, column_zcorn.begin() + 8 * kk_iter);
                 }
 
             }
         }
-        return nnc;
+
+        for (int kk = 0; kk < dims_[2]; ++kk) {
+            std::array<double, 8> cz;
+            std::copy(column_zcorn.begin() + 8 * kk, column_zcorn.begin() + 8 * (kk + 1), cz.begin());
+            setCellZcorn(ii, jj, kk, cz, zcorn);
+        }
     }
 
 
@@ -26,11 +26,16 @@
 #include <opm/parser/eclipse/EclipseState/Grid/FaceDir.hpp>
 #include <opm/parser/eclipse/EclipseState/Grid/PinchMode.hpp>
 #include <opm/parser/eclipse/Units/Units.hpp>
+#include <opm/grid/utility/SparseTable.hpp>
+#include <dune/grid/common/gridenums.hh>
 #include <array>
 #include <iostream>
 #include <algorithm>
-#include <unordered_map>
+#include <exception>
 #include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace Opm
 {
@@ -51,14 +56,25 @@ namespace Opm
         /// Generate NNCs for cells which pv is less than MINPV.
         /// \param[in]    Grid    cpgrid or unstructured grid
         /// \param[in]    htrans  half cell transmissibility, size is number of cellfaces.
+        /// \param[in]    actnum  active flags for all the cartesian cells
         /// \param[in]    multz   Z+ transmissibility multiplier for all active cells
         /// \param[in]    pv      pore volume for all the cartesian cells
         /// \param[in]    nnc     non-neighbor connection class
         /// Algorithm:
-        /// 1. Mark all the cells which pv less than minpvValue.
-        /// 2. Find out proper pinchouts column and associate top and bottom cells.
+        /// 1. Find the columns of cells which pv is less than minpvValue,
+        ///    each (i,j) column in parallel.
+        /// 2. Associate top and bottom cells with each column.
         /// 3. Compute transmissibility for nncs.
         /// 4. Apply multz due to different multz options.
+        ///
+        /// The top and bottom cells are the nearest cells above and below a
+        /// segment that are active in actnum. No NNC is created if there is
+        /// none, or if it is not in the grid, e.g. because it was removed
+        /// for having zero thickness.
+        ///
+        /// If the grid is distributed, the NNCs of a column are created by
+        /// the process that owns its top cell. The bottom cell has to be
+        /// present on that process, too, otherwise an exception is thrown.
         void process(const Grid& grid,
                      const std::vector<double>& htrans,
                      const std::vector<int>& actnum,
@@ -71,27 +87,47 @@ namespace Opm
         double thickness_;
         PinchMode::ModeEnum transMode_;
         PinchMode::ModeEnum multzMode_;
-        
-        /// Mark minpved cells.
-        std::vector<int> getMinpvCells_(const std::vector<int>& actnum,
-                                        const std::vector<double>& pv);
-
-        /// Get the interface for two cells.
-        int interface_(const Grid& grid,
-                       const int cellIdx1,
-                       const int cellIdx2);
-
-        /// Get the proper face for one cell.
-        int interface_(const Grid& grid,
-                       const int cellIdx,
-                       const Opm::FaceDir::DirEnum& faceDir);
-
-        /// Get pinchouts column.
-        std::vector<std::vector<int> >
-        getPinchoutsColumn_(const Grid& grid,
-                            const std::vector<int>& actnum,
-                            const std::vector<double>& pv);
-        
+
+        /// A pinched column: the top and bottom cells (cartesian
+        /// indices) and the faces and half-faces connecting them to the
+        /// removed cells.
+        struct Pinch
+        {
+            int topCell;
+            int botCell;
+            int topFace;
+            int botFace;
+            int topHalfFace;
+            int botHalfFace;
+        };
+
+        /// Faces and half-faces of the cells by face tag.
+        struct CellFaces
+        {
+            /// Face with tag t of cell c at 6*c + t, -1 if none.
+            std::vector<int> face;
+            /// Half-face index of those faces, i.e. index into htrans.
+            std::vector<int> halfFace;
+            /// Half-face index of side s of face f at 2*f + s, -1 if none.
+            std::vector<int> faceHalfFace;
+        };
+
+        /// Get map from cartesian to active cell index, -1 for cells not in the grid.
+        std::vector<int> getActiveCellIdxMap_(const Grid& grid,
+                                              const int numCartesianCells);
+
+        /// Get the faces of all cells by direction.
+        CellFaces getCellFaces_(const Grid& grid);
+
+        /// Mark the cells owned by this process.
+        template <class G>
+        static auto getOwnedCells_(const G& grid, int)
+            -> decltype(grid.leafGridView(), std::vector<char>());
+
+        /// Grids without a grid view are not distributed.
+        template <class G>
+        static std::vector<char> getOwnedCells_(const G& grid, long);
+
         /// Get global cell index.
         int getGlobalIndex_(const int i, const int j, const int k, const int* dims);
 
@@ -99,37 +135,63 @@ namespace Opm
         std::array<int, 3> getCartIndex_(const int idx,
                                          const int* dims);
 
-        /// Compute transmissibility for nnc.
+        /// Get the proper face and half-face for one cell.
+        std::pair<int, int> interface_(const CellFaces& cellFaces,
+                                       const int activeCellIdx,
+                                       const int cellIdx,
+                                       const Opm::FaceDir::DirEnum& faceDir);
+
+        /// Get the pinches of column (x, y), appending them together with
+        /// their first removed cell, and their segments including the
+        /// top cell. seg is scratch space.
+        void getPinchoutsColumn_(const Grid& grid,
+                                 const int x,
+                                 const int y,
+                                 const std::vector<int>& actnum,
+                                 const std::vector<double>& pv,
+                                 const std::vector<int>& activeIdx,
+                                 const std::vector<char>& owned,
+                                 const bool distributed,
+                                 const CellFaces& cellFaces,
+                                 std::vector<std::pair<int, Pinch> >& pinches,
+                                 SparseTable<int>& segments,
+                                 std::vector<int>& seg);
+
+        /// Get the pinched columns, and the cells of their segments
+        /// including the top cell, sorted by the first removed cell.
+        void getPinchoutsColumns_(const Grid& grid,
+                                  const std::vector<int>& actnum,
+                                  const std::vector<double>& pv,
+                                  const std::vector<int>& activeIdx,
+                                  const std::vector<char>& owned,
+                                  const bool distributed,
+                                  const CellFaces& cellFaces,
+                                  std::vector<Pinch>& pinches,
+                                  SparseTable<int>& segments);
+
+        /// Compute transmissibility for all faces, including the nncs.
         std::vector<double> transCompute_(const Grid& grid,
                                           const std::vector<double>& htrans,
-                                          const std::vector<int>& pinCells,
-                                          const std::vector<int>& pinFaces);
+                                          const CellFaces& cellFaces,
+                                          const std::vector<Pinch>& pinches);
 
-        /// Get map between half-trans index and the pair of face index and cell index.
-        std::vector<int> getHfIdxMap_(const Grid& grid);
-        
-        /// Get active cell index.
-        int getActiveCellIdx_(const Grid& grid,
-                              const int globalIdx);
-
-        /// Item 4 in PINCH keyword. 
+        /// Item 4 in PINCH keyword.
         void transTopbot_(const Grid& grid,
                           const std::vector<double>& htrans,
                           const std::vector<int>& actnum,
                           const std::vector<double>& multz,
                           const std::vector<double>& pv,
                           NNC& nnc);
-        
+
         /// Item 5 in PINCH keyword.
-        std::unordered_multimap<int, double> multzOptions_(const Grid& grid,
-                                                           const std::vector<int>& pinCells,
-                                                           const std::vector<int>& pinFaces,
-                                                           const std::vector<double>& multz,
-                                                           const std::vector<std::vector<int> >& seg);
+        std::vector<std::pair<int, double> > multzOptions_(const std::vector<Pinch>& pinches,
+                                                           const SparseTable<int>& segments,
+                                                           const std::vector<int>& activeIdx,
+                                                           const std::vector<double>& multz);
 
         /// Apply multz vector to face transmissibility.
         void applyMultz_(std::vector<double>& trans,
-                         const std::unordered_multimap<int, double>& multzmap);
+                         const std::vector<std::pair<int, double> >& multzFaces);
 
     };
 
@@ -172,195 +234,316 @@ namespace Opm
 
 
     template<class Grid>
-    inline int PinchProcessor<Grid>::interface_(const Grid& grid,
-                                                const int cellIdx1,
-                                                const int cellIdx2)
+    inline std::vector<int> PinchProcessor<Grid>::getActiveCellIdxMap_(const Grid& grid,
+                                                                       const int numCartesianCells)
     {
-        const auto cell_faces = Opm::UgGridHelpers::cell2Faces(grid);
-        int commonFace = -1;
-        const int actCellIdx1 = getActiveCellIdx_(grid, cellIdx1);
-        const int actCellIdx2 = getActiveCellIdx_(grid, cellIdx2);
-        const auto cellFacesRange1 = cell_faces[actCellIdx1];
-        const auto cellFacesRange2 = cell_faces[actCellIdx2];
-        for (const auto& f1 : cellFacesRange1) {
-            for (const auto& f2 : cellFacesRange2) {
-                if (f1 == f2) {
-                    commonFace = f1;
-                    break;
-                }
-            }
+        const int nc = Opm::UgGridHelpers::numCells(grid);
+        const int* global_cell = Opm::UgGridHelpers::globalCell(grid);
+        std::vector<int> activeIdx(numCartesianCells, -1);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < nc; ++i) {
+            activeIdx[global_cell ? global_cell[i] : i] = i;
         }
+        return activeIdx;
+    }
+
 
-        if (commonFace == -1) {
-            const auto dims = Opm::UgGridHelpers::cartDims(grid);
-            const auto ijk1 = getCartIndex_(cellIdx1, dims);
-            const auto ijk2 = getCartIndex_(cellIdx2, dims);
 
-            OPM_THROW(std::logic_error, "Couldn't find the common face for cell " 
-                      << cellIdx1<< "("<<ijk1[0]<<","<<ijk1[1]<<","<<ijk1[2]<<")"
-                      << " and " << cellIdx2<<"("<<ijk2[0]<<","<<ijk2[1]<<","<<ijk2[2]<<")");
+    template<class Grid>
+    inline typename PinchProcessor<Grid>::CellFaces
+    PinchProcessor<Grid>::getCellFaces_(const Grid& grid)
+    {
+        const int nc = Opm::UgGridHelpers::numCells(grid);
+        const int nf = Opm::UgGridHelpers::numFaces(grid);
+        const auto cell_faces = Opm::UgGridHelpers::cell2Faces(grid);
+        const auto& f2c = Opm::UgGridHelpers::faceCells(grid);
+
+        // Half-faces are numbered consecutively over the cells.
+        std::vector<int> hfStart(nc + 1, 0);
+        for (int c = 0; c < nc; ++c) {
+            const auto cellFacesRange = cell_faces[c];
+            hfStart[c + 1] = hfStart[c] + std::distance(cellFacesRange.begin(), cellFacesRange.end());
         }
 
-        return commonFace;
+        CellFaces cellFaces;
+        cellFaces.face.assign(6*nc, -1);
+        cellFaces.halfFace.assign(6*nc, -1);
+        cellFaces.faceHalfFace.assign(2*nf, -1);
+#pragma omp parallel for schedule(static)
+        for (int c = 0; c < nc; ++c) {
+            const auto cellFacesRange = cell_faces[c];
+            int hf = hfStart[c];
+            for (auto cellFaceIter = cellFacesRange.begin(); cellFaceIter != cellFacesRange.end(); ++cellFaceIter, ++hf) {
+                const int f = *cellFaceIter;
+                const int tag = Opm::UgGridHelpers::faceTag(grid, cellFaceIter);
+                if (tag >= 0 && tag < 6) {
+                    // Like a search over the faces, the last face with a tag wins.
+                    cellFaces.face[6*c + tag] = f;
+                    cellFaces.halfFace[6*c + tag] = hf;
+                }
+                cellFaces.faceHalfFace[2*f + (f2c(f, 0) != c)] = hf;
+            }
+        }
+        return cellFaces;
     }
 
 
 
     template<class Grid>
-    inline int PinchProcessor<Grid>::interface_(const Grid& grid,
-                                                const int cellIdx,
-                                                const Opm::FaceDir::DirEnum& faceDir)
+    template<class G>
+    inline auto PinchProcessor<Grid>::getOwnedCells_(const G& grid, int)
+        -> decltype(grid.leafGridView(), std::vector<char>())
     {
-        const auto actCellIdx = getActiveCellIdx_(grid, cellIdx);
-        const auto cell_faces = Opm::UgGridHelpers::cell2Faces(grid);
-        const auto cellFacesRange = cell_faces[actCellIdx];
-        int faceIdx = -1;
-        for (auto cellFaceIter = cellFacesRange.begin(); cellFaceIter != cellFacesRange.end(); ++cellFaceIter) {
-            int tag = Opm::UgGridHelpers::faceTag(grid, cellFaceIter);
-            if ( (faceDir == Opm::FaceDir::ZMinus && tag == 4) || (faceDir == Opm::FaceDir::ZPlus && tag == 5) ) {
-                faceIdx = *cellFaceIter;
-            }
+        const auto& view = grid.leafGridView();
+        std::vector<char> owned(view.size(0), 0);
+        for (auto it = view.template begin<0>(), end = view.template end<0>(); it != end; ++it) {
+            owned[view.indexSet().index(*it)] = (it->partitionType() == Dune::InteriorEntity);
         }
-        
-        if (faceIdx == -1) {
-            OPM_THROW(std::logic_error, "Couldn't find the face for cell ." << cellIdx);
-        }
-        
-        return faceIdx;
+        return owned;
     }
 
 
 
     template<class Grid>
-    inline std::vector<int> PinchProcessor<Grid>::getMinpvCells_(const std::vector<int>& actnum,
-                                                                 const std::vector<double>& pv)
+    template<class G>
+    inline std::vector<char> PinchProcessor<Grid>::getOwnedCells_(const G& grid, long)
     {
-        std::vector<int> minpvCells(pv.size(), 0);
-        for (int idx = 0; idx < static_cast<int>(pv.size()); ++idx) {
-            if (actnum[idx]) {
-                if (pv[idx] < minpvValue_) {
-                    minpvCells[idx] = 1;
-                }
-            }
-        }     
-        return minpvCells;
+        return std::vector<char>(Opm::UgGridHelpers::numCells(grid), 1);
     }
 
 
 
     template<class Grid>
-    inline std::vector<int> PinchProcessor<Grid>::getHfIdxMap_(const Grid& grid)
+    inline std::pair<int, int> PinchProcessor<Grid>::interface_(const CellFaces& cellFaces,
+                                                                const int activeCellIdx,
+                                                                const int cellIdx,
+                                                                const Opm::FaceDir::DirEnum& faceDir)
     {
-        std::vector<int> hf_ix(2*Opm::UgGridHelpers::numFaces(grid), -1);
-        const auto& f2c = Opm::UgGridHelpers::faceCells(grid);
-        const auto& cf = Opm::UgGridHelpers::cell2Faces(grid);
-        
-        for (int c = 0, i = 0; c < Opm::UgGridHelpers::numCells(grid); ++c) {
-            for (const auto& f: cf[c]) {
-                const auto off = 0 + (f2c(f, 0) != c);
-                hf_ix[2*f + off] = i++;
-            }
+        int faceIdx = -1;
+        int halfFaceIdx = -1;
+        if (activeCellIdx != -1) {
+            const int tag = (faceDir == Opm::FaceDir::ZMinus) ? 4 : 5;
+            faceIdx = cellFaces.face[6*activeCellIdx + tag];
+            halfFaceIdx = cellFaces.halfFace[6*activeCellIdx + tag];
+        }
+
+        if (faceIdx == -1) {
+            OPM_THROW(std::logic_error, "Couldn't find the face for cell ." << cellIdx);
         }
-        return hf_ix;
+
+        return std::make_pair(faceIdx, halfFaceIdx);
     }
 
 
 
     template<class Grid>
-    inline int PinchProcessor<Grid>::getActiveCellIdx_(const Grid& grid,
-                                                       const int globalIdx)
+    inline void PinchProcessor<Grid>::getPinchoutsColumn_(const Grid& grid,
+                                                          const int x,
+                                                          const int y,
+                                                          const std::vector<int>& actnum,
+                                                          const std::vector<double>& pv,
+                                                          const std::vector<int>& activeIdx,
+                                                          const std::vector<char>& owned,
+                                                          const bool distributed,
+                                                          const CellFaces& cellFaces,
+                                                          std::vector<std::pair<int, Pinch> >& pinches,
+                                                          SparseTable<int>& segments,
+                                                          std::vector<int>& seg)
     {
-        const int nc = Opm::UgGridHelpers::numCells(grid);
-        const int* global_cell = Opm::UgGridHelpers::globalCell(grid);
-        int idx = -1;
-        for (int i = 0; i < nc; ++i) {
-            if (global_cell[i] == globalIdx) {
-                idx = i;
-                break;
+        const int* dims = Opm::UgGridHelpers::cartDims(grid);
+        for (int z = 0; z < dims[2]; ++z) {
+            const int c = getGlobalIndex_(x, y, z, dims);
+            if (!(actnum[c] && pv[c] < minpvValue_)) {
+                continue;
+            }
+            // The segment of consecutive cells which pv is less than minpv.
+            const int segTop = z;
+            while (z + 1 < dims[2]) {
+                const int cc = getGlobalIndex_(x, y, z + 1, dims);
+                if (!(actnum[cc] && pv[cc] < minpvValue_)) {
+                    break;
+                }
+                ++z;
+            }
+            const int segBot = z;
+            if (!((segTop - 1) >= 0 && (segBot + 1) < dims[2])) {
+                continue;
+            }
+
+            int topCell = getGlobalIndex_(x, y, segTop - 1, dims);
+            int botCell = getGlobalIndex_(x, y, segBot + 1, dims);
+            /// for any segments, we need to find the active top and bottom cells.
+            /// if the original segment's top and bottom is inactive, we need to lookup
+            /// the column until they're found otherwise just ignore this segment.
+            if (!actnum[topCell]) {
+                for (int topk = segTop - 2; topk >= 0; --topk) {
+                    topCell = getGlobalIndex_(x, y, topk, dims);
+                    if (actnum[topCell]) {
+                        break;
+                    }
+                }
+            }
+            // Only the owner of the top cell creates the connection. An
+            // active top cell that is not in the grid was removed when the
+            // grid was built, or, in a distributed grid, it is on another
+            // process. There is nothing to connect here in either case.
+            const int topActive = activeIdx[topCell];
+            if (!actnum[topCell] || topActive == -1 || !owned[topActive]) {
+                continue;
             }
+            if (!actnum[botCell]) {
+                for (int botk = segBot + 2; botk < dims[2]; ++botk) {
+                    botCell = getGlobalIndex_(x, y, botk, dims);
+                    if (actnum[botCell]) {
+                        break;
+                    }
+                }
+            }
+            if (!actnum[botCell]) {
+                continue;
+            }
+            const int botActive = activeIdx[botCell];
+            if (botActive == -1) {
+                // Like a missing top cell, a missing bottom cell of a serial
+                // grid was removed. In a distributed grid it may be on another
+                // process, where the connection cannot be created.
+                if (distributed) {
+                    const auto ijk = getCartIndex_(botCell, dims);
+                    OPM_THROW(std::logic_error, "The bottom cell " << botCell
+                              << "(" << ijk[0] << "," << ijk[1] << "," << ijk[2] << ")"
+                              << " of a pinched column is not present on the process owning its top cell");
+                }
+                continue;
+            }
+
+            Pinch pinch;
+            pinch.topCell = topCell;
+            pinch.botCell = botCell;
+            std::tie(pinch.topFace, pinch.topHalfFace) = interface_(cellFaces, topActive, topCell, Opm::FaceDir::ZPlus);
+            std::tie(pinch.botFace, pinch.botHalfFace) = interface_(cellFaces, botActive, botCell, Opm::FaceDir::ZMinus);
+            pinches.emplace_back(getGlobalIndex_(x, y, segTop, dims), pinch);
+
+            seg.clear();
+            seg.push_back(topCell);
+            for (int zz = segTop; zz <= segBot; ++zz) {
+                seg.push_back(getGlobalIndex_(x, y, zz, dims));
+            }
+            segments.appendRow(seg.begin(), seg.end());
         }
-        return idx;
     }
 
 
 
     template<class Grid>
-    inline std::vector<double> PinchProcessor<Grid>::transCompute_(const Grid& grid,
-                                                                   const std::vector<double>& htrans,
-                                                                   const std::vector<int>& pinCells,
-                                                                   const std::vector<int>& pinFaces)
+    inline void PinchProcessor<Grid>::getPinchoutsColumns_(const Grid& grid,
+                                                           const std::vector<int>& actnum,
+                                                           const std::vector<double>& pv,
+                                                           const std::vector<int>& activeIdx,
+                                                           const std::vector<char>& owned,
+                                                           const bool distributed,
+                                                           const CellFaces& cellFaces,
+                                                           std::vector<Pinch>& pinches,
+                                                           SparseTable<int>& segments)
     {
-        const int nc = Opm::UgGridHelpers::numCells(grid);
-        const int nf = Opm::UgGridHelpers::numFaces(grid);
-        std::vector<double> trans(nf, 0);
-        int cellFaceIdx = 0;
-        auto cell_faces = Opm::UgGridHelpers::cell2Faces(grid);
-        const auto& hfmap = getHfIdxMap_(grid); 
-        const auto& f2c = Opm::UgGridHelpers::faceCells(grid);
-        for (int cellIdx = 0; cellIdx < nc; ++cellIdx) {
-            auto cellFacesRange = cell_faces[cellIdx];
-            for (auto cellFaceIter = cellFacesRange.begin(); cellFaceIter != cellFacesRange.end(); ++cellFaceIter, ++cellFaceIdx) {
-                const int faceIdx = *cellFaceIter;
-                const auto pos = std::find(pinFaces.begin(), pinFaces.end(), faceIdx);
-                if (pos == pinFaces.end()) {
-                    trans[faceIdx] += 1. / htrans[cellFaceIdx];
-                } else {
-                    const int idx1 = std::distance(std::begin(pinFaces), pos);
-                    int idx2;
-                    if (idx1 % 2 == 0) {
-                        idx2 = idx1 + 1;
-                    } else {
-                        idx2 = idx1 - 1;
+        const int* dims = Opm::UgGridHelpers::cartDims(grid);
+        const int numColumns = dims[0] * dims[1];
+
+        // Pinches in the order of the threads, with the cartesian index
+        // of their first removed cell for sorting.
+        std::vector<std::pair<int, Pinch> > unsortedPinches;
+        SparseTable<int> unsortedSegments;
+        // Exceptions must not leave the parallel region.
+        std::exception_ptr error;
+
+#pragma omp parallel
+        {
+            std::vector<std::pair<int, Pinch> > threadPinches;
+            SparseTable<int> threadSegments;
+            std::vector<int> seg;
+#pragma omp for schedule(static)
+            for (int column = 0; column < numColumns; ++column) {
+                try {
+                    getPinchoutsColumn_(grid, column % dims[0], column / dims[0], actnum, pv,
+                                        activeIdx, owned, distributed, cellFaces, threadPinches, threadSegments, seg);
+                }
+                catch (...) {
+#pragma omp critical
+                    if (!error) {
+                        error = std::current_exception();
                     }
-                    const int f1 = hfmap[2*pinFaces[idx1] + (f2c(pinFaces[idx1], 0) != getActiveCellIdx_(grid, pinCells[idx1]))];
-                    const int f2 = hfmap[2*pinFaces[idx2] + (f2c(pinFaces[idx2], 0) != getActiveCellIdx_(grid, pinCells[idx2]))];
-                    trans[faceIdx] = (1. / htrans[f1] + 1. / htrans[f2]);
-                    trans[pinFaces[idx2]] = trans[faceIdx];
+                }
+            }
+#pragma omp critical
+            {
+                for (int i = 0; i < threadSegments.size(); ++i) {
+                    unsortedPinches.push_back(threadPinches[i]);
+                    unsortedSegments.appendRow(threadSegments[i].begin(), threadSegments[i].end());
                 }
             }
         }
 
-        for (auto f = 0; f < nf; ++f) {
-            trans[f] = 1. / trans[f];
+        if (error) {
+            std::rethrow_exception(error);
         }
 
-        return trans;
+        // Order the columns by their first removed cell, i.e. layer by layer.
+        std::vector<int> order(unsortedPinches.size());
+        for (int i = 0; i < static_cast<int>(order.size()); ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(),
+                  [&unsortedPinches](const int a, const int b)
+                  { return unsortedPinches[a].first < unsortedPinches[b].first; });
+
+        pinches.clear();
+        pinches.reserve(order.size());
+        segments.clear();
+        segments.reserve(order.size(), unsortedSegments.dataSize());
+        for (const int i : order) {
+            pinches.push_back(unsortedPinches[i].second);
+            segments.appendRow(unsortedSegments[i].begin(), unsortedSegments[i].end());
+        }
     }
 
 
 
     template<class Grid>
-    inline std::vector<std::vector<int>> PinchProcessor<Grid>::getPinchoutsColumn_(const Grid& grid,
-                                                                                   const std::vector<int>& actnum,
-                                                                                   const std::vector<double>& pv)
+    inline std::vector<double> PinchProcessor<Grid>::transCompute_(const Grid& grid,
+                                                                   const std::vector<double>& htrans,
+                                                                   const CellFaces& cellFaces,
+                                                                   const std::vector<Pinch>& pinches)
     {
-        const int* dims = Opm::UgGridHelpers::cartDims(grid);
-        std::vector<int> minpvCells = getMinpvCells_(actnum, pv);
-        std::vector<std::vector<int>> segment;
-        for (int z = 0; z < dims[2]; ++z) {
-            for (int y = 0; y < dims[1]; ++y) {
-                for (int x = 0; x < dims[0]; ++x) {
-                    const int c = getGlobalIndex_(x, y, z, dims);
-                    std::vector<int> seg;
-                    if (minpvCells[c]) {
-                        seg.push_back(c);
-                        minpvCells[c] = 0;
-                        for (int zz = z+1; zz < dims[2]; ++zz) {
-                            const int cc =  getGlobalIndex_(x, y, zz, dims);
-                            if (minpvCells[cc]) {
-                                seg.push_back(cc);
-                                minpvCells[cc] = 0;
-                            } else {
-                                break;
-                            }
-                        }
-                        segment.push_back(seg);
+        const int nf = Opm::UgGridHelpers::numFaces(grid);
+
+        // The first pinch of each face connected to removed cells.
+        std::vector<int> facePinch(nf, -1);
+        for (int i = 0; i < static_cast<int>(pinches.size()); ++i) {
+            if (facePinch[pinches[i].topFace] == -1) {
+                facePinch[pinches[i].topFace] = i;
+            }
+            if (facePinch[pinches[i].botFace] == -1) {
+                facePinch[pinches[i].botFace] = i;
+            }
+        }
+
+        std::vector<double> trans(nf, 0);
+#pragma omp parallel for schedule(static)
+        for (int f = 0; f < nf; ++f) {
+            if (facePinch[f] == -1) {
+                for (int side = 0; side < 2; ++side) {
+                    const int hf = cellFaces.faceHalfFace[2*f + side];
+                    if (hf != -1) {
+                        trans[f] += 1. / htrans[hf];
                     }
                 }
+            } else {
+                const Pinch& pinch = pinches[facePinch[f]];
+                trans[f] = (1. / htrans[pinch.topHalfFace] + 1. / htrans[pinch.botHalfFace]);
             }
+            trans[f] = 1. / trans[f];
         }
 
-        return segment;
+        return trans;
     }
 
 
@@ -374,99 +557,84 @@ namespace Opm
                                                    NNC& nnc)
     {
         const int* dims = Opm::UgGridHelpers::cartDims(grid);
-        std::vector<int> pinFaces;
-        std::vector<int> pinCells;
-        std::vector<std::vector<int> > newSeg;
-        auto minpvSeg = getPinchoutsColumn_(grid, actnum, pv);
-        for (auto& seg : minpvSeg) {
-            std::array<int, 3> ijk1 = getCartIndex_(seg.front(), dims);
-            std::array<int, 3> ijk2 = getCartIndex_(seg.back(), dims);
-            auto tmp = seg;
-            if ((ijk1[2]-1) >= 0 && (ijk2[2]+1) < dims[2]) {
-                int topCell = getGlobalIndex_(ijk1[0], ijk1[1], ijk1[2]-1, dims);
-                int botCell = getGlobalIndex_(ijk2[0], ijk2[1], ijk2[2]+1, dims);
-                /// for any segments, we need to find the active top and bottom cells.
-                /// if the original segment's top and bottom is inactive, we need to lookup
-                /// the column until they're found otherwise just ignore this segment.
-                if (!actnum[topCell]) {
-                    for (int topk = ijk1[2]-2; topk > 0; --topk) {
-                        topCell = getGlobalIndex_(ijk1[0], ijk1[1], topk, dims);
-                        if (actnum[topCell]) {
-                            break;
-                        }
-                    }
-                }
-                pinFaces.push_back(interface_(grid, topCell, Opm::FaceDir::ZPlus));
-                pinCells.push_back(topCell);
-
-                tmp.insert(tmp.begin(), topCell);
-                newSeg.push_back(tmp);
-                if (!actnum[botCell]) {
-                    for (int botk = ijk2[2]+2; botk < dims[2]; ++botk) {
-                        botCell = getGlobalIndex_(ijk2[0], ijk2[1], botk, dims);
-                        if (actnum[botCell]) {
-                            break;
-
-                        }
-                    }
-                }
-                pinFaces.push_back(interface_(grid, botCell, Opm::FaceDir::ZMinus));
-                pinCells.push_back(botCell);
-
-            }
-        }
-
-        auto faceTrans = transCompute_(grid, htrans, pinCells, pinFaces);
-        auto multzmap = multzOptions_(grid, pinCells, pinFaces, multz, newSeg);
-        applyMultz_(faceTrans, multzmap);
-        for (int i = 0; i < static_cast<int>(pinCells.size())/2; ++i) {
-            nnc.addNNC(static_cast<int>(pinCells[2*i]), static_cast<int>(pinCells[2*i+1]), faceTrans[pinFaces[2*i]]);
+        const auto activeIdx = getActiveCellIdxMap_(grid, dims[0] * dims[1] * dims[2]);
+        const auto cellFaces = getCellFaces_(grid);
+        const auto owned = getOwnedCells_(grid, 0);
+        // Only distributed grids have cells owned by other processes.
+        const bool distributed = std::find(owned.begin(), owned.end(), 0) != owned.end();
+
+        std::vector<Pinch> pinches;
+        SparseTable<int> segments;
+        getPinchoutsColumns_(grid, actnum, pv, activeIdx, owned, distributed, cellFaces, pinches, segments);
+
+        auto faceTrans = transCompute_(grid, htrans, cellFaces, pinches);
+        auto multzFaces = multzOptions_(pinches, segments, activeIdx, multz);
+        applyMultz_(faceTrans, multzFaces);
+        for (const auto& pinch : pinches) {
+            nnc.addNNC(pinch.topCell, pinch.botCell, faceTrans[pinch.topFace]);
         }
     }
-        
 
- 
+
 
     template<class Grid>
-    inline std::unordered_multimap<int, double> PinchProcessor<Grid>::multzOptions_(const Grid& grid,
-                                                                                    const std::vector<int>& pinCells,
-                                                                                    const std::vector<int>& pinFaces,
-                                                                                    const std::vector<double>& multz,
-                                                                                    const std::vector<std::vector<int> >& segs)
+    inline std::vector<std::pair<int, double> >
+    PinchProcessor<Grid>::multzOptions_(const std::vector<Pinch>& pinches,
+                                        const SparseTable<int>& segments,
+                                        const std::vector<int>& activeIdx,
+                                        const std::vector<double>& multz)
     {
-        std::unordered_multimap<int, double> multzmap;
+        std::vector<std::pair<int, double> > multzFaces;
         if (multzMode_ == PinchMode::ModeEnum::TOP) {
-            for (int i = 0; i < static_cast<int>(pinFaces.size())/2; ++i) {
-                multzmap.insert(std::make_pair(pinFaces[2*i], multz[getActiveCellIdx_(grid, pinCells[2*i])]));
-                multzmap.insert(std::make_pair(pinFaces[2*i+1],multz[getActiveCellIdx_(grid, pinCells[2*i])]));
+            for (const auto& pinch : pinches) {
+                const double multzValue = multz[activeIdx[pinch.topCell]];
+                multzFaces.emplace_back(pinch.topFace, multzValue);
+                multzFaces.emplace_back(pinch.botFace, multzValue);
             }
         } else if (multzMode_ == PinchMode::ModeEnum::ALL) {
-            for (auto& seg : segs) {
+            // The connected cells in the order top, bottom, top, ..., and
+            // their position there, to find the first appearance of a cell.
+            std::vector<std::pair<int, int> > pinCells;
+            pinCells.reserve(2*pinches.size());
+            for (int i = 0; i < static_cast<int>(pinches.size()); ++i) {
+                pinCells.emplace_back(pinches[i].topCell, 2*i);
+                pinCells.emplace_back(pinches[i].botCell, 2*i + 1);
+            }
+            std::sort(pinCells.begin(), pinCells.end());
+
+            for (int i = 0; i < segments.size(); ++i) {
                 //find the min multz in seg cells.
                 auto multzValue = std::numeric_limits<double>::max();
-                for (auto& cellIdx : seg) {
-                    auto activeIdx = getActiveCellIdx_(grid, cellIdx);
-                    if (activeIdx != -1) {
-                        multzValue = std::min(multzValue, multz[activeIdx]);
+                for (const int cellIdx : segments[i]) {
+                    const int active = activeIdx[cellIdx];
+                    if (active != -1) {
+                        multzValue = std::min(multzValue, multz[active]);
                     }
                 }
                 //find the right face.
-                auto index = std::distance(std::begin(pinCells), std::find(pinCells.begin(), pinCells.end(), seg.front()));
-                multzmap.insert(std::make_pair(pinFaces[index], multzValue));
-                multzmap.insert(std::make_pair(pinFaces[index+1], multzValue));
+                const int index = std::lower_bound(pinCells.begin(), pinCells.end(),
+                                                   std::make_pair(segments[i][0], 0))->second;
+                const Pinch& pinch = pinches[index / 2];
+                if (index % 2 == 0) {
+                    multzFaces.emplace_back(pinch.topFace, multzValue);
+                    multzFaces.emplace_back(pinch.botFace, multzValue);
+                } else {
+                    multzFaces.emplace_back(pinch.botFace, multzValue);
+                    multzFaces.emplace_back(pinches[index / 2 + 1].topFace, multzValue);
+                }
             }
         }
 
-        return multzmap;
+        return multzFaces;
     }
 
 
 
     template<class Grid>
     inline void PinchProcessor<Grid>::applyMultz_(std::vector<double>& trans,
-                                                  const std::unordered_multimap<int, double>& multzmap)
+                                                  const std::vector<std::pair<int, double> >& multzFaces)
     {
-        for (auto& x : multzmap) {
+        for (const auto& x : multzFaces) {
             trans[x.first] *= x.second;
         }
     }
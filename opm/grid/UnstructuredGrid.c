@@ -21,7 +21,10 @@
 #include <opm/grid/UnstructuredGrid.h>
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -176,43 +179,169 @@ allocate_grid(size_t ndims     ,
 #define GRID_NCELLFACES 5
 
 
-static void
-input_error(FILE *fp, const char * const err)
+/* ---------------------------------------------------------------------- */
+/* Character representation                                               */
+/* ---------------------------------------------------------------------- */
+
+/* Complete contents of a grid file, read in a single pass, and the
+ * current parse position.  The buffer is NUL-terminated so that the
+ * strto*() family may be used directly on it. */
+struct grid_text {
+    char       *buf;
+    const char *pos;
+};
+
+
+static int
+load_grid_text(FILE *fp, struct grid_text *t)
 {
-    int save_errno = errno;
+    size_t cap, len, nread;
+    char   *buf, *tmp;
+
+    cap = 1 << 20;
+    len = 0;
+    buf = malloc(cap);
+
+    while (buf != NULL) {
+        nread = fread(buf + len, 1, cap - len - 1, fp);
+        len  += nread;
+
+        if (len + 1 < cap) {
+            break;              /* EOF or read error */
+        }
+
+        tmp = realloc(buf, 2 * cap);
+        if (tmp == NULL) {
+            free(buf);
+            buf = NULL;
+        }
+        else {
+            buf  = tmp;
+            cap *= 2;
+        }
+    }
+
+    if ((buf != NULL) && ferror(fp)) {
+        free(buf);
+        buf = NULL;
+    }
 
-    if (ferror(fp)) {
-        fprintf(stderr, "%s: %s\n", err, strerror(save_errno));
-        clearerr(fp);
+    if (buf != NULL) {
+        buf[len] = '\0';
     }
-    else if (feof(fp)) {
+
+    t->buf = buf;
+    t->pos = buf;
+
+    return buf != NULL;
+}
+
+
+static void
+input_error(const struct grid_text *t, const char * const err)
+{
+    const char *p = t->pos;
+
+    while (isspace((unsigned char) *p)) { p += 1; }
+
+    if (*p == '\0') {
         fprintf(stderr, "%s: End-of-file\n", err);
     }
+    else {
+        fprintf(stderr, "%s: Unexpected input '%.16s'\n", err, p);
+    }
+}
 
-    errno = save_errno;
+
+static int
+next_ulong(struct grid_text *t, unsigned long *x)
+{
+    char *end;
+
+    *x = strtoul(t->pos, &end, 10);
+
+    if (end == t->pos) { return 0; }
+
+    t->pos = end;
+    return 1;
+}
+
+
+static int
+next_int(struct grid_text *t, int *x)
+{
+    char *end;
+    long  v;
+
+    v = strtol(t->pos, &end, 10);
+
+    if ((end == t->pos) || (v < INT_MIN) || (v > INT_MAX)) { return 0; }
+
+    *x     = (int) v;
+    t->pos = end;
+    return 1;
+}
+
+
+static int
+next_double(struct grid_text *t, double *x)
+{
+    char *end;
+
+    *x = strtod(t->pos, &end);
+
+    if (end == t->pos) { return 0; }
+
+    t->pos = end;
+    return 1;
+}
+
+
+static int
+read_ints(struct grid_text *t, size_t n, int *x)
+{
+    size_t i;
+
+    i = 0;
+    while ((i < n) && next_int(t, & x[ i ])) {
+        i += 1;
+    }
+
+    return i == n;
+}
+
+
+static int
+read_doubles(struct grid_text *t, size_t n, double *x)
+{
+    size_t i;
+
+    i = 0;
+    while ((i < n) && next_double(t, & x[ i ])) {
+        i += 1;
+    }
+
+    return i == n;
 }
 
 
 static struct UnstructuredGrid *
-allocate_grid_from_file(FILE *fp, int *has_tag, int *has_indexmap)
+allocate_grid_from_text(struct grid_text *t, int *has_tag, int *has_indexmap)
 {
     struct UnstructuredGrid *G;
 
-    int           save_errno;
     unsigned long tmp;
     size_t        dimens[GRID_NMETA], i;
 
-    save_errno = errno;
-
     i = 0;
-    while ((i < GRID_NMETA) && (fscanf(fp, " %lu", &tmp) == 1)) {
+    while ((i < GRID_NMETA) && next_ulong(t, &tmp)) {
         dimens[i] = tmp;
 
         i += 1;
     }
 
     if (i == GRID_NMETA) {
-        if (fscanf(fp, "%d %d", has_tag, has_indexmap) == 2) {
+        if (next_int(t, has_tag) && next_int(t, has_indexmap)) {
             G = allocate_grid(dimens[GRID_NDIMS]     ,
                               dimens[GRID_NCELLS]    ,
                               dimens[GRID_NFACES]    ,
@@ -238,14 +367,8 @@ allocate_grid_from_file(FILE *fp, int *has_tag, int *has_indexmap)
                 G->number_of_nodes = (int) dimens[GRID_NNODES];
                 G->dimensions      = (int) dimens[GRID_NDIMS];
 
-                i = 0;
-                while ((i < dimens[GRID_NDIMS]) &&
-                       (fscanf(fp, "%d", & G->cartdims[ i ]) == 1)) {
-                    i += 1;
-                }
-
-                if (i < dimens[GRID_NDIMS]) {
-                    input_error(fp, "Unable to read Cartesian dimensions");
+                if (! read_ints(t, dimens[GRID_NDIMS], G->cartdims)) {
+                    input_error(t, "Unable to read Cartesian dimensions");
 
                     destroy_grid(G);
                     G = NULL;
@@ -253,248 +376,182 @@ allocate_grid_from_file(FILE *fp, int *has_tag, int *has_indexmap)
                 else {
                     /* Account for dimens[GRID_DIMS] < 3 */
                     size_t n = (sizeof G->cartdims) / (sizeof G->cartdims[0]);
-                    for (; i < n; i++) { G->cartdims[ i ] = 1; }
+                    for (i = dimens[GRID_NDIMS]; i < n; i++) { G->cartdims[ i ] = 1; }
                 }
             }
         }
         else {
-            input_error(fp, "Unable to read grid predicates");
+            input_error(t, "Unable to read grid predicates");
 
             G = NULL;
         }
     }
     else {
-        input_error(fp, "Unable to read grid dimensions");
+        input_error(t, "Unable to read grid dimensions");
 
         G = NULL;
     }
 
-    errno = save_errno;
-
     return G;
 }
 
 
 static int
-read_grid_nodes(FILE *fp, struct UnstructuredGrid *G)
+read_grid_nodes(struct grid_text *t, struct UnstructuredGrid *G)
 {
-    int    save_errno;
-    size_t i, n;
-
-    save_errno = errno;
+    int    ok;
+    size_t n;
 
     n  = G->dimensions;
     n *= G->number_of_nodes;
 
-    i = 0;
-    while ((i < n) &&
-           (fscanf(fp, " %lf", & G->node_coordinates[ i ]) == 1)) {
-        i += 1;
-    }
+    ok = read_doubles(t, n, G->node_coordinates);
 
-    if (i < n) {
-        input_error(fp, "Unable to read node coordinates");
+    if (! ok) {
+        input_error(t, "Unable to read node coordinates");
     }
 
-    errno = save_errno;
-
-    return i == n;
+    return ok;
 }
 
 
 static int
-read_grid_faces(FILE *fp, struct UnstructuredGrid *G)
+read_grid_faces(struct grid_text *t, struct UnstructuredGrid *G)
 {
-    int    save_errno, ok;
-    size_t nf, nfn, i;
-
-    save_errno = errno;
+    int    ok;
+    size_t nf, n;
 
     nf = G->number_of_faces;
+    n  = G->dimensions;
+    n *= nf;
 
     /* G->face_nodepos */
-    i = 0;
-    while ((i < nf + 1) &&
-           (fscanf(fp, " %d", & G->face_nodepos[ i ]) == 1)) {
-        i += 1;
-    }
-    ok = i == nf + 1;
+    ok = read_ints(t, nf + 1, G->face_nodepos);
 
     if (! ok) {
-        input_error(fp, "Unable to read node indirection array");
+        input_error(t, "Unable to read node indirection array");
     }
     else {
         /* G->face_nodes */
-        nfn = G->face_nodepos[ nf ];
-
-        i = 0;
-        while ((i < nfn) && (fscanf(fp, " %d", & G->face_nodes[ i ]) == 1)) {
-            i += 1;
-        }
+        ok = read_ints(t, G->face_nodepos[ nf ], G->face_nodes);
 
-        ok = i == nfn;
         if (! ok) {
-            input_error(fp, "Unable to read face-nodes");
+            input_error(t, "Unable to read face-nodes");
         }
     }
 
     if (ok) {
         /* G->face_cells */
-        i = 0;
-        while ((i < 2 * nf) && (fscanf(fp, " %d", & G->face_cells[ i ]) == 1)) {
-            i += 1;
-        }
+        ok = read_ints(t, 2 * nf, G->face_cells);
 
-        ok = i == 2 * nf;
         if (! ok) {
-            input_error(fp, "Unable to read neighbourship");
+            input_error(t, "Unable to read neighbourship");
         }
     }
 
     if (ok) {
         /* G->face_areas */
-        i = 0;
-        while ((i < nf) && (fscanf(fp, " %lf", & G->face_areas[ i ]) == 1)) {
-            i += 1;
-        }
+        ok = read_doubles(t, nf, G->face_areas);
 
-        ok = i == nf;
         if (! ok) {
-            input_error(fp, "Unable to read face areas");
+            input_error(t, "Unable to read face areas");
         }
     }
 
     if (ok) {
         /* G->face_centroids */
-        size_t n;
+        ok = read_doubles(t, n, G->face_centroids);
 
-        n  = G->dimensions;
-        n *= nf;
-
-        i = 0;
-        while ((i < n) && (fscanf(fp, " %lf", & G->face_centroids[ i ]) == 1)) {
-            i += 1;
-        }
-
-        ok = i == n;
         if (! ok) {
-            input_error(fp, "Unable to read face centroids");
+            input_error(t, "Unable to read face centroids");
         }
     }
 
     if (ok) {
         /* G->face_normals */
-        size_t n;
-
-        n  = G->dimensions;
-        n *= nf;
+        ok = read_doubles(t, n, G->face_normals);
 
-        i = 0;
-        while ((i < n) && (fscanf(fp, " %lf", & G->face_normals[ i ]) == 1)) {
-            i += 1;
-        }
-
-        ok = i == n;
         if (! ok) {
-            input_error(fp, "Unable to read face normals");
+            input_error(t, "Unable to read face normals");
         }
     }
 
-    errno = save_errno;
-
     return ok;
 }
 
 
 static int
-read_grid_cells(FILE *fp, int has_tag, int has_indexmap,
+read_grid_cells(struct grid_text *t, int has_tag, int has_indexmap,
                 struct UnstructuredGrid *G)
 {
-    int    save_errno, ok;
+    int    ok;
     size_t nc, ncf, i;
 
-    save_errno = errno;
-
     nc = G->number_of_cells;
 
     /* G->cell_facepos */
-    i = 0;
-    while ((i < nc + 1) && (fscanf(fp, " %d", & G->cell_facepos[ i ]) == 1)) {
-        i += 1;
-    }
-    ok = i == nc + 1;
+    ok = read_ints(t, nc + 1, G->cell_facepos);
 
     if (! ok) {
-        input_error(fp, "Unable to read face indirection array");
+        input_error(t, "Unable to read face indirection array");
     }
     else {
         /* G->cell_faces (and G->cell_facetag if applicable) */
         ncf = G->cell_facepos[ nc ];
-        i   = 0;
 
         if (has_tag) {
             assert (G->cell_facetag != NULL);
 
+            i = 0;
             while ((i < ncf) &&
-                   (fscanf(fp, " %d %d",
-                           & G->cell_faces  [ i ],
-                           & G->cell_facetag[ i ]) == 2)) {
+                   next_int(t, & G->cell_faces  [ i ]) &&
+                   next_int(t, & G->cell_facetag[ i ])) {
                 i += 1;
             }
+
+            ok = i == ncf;
         }
         else {
-            while ((i < ncf) &&
-                   (fscanf(fp, " %d", & G->cell_faces[ i ]) == 1)) {
-                i += 1;
-            }
+            ok = read_ints(t, ncf, G->cell_faces);
         }
 
-        ok = i == ncf;
         if (! ok) {
-            input_error(fp, "Unable to read cell-faces");
+            input_error(t, "Unable to read cell-faces");
         }
     }
 
     if (ok) {
         /* G->global_cell if applicable */
         if (has_indexmap) {
-            i = 0;
-
             if (G->global_cell != NULL) {
-                while ((i < nc) &&
-                       (fscanf(fp, " %d", & G->global_cell[ i ]) == 1)) {
-                    i += 1;
-                }
+                ok = read_ints(t, nc, G->global_cell);
             }
             else {
                 int discard;
 
-                while ((i < nc) && (fscanf(fp, " %d", & discard) == 1)) {
+                i = 0;
+                while ((i < nc) && next_int(t, & discard)) {
                     i += 1;
                 }
+
+                ok = i == nc;
             }
         }
         else {
             assert (G->global_cell == NULL);
-            i = nc;
         }
 
-        ok = i == nc;
         if (! ok) {
-            input_error(fp, "Unable to read global cellmap");
+            input_error(t, "Unable to read global cellmap");
         }
     }
 
     if (ok) {
         /* G->cell_volumes */
-        i = 0;
-        while ((i < nc) && (fscanf(fp, " %lf", & G->cell_volumes[ i ]) == 1)) {
-            i += 1;
-        }
+        ok = read_doubles(t, nc, G->cell_volumes);
 
-        ok = i == nc;
         if (! ok) {
-            input_error(fp, "Unable to read cell volumes");
+            input_error(t, "Unable to read cell volumes");
         }
     }
 
@@ -505,19 +562,13 @@ read_grid_cells(FILE *fp, int has_tag, int has_indexmap,
         n  = G->dimensions;
         n *= nc;
 
-        i = 0;
-        while ((i < n) && (fscanf(fp, " %lf", & G->cell_centroids[ i ]) == 1)) {
-            i += 1;
-        }
+        ok = read_doubles(t, n, G->cell_centroids);
 
-        ok = i == n;
         if (! ok) {
-            input_error(fp, "Unable to read cell centroids");
+            input_error(t, "Unable to read cell centroids");
         }
     }
 
-    errno = save_errno;
-
     return ok;
 }
 
@@ -526,6 +577,7 @@ struct UnstructuredGrid *
 read_grid(const char *fname)
 {
     struct UnstructuredGrid *G;
+    struct grid_text         t;
     FILE                    *fp;
 
     int save_errno;
@@ -533,24 +585,319 @@ read_grid(const char *fname)
 
     save_errno = errno;
 
+    G  = NULL;
     fp = fopen(fname, "rt");
     if (fp != NULL) {
-        G = allocate_grid_from_file(fp, & has_tag, & has_indexmap);
+        ok = load_grid_text(fp, &t);
+        fclose(fp);
 
-        ok = G != NULL;
+        if (! ok) {
+            fprintf(stderr, "Unable to read grid file '%s': %s\n",
+                    fname, strerror(errno));
+        }
+        else {
+            G = allocate_grid_from_text(&t, & has_tag, & has_indexmap);
+
+            ok = G != NULL;
+
+            if (ok) { ok = read_grid_nodes(&t, G); }
+            if (ok) { ok = read_grid_faces(&t, G); }
+            if (ok) { ok = read_grid_cells(&t, has_tag, has_indexmap, G); }
+
+            if (! ok) {
+                destroy_grid(G);
+                G = NULL;
+            }
+
+            free(t.buf);
+        }
+    }
+
+    errno = save_errno;
 
-        if (ok) { ok = read_grid_nodes(fp, G); }
-        if (ok) { ok = read_grid_faces(fp, G); }
-        if (ok) { ok = read_grid_cells(fp, has_tag, has_indexmap, G); }
+    return G;
+}
+
+
+/* ---------------------------------------------------------------------- */
+/* Binary representation                                                  */
+/* ---------------------------------------------------------------------- */
+
+/* File layout:
+ *
+ *   magic            8 bytes, "OPMUGRID"
+ *   version          uint32
+ *   flags            uint32, GRID_BIN_* below
+ *   dimensions       uint64    \
+ *   number_of_cells  uint64     |
+ *   number_of_faces  uint64     |  Same order as the character
+ *   number_of_nodes  uint64     |  representation's header.
+ *   face node count  uint64     |
+ *   cell face count  uint64    /
+ *   cartdims         3 x uint64
+ *
+ * All header fields are little-endian.  The header is followed by one
+ * block per array, each being a uint64 (little-endian) byte count and
+ * the array contents in the byte order recorded in the flags.  Blocks
+ * appear in the order of the character representation followed by
+ * the optional zcorn array. */
+
+#define GRID_BIN_VERSION     1u
+#define GRID_BIN_HEADER_SIZE (8 + 2*4 + (GRID_NMETA + 3)*8)
+
+#define GRID_BIN_HAS_TAG      (1u << 0)
+#define GRID_BIN_HAS_INDEXMAP (1u << 1)
+#define GRID_BIN_HAS_ZCORN    (1u << 2)
+#define GRID_BIN_BIG_ENDIAN   (1u << 3)
+
+static const char grid_bin_magic[8] = { 'O', 'P', 'M', 'U', 'G', 'R', 'I', 'D' };
+
+
+static int
+host_is_big_endian(void)
+{
+    const uint32_t one = 1;
+
+    return *(const unsigned char *) &one == 0;
+}
+
+
+static void
+put_le(unsigned char *p, uint64_t v, size_t nbytes)
+{
+    size_t i;
+
+    for (i = 0; i < nbytes; i++, v >>= 8) {
+        p[i] = (unsigned char) (v & 0xFFu);
+    }
+}
+
+
+static uint64_t
+get_le(const unsigned char *p, size_t nbytes)
+{
+    uint64_t v;
+    size_t   i;
+
+    v = 0;
+    for (i = nbytes; i > 0; i--) {
+        v = (v << 8) | p[i - 1];
+    }
+
+    return v;
+}
+
+
+static size_t
+zcorn_size(const struct UnstructuredGrid *G)
+{
+    return 8 * (size_t) G->cartdims[0] * G->cartdims[1] * G->cartdims[2];
+}
+
+
+static int
+write_block(FILE *fp, const void *data, size_t nbytes)
+{
+    unsigned char len[8];
+
+    put_le(len, nbytes, 8);
+
+    return (fwrite(len, 1, 8, fp) == 8) &&
+        ((nbytes == 0) || (fwrite(data, 1, nbytes, fp) == nbytes));
+}
+
+
+static int
+read_block(FILE *fp, void *data, size_t nbytes)
+{
+    unsigned char len[8];
 
+    return (fread(len, 1, 8, fp) == 8) &&
+        (get_le(len, 8) == nbytes) &&
+        ((nbytes == 0) || (fread(data, 1, nbytes, fp) == nbytes));
+}
+
+
+int
+write_grid_binary(const struct UnstructuredGrid *G, const char *fname)
+{
+    FILE          *fp;
+    unsigned char  header[GRID_BIN_HEADER_SIZE], *p;
+    uint32_t       flags;
+    size_t         nd, nc, nf, ncf, i;
+    int            ok;
+
+    nd  = G->dimensions;
+    nc  = G->number_of_cells;
+    nf  = G->number_of_faces;
+    ncf = G->cell_facepos[ nc ];
+
+    flags = 0;
+    if (G->cell_facetag != NULL) { flags |= GRID_BIN_HAS_TAG;      }
+    if (G->global_cell  != NULL) { flags |= GRID_BIN_HAS_INDEXMAP; }
+    if (G->zcorn        != NULL) { flags |= GRID_BIN_HAS_ZCORN;    }
+    if (host_is_big_endian())    { flags |= GRID_BIN_BIG_ENDIAN;   }
+
+    p = header;
+    memcpy(p, grid_bin_magic, sizeof grid_bin_magic);  p += 8;
+    put_le(p, GRID_BIN_VERSION, 4);                    p += 4;
+    put_le(p, flags, 4);                               p += 4;
+    put_le(p, nd, 8);                                  p += 8;
+    put_le(p, nc, 8);                                  p += 8;
+    put_le(p, nf, 8);                                  p += 8;
+    put_le(p, G->number_of_nodes, 8);                  p += 8;
+    put_le(p, G->face_nodepos[ nf ], 8);               p += 8;
+    put_le(p, ncf, 8);                                 p += 8;
+    for (i = 0; i < 3; i++, p += 8) {
+        put_le(p, G->cartdims[ i ], 8);
+    }
+    assert (p == header + GRID_BIN_HEADER_SIZE);
+
+    fp = fopen(fname, "wb");
+    if (fp == NULL) {
+        return 0;
+    }
+
+    ok = fwrite(header, 1, sizeof header, fp) == sizeof header;
+
+#define WRITE_ARRAY(a, n) \
+    if (ok) { ok = write_block(fp, (a), (n) * sizeof *(a)); }
+
+    WRITE_ARRAY(G->node_coordinates, nd * G->number_of_nodes);
+    WRITE_ARRAY(G->face_nodepos    , nf + 1);
+    WRITE_ARRAY(G->face_nodes      , (size_t) G->face_nodepos[ nf ]);
+    WRITE_ARRAY(G->face_cells      , 2 * nf);
+    WRITE_ARRAY(G->face_areas      , nf);
+    WRITE_ARRAY(G->face_centroids  , nd * nf);
+    WRITE_ARRAY(G->face_normals    , nd * nf);
+    WRITE_ARRAY(G->cell_facepos    , nc + 1);
+    WRITE_ARRAY(G->cell_faces      , ncf);
+    if (flags & GRID_BIN_HAS_TAG)      { WRITE_ARRAY(G->cell_facetag, ncf); }
+    if (flags & GRID_BIN_HAS_INDEXMAP) { WRITE_ARRAY(G->global_cell , nc ); }
+    WRITE_ARRAY(G->cell_volumes    , nc);
+    WRITE_ARRAY(G->cell_centroids  , nd * nc);
+    if (flags & GRID_BIN_HAS_ZCORN)    { WRITE_ARRAY(G->zcorn, zcorn_size(G)); }
+
+#undef WRITE_ARRAY
+
+    ok = (fclose(fp) == 0) && ok;
+
+    return ok;
+}
+
+
+struct UnstructuredGrid *
+read_grid_binary(const char *fname)
+{
+    struct UnstructuredGrid *G;
+    FILE                    *fp;
+
+    unsigned char header[GRID_BIN_HEADER_SIZE];
+    const unsigned char *p;
+    uint64_t dimens[GRID_NMETA];
+    uint32_t flags, expected_order;
+    size_t   nd, nc, nf, ncf, i;
+    int      ok, save_errno;
+
+    save_errno = errno;
+
+    fp = fopen(fname, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+
+    G  = NULL;
+    ok = fread(header, 1, sizeof header, fp) == sizeof header;
+
+    p = header;
+    if (ok) {
+        ok = (memcmp(p, grid_bin_magic, sizeof grid_bin_magic) == 0) &&
+             (get_le(p + 8, 4) == GRID_BIN_VERSION);
+    }
+    if (! ok) {
+        fprintf(stderr, "'%s' is not a binary grid file of version %u\n",
+                fname, GRID_BIN_VERSION);
+    }
+
+    if (ok) {
+        flags          = (uint32_t) get_le(p + 12, 4);
+        expected_order = host_is_big_endian() ? GRID_BIN_BIG_ENDIAN : 0;
+
+        ok = (flags & GRID_BIN_BIG_ENDIAN) == expected_order;
         if (! ok) {
-            destroy_grid(G);
-            G = NULL;
+            fprintf(stderr, "Binary grid file '%s' has foreign byte order\n", fname);
         }
+    }
 
-        fclose(fp);
+    if (ok) {
+        p += 16;
+        for (i = 0; i < GRID_NMETA; i++, p += 8) {
+            dimens[i] = get_le(p, 8);
+        }
+
+        G = allocate_grid(dimens[GRID_NDIMS]     ,
+                          dimens[GRID_NCELLS]    ,
+                          dimens[GRID_NFACES]    ,
+                          dimens[GRID_NFACENODES],
+                          dimens[GRID_NCELLFACES],
+                          dimens[GRID_NNODES]    );
+        ok = G != NULL;
     }
-    else {
+
+    if (ok) {
+        for (i = 0; i < 3; i++, p += 8) {
+            G->cartdims[ i ] = (int) get_le(p, 8);
+        }
+
+        if (! (flags & GRID_BIN_HAS_TAG)) {
+            free(G->cell_facetag);
+            G->cell_facetag = NULL;
+        }
+        if (flags & GRID_BIN_HAS_INDEXMAP) {
+            G->global_cell = malloc(dimens[GRID_NCELLS] * sizeof *G->global_cell);
+            ok = G->global_cell != NULL;
+        }
+        if (ok && (flags & GRID_BIN_HAS_ZCORN)) {
+            G->zcorn = malloc(zcorn_size(G) * sizeof *G->zcorn);
+            ok = G->zcorn != NULL;
+        }
+    }
+
+    if (ok) {
+        nd  = dimens[GRID_NDIMS];
+        nc  = dimens[GRID_NCELLS];
+        nf  = dimens[GRID_NFACES];
+        ncf = dimens[GRID_NCELLFACES];
+
+#define READ_ARRAY(a, n) \
+        if (ok) { ok = read_block(fp, (a), (n) * sizeof *(a)); }
+
+        READ_ARRAY(G->node_coordinates, nd * dimens[GRID_NNODES]);
+        READ_ARRAY(G->face_nodepos    , nf + 1);
+        READ_ARRAY(G->face_nodes      , dimens[GRID_NFACENODES]);
+        READ_ARRAY(G->face_cells      , 2 * nf);
+        READ_ARRAY(G->face_areas      , nf);
+        READ_ARRAY(G->face_centroids  , nd * nf);
+        READ_ARRAY(G->face_normals    , nd * nf);
+        READ_ARRAY(G->cell_facepos    , nc + 1);
+        READ_ARRAY(G->cell_faces      , ncf);
+        if (flags & GRID_BIN_HAS_TAG)      { READ_ARRAY(G->cell_facetag, ncf); }
+        if (flags & GRID_BIN_HAS_INDEXMAP) { READ_ARRAY(G->global_cell , nc ); }
+        READ_ARRAY(G->cell_volumes    , nc);
+        READ_ARRAY(G->cell_centroids  , nd * nc);
+        if (flags & GRID_BIN_HAS_ZCORN)    { READ_ARRAY(G->zcorn, zcorn_size(G)); }
+
+#undef READ_ARRAY
+
+        if (! ok) {
+            fprintf(stderr, "Binary grid file '%s' is truncated or corrupt\n", fname);
+        }
+    }
+
+    fclose(fp);
+
+    if (! ok) {
+        destroy_grid(G);
         G = NULL;
     }
 
@@ -558,5 +905,3 @@ read_grid(const char *fname)
 
     return G;
 }
-
-
@@ -75,6 +75,12 @@ allocate_grid(size_t ndims     ,
 struct UnstructuredGrid *
 read_grid(const char *fname);
 
+int
+write_grid_binary(const struct UnstructuredGrid *G, const char *fname);
+
+struct UnstructuredGrid *
+read_grid_binary(const char *fname);
+
  ---- end of synopsis of grid.h ----
 */
 
@@ -320,6 +326,35 @@ struct UnstructuredGrid *
 read_grid(const char *fname);
 
 
+/**
+ * Export a grid to a binary file.
+ *
+ * The file starts with a little-endian header holding the grid
+ * dimensions, followed by one block per array of the grid, in native
+ * byte order.  Such files are read much faster than the character
+ * representation of read_grid().
+ *
+ * @param[in] G     Grid.
+ * @param[in] fname File name.
+ * @return Non-zero on success, zero on failure.
+ */
+int
+write_grid_binary(const struct UnstructuredGrid *G, const char *fname);
+
+
+/**
+ * Import a grid from a binary file written by write_grid_binary().
+ *
+ * @param[in] fname File name.
+ * @return Fully formed UnstructuredGrid with all fields allocated and filled.
+ * Returns @c NULL if the file cannot be read, is not a binary grid
+ * file of the supported version, was written on a platform with
+ * different byte order, or in case of allocation failure.
+ */
+struct UnstructuredGrid *
+read_grid_binary(const char *fname);
+
+
 
 
 bool
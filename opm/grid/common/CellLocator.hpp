@@ -0,0 +1,332 @@
+/*
+  This file is part of The Open Porous Media project  (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_CELLLOCATOR_HEADER_INCLUDED
+#define OPM_CELLLOCATOR_HEADER_INCLUDED
+
+#include <opm/grid/utility/ErrorMacros.hpp>
+#include <opm/grid/GridHelpers.hpp>
+
+#include <opm/grid/utility/platform_dependent/disable_warnings.h>
+#include <dune/common/fvector.hh>
+#include <opm/grid/utility/platform_dependent/reenable_warnings.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm
+{
+
+    /// \brief Finds the cells of a grid that contain given points.
+    ///
+    /// The bounding boxes of the cells are organized in a bounding volume
+    /// hierarchy, built by recursively splitting the cells at the median
+    /// of their box centers along the longest axis. A query descends the
+    /// hierarchy to the cells whose boxes contain the point and tests
+    /// these against the faces of the cell.
+    ///
+    /// The inside test computes the winding number of the cell surface
+    /// around the point, with each face triangulated as a fan around the
+    /// average of its vertices. It therefore handles non-planar faces and
+    /// non-convex cells, as found in faulted corner-point grids, and
+    /// tolerates small gaps between the faces of a cell. A point on a face
+    /// shared by two cells may be reported in either of them.
+    ///
+    /// The locator keeps a reference to the grid, which must not change
+    /// while it is in use. Queries are thread safe.
+    ///
+    /// \tparam Grid  UnstructuredGrid or Dune::CpGrid. For the latter,
+    ///               opm/grid/cpgrid/GridHelpers.hpp has to be included.
+    template <class Grid>
+    class CellLocator
+    {
+    public:
+        typedef Dune::FieldVector<double, 3> Point;
+
+        /// \brief Build the search structure.
+        /// \param[in] grid          a three-dimensional grid
+        /// \param[in] cellsPerLeaf  maximum number of cells in a leaf of the hierarchy
+        explicit CellLocator(const Grid& grid, const int cellsPerLeaf = 8);
+
+        /// \brief Find the cell containing a point.
+        /// \return The index of the cell, or -1 if the point is outside the grid.
+        int locate(const Point& point) const;
+
+        /// \brief Find the cells containing many points, in parallel.
+        /// \return For each point the index of its cell, or -1 if the
+        ///         point is outside the grid.
+        std::vector<int> locate(const std::vector<Point>& points) const;
+
+        /// \brief Whether a cell contains a point.
+        bool contains(const int cell, const Point& point) const;
+
+    private:
+        /// A node of the hierarchy. The left child directly follows its
+        /// parent, leaves have no right child and own the cells
+        /// cells_[begin], ..., cells_[end-1].
+        struct Node
+        {
+            Point lower;
+            Point upper;
+            int begin;
+            int end;
+            int right;
+        };
+
+        /// Add the node for cells_[begin], ..., cells_[end-1] and its
+        /// descendants, return its index.
+        int build_(const int begin, const int end, const int cellsPerLeaf);
+
+        bool inBox_(const Point& lower, const Point& upper, const Point& point) const;
+
+        const Grid& grid_;
+        /// Bounding boxes of the cells.
+        std::vector<Point> cellLower_;
+        std::vector<Point> cellUpper_;
+        /// Cell indices ordered such that each leaf owns a contiguous range.
+        std::vector<int> cells_;
+        std::vector<Node> nodes_;
+        /// Padding of the bounding boxes.
+        double tolerance_;
+    };
+
+
+
+    template <class Grid>
+    inline CellLocator<Grid>::CellLocator(const Grid& grid, const int cellsPerLeaf)
+        : grid_(grid), tolerance_(0.0)
+    {
+        if (Opm::UgGridHelpers::dimensions(grid) != 3) {
+            OPM_THROW(std::logic_error, "CellLocator requires a three-dimensional grid");
+        }
+        if (cellsPerLeaf < 1) {
+            OPM_THROW(std::logic_error, "CellLocator needs at least one cell per leaf");
+        }
+
+        const int nc = Opm::UgGridHelpers::numCells(grid);
+        const auto cell_faces = Opm::UgGridHelpers::cell2Faces(grid);
+        const auto face_vertices = Opm::UgGridHelpers::face2Vertices(grid);
+        cellLower_.resize(nc);
+        cellUpper_.resize(nc);
+#pragma omp parallel for schedule(static)
+        for (int c = 0; c < nc; ++c) {
+            Point lower(std::numeric_limits<double>::max());
+            Point upper(-std::numeric_limits<double>::max());
+            for (const int f : cell_faces[c]) {
+                for (const int v : face_vertices[f]) {
+                    const double* x = Opm::UgGridHelpers::vertexCoordinates(grid, v);
+                    for (int d = 0; d < 3; ++d) {
+                        lower[d] = std::min(lower[d], x[d]);
+                        upper[d] = std::max(upper[d], x[d]);
+                    }
+                }
+            }
+            cellLower_[c] = lower;
+            cellUpper_[c] = upper;
+        }
+
+        cells_.resize(nc);
+        for (int c = 0; c < nc; ++c) {
+            cells_[c] = c;
+        }
+        if (nc > 0) {
+            nodes_.reserve(2 * (nc / cellsPerLeaf + 1));
+            build_(0, nc, cellsPerLeaf);
+            const Point extent = nodes_[0].upper - nodes_[0].lower;
+            tolerance_ = 1e-10 * std::max(extent.infinity_norm(), 1.0);
+        }
+    }
+
+
+
+    template <class Grid>
+    inline int CellLocator<Grid>::build_(const int begin, const int end, const int cellsPerLeaf)
+    {
+        const int index = nodes_.size();
+        nodes_.emplace_back();
+        Point lower(std::numeric_limits<double>::max());
+        Point upper(-std::numeric_limits<double>::max());
+        Point centerLower(std::numeric_limits<double>::max());
+        Point centerUpper(-std::numeric_limits<double>::max());
+        for (int i = begin; i < end; ++i) {
+            const int c = cells_[i];
+            for (int d = 0; d < 3; ++d) {
+                lower[d] = std::min(lower[d], cellLower_[c][d]);
+                upper[d] = std::max(upper[d], cellUpper_[c][d]);
+                const double center = cellLower_[c][d] + cellUpper_[c][d];
+                centerLower[d] = std::min(centerLower[d], center);
+                centerUpper[d] = std::max(centerUpper[d], center);
+            }
+        }
+        nodes_[index].lower = lower;
+        nodes_[index].upper = upper;
+        nodes_[index].begin = begin;
+        nodes_[index].end = end;
+        nodes_[index].right = -1;
+
+        if (end - begin <= cellsPerLeaf) {
+            return index;
+        }
+
+        // Split at the median of the box centers along their longest extent.
+        const Point centerExtent = centerUpper - centerLower;
+        const int axis = std::max_element(centerExtent.begin(), centerExtent.end()) - centerExtent.begin();
+        const int middle = begin + (end - begin) / 2;
+        std::nth_element(cells_.begin() + begin, cells_.begin() + middle, cells_.begin() + end,
+                         [this, axis](const int a, const int b)
+                         {
+                             return cellLower_[a][axis] + cellUpper_[a][axis]
+                                 < cellLower_[b][axis] + cellUpper_[b][axis];
+                         });
+        build_(begin, middle, cellsPerLeaf);
+        const int right = build_(middle, end, cellsPerLeaf);
+        nodes_[index].right = right;
+        return index;
+    }
+
+
+
+    template <class Grid>
+    inline bool CellLocator<Grid>::inBox_(const Point& lower, const Point& upper, const Point& point) const
+    {
+        for (int d = 0; d < 3; ++d) {
+            if (point[d] < lower[d] - tolerance_ || point[d] > upper[d] + tolerance_) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+
+    template <class Grid>
+    inline int CellLocator<Grid>::locate(const Point& point) const
+    {
+        if (nodes_.empty()) {
+            return -1;
+        }
+        // The depth of the hierarchy is logarithmic in the number of cells,
+        // and at most one node per level is waiting on the stack.
+        std::array<int, 64> stack;
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const int index = stack[--top];
+            const Node& node = nodes_[index];
+            if (!inBox_(node.lower, node.upper, point)) {
+                continue;
+            }
+            if (node.right == -1) {
+                for (int i = node.begin; i < node.end; ++i) {
+                    const int c = cells_[i];
+                    if (inBox_(cellLower_[c], cellUpper_[c], point) && contains(c, point)) {
+                        return c;
+                    }
+                }
+            } else {
+                stack[top++] = node.right;
+                stack[top++] = index + 1;
+            }
+        }
+        return -1;
+    }
+
+
+
+    template <class Grid>
+    inline std::vector<int> CellLocator<Grid>::locate(const std::vector<Point>& points) const
+    {
+        const int np = points.size();
+        std::vector<int> cells(np);
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < np; ++i) {
+            cells[i] = locate(points[i]);
+        }
+        return cells;
+    }
+
+
+
+    template <class Grid>
+    inline bool CellLocator<Grid>::contains(const int cell, const Point& point) const
+    {
+        const auto cell_faces = Opm::UgGridHelpers::cell2Faces(grid_);
+        const auto face_vertices = Opm::UgGridHelpers::face2Vertices(grid_);
+        const auto face_cells = Opm::UgGridHelpers::faceCells(grid_);
+
+        // Sum of the solid angles of the outward oriented face triangles
+        // as seen from the point: 4 pi inside the cell, 0 outside.
+        double solidAngle = 0.0;
+        std::vector<Point> vertices;
+        for (const int f : cell_faces[cell]) {
+            vertices.clear();
+            Point center(0.0);
+            for (const int v : face_vertices[f]) {
+                const double* x = Opm::UgGridHelpers::vertexCoordinates(grid_, v);
+                vertices.emplace_back();
+                for (int d = 0; d < 3; ++d) {
+                    vertices.back()[d] = x[d];
+                }
+                center += vertices.back();
+            }
+            const int nv = vertices.size();
+            if (nv < 3) {
+                continue;
+            }
+            center /= nv;
+
+            // Orient the triangles like the face normal, which points
+            // from the first to the second cell of the face.
+            Point area(0.0);
+            for (int i = 0; i < nv; ++i) {
+                const Point a = vertices[i] - center;
+                const Point b = vertices[(i + 1) % nv] - center;
+                area[0] += a[1]*b[2] - a[2]*b[1];
+                area[1] += a[2]*b[0] - a[0]*b[2];
+                area[2] += a[0]*b[1] - a[1]*b[0];
+            }
+            const double* normal = Opm::UgGridHelpers::faceNormal(grid_, f);
+            const double orientation = area[0]*normal[0] + area[1]*normal[1] + area[2]*normal[2];
+            const double sign = ((orientation >= 0.0) == (face_cells(f, 0) == cell)) ? 1.0 : -1.0;
+
+            const Point a = center - point;
+            const double la = a.two_norm();
+            for (int i = 0; i < nv; ++i) {
+                const Point b = vertices[i] - point;
+                const Point c = vertices[(i + 1) % nv] - point;
+                const double lb = b.two_norm();
+                const double lc = c.two_norm();
+                // Van Oosterom and Strackee's formula for the solid angle of a triangle.
+                const double det = a[0]*(b[1]*c[2] - b[2]*c[1])
+                                 - a[1]*(b[0]*c[2] - b[2]*c[0])
+                                 + a[2]*(b[0]*c[1] - b[1]*c[0]);
+                const double div = la*lb*lc + (a*b)*lc + (a*c)*lb + (b*c)*la;
+                solidAngle += sign * 2.0 * std::atan2(det, div);
+            }
+        }
+        // Winding number above one half.
+        const double pi = 4.0 * std::atan(1.0);
+        return solidAngle > 2.0 * pi;
+    }
+
+} // namespace Opm
+
+#endif // OPM_CELLLOCATOR_HEADER_INCLUDED
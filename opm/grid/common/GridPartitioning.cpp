@@ -39,6 +39,9 @@
 #endif
 #include "GridPartitioning.hpp"
 #include <opm/grid/CpGrid.hpp>
+#include <algorithm>
+#include <limits>
+#include <numeric>
 #include <stack>
 
 namespace Dune
@@ -182,6 +185,196 @@ namespace Dune
             }
         }
 
+        void checkInitialSplit(const CpGrid& grid, const coord_t& initial_split)
+        {
+            // Checking that the initial split makes sense (that there may be at least one cell
+            // in each expected partition).
+            const coord_t& lc_size = grid.logicalCartesianSize();
+            for (int i = 0; i < 3; ++i) {
+                if (initial_split[i] > lc_size[i]) {
+                    OPM_THROW(std::runtime_error, "In direction " << i << " requested splitting " << initial_split[i] << " size " << lc_size[i]);
+                }
+            }
+        }
+
+
+        /// Split a sequence of slices into num_split consecutive parts of
+        /// (approximately) equal weight. Returns the part of each slice.
+        std::vector<int> splitByWeight(const std::vector<double>& slice_weight, int num_split)
+        {
+            const int num_slices = slice_weight.size();
+            const double total = std::accumulate(slice_weight.begin(), slice_weight.end(), 0.0);
+            std::vector<int> slice_part(num_slices);
+            double before = 0.0;
+            for (int s = 0; s < num_slices; ++s) {
+                if (total > 0.0) {
+                    // Assign the slice to the part containing its midpoint.
+                    const double mid = before + 0.5*slice_weight[s];
+                    slice_part[s] = std::min(num_split - 1, static_cast<int>(mid/total*num_split));
+                } else {
+                    slice_part[s] = static_cast<int>(static_cast<long long>(s)*num_split/num_slices);
+                }
+                before += slice_weight[s];
+            }
+            return slice_part;
+        }
+
+
+        /// Combine the constraints into one weight per cell, each normalized by its total.
+        std::vector<double> combineCellWeights(int num_cells,
+                                               const std::vector<std::vector<double> >& cell_weights)
+        {
+            std::vector<double> weight(num_cells, cell_weights.empty() ? 1.0 : 0.0);
+            for (const auto& constraint : cell_weights) {
+                if (static_cast<int>(constraint.size()) != num_cells) {
+                    OPM_THROW(std::runtime_error, "Cell weights have size " << constraint.size()
+                              << " but the grid has " << num_cells << " cells");
+                }
+                if (std::any_of(constraint.begin(), constraint.end(), [](double w) { return w < 0.0; })) {
+                    OPM_THROW(std::runtime_error, "Cell weights must not be negative");
+                }
+                const double total = std::accumulate(constraint.begin(), constraint.end(), 0.0);
+                if (total > 0.0) {
+                    for (int c = 0; c < num_cells; ++c) {
+                        weight[c] += constraint[c]/total;
+                    }
+                }
+            }
+            return weight;
+        }
+
+
+        /// A cell as seen by the recursive coordinate bisection.
+        struct BisectionCell
+        {
+            std::array<double, 3> centroid;
+            double weight;
+            int index;
+        };
+
+        typedef std::vector<BisectionCell>::iterator BisectionIterator;
+
+
+        /// Reorder [begin, end) by the coordinate dim such that the cells before the
+        /// returned position have (approximately) the given weight and no larger
+        /// coordinate than the ones after it. Runs in expected linear time.
+        BisectionIterator splitAtWeight(BisectionIterator begin, BisectionIterator end,
+                                        int dim, double target)
+        {
+            auto less = [dim](const BisectionCell& a, const BisectionCell& b) {
+                return a.centroid[dim] < b.centroid[dim];
+            };
+            // The cells before begin belong to the first part, the ones after end to the second.
+            while (end - begin > 1) {
+                const BisectionIterator middle = begin + (end - begin)/2;
+                std::nth_element(begin, middle, end, less);
+                double left = 0.0;
+                for (auto c = begin; c != middle; ++c) {
+                    left += c->weight;
+                }
+                if (left >= target) {
+                    end = middle;
+                } else {
+                    target -= left;
+                    begin = middle;
+                }
+            }
+            // Assign the remaining cell to the first part if it contains its midpoint.
+            if (begin != end && target > 0.5*begin->weight) {
+                ++begin;
+            }
+            return begin;
+        }
+
+
+        /// Recursively bisect [begin, end) into num_parts parts numbered from first_part,
+        /// always cutting the longest side of the bounding box of the centroids.
+        void recursiveBisection(BisectionIterator begin, BisectionIterator end,
+                                int first_part, int num_parts, std::vector<int>& cell_part)
+        {
+            const int num_cells = end - begin;
+            if (num_parts == 1 || num_cells <= 1) {
+                for (auto c = begin; c != end; ++c) {
+                    cell_part[c->index] = first_part;
+                }
+                return;
+            }
+
+            std::array<double, 3> lower, upper;
+            lower.fill(std::numeric_limits<double>::max());
+            upper.fill(-std::numeric_limits<double>::max());
+            double total = 0.0;
+            for (auto c = begin; c != end; ++c) {
+                for (int d = 0; d < 3; ++d) {
+                    lower[d] = std::min(lower[d], c->centroid[d]);
+                    upper[d] = std::max(upper[d], c->centroid[d]);
+                }
+                total += c->weight;
+            }
+            int dim = 0;
+            for (int d = 1; d < 3; ++d) {
+                if (upper[d] - lower[d] > upper[dim] - lower[dim]) {
+                    dim = d;
+                }
+            }
+
+            const int left_parts = num_parts/2;
+            BisectionIterator middle = splitAtWeight(begin, end, dim, total*left_parts/num_parts);
+
+            // Make sure that each part gets at least one cell, if possible.
+            const BisectionIterator min_middle = begin + std::min(left_parts, num_cells);
+            const BisectionIterator max_middle = end - std::min(num_parts - left_parts, num_cells);
+            if (middle < min_middle || middle > max_middle) {
+                middle = middle < min_middle ? min_middle : max_middle;
+                std::nth_element(begin, middle, end,
+                                 [dim](const BisectionCell& a, const BisectionCell& b) {
+                                     return a.centroid[dim] < b.centroid[dim];
+                                 });
+            }
+
+            recursiveBisection(begin, middle, first_part, left_parts, cell_part);
+            recursiveBisection(middle, end, first_part + left_parts, num_parts - left_parts, cell_part);
+        }
+
+
+        /// Remove empty partitions from an initial partitioning and split
+        /// partitions that are not connected, if requested.
+        void finishPartition(const CpGrid& grid,
+                             std::vector<int>::size_type num_initial,
+                             std::vector<int>& my_part,
+                             int& num_part,
+                             std::vector<int>& cell_part,
+                             bool recursive,
+                             bool ensureConnectivity)
+        {
+            std::vector<int> num_in_part(num_initial, 0); // no cells of partitions
+            for (int i = 0; i < grid.size(0); ++i) {
+                ++num_in_part[my_part[i]];
+            }
+
+            // Renumber partitions.
+            std::vector<int> num_to_subtract(num_initial); // if partitions are empty they do not get a number.
+            num_to_subtract[0] = 0;
+            for (std::vector<int>::size_type i = 1; i < num_initial; ++i) {
+                num_to_subtract[i] = num_to_subtract[i-1];
+                if (num_in_part[i-1] == 0) {
+                    ++num_to_subtract[i];
+                }
+            }
+            for (int i = 0; i < grid.size(0); ++i) {
+                my_part[i] -= num_to_subtract[my_part[i]];
+            }
+
+            num_part = num_initial - num_to_subtract.back();
+            cell_part.swap(my_part);
+
+            // Check the connectivity, split.
+            if ( ensureConnectivity )
+            {
+                ensureConnectedPartitions(grid, num_part, cell_part, recursive);
+            }
+        }
+
     } // anon namespace
 
 
@@ -192,50 +385,138 @@ namespace Dune
                    bool recursive,
                    bool ensureConnectivity)
     {
-        // Checking that the initial split makes sense (that there may be at least one cell
-        // in each expected partition).
-        const coord_t& lc_size = grid.logicalCartesianSize();
-        for (int i = 0; i < 3; ++i) {
-            if (initial_split[i] > lc_size[i]) {
-                OPM_THROW(std::runtime_error, "In direction " << i << " requested splitting " << initial_split[i] << " size " << lc_size[i]);
-            }
-        }
+        checkInitialSplit(grid, initial_split);
 
         // Initial partitioning depending on (ijk) coordinates.
+        const coord_t& lc_size = grid.logicalCartesianSize();
         std::vector<int>::size_type  num_initial =
             initial_split[0]*initial_split[1]*initial_split[2];
         const std::vector<int>& lc_ind = grid.globalCell();
-        std::vector<int> num_in_part(num_initial, 0); // no cells of partitions
         std::vector<int> my_part(grid.size(0), -1); // contains partition number of cell
         IndexToIJK ijk_coord(lc_size);
         for (int i = 0; i < grid.size(0); ++i) {
             coord_t ijk = ijk_coord(lc_ind[i]);
-            int part = initialPartition(ijk, lc_size, initial_split);
-            my_part[i] = part;
-            ++num_in_part[part];
+            my_part[i] = initialPartition(ijk, lc_size, initial_split);
         }
 
-        // Renumber partitions.
-        std::vector<int> num_to_subtract(num_initial); // if partitions are empty they do not get a number.
-        num_to_subtract[0] = 0;
-        for (std::vector<int>::size_type i = 1; i < num_initial; ++i) {
-            num_to_subtract[i] = num_to_subtract[i-1];
-            if (num_in_part[i-1] == 0) {
-                ++num_to_subtract[i];
-            }
+        finishPartition(grid, num_initial, my_part, num_part, cell_part, recursive, ensureConnectivity);
+    }
+
+
+    void partition(const CpGrid& grid,
+                   const coord_t& initial_split,
+                   int& num_part,
+                   std::vector<int>& cell_part,
+                   const std::vector<std::vector<double> >& cell_weights,
+                   bool recursive,
+                   bool ensureConnectivity)
+    {
+        checkInitialSplit(grid, initial_split);
+
+        const int num_cells = grid.size(0);
+        const std::vector<double> weight = combineCellWeights(num_cells, cell_weights);
+
+        const coord_t& lc_size = grid.logicalCartesianSize();
+        const std::vector<int>& lc_ind = grid.globalCell();
+        IndexToIJK ijk_coord(lc_size);
+        std::vector<coord_t> cell_ijk(num_cells);
+        for (int c = 0; c < num_cells; ++c) {
+            cell_ijk[c] = ijk_coord(lc_ind[c]);
         }
-        for (int i = 0; i < grid.size(0); ++i) {
-            my_part[i] -= num_to_subtract[my_part[i]];
+
+        // Split into slabs in k direction, ...
+        std::vector<double> k_weight(lc_size[2], 0.0);
+        for (int c = 0; c < num_cells; ++c) {
+            k_weight[cell_ijk[c][2]] += weight[c];
         }
+        const std::vector<int> k_part = splitByWeight(k_weight, initial_split[2]);
 
-        num_part = num_initial - num_to_subtract.back();
-        cell_part.swap(my_part);
+        // ... each slab in j direction, ...
+        std::vector<std::vector<double> > j_weight(initial_split[2], std::vector<double>(lc_size[1], 0.0));
+        for (int c = 0; c < num_cells; ++c) {
+            j_weight[k_part[cell_ijk[c][2]]][cell_ijk[c][1]] += weight[c];
+        }
+        std::vector<std::vector<int> > j_part(initial_split[2]);
+        for (int pk = 0; pk < initial_split[2]; ++pk) {
+            j_part[pk] = splitByWeight(j_weight[pk], initial_split[1]);
+        }
 
-        // Check the connectivity, split.
-        if ( ensureConnectivity )
-        {
-            ensureConnectedPartitions(grid, num_part, cell_part, recursive);
+        // ... and each of the resulting columns in i direction.
+        const int num_columns = initial_split[1]*initial_split[2];
+        std::vector<std::vector<double> > i_weight(num_columns, std::vector<double>(lc_size[0], 0.0));
+        for (int c = 0; c < num_cells; ++c) {
+            const int pk = k_part[cell_ijk[c][2]];
+            const int pj = j_part[pk][cell_ijk[c][1]];
+            i_weight[pj + initial_split[1]*pk][cell_ijk[c][0]] += weight[c];
         }
+        std::vector<std::vector<int> > i_part(num_columns);
+        for (int col = 0; col < num_columns; ++col) {
+            i_part[col] = splitByWeight(i_weight[col], initial_split[0]);
+        }
+
+        std::vector<int> my_part(num_cells, -1); // contains partition number of cell
+        for (int c = 0; c < num_cells; ++c) {
+            const int pk = k_part[cell_ijk[c][2]];
+            const int pj = j_part[pk][cell_ijk[c][1]];
+            const int pi = i_part[pj + initial_split[1]*pk][cell_ijk[c][0]];
+            my_part[c] = pi + initial_split[0]*(pj + initial_split[1]*pk);
+        }
+
+        const std::vector<int>::size_type num_initial =
+            initial_split[0]*initial_split[1]*initial_split[2];
+        finishPartition(grid, num_initial, my_part, num_part, cell_part, recursive, ensureConnectivity);
+    }
+
+    void partitionGeometric(const CpGrid& grid,
+                            int num_part,
+                            std::vector<int>& cell_part,
+                            const std::vector<std::vector<double> >& cell_weights)
+    {
+        if (num_part < 1) {
+            OPM_THROW(std::runtime_error, "Cannot partition into " << num_part << " parts");
+        }
+        const int num_cells = grid.size(0);
+        const std::vector<double> weight = combineCellWeights(num_cells, cell_weights);
+
+        std::vector<BisectionCell> cells(num_cells);
+#pragma omp parallel for schedule(static)
+        for (int c = 0; c < num_cells; ++c) {
+            const auto& centroid = grid.cellCentroid(c);
+            cells[c].centroid = {{ centroid[0], centroid[1], centroid[2] }};
+            cells[c].weight = weight[c];
+            cells[c].index = c;
+        }
+
+        cell_part.assign(num_cells, 0);
+        recursiveBisection(cells.begin(), cells.end(), 0, num_part, cell_part);
+    }
+
+    void partitionGeometric(const double* centroids,
+                            int num_cells,
+                            int dimensions,
+                            int num_part,
+                            std::vector<int>& cell_part,
+                            const std::vector<std::vector<double> >& cell_weights)
+    {
+        if (num_part < 1) {
+            OPM_THROW(std::runtime_error, "Cannot partition into " << num_part << " parts");
+        }
+        if (dimensions < 1 || dimensions > 3) {
+            OPM_THROW(std::runtime_error, "Cannot partition cells in " << dimensions << " dimensions");
+        }
+        const std::vector<double> weight = combineCellWeights(num_cells, cell_weights);
+
+        std::vector<BisectionCell> cells(num_cells);
+#pragma omp parallel for schedule(static)
+        for (int c = 0; c < num_cells; ++c) {
+            cells[c].centroid.fill(0.0);
+            std::copy(centroids + c*dimensions, centroids + (c + 1)*dimensions, cells[c].centroid.begin());
+            cells[c].weight = weight[c];
+            cells[c].index = c;
+        }
+
+        cell_part.assign(num_cells, 0);
+        recursiveBisection(cells.begin(), cells.end(), 0, num_part, cell_part);
     }
 
 /// \brief Adds cells to the overlap that just share a point with an owner cell.
@@ -243,7 +524,7 @@ void addOverlapCornerCell(const CpGrid& grid, int owner,
                           const CpGrid::Codim<0>::Entity& from,
                           const CpGrid::Codim<0>::Entity& neighbor,
                           const std::vector<int>& cell_part,
-                          std::vector<std::set<int> >& cell_overlap)
+                          std::vector<std::pair<int,int> >& cell_overlap)
 {
     const CpGrid::LeafIndexSet& ix = grid.leafIndexSet();
     int my_index = ix.index(from);
@@ -258,8 +539,8 @@ void addOverlapCornerCell(const CpGrid& grid, int owner,
             int otherpoint = ix.index(*neighbor.subEntity<CpGrid::dimension>(i));
             if ( mypoint == otherpoint )
             {
-                cell_overlap[nb_index].insert(owner);
-                cell_overlap[my_index].insert(cell_part[nb_index]);
+                cell_overlap.emplace_back(nb_index, owner);
+                cell_overlap.emplace_back(my_index, cell_part[nb_index]);
                 return;
             }
         }
@@ -268,7 +549,7 @@ void addOverlapCornerCell(const CpGrid& grid, int owner,
 
 void addOverlapLayer(const CpGrid& grid, int index, const CpGrid::Codim<0>::Entity& e,
                      const int owner, const std::vector<int>& cell_part,
-                     std::vector<std::set<int> >& cell_overlap, int recursion_deps)
+                     std::vector<std::pair<int,int> >& cell_overlap, int recursion_deps)
     {
         const CpGrid::LeafIndexSet& ix = grid.leafIndexSet();
         for (CpGrid::LeafIntersectionIterator iit = e.ileafbegin(); iit != e.ileafend(); ++iit) {
@@ -276,8 +557,8 @@ void addOverlapLayer(const CpGrid& grid, int index, const CpGrid::Codim<0>::Enti
                 int nb_index = ix.index(*(iit->outside()));
                 if ( cell_part[nb_index]!=owner )
                 {
-                    cell_overlap[nb_index].insert(owner);
-                    cell_overlap[index].insert(cell_part[nb_index]);
+                    cell_overlap.emplace_back(nb_index, owner);
+                    cell_overlap.emplace_back(index, cell_part[nb_index]);
                     if ( recursion_deps>0 )
                     {
                         // Add another layer
@@ -304,11 +585,52 @@ void addOverlapLayer(const CpGrid& grid, int index, const CpGrid::Codim<0>::Enti
         }
     }
 
+namespace
+{
+/// \brief Build a table with the sorted, unique partitions of each cell
+///        from a list of (cell, partition) pairs using a counting sort.
+void buildOverlapTable(std::size_t num_cells, const std::vector<std::pair<int,int> >& pairs,
+                       Opm::SparseTable<int>& cell_overlap)
+{
+    std::vector<int> row_start(num_cells + 1, 0);
+    for (const auto& pair : pairs)
+        ++row_start[pair.first + 1];
+    for (std::size_t c = 0; c < num_cells; ++c)
+        row_start[c + 1] += row_start[c];
+
+    std::vector<int> parts(pairs.size());
+    std::vector<int> position(row_start.begin(), row_start.end() - 1);
+    for (const auto& pair : pairs)
+        parts[position[pair.first]++] = pair.second;
+
+    // Sort each row and remove duplicates in place.
+    std::vector<int> row_size(num_cells);
+    auto out = parts.begin();
+    for (std::size_t c = 0; c < num_cells; ++c)
+    {
+        auto begin = parts.begin() + row_start[c];
+        auto end = parts.begin() + row_start[c + 1];
+        std::sort(begin, end);
+        end = std::unique(begin, end);
+        row_size[c] = end - begin;
+        out = (out == begin) ? end : std::copy(begin, end, out);
+    }
+    parts.erase(out, parts.end());
+
+    if (num_cells == 0)
+        cell_overlap.clear();
+    else
+        cell_overlap.assign(parts.begin(), parts.end(), row_size.begin(), row_size.end());
+}
+} // anonymous namespace
+
     void addOverlapLayer(const CpGrid& grid, const std::vector<int>& cell_part,
-                         std::vector<std::set<int> >& cell_overlap, int mypart,
+                         Opm::SparseTable<int>& cell_overlap, int mypart,
                          int layers, bool all)
     {
-        cell_overlap.resize(cell_part.size());
+        // Collect (cell, partition) pairs first and sort them into a table
+        // afterwards, to avoid one small allocation per shared cell.
+        std::vector<std::pair<int,int> > overlap_pairs;
         const CpGrid::LeafIndexSet& ix = grid.leafIndexSet();
         for (CpGrid::Codim<0>::LeafIterator it = grid.leafbegin<0>();
              it != grid.leafend<0>(); ++it) {
@@ -323,8 +645,9 @@ void addOverlapLayer(const CpGrid& grid, int index, const CpGrid::Codim<0>::Enti
                 else
                     continue;
             }
-            addOverlapLayer(grid, index, *it, owner, cell_part, cell_overlap, layers-1);
+            addOverlapLayer(grid, index, *it, owner, cell_part, overlap_pairs, layers-1);
         }
+        buildOverlapTable(cell_part.size(), overlap_pairs, cell_overlap);
 }
 } // namespace Dune
 
@@ -37,6 +37,8 @@
 #ifndef OPM_GRIDPARTITIONING_HEADER
 #define OPM_GRIDPARTITIONING_HEADER
 
+#include <opm/grid/utility/SparseTable.hpp>
+
 #include <vector>
 #include <array>
 #include <set>
@@ -69,17 +71,75 @@ namespace Dune
                    bool recursive = false,
                    bool ensureConnectivity = true);
 
+    /// Partition a CpGrid based on (ijk) coordinates, balancing per-cell weights.
+    ///
+    /// The grid is first split into slabs in k direction, each slab in j direction
+    /// and each of these in i direction, such that every split balances the weights
+    /// of the cells. With several weights per cell (multiple constraints) each weight
+    /// is normalized by its total and their sum is balanced.
+    /// @param[in] grid the grid to partition
+    /// @param[in] initial_split the number of parts in which to partition the grid, in each cardinal direction.
+    ///                          Their product is the expected number of partitions produced.
+    /// @param[out] num_part the resulting number of partitions, see above.
+    /// @param[out] cell_part a vector containing, for each cell, its partition number
+    /// @param[in] cell_weights one or more vectors with a non-negative weight for each cell.
+    ///                         If empty, all cells have the same weight.
+    void partition(const CpGrid& grid,
+                   const std::array<int, 3>& initial_split,
+                   int& num_part,
+                   std::vector<int>& cell_part,
+                   const std::vector<std::vector<double> >& cell_weights,
+                   bool recursive = false,
+                   bool ensureConnectivity = true);
+
+    /// Partition a CpGrid geometrically by recursive coordinate bisection of the cell centroids.
+    ///
+    /// The cells are recursively split along the longest side of the bounding box of
+    /// their centroids, such that the weights of the cells are balanced. Only active
+    /// cells are considered, hence sparse grids are partitioned evenly. The partitions
+    /// are not guaranteed to be connected.
+    /// @param[in] grid the grid to partition
+    /// @param[in] num_part the number of partitions. Each one gets at least one cell
+    ///                     if there are enough cells.
+    /// @param[out] cell_part a vector containing, for each cell, its partition number
+    /// @param[in] cell_weights one or more vectors with a non-negative weight for each cell.
+    ///                         If empty, all cells have the same weight.
+    void partitionGeometric(const CpGrid& grid,
+                            int num_part,
+                            std::vector<int>& cell_part,
+                            const std::vector<std::vector<double> >& cell_weights = std::vector<std::vector<double> >());
+
+    /// Partition cells geometrically by recursive coordinate bisection of their centroids.
+    ///
+    /// Same as partitionGeometric() for a CpGrid, but for cells given by their
+    /// centroids only, e.g. the cells of an UnstructuredGrid.
+    /// @param[in] centroids the centroids of the cells, dimensions coordinates for each cell
+    /// @param[in] num_cells the number of cells
+    /// @param[in] dimensions the number of coordinates of each centroid (at most 3)
+    /// @param[in] num_part the number of partitions
+    /// @param[out] cell_part a vector containing, for each cell, its partition number
+    /// @param[in] cell_weights one or more vectors with a non-negative weight for each cell.
+    ///                         If empty, all cells have the same weight.
+    void partitionGeometric(const double* centroids,
+                            int num_cells,
+                            int dimensions,
+                            int num_part,
+                            std::vector<int>& cell_part,
+                            const std::vector<std::vector<double> >& cell_weights = std::vector<std::vector<double> >());
+
 /// \brief Adds a layer of overlap cells to a partitioning.
 /// \param[in] grid The grid that is partitioned.
 /// \param[in] cell_part a vector containing each cells partition number.
-/// \param[out] cell_overlap a vector of sets that contains for each cell all
-///             the partition numbers that it is an overlap cell of.
+/// \param[out] cell_overlap a table with one row per cell. For overlap cells
+///             the row contains the partition that it is an overlap cell of;
+///             for owner cells the partitions of its overlap neighbours. Each
+///             row is sorted in ascending order without duplicates.
 /// \param[in] mypart The partition number of the processor.
 /// \param[in] all Whether to compute the overlap for all partions or just the
 ///            one associated by mypart.
      void addOverlapLayer(const CpGrid& grid,
                           const std::vector<int>& cell_part,
-                          std::vector<std::set<int> >& cell_overlap,
+                          Opm::SparseTable<int>& cell_overlap,
                           int mypart, int overlapLayers, bool all=false);
 
 } // namespace Dune
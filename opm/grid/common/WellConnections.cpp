@@ -21,7 +21,10 @@
 #include <config.h>
 #endif
 
+#include <algorithm>
+#include <iostream>
 #include <map>
+#include <numeric>
 
 #include <opm/grid/common/WellConnections.hpp>
 
@@ -194,6 +197,120 @@ computeDefunctWellNames(const std::vector<std::vector<int> >& wells_on_proc,
 
     return defunct_well_names;
 }
+
+std::vector<std::vector<int> >
+postProcessDistributedPartitioningForWells(std::vector<int>& parts,
+                                           const std::vector<int>& ownedCells,
+                                           const std::vector<int>& globalCell,
+                                           const std::vector<OpmWellType>& wells,
+                                           const std::array<int, 3>& cartesianSize,
+                                           const CollectiveCommunication<MPI_Comm>& cc,
+                                           int root)
+{
+    // Contains for each process the indices of the wells assigned to it.
+    std::vector<std::vector<int> > well_indices_on_proc(cc.rank() == root ? cc.size() : 0);
+
+#if HAVE_ECL_INPUT
+    if( wells.empty() )
+    {
+        return well_indices_on_proc;
+    }
+
+    // The wells perforating each logical cartesian cell.
+    std::map<int, std::set<int> > wells_of_cell;
+    int well_index = 0;
+    for (const auto& well : wells) {
+        const auto& connectionSet = well.getConnections( );
+        for (size_t c=0; c<connectionSet.size(); c++) {
+            const auto& connection = connectionSet.get(c);
+            int cart_grid_idx = connection.getI() +
+                cartesianSize[0]*(connection.getJ() + cartesianSize[1]*connection.getK());
+            wells_of_cell[cart_grid_idx].insert(well_index);
+        }
+        ++well_index;
+    }
+
+    // Pairs of well index and partition number of the perforated cells of this process.
+    std::vector<int> my_connections;
+    for ( int cell : ownedCells )
+    {
+        auto candidate = wells_of_cell.find(globalCell[cell]);
+        if ( candidate == wells_of_cell.end() )
+        {
+            continue;
+        }
+        for ( int well : candidate->second )
+        {
+            my_connections.push_back(well);
+            my_connections.push_back(parts[cell]);
+        }
+    }
+
+    int no_entries = my_connections.size();
+    std::vector<int> no_entries_per_rank(cc.rank() == root ? cc.size() : 0);
+    cc.gather(&no_entries, no_entries_per_rank.data(), 1, root);
+    std::vector<int> displ;
+    std::vector<int> all_connections;
+    if ( cc.rank() == root )
+    {
+        displ.resize(cc.size() + 1, 0);
+        std::partial_sum(no_entries_per_rank.begin(), no_entries_per_rank.end(), displ.begin() + 1);
+        all_connections.resize(displ.back());
+    }
+    cc.gatherv(my_connections.data(), no_entries, all_connections.data(),
+               no_entries_per_rank.data(), displ.data(), root);
+
+    // The partition with the most connections of a well becomes its owner.
+    // Wells without active connections are assigned to the root process.
+    std::vector<int> well_owner(wells.size(), root);
+    if ( cc.rank() == root )
+    {
+        std::vector<std::map<int,std::size_t> > no_connections_on_proc(wells.size());
+        for ( std::size_t i = 0; i < all_connections.size(); i += 2 )
+        {
+            ++no_connections_on_proc[all_connections[i]][all_connections[i+1]];
+        }
+        for ( std::size_t well = 0; well < wells.size(); ++well )
+        {
+            const auto& on_proc = no_connections_on_proc[well];
+            if ( !on_proc.empty() )
+            {
+                auto owner = std::max_element(on_proc.begin(), on_proc.end(),
+                                              [](const std::pair<const int,std::size_t>& p1,
+                                                 const std::pair<const int,std::size_t>& p2){
+                                                  return ( p1.second < p2.second );
+                                              });
+                well_owner[well] = owner->first;
+                if ( on_proc.size() > 1 )
+                {
+                    std::cout << "Manually moving well " << wells[well].name() << " to partition "
+                              << well_owner[well] << std::endl;
+                }
+            }
+            well_indices_on_proc[well_owner[well]].push_back(well);
+        }
+    }
+    cc.broadcast(well_owner.data(), well_owner.size(), root);
+
+    for ( int cell : ownedCells )
+    {
+        auto candidate = wells_of_cell.find(globalCell[cell]);
+        if ( candidate != wells_of_cell.end() )
+        {
+            parts[cell] = well_owner[*candidate->second.begin()];
+        }
+    }
+#else
+    static_cast<void>(parts);
+    static_cast<void>(ownedCells);
+    static_cast<void>(globalCell);
+    static_cast<void>(wells);
+    static_cast<void>(cartesianSize);
+    static_cast<void>(root);
+#endif
+
+    return well_indices_on_proc;
+}
 #endif
 } // end namespace cpgrid
 } // end namespace Dune
@@ -20,6 +20,7 @@
 #ifndef DUNE_CPGRID_WELL_CONNECTIONS_HEADER_INCLUDED
 #define DUNE_CPGRID_WELL_CONNECTIONS_HEADER_INCLUDED
 
+#include <array>
 #include <set>
 #include <unordered_set>
 #include <vector>
@@ -135,6 +136,32 @@ computeDefunctWellNames(const std::vector<std::vector<int> >& wells_on_proc,
                         const std::vector<OpmWellType>&  wells,
                         const CollectiveCommunication<MPI_Comm>& cc,
                         int root);
+
+/// \brief Computes wells assigned to processes for a distributed partitioning.
+///
+/// Like postProcessPartitioningForWells, but the partitioning is only known
+/// for the cells owned by each process. Only the partition numbers of the
+/// perforated cells are gathered on the root process, which decides the
+/// owner of each well and broadcasts it. Thus the communication volume only
+/// depends on the number of perforations.
+/// \param parts The partition number for each local cell. The entries of
+///              perforated owned cells are changed to the owner of the well.
+/// \param ownedCells The local indices of the cells owned by this process.
+/// \param globalCell The logical cartesian index of each local cell.
+/// \param wells The wells (has to be the same on all processes).
+/// \param cartesianSize The logical cartesian size of the grid.
+/// \param cc The communicator.
+/// \param root The rank of the process that decides about the well owners.
+/// \return On the root process for each process the indices of the wells
+///         assigned to it. Empty on all other processes.
+std::vector<std::vector<int> >
+postProcessDistributedPartitioningForWells(std::vector<int>& parts,
+                                           const std::vector<int>& ownedCells,
+                                           const std::vector<int>& globalCell,
+                                           const std::vector<OpmWellType>& wells,
+                                           const std::array<int, 3>& cartesianSize,
+                                           const CollectiveCommunication<MPI_Comm>& cc,
+                                           int root);
 #endif
 } // end namespace cpgrid
 } // end namespace Dune
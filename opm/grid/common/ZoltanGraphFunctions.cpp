@@ -21,6 +21,7 @@
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
+#include <algorithm>
 #include <limits>
 
 #include <opm/grid/utility/OpmParserIncludes.hpp>
@@ -400,6 +401,159 @@ void setCpGridZoltanGraphFunctions(Zoltan_Struct *zz,
         Zoltan_Set_Edge_List_Multi_Fn(zz, getCpGridWellsEdgeList, graphPointer);
     }
 }
+
+namespace
+{
+void getCpGridWeightedVertexList(void* weightsPointer, int numGlobalIdEntries,
+                                 int numLocalIdEntries, ZOLTAN_ID_PTR gids,
+                                 ZOLTAN_ID_PTR lids, int wgtDim,
+                                 float *objWgts, int *err)
+{
+    const CpGridVertexWeights& weights = *static_cast<const CpGridVertexWeights*>(weightsPointer);
+    if ( numGlobalIdEntries != numLocalIdEntries || numGlobalIdEntries != 1 ||
+         wgtDim != weights.numConstraints() )
+    {
+        *err = ZOLTAN_FATAL;
+        return;
+    }
+    // The grid is not distributed. Hence the global id of a cell is its index.
+    int idx = 0;
+    for ( int cell = weights.begin(); cell < weights.end(); ++cell, ++idx )
+    {
+        gids[idx] = cell;
+        lids[idx] = cell;
+        for ( int w = 0; w < wgtDim; ++w )
+        {
+            objWgts[idx*wgtDim + w] = weights.weight(w, cell);
+        }
+    }
+    *err = ZOLTAN_OK;
+}
+} // end anonymous namespace
+
+void setCpGridZoltanVertexWeights(Zoltan_Struct *zz,
+                                  const CpGridVertexWeights& weights)
+{
+    CpGridVertexWeights* weightsPointer = const_cast<CpGridVertexWeights*>(&weights);
+    Zoltan_Set_Obj_List_Fn(zz, getCpGridWeightedVertexList, weightsPointer);
+}
+
+DistributedCpGridGraph::DistributedCpGridGraph(const Dune::CpGrid& grid,
+                                               const std::vector<std::vector<double> >& weights)
+    : grid_(grid), weights_(weights), globalIndex_(grid.numCells()),
+      owner_(grid.numCells(), grid.comm().rank())
+{
+    for ( const auto& index : grid.getCellIndexSet() )
+    {
+        globalIndex_[index.local()] = index.global();
+        if ( index.local().attribute() == Dune::OwnerOverlapCopyAttributeSet::owner )
+        {
+            ownedCells_.push_back(index.local());
+        }
+    }
+    std::sort(ownedCells_.begin(), ownedCells_.end());
+    // The owners send their rank to the copies.
+    grid.haloExchangePlan<int>(Dune::InteriorBorder_All_Interface)->exchange(owner_);
+}
+
+namespace
+{
+int getDistributedCpGridNumCells(void* graphPointer, int* err)
+{
+    const DistributedCpGridGraph& graph = *static_cast<const DistributedCpGridGraph*>(graphPointer);
+    *err = ZOLTAN_OK;
+    return graph.ownedCells().size();
+}
+
+void getDistributedCpGridVertexList(void* graphPointer, int numGlobalIdEntries,
+                                    int numLocalIdEntries, ZOLTAN_ID_PTR gids,
+                                    ZOLTAN_ID_PTR lids, int wgtDim,
+                                    float *objWgts, int *err)
+{
+    const DistributedCpGridGraph& graph = *static_cast<const DistributedCpGridGraph*>(graphPointer);
+    if ( numGlobalIdEntries != numLocalIdEntries || numGlobalIdEntries != 1 ||
+         ( wgtDim > 0 && wgtDim != graph.numConstraints() ) )
+    {
+        *err = ZOLTAN_FATAL;
+        return;
+    }
+    int idx = 0;
+    for ( int cell : graph.ownedCells() )
+    {
+        gids[idx] = graph.globalIndex(cell);
+        lids[idx] = cell;
+        for ( int w = 0; w < wgtDim; ++w )
+        {
+            objWgts[idx*wgtDim + w] = graph.weight(w, cell);
+        }
+        ++idx;
+    }
+    *err = ZOLTAN_OK;
+}
+
+void getDistributedCpGridNumEdgesList(void *graphPointer, int sizeGID, int sizeLID,
+                                      int numCells,
+                                      ZOLTAN_ID_PTR globalID, ZOLTAN_ID_PTR localID,
+                                      int *numEdges, int *err)
+{
+    (void) globalID;
+    const DistributedCpGridGraph& graph = *static_cast<const DistributedCpGridGraph*>(graphPointer);
+    if ( sizeGID != 1 || sizeLID != 1 ||
+         numCells != static_cast<int>(graph.ownedCells().size()) )
+    {
+        *err = ZOLTAN_FATAL;
+        return;
+    }
+    const auto& connections = graph.getGrid().cellConnections();
+    for( int i = 0; i < numCells;  i++ )
+    {
+        numEdges[i] = connections.neighbours(localID[i]).size();
+    }
+    *err = ZOLTAN_OK;
+}
+
+void getDistributedCpGridEdgeList(void *graphPointer, int sizeGID, int sizeLID,
+                                  int numCells, ZOLTAN_ID_PTR globalID, ZOLTAN_ID_PTR localID,
+                                  int *numEdges,
+                                  ZOLTAN_ID_PTR nborGID, int *nborProc,
+                                  int wgtDim, float *ewgts, int *err)
+{
+    (void) globalID; (void) numEdges;
+    const DistributedCpGridGraph& graph = *static_cast<const DistributedCpGridGraph*>(graphPointer);
+    if ( sizeGID != 1 || sizeLID != 1 ||
+         numCells != static_cast<int>(graph.ownedCells().size()) )
+    {
+        *err = ZOLTAN_FATAL;
+        return;
+    }
+    const auto& connections = graph.getGrid().cellConnections();
+    int idx = 0;
+    for( int cell = 0; cell < numCells;  cell++ )
+    {
+        for ( int other : connections.neighbours(localID[cell]) )
+        {
+            nborGID[idx]  = graph.globalIndex(other);
+            nborProc[idx] = graph.owner(other);
+            if ( wgtDim )
+            {
+                ewgts[idx] = 1.0;
+            }
+            ++idx;
+        }
+    }
+    *err = ZOLTAN_OK;
+}
+} // end anonymous namespace
+
+void setCpGridZoltanGraphFunctions(Zoltan_Struct *zz,
+                                   const DistributedCpGridGraph& graph)
+{
+    DistributedCpGridGraph* graphPointer = const_cast<DistributedCpGridGraph*>(&graph);
+    Zoltan_Set_Num_Obj_Fn(zz, getDistributedCpGridNumCells, graphPointer);
+    Zoltan_Set_Obj_List_Fn(zz, getDistributedCpGridVertexList, graphPointer);
+    Zoltan_Set_Num_Edges_Multi_Fn(zz, getDistributedCpGridNumEdgesList, graphPointer);
+    Zoltan_Set_Edge_List_Multi_Fn(zz, getDistributedCpGridEdgeList, graphPointer);
+}
 } // end namespace cpgrid
 } // end namespace Dune
 #endif // HAVE_ZOLTAN
@@ -26,6 +26,9 @@
 #include <opm/grid/CpGrid.hpp>
 #include <opm/grid/common/WellConnections.hpp>
 
+#include <algorithm>
+#include <vector>
+
 #if defined(HAVE_ZOLTAN) && defined(HAVE_MPI)
 
 #include <mpi.h>
@@ -220,6 +223,117 @@ private:
 };
 
 
+/// \brief The weights of the vertices of the graph of a grid.
+///
+/// Each cell (vertex of the graph) has one weight per constraint, which
+/// ZOLTAN balances simultaneously (multi-constraint partitioning). The
+/// vertices are the cells in [begin, end) of a grid that is not distributed,
+/// such that the global id of a cell is its index.
+class CpGridVertexWeights
+{
+public:
+    /// \brief Create the vertex weights.
+    /// \param weights One vector per constraint with a weight for each cell.
+    /// \param begin The first cell provided to ZOLTAN.
+    /// \param end One past the last cell provided to ZOLTAN.
+    CpGridVertexWeights(const std::vector<std::vector<double> >& weights,
+                        int begin, int end)
+        : weights_(weights), begin_(begin), end_(end)
+    {}
+
+    /// \brief The first cell provided to ZOLTAN.
+    int begin() const
+    {
+        return begin_;
+    }
+
+    /// \brief One past the last cell provided to ZOLTAN.
+    int end() const
+    {
+        return end_;
+    }
+
+    /// \brief The number of weights per cell.
+    int numConstraints() const
+    {
+        return weights_.size();
+    }
+
+    /// \brief The weight of a cell for a constraint.
+    double weight(int constraint, int cell) const
+    {
+        return weights_[constraint][cell];
+    }
+
+private:
+    const std::vector<std::vector<double> >& weights_;
+    int begin_;
+    int end_;
+};
+
+/// \brief The graph of a distributed grid.
+///
+/// This is used to repartition a grid that is already distributed. The
+/// vertices of each process are its interior cells, identified by their
+/// global index. Edges are the connections through faces, also to cells
+/// owned by other processes.
+class DistributedCpGridGraph
+{
+public:
+    /// \brief Create the graph.
+    ///
+    /// This is a collective operation as the owners of the overlap cells
+    /// are communicated.
+    /// \param grid The grid in its distributed view.
+    /// \param weights One vector per constraint with a weight for each cell
+    ///        of the distributed grid (may be empty).
+    DistributedCpGridGraph(const Dune::CpGrid& grid,
+                           const std::vector<std::vector<double> >& weights);
+
+    /// \brief Access the grid.
+    const Dune::CpGrid& getGrid() const
+    {
+        return grid_;
+    }
+
+    /// \brief The interior cells of this process.
+    const std::vector<int>& ownedCells() const
+    {
+        return ownedCells_;
+    }
+
+    /// \brief The global index of a cell.
+    int globalIndex(int cell) const
+    {
+        return globalIndex_[cell];
+    }
+
+    /// \brief The process owning a cell.
+    int owner(int cell) const
+    {
+        return owner_[cell];
+    }
+
+    /// \brief The number of weights per cell.
+    int numConstraints() const
+    {
+        return weights_.size();
+    }
+
+    /// \brief The weight of a cell for a constraint.
+    double weight(int constraint, int cell) const
+    {
+        return weights_[constraint][cell];
+    }
+
+private:
+    const Dune::CpGrid& grid_;
+    const std::vector<std::vector<double> >& weights_;
+    std::vector<int> ownedCells_;
+    std::vector<int> globalIndex_;
+    std::vector<int> owner_;
+};
+
 /// \brief Sets up the call-back functions for ZOLTAN's graph partitioning.
 /// \param zz The struct with the information for ZOLTAN.
 /// \param grid The grid to partition.
@@ -230,6 +344,22 @@ void setCpGridZoltanGraphFunctions(Zoltan_Struct *zz, const Dune::CpGrid& grid,
 void setCpGridZoltanGraphFunctions(Zoltan_Struct *zz,
                                    const CombinedGridWellGraph& graph,
                                    bool pretendNull);
+
+/// \brief Sets up the call-back functions for ZOLTAN's partitioning of a distributed grid.
+/// \param zz The struct with the information for ZOLTAN.
+/// \param graph The graph with the interior cells of this process.
+void setCpGridZoltanGraphFunctions(Zoltan_Struct *zz,
+                                   const DistributedCpGridGraph& graph);
+
+/// \brief Sets up the call-back function providing the vertices with their weights.
+///
+/// Has to be called after setCpGridZoltanGraphFunctions and replaces the
+/// list of vertices set there. The parameter OBJ_WEIGHT_DIM has to be set
+/// to the number of constraints on all processes.
+/// \param zz The struct with the information for ZOLTAN.
+/// \param weights The weights of the vertices of this process.
+void setCpGridZoltanVertexWeights(Zoltan_Struct *zz,
+                                  const CpGridVertexWeights& weights);
 } // end namespace cpgrid
 } // end namespace Dune
 
@@ -24,28 +24,23 @@
 
 #include <opm/grid/utility/OpmParserIncludes.hpp>
 
+#include <string>
+
 #if defined(HAVE_ZOLTAN) && defined(HAVE_MPI)
 namespace Dune
 {
 namespace cpgrid
 {
-std::pair<std::vector<int>, std::unordered_set<std::string> >
-zoltanGraphPartitionGridOnRoot(const CpGrid& cpgrid,
-                               const std::vector<OpmWellType> * wells,
-                               const double* transmissibilities,
-                               const CollectiveCommunication<MPI_Comm>& cc,
-                               EdgeWeightMethod edgeWeightsMethod, int root)
+namespace
+{
+Zoltan_Struct* createZoltanGraphPartitioner(const CollectiveCommunication<MPI_Comm>& cc)
 {
     int rc = ZOLTAN_OK - 1;
     float ver = 0;
-    struct Zoltan_Struct *zz;
-    int changes, numGidEntries, numLidEntries, numImport, numExport;
-    ZOLTAN_ID_PTR importGlobalGids, importLocalGids, exportGlobalGids, exportLocalGids;
-    int *importProcs, *importToPart, *exportProcs, *exportToPart;
     int argc=0;
     char** argv = 0 ;
     rc = Zoltan_Initialize(argc, argv, &ver);
-    zz = Zoltan_Create(cc);
+    struct Zoltan_Struct *zz = Zoltan_Create(cc);
     if ( rc != ZOLTAN_OK )
     {
         OPM_THROW(std::runtime_error, "Could not initialize Zoltan!");
@@ -61,6 +56,39 @@ zoltanGraphPartitionGridOnRoot(const CpGrid& cpgrid,
     Zoltan_Set_Param(zz,"EDGE_WEIGHT_DIM","0");
     Zoltan_Set_Param(zz, "OBJ_WEIGHT_DIM", "0");
     Zoltan_Set_Param(zz, "PHG_EDGE_SIZE_THRESHOLD", ".35");  /* 0-remove all, 1-remove none */
+    return zz;
+}
+
+/// \brief Set the number of weights per vertex.
+///
+/// The number has to be the same on all processes, even on those that
+/// do not provide any vertices.
+int setZoltanVertexWeightDim(Zoltan_Struct* zz,
+                             const std::vector<std::vector<double> >& cellWeights,
+                             const CollectiveCommunication<MPI_Comm>& cc)
+{
+    const int weightDim = cc.max(static_cast<int>(cellWeights.size()));
+    if ( weightDim > 0 )
+    {
+        Zoltan_Set_Param(zz, "OBJ_WEIGHT_DIM", std::to_string(weightDim).c_str());
+    }
+    return weightDim;
+}
+} // end anonymous namespace
+
+std::pair<std::vector<int>, std::unordered_set<std::string> >
+zoltanGraphPartitionGridOnRoot(const CpGrid& cpgrid,
+                               const std::vector<OpmWellType> * wells,
+                               const double* transmissibilities,
+                               const CollectiveCommunication<MPI_Comm>& cc,
+                               EdgeWeightMethod edgeWeightsMethod, int root,
+                               const std::vector<std::vector<double> >& cellWeights)
+{
+    int rc;
+    int changes, numGidEntries, numLidEntries, numImport, numExport;
+    ZOLTAN_ID_PTR importGlobalGids, importLocalGids, exportGlobalGids, exportLocalGids;
+    int *importProcs, *importToPart, *exportProcs, *exportToPart;
+    struct Zoltan_Struct *zz = createZoltanGraphPartitioner(cc);
 
     // For the load balancer one process has the whole grid and
     // all others an empty partition before loadbalancing.
@@ -85,6 +113,12 @@ zoltanGraphPartitionGridOnRoot(const CpGrid& cpgrid,
         Dune::cpgrid::setCpGridZoltanGraphFunctions(zz, cpgrid, partitionIsEmpty);
     }
 
+    CpGridVertexWeights vertex_weights(cellWeights, 0, cpgrid.numCells());
+    if ( setZoltanVertexWeightDim(zz, cellWeights, cc) > 0 && !partitionIsEmpty )
+    {
+        setCpGridZoltanVertexWeights(zz, vertex_weights);
+    }
+
     rc = Zoltan_LB_Partition(zz, /* input (all remaining fields are output) */
                              &changes,        /* 1 if partitioning was changed, 0 otherwise */
                              &numGidEntries,  /* Number of integers used for a global ID */
@@ -153,10 +187,106 @@ zoltanGraphPartitionGridOnRoot(const CpGrid& cpgrid,
                                                      root);
     }
 
-    cc.broadcast(&parts[0], parts.size(), root);
+    // If the global grid is only present on the root process, then the
+    // partitioning is only needed there and is not broadcast.
+    if( cc.min(size) == cc.max(size) )
+    {
+        cc.broadcast(parts.data(), parts.size(), root);
+    }
+
+    return std::make_pair(parts, defunct_well_names);
+}
+
+namespace
+{
+/// \brief Partition the graph of a distributed grid with Zoltan.
+///
+/// Each process only provides its interior cells and their connections.
+std::vector<int>
+zoltanPartitionDistributedGraph(const CpGrid& cpgrid,
+                                const std::vector<std::vector<double> >& cellWeights,
+                                const CollectiveCommunication<MPI_Comm>& cc,
+                                const char* approach,
+                                std::vector<int>* ownedCells = nullptr)
+{
+    int changes, numGidEntries, numLidEntries, numImport, numExport;
+    ZOLTAN_ID_PTR importGlobalGids, importLocalGids, exportGlobalGids, exportLocalGids;
+    int *importProcs, *importToPart, *exportProcs, *exportToPart;
+    struct Zoltan_Struct *zz = createZoltanGraphPartitioner(cc);
+    Zoltan_Set_Param(zz, "LB_APPROACH", approach);
+
+    DistributedCpGridGraph graph(cpgrid, cellWeights);
+    setCpGridZoltanGraphFunctions(zz, graph);
+    setZoltanVertexWeightDim(zz, cellWeights, cc);
+
+    int rc = Zoltan_LB_Partition(zz, &changes, &numGidEntries, &numLidEntries,
+                                 &numImport, &importGlobalGids, &importLocalGids,
+                                 &importProcs, &importToPart,
+                                 &numExport, &exportGlobalGids, &exportLocalGids,
+                                 &exportProcs, &exportToPart);
+    if ( rc != ZOLTAN_OK )
+    {
+        OPM_THROW(std::runtime_error, "Zoltan failed to partition the distributed grid!");
+    }
+
+    std::vector<int> parts(cpgrid.numCells(), cc.rank());
+
+    for ( int i=0; i < numExport; ++i )
+    {
+        parts[exportLocalGids[i]] = exportProcs[i];
+    }
+
+    Zoltan_LB_Free_Part(&exportGlobalGids, &exportLocalGids, &exportProcs, &exportToPart);
+    Zoltan_LB_Free_Part(&importGlobalGids, &importLocalGids, &importProcs, &importToPart);
+    Zoltan_Destroy(&zz);
+
+    if ( ownedCells )
+    {
+        *ownedCells = graph.ownedCells();
+    }
+    return parts;
+}
+} // end anonymous namespace
+
+std::pair<std::vector<int>, std::unordered_set<std::string> >
+zoltanGraphPartitionGridInParallel(const CpGrid& cpgrid,
+                                   const std::vector<OpmWellType> * wells,
+                                   const std::vector<std::vector<double> >& cellWeights,
+                                   const CollectiveCommunication<MPI_Comm>& cc,
+                                   int root)
+{
+    // The initial distribution is arbitrary. Hence there is no point in
+    // trying to keep cells where they are.
+    std::vector<int> owned_cells;
+    std::vector<int> parts = zoltanPartitionDistributedGraph(cpgrid, cellWeights, cc,
+                                                             "PARTITION", &owned_cells);
+    std::unordered_set<std::string> defunct_well_names;
+
+    if( wells )
+    {
+        auto wells_on_proc =
+            postProcessDistributedPartitioningForWells(parts, owned_cells,
+                                                       cpgrid.globalCell(),
+                                                       *wells,
+                                                       cpgrid.logicalCartesianSize(),
+                                                       cc, root);
+        defunct_well_names = computeDefunctWellNames(wells_on_proc,
+                                                     *wells,
+                                                     cc,
+                                                     root);
+    }
 
     return std::make_pair(parts, defunct_well_names);
 }
+
+std::vector<int>
+zoltanRepartitionDistributedGrid(const CpGrid& cpgrid,
+                                 const std::vector<std::vector<double> >& cellWeights,
+                                 const CollectiveCommunication<MPI_Comm>& cc)
+{
+    // The cells are already distributed. Try to keep them where they are.
+    return zoltanPartitionDistributedGraph(cpgrid, cellWeights, cc, "REPARTITION");
+}
 }
 }
 #endif // HAVE_ZOLTAN
@@ -37,6 +37,8 @@ namespace cpgrid
 /// In case the global grid is available on all processes, it
 /// will nevertheless only use the information on the root process
 /// to partition it as Zoltan cannot identify this situation.
+/// If the other processes only hold an empty grid, then the
+/// partitioning is only returned on the root process.
 /// @param grid The grid to partition
 /// @param wells The wells of the eclipse If null wells will be neglected.
 /// @param transmissibilities The transmissibilities associated with the
@@ -46,6 +48,9 @@ namespace cpgrid
 /// @param edgeWeightMethod The method used to calculate the weights associated
 ///             with the edges of the graph (uniform, transmissibilities, log thereof)
 /// @param root The process number that holds the global grid.
+/// @param cellWeights One or more vectors with a weight for each cell, which
+///             are balanced simultaneously. Only needed on the root process.
+///             If empty, all cells have the same weight.
 /// @return A pair consisting of a vector that contains for each local cell of the grid the
 ///         the number of the process that owns it after repartitioning,
 ///         and a set of names of wells that should be defunct in a parallel
@@ -55,7 +60,56 @@ zoltanGraphPartitionGridOnRoot(const CpGrid& grid,
                                const std::vector<OpmWellType> * wells,
                                const double* transmissibilities,
                                const CollectiveCommunication<MPI_Comm>& cc,
-                               EdgeWeightMethod edgeWeightsMethod, int root);
+                               EdgeWeightMethod edgeWeightsMethod, int root,
+                               const std::vector<std::vector<double> >& cellWeights = std::vector<std::vector<double> >());
+
+/// \brief Partition a distributed CpGrid using Zoltan in parallel
+///
+/// In contrast to zoltanGraphPartitionGridOnRoot the global grid is not
+/// needed. The grid has to be distributed already, e.g. by an inexpensive
+/// initial split into slabs of the logical cartesian grid. Each process only
+/// provides its interior cells and their connections to Zoltan, which
+/// partitions the graph from scratch. Cells perforated by a well are moved to
+/// one process afterwards, where only the partition numbers of the perforated
+/// cells are gathered on the root process. The edges have uniform weights.
+/// @param grid The grid in its distributed view.
+/// @param wells The wells of the eclipse If null wells will be neglected.
+///             Have to be present on all processes.
+/// @param cellWeights One or more vectors with a weight for each cell of
+///             the distributed grid, which are balanced simultaneously.
+///             If empty, all cells have the same weight.
+/// @paramm cc  The MPI communicator of the distributed grid.
+/// @param root The process number that computes the defunct wells.
+/// @return A pair consisting of a vector that contains for each cell of the
+///         distributed grid the number of the process that owns it after
+///         partitioning (only the entries of the interior cells are meaningful),
+///         and a set of names of wells that should be defunct in a parallel
+///         simulation.
+std::pair<std::vector<int>,std::unordered_set<std::string> >
+zoltanGraphPartitionGridInParallel(const CpGrid& grid,
+                                   const std::vector<OpmWellType> * wells,
+                                   const std::vector<std::vector<double> >& cellWeights,
+                                   const CollectiveCommunication<MPI_Comm>& cc,
+                                   int root);
+
+/// \brief Repartition a distributed CpGrid using Zoltan
+///
+/// Each process provides its interior cells and their connections to
+/// Zoltan, which uses its repartitioning approach to balance the load
+/// while keeping the number of migrated cells small. The global grid is
+/// not needed. Wells are not taken into account.
+/// @param grid The grid in its distributed view.
+/// @param cellWeights One or more vectors with a weight for each cell of
+///             the distributed grid, which are balanced simultaneously.
+///             If empty, all cells have the same weight.
+/// @paramm cc  The MPI communicator of the distributed grid.
+/// @return A vector that contains for each cell of the distributed grid the
+///         the number of the process that owns it after repartitioning. Only
+///         the entries of the interior cells are meaningful.
+std::vector<int>
+zoltanRepartitionDistributedGrid(const CpGrid& grid,
+                                 const std::vector<std::vector<double> >& cellWeights,
+                                 const CollectiveCommunication<MPI_Comm>& cc);
 }
 }
 #endif // HAVE_ZOLTAN
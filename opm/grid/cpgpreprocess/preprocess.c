@@ -35,11 +35,16 @@
 #include "config.h"
 #include <assert.h>
 #include <float.h>
+#include <limits.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "preprocess.h"
 #include "uniquepoints.h"
 #include "facetopology.h"
@@ -55,13 +60,14 @@ static int
 checkmemory(int nz, struct processed_grid *out, int **intersections);
 
 static void
-process_vertical_faces(int direction,
+process_vertical_faces(int direction, int jstart, int jend,
                        int **intersections,
                        int *plist, int *work,
                        struct processed_grid *out);
 
 static void
-process_horizontal_faces(int **intersections,
+process_horizontal_faces(int jstart, int jend,
+                         int **intersections,
                          int *plist,
                          struct processed_grid *out);
 
@@ -135,27 +141,26 @@ compute_cell_index(const int dims[3], int i, int j,
 
 
 /*-----------------------------------------------------------------
-  Ensure there's sufficient memory */
+  Grow face storage (and intersection record) such that there is room
+  for (at least) m faces and n face nodes. */
 static int
-checkmemory(int nz, struct processed_grid *out, int **intersections)
+reserve_face_storage(int m, int n, struct processed_grid *out,
+                     int **intersections)
 {
-    int r, m, n, ok;
-
-    /* Ensure there is enough space to manage the (pathological) case
-     * of every single cell on one side of a fault connecting to all
-     * cells on the other side of the fault (i.e., an all-to-all cell
-     * connectivity pairing). */
-    r = (2*nz + 2) * (2*nz + 2);
-    m = out->m;
-    n = out->n;
-
-    if (out->number_of_faces +  r > m) {
-        m += MAX(m / 2,  2 * r);
-    }
-    if (out->face_ptr[out->number_of_faces] + 6*r > n) {
-        n += MAX(n / 2, 12 * r);
+    int ok;
+
+    /* All face and node offsets of processed_grid are of type int, and
+     * the intersection table holds four entries per face.  Refuse to
+     * grow beyond that rather than wrap around. */
+    if ((m < 0) || (n < 0) || (m > (INT_MAX - 1) / 4)) {
+        fprintf(stderr, "Corner-point grid too large for the 32-bit "
+                "index range of processed_grid\n");
+        return 0;
     }
 
+    m = MAX(m, out->m);
+    n = MAX(n, out->n);
+
     ok = m == out->m;
     if (! ok) {
         void *p1, *p2, *p3, *p4;
@@ -191,6 +196,42 @@ checkmemory(int nz, struct processed_grid *out, int **intersections)
     return ok;
 }
 
+/*-----------------------------------------------------------------
+  Ensure there's sufficient memory */
+static int
+checkmemory(int nz, struct processed_grid *out, int **intersections)
+{
+    long r, m, n;
+
+    /* Ensure there is enough space to manage the (pathological) case
+     * of every single cell on one side of a fault connecting to all
+     * cells on the other side of the fault (i.e., an all-to-all cell
+     * connectivity pairing). */
+    r = (2*(long)nz + 2) * (2*(long)nz + 2);
+    m = out->m;
+    n = out->n;
+
+    if (out->number_of_faces +  r > m) {
+        m += MAX(m / 2,  2 * r);
+    }
+    if (out->face_ptr[out->number_of_faces] + 6*r > n) {
+        n += MAX(n / 2, 12 * r);
+    }
+
+    /* Growth is computed in long so that it cannot wrap.  Cap it at
+     * what processed_grid can index; if even that is too small,
+     * reserve_face_storage() reports the overflow. */
+    if (m > (INT_MAX - 1) / 4) {
+        m = MAX((INT_MAX - 1) / 4, out->number_of_faces + r);
+    }
+    n = MIN(n, MAX((long) INT_MAX, out->face_ptr[out->number_of_faces] + 6*r));
+    if ((m > INT_MAX) || (n > INT_MAX)) {
+        m = -1;
+    }
+
+    return reserve_face_storage((int) m, (int) n, out, intersections);
+}
+
 /*-----------------------------------------------------------------
   For each vertical face (i.e. i or j constant),
   -find point numbers for the corners and
@@ -199,9 +240,11 @@ checkmemory(int nz, struct processed_grid *out, int **intersections)
 
   direction == 0 : constant-i faces.
   direction == 1 : constant-j faces.
+
+  Only pillar rows jstart <= j < jend are processed.
 */
 static void
-process_vertical_faces(int direction,
+process_vertical_faces(int direction, int jstart, int jend,
                        int **intersections,
                        int *plist, int *work,
                        struct processed_grid *out)
@@ -226,7 +269,9 @@ process_vertical_faces(int direction,
     d[1] = 2 * (ny + 0);
     d[2] = 2 * (nz + 1);
 
-    for (j = 0; j < ny + direction; ++j) {
+    assert ((0 <= jstart) && (jend <= ny + direction));
+
+    for (j = jstart; j < jend; ++j) {
         for (i = 0; i < nx + (1 - direction); ++i) {
 
             if (! checkmemory(nz, out, intersections)) {
@@ -296,9 +341,11 @@ process_vertical_faces(int direction,
   cells that are have collapsed coordinates. (This includes cells with
   ACTNUM==0)
 
+  Only pillar rows jstart <= j < jend are processed.
 */
 static void
-process_horizontal_faces(int **intersections,
+process_horizontal_faces(int jstart, int jend,
+                         int **intersections,
                          int *plist,
                          struct processed_grid *out)
 {
@@ -321,7 +368,7 @@ process_horizontal_faces(int **intersections,
     d[2] = 2+2*nz;
 
 
-    for(j=0; j<ny; ++j) {
+    for(j=jstart; j<jend; ++j) {
         for (i=0; i<nx; ++i) {
 
 
@@ -399,6 +446,316 @@ process_horizontal_faces(int **intersections,
 }
 
 
+/*-----------------------------------------------------------------
+  Allocate initial face storage and intersection record for "out". */
+static int
+init_face_storage(size_t bignum, struct processed_grid *out,
+                  int **intersections)
+{
+    out->m                = (int) (bignum / 3);
+    out->n                = (int) bignum;
+
+    out->face_neighbors   = malloc( 2*out->m     * sizeof *out->face_neighbors);
+    out->face_nodes       = malloc( out->n       * sizeof *out->face_nodes);
+    out->face_ptr         = malloc((out->m + 1)  * sizeof *out->face_ptr);
+    out->face_tag         = malloc( out->m       * sizeof *out->face_tag);
+    *intersections        = malloc( 4*out->m     * sizeof **intersections);
+
+    out->number_of_faces  = 0;
+
+    if (out->face_ptr != NULL) {
+        out->face_ptr[0]  = 0;
+    }
+
+    return (out->face_neighbors != NULL) && (out->face_nodes    != NULL) &&
+           (out->face_ptr       != NULL) && (out->face_tag      != NULL) &&
+           (*intersections      != NULL);
+}
+
+
+/*-----------------------------------------------------------------
+  Faces (and fault intersections) of a contiguous range of pillar
+  rows, stored in private buffers so that several blocks may be
+  processed concurrently.  Intersection nodes are numbered from
+  "number_of_nodes_on_pillars" within each block and renumbered when
+  the blocks are merged into the final structure. */
+struct face_block {
+    struct processed_grid g;
+    int                  *intersections;
+    int                   ok;
+};
+
+
+static void
+init_face_block(const struct processed_grid *out, struct face_block *b)
+{
+    b->g.dimensions[0]             = out->dimensions[0];
+    b->g.dimensions[1]             = out->dimensions[1];
+    b->g.dimensions[2]             = out->dimensions[2];
+    b->g.number_of_nodes_on_pillars = out->number_of_nodes_on_pillars;
+    b->g.number_of_nodes           = out->number_of_nodes_on_pillars;
+    b->g.number_of_cells           = 0;
+    b->g.node_coordinates          = NULL;
+
+    /* Shared with "out".  Distinct blocks touch distinct columns. */
+    b->g.local_cell_index          = out->local_cell_index;
+
+    b->ok = init_face_storage(64, &b->g, &b->intersections);
+}
+
+
+static void
+free_face_block(struct face_block *b)
+{
+    free(b->intersections);
+    free(b->g.face_nodes);
+    free(b->g.face_ptr);
+    free(b->g.face_tag);
+    free(b->g.face_neighbors);
+}
+
+
+/*-----------------------------------------------------------------
+  Append the faces of all blocks, in block order, to "out".  Offsets
+  into the final arrays are computed by prefix sums over the block
+  sizes, whence the blocks may be copied independently.  The result is
+  identical to processing all pillar rows serially. */
+static void
+merge_face_blocks(int nblocks, struct face_block *blocks,
+                  int **intersections, struct processed_grid *out)
+{
+    int    b;
+    int    np = out->number_of_nodes_on_pillars;
+    int   *face_start, *node_start, *isct_start, *cell_start;
+
+    face_start = malloc(4 * (nblocks + 1) * sizeof *face_start);
+    node_start = face_start + 1*(nblocks + 1);
+    isct_start = face_start + 2*(nblocks + 1);
+    cell_start = face_start + 3*(nblocks + 1);
+
+    if (face_start == NULL) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "merge_face_blocks()\n");
+        exit(1);
+    }
+
+    face_start[0] = out->number_of_faces;
+    node_start[0] = out->face_ptr[out->number_of_faces];
+    isct_start[0] = out->number_of_nodes - np;
+    cell_start[0] = out->number_of_cells;
+
+    for (b = 0; b < nblocks; ++b) {
+        const struct processed_grid *g = &blocks[b].g;
+
+        face_start[b + 1] = face_start[b] + g->number_of_faces;
+        node_start[b + 1] = node_start[b] + g->face_ptr[g->number_of_faces];
+        isct_start[b + 1] = isct_start[b] + (g->number_of_nodes - np);
+        cell_start[b + 1] = cell_start[b] + g->number_of_cells;
+    }
+
+    if (! reserve_face_storage(MAX(face_start[nblocks], isct_start[nblocks]),
+                               node_start[nblocks], out, intersections)) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "merge_face_blocks()\n");
+        exit(1);
+    }
+
+#pragma omp parallel for default(none) schedule(dynamic, 1) \
+    shared(blocks, nblocks, out, intersections, np,           \
+           face_start, node_start, isct_start, cell_start)
+    for (b = 0; b < nblocks; ++b) {
+        const struct processed_grid *g = &blocks[b].g;
+        int    f, k, node, nf, nn, ni;
+
+        nf = g->number_of_faces;
+        nn = g->face_ptr[nf];
+        ni = g->number_of_nodes - np;
+
+        memcpy(out->face_neighbors + 2*face_start[b], g->face_neighbors,
+               2 * ((size_t) nf) * sizeof *g->face_neighbors);
+        memcpy(out->face_tag + face_start[b], g->face_tag,
+               ((size_t) nf) * sizeof *g->face_tag);
+        memcpy(*intersections + 4*isct_start[b], blocks[b].intersections,
+               4 * ((size_t) ni) * sizeof *blocks[b].intersections);
+
+        for (f = 0; f < nf; ++f) {
+            out->face_ptr[face_start[b] + f + 1] =
+                node_start[b] + g->face_ptr[f + 1];
+        }
+
+        /* Intersection nodes are numbered consecutively after the
+         * intersections of all preceding blocks. */
+        for (k = 0; k < nn; ++k) {
+            node = g->face_nodes[k];
+            if (node >= np) {
+                node += isct_start[b];
+            }
+            out->face_nodes[node_start[b] + k] = node;
+        }
+    }
+
+    out->number_of_faces = face_start[nblocks];
+    out->number_of_nodes = np + isct_start[nblocks];
+    out->number_of_cells = cell_start[nblocks];
+
+    free(face_start);
+}
+
+
+/*-----------------------------------------------------------------
+  Block-local cell numbers assigned by process_horizontal_faces()
+  start at zero.  Shift them such that active cells are numbered
+  consecutively across blocks as in the serial case. */
+static void
+shift_cell_numbers(int nblocks, const struct face_block *blocks,
+                   struct processed_grid *out)
+{
+    int   b;
+    int  *offset;
+
+    offset = malloc((nblocks + 1) * sizeof *offset);
+    if (offset == NULL) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "shift_cell_numbers()\n");
+        exit(1);
+    }
+
+    offset[0] = 0;
+    for (b = 0; b < nblocks; ++b) {
+        offset[b + 1] = offset[b] + blocks[b].g.number_of_cells;
+    }
+
+#pragma omp parallel for default(none) schedule(dynamic, 1) \
+    shared(nblocks, offset, out)
+    for (b = 1; b < nblocks; ++b) {
+        int  i, j, k, idx;
+        int  nx     = out->dimensions[0];
+        int  ny     = out->dimensions[1];
+        int  nz     = out->dimensions[2];
+        int  jstart = (int) ((((size_t) ny) * (b + 0)) / nblocks);
+        int  jend   = (int) ((((size_t) ny) * (b + 1)) / nblocks);
+        int *cell   = out->local_cell_index;
+
+        for (k = 0; k < nz; ++k) {
+            for (j = jstart; j < jend; ++j) {
+                for (i = 0; i < nx; ++i) {
+                    idx = linearindex(out->dimensions, i, j, k);
+                    if (cell[idx] != -1) { cell[idx] += offset[b]; }
+                }
+            }
+        }
+    }
+
+    free(offset);
+}
+
+
+/*-----------------------------------------------------------------
+  Number of pillar-row blocks to use for a sweep over "nrows" rows.
+  Zero means "process serially". */
+static int
+number_of_face_blocks(int nrows)
+{
+#ifdef _OPENMP
+    int nthreads = omp_get_max_threads();
+
+    if (nthreads > 1) {
+        /* A few blocks per thread to even out the (highly variable)
+         * cost of faulted pillar rows. */
+        return MIN(nrows, 4 * nthreads);
+    }
+#else
+    (void) nrows;
+#endif
+
+    return 0;
+}
+
+
+/*-----------------------------------------------------------------
+  Threaded counterpart to process_vertical_faces() and
+  process_horizontal_faces().  Pillar rows are split into contiguous
+  blocks that are processed concurrently into private buffers and
+  subsequently merged in order.
+
+  direction == 0 : constant-i faces.
+  direction == 1 : constant-j faces.
+  direction == 2 : constant-k faces.
+*/
+static void
+process_faces_blocked(int direction, int nblocks,
+                      int **intersections,
+                      int *plist,
+                      struct processed_grid *out)
+{
+    int    b, ok;
+    int    nz    = out->dimensions[2];
+    int    nrows = out->dimensions[1] + (direction == 1);
+
+    struct face_block *blocks;
+
+    blocks = malloc(nblocks * sizeof *blocks);
+    if (blocks == NULL) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "process_faces_blocked()\n");
+        exit(1);
+    }
+
+    ok = 1;
+
+#pragma omp parallel for default(none) schedule(dynamic, 1) \
+    shared(blocks, nblocks, nrows, nz, direction, plist, out)  \
+    reduction(&& : ok)
+    for (b = 0; b < nblocks; ++b) {
+        int  i, *work;
+        int  jstart = (int) ((((size_t) nrows) * (b + 0)) / nblocks);
+        int  jend   = (int) ((((size_t) nrows) * (b + 1)) / nblocks);
+
+        init_face_block(out, &blocks[b]);
+
+        if (! blocks[b].ok) {
+            ok = 0;
+            continue;
+        }
+
+        if (direction == 2) {
+            process_horizontal_faces(jstart, jend, &blocks[b].intersections,
+                                     plist, &blocks[b].g);
+        }
+        else {
+            work = malloc(2 * ((size_t) (2*nz + 2)) * sizeof *work);
+            if (work == NULL) {
+                ok = 0;
+                continue;
+            }
+            for (i = 0; i < 4 * (nz + 1); ++i) { work[i] = -1; }
+
+            process_vertical_faces(direction, jstart, jend,
+                                   &blocks[b].intersections,
+                                   plist, work, &blocks[b].g);
+            free(work);
+        }
+    }
+
+    if (! ok) {
+        fprintf(stderr, "Could not allocate enough space in "
+                "process_faces_blocked()\n");
+        exit(1);
+    }
+
+    if (direction == 2) {
+        shift_cell_numbers(nblocks, blocks, out);
+    }
+
+    merge_face_blocks(nblocks, blocks, intersections, out);
+
+    for (b = 0; b < nblocks; ++b) {
+        free_face_block(&blocks[b]);
+    }
+    free(blocks);
+}
+
+
 /*-----------------------------------------------------------------
   On input,
   L points to 4 ints that indirectly refers to points in c.
@@ -499,234 +856,189 @@ compute_intersection_coordinates(int                   *intersections,
 
 
 /* ------------------------------------------------------------------ */
-static int*
-copy_and_permute_actnum(int nx, int ny, int nz, const int *in, int *out)
-/* ------------------------------------------------------------------ */
-{
-    int i,j,k;
-    int *ptr = out;
-
-    /* Permute actnum such that values of each vertical stack of cells
-     * are adjacent in memory, i.e.,
-     *
-     *    out = [in(0,0,:), in(1,0,:),..., in(nx-1, ny-1,:)]
-     *
-     * in MATLAB pseudo-code.
-     */
-    if (in != NULL) {
-        for (j = 0; j < ny; ++j) {
-            for (i = 0; i < nx; ++i) {
-                for (k = 0; k < nz; ++k) {
-                    *ptr++ = in[i + nx*(j + ny*k)];
-                }
-            }
-        }
-    }
-    else {
-        /* No explicit ACTNUM.  Assume all cells active. */
-        for (i = 0; i < nx * ny * nz; i++) {
-            out[ i ] = 1;
-        }
-    }
-
-    return out;
-}
-
-/* ------------------------------------------------------------------ */
-static double*
-copy_and_permute_zcorn(int nx, int ny, int nz, const double *in,
-                       double sign, double *out)
+static int
+scan_zcorn_rows(const struct grdecl_rows *in, int *sign, int *error,
+                int *left_handed)
 /* ------------------------------------------------------------------ */
 {
-    int i,j,k;
-    double *ptr = out;
-    /* Permute zcorn such that values of each vertical stack of cells
-     * are adjacent in memory, i.e.,
+    /* Traverse the corner rows once to
 
-     out = [in(0,0,:), in(1,0,:),..., in(2*nx-1, 2*ny-1,:)]
+       a) Ensure that zcorn (i.e., depth) is strictly nondecreasing in
+          the k-direction.  This is required by the processign
+          algorithm.
 
-     in Matlab pseudo-code.
-    */
-    for (j=0; j<2*ny; ++j){
-        for (i=0; i<2*nx; ++i){
-            for (k=0; k<2*nz; ++k){
-                *ptr++ = sign * in[i+2*nx*(j+2*ny*k)];
-            }
-        }
-    }
-    return out;
-}
+          1) if  z(i,j,k) <= z(i,j,k+1) for all (i,j,k), *sign = 1
 
-/* ------------------------------------------------------------------ */
-static int
-get_zcorn_sign(int nx, int ny, int nz, const int *actnum,
-               const double *zcorn, int *error)
-/* ------------------------------------------------------------------ */
-{
-    /* Ensure that zcorn (i.e., depth) is strictly nondecreasing in
-       the k-direction.  This is required by the processign algorithm.
+          2) if -z(i,j,k) <=-z(i,j,k+1) for all (i,j,k), *sign = -1
 
-       1) if  z(i,j,k) <= z(i,j,k+1) for all (i,j,k), return 1.0
+          3) if (1) and (2) fails, *sign = -1, and set *error = 1.
 
-       2) if -z(i,j,k) <=-z(i,j,k+1) for all (i,j,k), return -1.0
+       b) Determine whether the coordinate system is left-handed, using
+          the vertical size of the first active cell (in natural
+          ordering) with non-zero height.
 
-       3) if (1) and (2) fails, return -1.0, and set *error = 1.
+       Returns zero if a row could not be read or on allocation
+       failure. */
+    const size_t nx = in->dims[0];
+    const size_t ny = in->dims[1];
+    const size_t nz = in->dims[2];
+    const size_t nrow = 4 * nx * nz;
 
-    */
-    int    sign;
-    int    i, j, k;
-    int    c1, c2;
-    double z1, z2;
+    int     ok = 1, increasing = 1, decreasing = 1;
+    size_t  i, j, k, m, c, first = nx * ny * nz;
+    double  z1, z2, dz, first_dz = 0.0;
+    double  dx[2], dy[2], triple;
+    const double *zb, *zt, *coord = in->coord;
+    const size_t imax = (nx + 0) * 1        * (2 * 3);
+    const size_t jmax = (nx + 1) * (ny + 0) * (2 * 3);
 
-    for (sign = 1; sign>-2; sign = sign - 2)
-    {
-        *error = 0;
+    double *zrows  = malloc(2 * nrow * sizeof *zrows);
+    int    *actnum = malloc(nx * nz * sizeof *actnum);
 
-        for (j=0; j<2*ny; ++j){
-            for (i=0; i<2*nx; ++i){
-                for (k=0; k<2*nz-1; ++k){
-                    z1 = sign*zcorn[i+2*nx*(j+2*ny*(k))];
-                    z2 = sign*zcorn[i+2*nx*(j+2*ny*(k+1))];
+    if ((zrows == NULL) || (actnum == NULL)) {
+        free(actnum);
+        free(zrows);
+        return 0;
+    }
 
-                    c1 = i/2 + nx*(j/2 + ny*(k/2));
-                    c2 = i/2 + nx*(j/2 + ny*((k+1)/2));
+    for (j = 0; ok && (j < 2*ny); ++j) {
+        double *z = zrows + (j % 2)*nrow;
 
-                    assert (c1 < (nx * ny * nz));
-                    assert (c2 < (nx * ny * nz));
+        if (!in->read_zcorn_row(in->data, (int) j, z)) {
+            fprintf(stderr, "Could not read ZCORN row %d\n", (int) j);
+            ok = 0;
+            break;
+        }
+        if ((j % 2) == 0) {
+            if (in->read_actnum_row == NULL) {
+                for (c = 0; c < nx*nz; ++c) { actnum[c] = 1; }
+            }
+            else if (!in->read_actnum_row(in->data, (int) (j/2), actnum)) {
+                fprintf(stderr, "Could not read ACTNUM row %d\n", (int) (j/2));
+                ok = 0;
+                break;
+            }
+        }
 
-                    if (((actnum == NULL) ||
-                         (actnum[c1] && actnum[c2]))
-                        && (z2 < z1)) {
+        for (i = 0; i < 2*nx; ++i) {
+            for (k = 0; k < 2*nz - 1; ++k) {
+                z1 = z[i + 2*nx*(k    )];
+                z2 = z[i + 2*nx*(k + 1)];
+                if (actnum[i/2 + nx*(k/2)] && actnum[i/2 + nx*((k+1)/2)]) {
+                    increasing = increasing && !(z2 < z1);
+                    decreasing = decreasing && !(z2 > z1);
+                }
+            }
+        }
 
-                        fprintf(stderr, "\nZCORN should be strictly "
-                                "nondecreasing along pillars!\n");
-                        *error = 1;
-                        goto end;
+        /* Both corner rows of cell row j/2 are available. */
+        if ((j % 2) == 1) {
+            zb = zrows;
+            zt = zrows + nrow;
+            for (k = 0; (k < nz) && (nx*((j/2) + ny*k) < first); ++k) {
+                for (i = 0; i < nx; ++i) {
+                    c = i + nx*((j/2) + ny*k);
+                    if (!actnum[i + nx*k]) { continue; }
+
+                    /* The four corners of the bottom of the cell */
+                    for (m = 0, dz = 0.0; (! (fabs(dz) > 0)) && (m < 4); m++) {
+                        const double *zr = (m < 2) ? zb : zt;
+                        const size_t  b  = (2*i + (m % 2)) + 2*nx*(2*k);
+                        dz = zr[b + 2*nx] - zr[b];
+                    }
+                    if (fabs(dz) > 0) {
+                        first    = c;
+                        first_dz = dz;
+                        break;
                     }
                 }
             }
         }
+    }
 
-    end:
-        if (!*error){
-            break;
-        }
+    free(actnum);
+    free(zrows);
+
+    if (!ok) {
+        return 0;
     }
 
-    if (*error){
-        fprintf(stderr, "Attempt to reverse sign in ZCORN failed.\n"
-                "Grid definition may be broken\n");
+    *error = 0;
+    *sign  = 1;
+    if (!increasing) {
+        fprintf(stderr, "\nZCORN should be strictly "
+                "nondecreasing along pillars!\n");
+        *sign = -1;
+        if (!decreasing) {
+            fprintf(stderr, "\nZCORN should be strictly "
+                    "nondecreasing along pillars!\n");
+            *error = 1;
+            fprintf(stderr, "Attempt to reverse sign in ZCORN failed.\n"
+                    "Grid definition may be broken\n");
+        }
     }
 
-    return sign;
-}
+    assert (first < nx*ny*nz); /* active && (fabs(dz) > 0) */
 
+    dx[0] = coord[imax + 0] - coord[0];
+    dy[0] = coord[imax + 1] - coord[1];
 
-static void
-ind2sub(const size_t nx,
-        const size_t ny,
-        const size_t nz,
-        size_t       c ,
-        size_t *i, size_t *j, size_t *k)
-{
-    assert (c < (nx * ny * nz));
+    dx[1] = coord[jmax + 0] - coord[0];
+    dy[1] = coord[jmax + 1] - coord[1];
 
-#if defined(NDEBUG)
-    (void) nz;
-#endif
+    /* Compute vector triple product to distinguish left-handed (<0)
+     * from right-handed (>0) coordinate systems. */
+    triple = (*sign) * first_dz * (dx[0]*dy[1] - dx[1]*dy[0]);
+
+    assert (fabs(triple) > 0.0);
+
+    *left_handed = triple < 0.0;
 
-    *i = c % nx;  c /= nx;
-    *j = c % ny;
-    *k = c / ny;
+    return 1;
 }
 
 
 /* ---------------------------------------------------------------------- */
-static double
-vert_size(const struct grdecl *in,
-          const size_t         c ,
-          const size_t         off[8])
+static int
+read_grdecl_zcorn_row(void *data, int j, double *zcorn)
 /* ---------------------------------------------------------------------- */
 {
-    size_t        i, j, k, nx, ny, start;
-    double        dz;
-    const double *zcorn;
-
-    nx = in->dims[ 0 ];
-    ny = in->dims[ 1 ];
-
-    ind2sub(nx, ny, in->dims[ 2 ], c, &i, &j, &k);
-
-    zcorn = in->zcorn;
-    start = (2 * i) + (2 * nx)*((2 * j) + (2 * ny)*(2 * k));
-
-    for (k = 0, dz = 0.0; (! (fabs(dz) > 0)) && (k < 4); k++) {
-        dz = zcorn[start + off[k + 4]] - zcorn[start + off[k]];
+    /* Corner row j of an in-memory ZCORN array. */
+    const struct grdecl *g = data;
+    const size_t nx = g->dims[0];
+    const size_t ny = g->dims[1];
+    const size_t nz = g->dims[2];
+    size_t i, k;
+
+    for (k = 0; k < 2*nz; ++k) {
+        const double *src = g->zcorn + 2*nx*(j + 2*ny*k);
+        for (i = 0; i < 2*nx; ++i) {
+            *zcorn++ = src[i];
+        }
     }
-
-    return dz;
+    return 1;
 }
 
 
 /* ---------------------------------------------------------------------- */
 static int
-is_lefthanded(const struct grdecl *in, const double sign)
+read_grdecl_actnum_row(void *data, int j, int *actnum)
 /* ---------------------------------------------------------------------- */
 {
-    int           active, searching;
-    size_t        nx, ny, nz, c;
-    size_t        origin, imax, jmax;
-    size_t        off[8];
-    double        dx[2], dy[2], dz, triple;
-    const double *pt_coord;
-
-    nx = in->dims[0];
-    ny = in->dims[1];
-    nz = in->dims[2];
-
-    off[0] = 0;
-    off[1] = off[0] + 1;
-    off[2] = off[0] + (2 * nx);
-    off[3] = off[2] + 1;
-    off[4] = off[0] + ((2 * nx) * (2 * ny));
-    off[5] = off[4] + 1;
-    off[6] = off[4] + (2 * nx);
-    off[7] = off[6] + 1;
-
-    pt_coord = in->coord;
-
-    origin = 0;
-    imax   = (nx + 0) * 1        * (2 * 3);
-    jmax   = (nx + 1) * (ny + 0) * (2 * 3);
-
-    dx[0] = pt_coord[imax + 0] - pt_coord[origin + 0];
-    dy[0] = pt_coord[imax + 1] - pt_coord[origin + 1];
-
-    dx[1] = pt_coord[jmax + 0] - pt_coord[origin + 0];
-    dy[1] = pt_coord[jmax + 1] - pt_coord[origin + 1];
-
-    c = 0;  dz = 0.0;
-    do {
-        active = (in->actnum == NULL) || (in->actnum[c] != 0);
-
-        if (active) {
-            dz = vert_size(in, c, off);
+    /* Cell row j of an in-memory ACTNUM array. */
+    const struct grdecl *g = data;
+    const size_t nx = g->dims[0];
+    const size_t ny = g->dims[1];
+    const size_t nz = g->dims[2];
+    size_t i, k;
+
+    for (k = 0; k < nz; ++k) {
+        const int *src = g->actnum + nx*(j + ny*k);
+        for (i = 0; i < nx; ++i) {
+            *actnum++ = src[i];
         }
-
-        searching = ! (active && (fabs(dz) > 0.0));
-
-        c += 1;
-    } while (searching && (c < (nx * ny * nz)));
-
-    assert (! searching);       /* active && (fabs(dz) > 0) */
-
-    /* Compute vector triple product to distinguish left-handed (<0)
-     * from right-handed (>0) coordinate systems. */
-    triple = sign * dz * (dx[0]*dy[1] - dx[1]*dy[0]);
-
-    assert (fabs(triple) > 0.0);
-
-    return triple < 0.0;
+    }
+    return 1;
 }
 
 
@@ -762,17 +1074,37 @@ void process_grdecl(const struct grdecl   *in,
                     double                tolerance,
                     struct processed_grid *out)
 {
-    struct grdecl g;
+    struct grdecl_rows rows;
+
+    rows.dims[0] = in->dims[0];
+    rows.dims[1] = in->dims[1];
+    rows.dims[2] = in->dims[2];
+    rows.coord   = in->coord;
+    rows.mapaxes = in->mapaxes;
+    rows.read_zcorn_row  = read_grdecl_zcorn_row;
+    rows.read_actnum_row = (in->actnum != NULL) ? read_grdecl_actnum_row : NULL;
+    rows.data    = (void *) in;
+
+    if (! process_grdecl_rows(&rows, tolerance, out)) {
+        fprintf(stderr, "Could not process corner-point grid in process_grdecl()\n");
+    }
+}
 
+
+/*-----------------------------------------------------------------
+  Public interface
+*/
+int process_grdecl_rows(const struct grdecl_rows *in,
+                        double                    tolerance,
+                        struct processed_grid    *out)
+{
     size_t i;
     int    sign, error, left_handed;
-    int    cellnum;
+    int    cellnum, nblocks;
 
-    int    *actnum, *iptr;
+    int    *iptr;
     int    *global_cell_index;
 
-    double *zcorn;
-
     const size_t BIGNUM = 64;
     const int    nx = in->dims[0];
     const int    ny = in->dims[1];
@@ -793,14 +1125,15 @@ void process_grdecl(const struct grdecl   *in,
           increased)
        2) set Cartesian imensions
     */
-    out->m                = (int) (BIGNUM / 3);
-    out->n                = (int) BIGNUM;
-
-    out->face_neighbors   = malloc( BIGNUM      * sizeof *out->face_neighbors);
-    out->face_nodes       = malloc( out->n      * sizeof *out->face_nodes);
-    out->face_ptr         = malloc((out->m + 1) * sizeof *out->face_ptr);
-    out->face_tag         = malloc( out->m      * sizeof *out->face_tag);
-    out->face_ptr[0]      = 0;
+    out->node_coordinates = NULL;
+    out->local_cell_index = NULL;
+    if (! init_face_storage(BIGNUM, out, &intersections)) {
+        fprintf(stderr, "Could not allocate space in process_grdecl()\n");
+        free(intersections);
+        free_processed_grid(out);
+        memset(out, 0, sizeof *out);
+        return 0;
+    }
 
     out->dimensions[0]    = in->dims[0];
     out->dimensions[1]    = in->dims[1];
@@ -823,33 +1156,26 @@ void process_grdecl(const struct grdecl   *in,
      * (in plist) for each cornerpoint cell. In other words, plist has
      * 8 node numbers for each cornerpoint cell.*/
 
-    /* initialize grdecl structure "g" that will be processd by
-     * "finduniquepoints" */
-    g.dims[0] = in->dims[0];
-    g.dims[1] = in->dims[1];
-    g.dims[2] = in->dims[2];
-
-    actnum    = malloc (nc *     sizeof *actnum);
-    g.actnum  = copy_and_permute_actnum(nx, ny, nz, in->actnum, actnum);
-
-    zcorn     = malloc (nc * 8 * sizeof *zcorn);
-    sign      = get_zcorn_sign(nx, ny, nz, in->actnum, in->zcorn, &error);
-    g.zcorn   = copy_and_permute_zcorn(nx, ny, nz, in->zcorn, sign, zcorn);
-
-    g.coord   = in->coord;
-
-
-    /* allocate space for cornerpoint numbers plus INT_MIN (INT_MAX)
-     * padding */
-    plist = malloc(8 * (nc + ((size_t)nx)*((size_t)ny)) * sizeof *plist);
-
-    finduniquepoints(&g, plist, tolerance, out);
+    /* "finduniquepoints" permutes ZCORN and ACTNUM one row of pillars
+     * at a time, so no permuted copies of the full arrays are made.
+     * A first traversal of the rows determines the sign of ZCORN and
+     * whether the coordinate system is left handed or not. */
+    plist = NULL;
+    if (scan_zcorn_rows(in, &sign, &error, &left_handed)) {
+        /* allocate space for cornerpoint numbers plus INT_MIN (INT_MAX)
+         * padding */
+        plist = malloc(8 * (nc + ((size_t)nx)*((size_t)ny)) * sizeof *plist);
+    }
 
-    free (zcorn);
-    free (actnum);
+    if ((plist == NULL) || (out->local_cell_index == NULL) ||
+        ! finduniquepoints(in, sign, plist, tolerance, out)) {
+        free(plist);
+        free(intersections);
+        free_processed_grid(out);
+        memset(out, 0, sizeof *out);
+        return 0;
+    }
 
-    /* Determine if coordinate system is left handed or not. */
-    left_handed = is_lefthanded(in, sign);
     if (left_handed) {
         /* Reflect Y coordinates about XZ plane to create right-handed
          * coordinate system whilst processing intersections. */
@@ -861,21 +1187,29 @@ void process_grdecl(const struct grdecl   *in,
     /* -----------------------------------------------------------------*/
     /* Find face topology and face-to-cell connections */
 
-    /* internal */
-    work = malloc(2 * ((size_t) (2*nz + 2)) * sizeof *work);
-    for(i = 0; i < ((size_t)4) * (nz + 1); ++i) { work[i] = -1; }
-
-    /* internal array to store intersections */
-    intersections = malloc(BIGNUM* sizeof(*intersections));
+    /* Pillar rows are independent.  Process blocks of rows
+     * concurrently if threads are available. */
+    nblocks = number_of_face_blocks(ny);
 
+    if (nblocks > 1) {
+        process_faces_blocked(0, nblocks, &intersections, plist, out);
+        process_faces_blocked(1, number_of_face_blocks(ny + 1),
+                              &intersections, plist, out);
+        process_faces_blocked(2, nblocks, &intersections, plist, out);
+    }
+    else {
+        /* internal */
+        work = malloc(2 * ((size_t) (2*nz + 2)) * sizeof *work);
+        for(i = 0; i < ((size_t)4) * (nz + 1); ++i) { work[i] = -1; }
 
+        process_vertical_faces   (0, 0, ny    , &intersections, plist, work, out);
+        process_vertical_faces   (1, 0, ny + 1, &intersections, plist, work, out);
+        process_horizontal_faces (   0, ny    , &intersections, plist,       out);
 
-    process_vertical_faces   (0, &intersections, plist, work, out);
-    process_vertical_faces   (1, &intersections, plist, work, out);
-    process_horizontal_faces (   &intersections, plist,       out);
+        free (work);
+    }
 
     free (plist);
-    free (work);
 
     /* -----------------------------------------------------------------*/
     /* (re)allocate space for and compute coordinates of nodes that
@@ -936,6 +1270,8 @@ void process_grdecl(const struct grdecl   *in,
     if (left_handed ^ (sign == -1)) {
         reverse_face_nodes(out);
     }
+
+    return 1;
 }
 
 /*-------------------------------------------------------*/
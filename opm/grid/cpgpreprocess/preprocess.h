@@ -61,6 +61,39 @@ extern "C" {
         const double *mapaxes; /**< 6 Element rotation vector - can be NULL. */
     };
 
+    /**
+     * Row-wise corner-point specification.
+     *
+     * Provides the corner-point depths and the "active" map one row of
+     * constant J at a time through callbacks, such that the full ZCORN and
+     * ACTNUM arrays need not be held in memory.  Each row is requested a
+     * small, fixed number of times and in order of increasing J within
+     * each traversal.  The pillars are small and kept in memory.
+     */
+    struct grdecl_rows {
+        int           dims[3]; /**< Cartesian box dimensions. */
+        const double *coord;   /**< Pillar end-points. */
+        const double *mapaxes; /**< 6 Element rotation vector - can be NULL. */
+
+        /**
+         * Read the corner-point depths of corner row @c j,
+         * 0 <= j < 2*dims[1].  The 2*dims[0] * 2*dims[2] values are
+         * stored in ZCORN order, i.e., with the I index running fastest,
+         * then the K index.  Return non-zero on success.
+         */
+        int (*read_zcorn_row)(void *data, int j, double *zcorn);
+
+        /**
+         * Read the "active" flags of cell row @c j, 0 <= j < dims[1].  The
+         * dims[0] * dims[2] values are stored with the I index running
+         * fastest.  May be NULL, in which case all cells are initially
+         * active.  Return non-zero on success.
+         */
+        int (*read_actnum_row)(void *data, int j, int *actnum);
+
+        void *data; /**< User data passed to the callbacks. */
+    };
+
     /**
      * Connection taxonomy.
      */
@@ -131,6 +164,25 @@ extern "C" {
                         double                 tol,
                         struct processed_grid *out);
 
+    /**
+     * Construct a prototypical grid representation from a row-wise
+     * corner-point specification.
+     *
+     * Equivalent to process_grdecl(), but never holds more than a few rows
+     * of the corner-point depths and the "active" map in memory.  The input
+     * is traversed three times.
+     *
+     * @param[in]     g   Row-wise corner-point specification.
+     * @param[in]     tol Absolute tolerance of node-coincidence.
+     * @param[in,out] out Minimal grid representation, see process_grdecl().
+     *                    Left empty on failure.
+     * @return Non-zero on success, zero if a callback failed or if the
+     *         input could not be processed.
+     */
+    int process_grdecl_rows(const struct grdecl_rows *g  ,
+                            double                    tol,
+                            struct processed_grid    *out);
+
     /**
      * Release memory resources acquired in previous grid processing using
      * function process_grdecl().
@@ -132,7 +132,8 @@ static int assignPointNumbers(int    begin,
                               double tolerance)
 {
     /* n     - number of cells */
-    /* zlist - list of len unique z-values */
+    /* zlist - unique z-values, stored with a stride of 3 (the z
+     *         coordinates of the pillar nodes) */
     /* start - number of unique z-values processed before. */
 
     int i, k;
@@ -156,12 +157,12 @@ static int assignPointNumbers(int    begin,
         }
 
         /* Find next k such that zlist[k] < z[i] < zlist[k+1] */
-        while ((k < end) && (zlist[k] + tolerance < z[i])){
+        while ((k < end) && (zlist[3*k] + tolerance < z[i])){
             k++;
         }
 
         /* assert (k < len && z[i] - zlist[k] <= tolerance) */
-        if ((k == end) || ( zlist[k] + tolerance < z[i])){
+        if ((k == end) || ( zlist[3*k] + tolerance < z[i])){
             fprintf(stderr, "Cannot associate  zcorn values with given list\n");
             fprintf(stderr, "of z-coordinates to given tolerance\n");
             return 0;
@@ -176,61 +177,95 @@ static int assignPointNumbers(int    begin,
 }
 
 
+/*-----------------------------------------------------------------
+  The ZCORN and ACTNUM values of the two rows of corners (cells)
+  adjacent to one row of pillars, permuted such that the values of
+  each vertical stack are adjacent in memory and multiplied by the
+  ZCORN sign.  Only these rows are held in memory at any time, rather
+  than permuted copies of the full input arrays. */
+struct pillar_row {
+    double *zcorn;   /* 2 rows of 2*nx stacks of 2*nz values */
+    int    *actnum;  /* 2 rows of   nx stacks of   nz values */
+    double *zinput;  /* one corner row as read, I index fastest */
+    int    *ainput;  /* one cell row as read, I index fastest */
+};
+
 /* ---------------------------------------------------------------------- */
-static void
-vector_positions(const int dims[3] ,
-                 const int i       ,
-                 const int j       ,
-                 size_t    start[4])
+static int
+load_pillar_row(const struct grdecl_rows *g, double sign, int j,
+                struct pillar_row *row)
 /* ---------------------------------------------------------------------- */
 {
-    size_t im, ip, jm, jp;
-
-    im = MAX(1,       i  ) - 1;
-    jm = MAX(1,       j  ) - 1;
-    ip = MIN(dims[0], i+1) - 1;
-    jp = MIN(dims[1], j+1) - 1;
-
-    start[ 0 ] = dims[2] * (im + dims[0]*jm);
-    start[ 1 ] = dims[2] * (im + dims[0]*jp);
-    start[ 2 ] = dims[2] * (ip + dims[0]*jm);
-    start[ 3 ] = dims[2] * (ip + dims[0]*jp);
-}
+    const int nx = g->dims[0];
+    const int ny = g->dims[1];
+    const int nz = g->dims[2];
 
+    int r, i, k, jz, jc;
+    double *zptr = row->zcorn;
+    int    *aptr = row->actnum;
 
-/*-----------------------------------------------------------------
-  Given a vector <field> with k index running faster than i running
-  faster than j, and Cartesian dimensions <dims>, find pointers to the
-  (i-1, j-1, 0), (i-1, j, 0), (i, j-1, 0) and (i, j, 0) elements of
-  field.  */
-static void igetvectors(const int dims[3], int i, int j,
-                        const int *field, const int *v[])
-{
-    size_t p, start[4];
+    for (r = 0; r < 2; ++r) {
+        /* Corner row 2j-1+r and cell row j-1+r, clamped to the grid. */
+        jz = MIN(MAX(2*j - 1 + r, 0), 2*ny - 1);
+        jc = MIN(MAX(  j - 1 + r, 0),   ny - 1);
 
-    vector_positions(dims, i, j, start);
+        if (!g->read_zcorn_row(g->data, jz, row->zinput)) {
+            fprintf(stderr, "Could not read ZCORN row %d\n", jz);
+            return 0;
+        }
+        for (i = 0; i < 2*nx; ++i) {
+            for (k = 0; k < 2*nz; ++k) {
+                *zptr++ = sign * row->zinput[i + 2*((size_t) nx)*k];
+            }
+        }
 
-    for (p = 0; p < 4; p++) {
-        v[p] = field + start[p];
+        if (g->read_actnum_row == NULL) {
+            for (i = 0; i < nx*nz; ++i) { *aptr++ = 1; }
+            continue;
+        }
+        if (!g->read_actnum_row(g->data, jc, row->ainput)) {
+            fprintf(stderr, "Could not read ACTNUM row %d\n", jc);
+            return 0;
+        }
+        for (i = 0; i < nx; ++i) {
+            for (k = 0; k < nz; ++k) {
+                *aptr++ = row->ainput[i + ((size_t) nx)*k];
+            }
+        }
     }
+
+    return 1;
 }
 
 
 /*-----------------------------------------------------------------
-  Given a vector <field> with k index running faster than i running
-  faster than j, and Cartesian dimensions <dims>, find pointers to the
-  (i-1, j-1, 0), (i-1, j, 0), (i, j-1, 0) and (i, j, 0) elements of
-  field.  */
-static void dgetvectors(const int dims[3], int i, int j,
-                        const double *field, const double *v[])
+  Find the pointers to the ZCORN and ACTNUM stacks of the four
+  corners (cells) around pillar i of a loaded pillar row, in the
+  order (i-1, j-1), (i-1, j), (i, j-1), (i, j). */
+static void
+getpillarvectors(const int dims[3], int i, const struct pillar_row *row,
+                 const double *z[], const int *a[])
 {
-    size_t p, start[4];
-
-    vector_positions(dims, i, j, start);
-
-    for (p = 0; p < 4; p++) {
-        v[p] = field + start[p];
-    }
+    const int nx = dims[0];
+    const int nz = dims[2];
+
+    const size_t zim = MAX(1, 2*i    ) - 1;
+    const size_t zip = MIN(2*nx, 2*i + 1) - 1;
+    const size_t aim = MAX(1,   i    ) - 1;
+    const size_t aip = MIN(nx,   i + 1) - 1;
+
+    const size_t zrow = 2*((size_t) nx) * 2*nz;
+    const size_t arow =   ((size_t) nx) *   nz;
+
+    z[0] = row->zcorn  +        zim * 2*nz;
+    z[1] = row->zcorn  + zrow + zim * 2*nz;
+    z[2] = row->zcorn  +        zip * 2*nz;
+    z[3] = row->zcorn  + zrow + zip * 2*nz;
+
+    a[0] = row->actnum +        aim * nz;
+    a[1] = row->actnum + arow + aim * nz;
+    a[2] = row->actnum +        aip * nz;
+    a[3] = row->actnum + arow + aip * nz;
 }
 
 
@@ -264,8 +299,17 @@ static void interpolate_pillar(const double *coord, double *pt)
 /*-----------------------------------------------------------------
   Assign point numbers p such that "zlist(p)==zcorn".  Assume that
   coordinate number is arranged in a sequence such that the natural
-  index is (k,i,j) */
-int finduniquepoints(const struct grdecl *g,
+  index is (k,i,j)
+
+  The input is traversed twice, one row of pillars at a time.  The
+  first pass counts the unique points on each pillar, such that the
+  node coordinates can be allocated with their exact size.  The
+  second pass computes the node coordinates and assigns the point
+  numbers of the corners in the two corner rows next to each pillar
+  row.  The z coordinates of the nodes double as the list of unique
+  z values. */
+int finduniquepoints(const struct grdecl_rows *g,
+                     double sign,
                      /* return values: */
                      int           *plist, /* list of point numbers on
                                             * each pillar*/
@@ -277,105 +321,138 @@ int finduniquepoints(const struct grdecl *g,
     const int nx = out->dimensions[0];
     const int ny = out->dimensions[1];
     const int nz = out->dimensions[2];
-    const int nc = g->dims[0]*g->dims[1]*g->dims[2];
 
+    const int npillars = (nx+1)*(ny+1);
 
-    /* zlist may need extra space temporarily due to simple boundary
-     * treatement  */
-    int            npillarpoints = 8*(nx+1)*(ny+1)*nz;
-    int            npillars      = (nx+1)*(ny+1);
+    int    *zptr    = malloc((npillars+1) * sizeof *zptr);
+    /* Sorted z values of the (at most) four stacks around a pillar */
+    double *zsorted = malloc(8 * ((size_t) nz) * sizeof *zsorted);
 
-    double *zlist = malloc(npillarpoints*sizeof *zlist);
-    int     *zptr = malloc((npillars+1)*sizeof *zptr);
+    struct pillar_row row;
 
+    int     i,j,k,r;
 
-
-
-    int     i,j,k;
-
-    int     d1[3];
     int     len    = 0;
-    double  *zout  = zlist;
     int     pos    = 0;
     double *pt;
     const double *z[4];
     const int *a[4];
     int *p;
-    int pix, cix;
-    int zix;
-
-    const double *coord = g->coord;
-
-    d1[0] = 2*g->dims[0];
-    d1[1] = 2*g->dims[1];
-    d1[2] = 2*g->dims[2];
+    int pix, jz;
+    long nnodes;
+    int ok = 1;
 
-    out->node_coordinates = malloc (3*8*nc*sizeof(*out->node_coordinates));
+    const double *coord;
 
-    zptr[pos++] = zout - zlist;
+    row.zcorn  = malloc(2 * 4 * ((size_t) nx) * nz * sizeof *row.zcorn);
+    row.actnum = malloc(2 *     ((size_t) nx) * nz * sizeof *row.actnum);
+    row.zinput = malloc(    4 * ((size_t) nx) * nz * sizeof *row.zinput);
+    row.ainput = malloc(        ((size_t) nx) * nz * sizeof *row.ainput);
 
-    pt    = out->node_coordinates;
+    out->node_coordinates = NULL;
 
-    /* Loop over pillars, find unique points on each pillar */
-    for (j=0; j < g->dims[1]+1; ++j){
-        for (i=0; i < g->dims[0]+1; ++i){
-
-            /* Get positioned pointers for actnum and zcorn data */
-            igetvectors(g->dims,   i,   j, g->actnum, a);
-            dgetvectors(d1,      2*i, 2*j, g->zcorn,  z);
-
-            len = createSortedList(     zout, d1[2], 4, z, a);
-            len = uniquify        (len, zout, tolerance);
+    if ((zptr == NULL) || (zsorted == NULL) ||
+        (row.zcorn == NULL) || (row.actnum == NULL) ||
+        (row.zinput == NULL) || (row.ainput == NULL)) {
+        fprintf(stderr, "Could not allocate work space in finduniquepoints\n");
+        ok = 0;
+    }
 
-            /* Assign unique points */
-            for (k=0; k<len; ++k){
-                pt[2] = zout[k];
-                interpolate_pillar(coord, pt);
-                pt += 3;
+    /* First pass: count the unique points on each pillar. */
+    if (ok) {
+        nnodes = 0;
+        zptr[pos++] = 0;
+        for (j=0; j < ny+1; ++j){
+            if (!load_pillar_row(g, sign, j, &row)) { ok = 0; break; }
+            for (i=0; i < nx+1; ++i){
+                getpillarvectors(g->dims, i, &row, z, a);
+
+                len = createSortedList(     zsorted, 2*nz, 4, z, a);
+                len = uniquify        (len, zsorted, tolerance);
+
+                nnodes += len;
+                if (nnodes > INT_MAX / 3) {
+                    fprintf(stderr, "Too many nodes in finduniquepoints\n");
+                    ok = 0;
+                    break;
+                }
+                zptr[pos++] = (int) nnodes;
             }
+            if (!ok) { break; }
+        }
+    }
 
-            /* Increment pointer to sparse table of unique zcorn
-             * values */
-            zout        = zout + len;
-            zptr[pos++] = zout - zlist;
-
-            coord += 6;
+    if (ok) {
+        out->number_of_nodes_on_pillars = zptr[pos-1];
+        out->number_of_nodes            = zptr[pos-1];
+        out->node_coordinates = malloc(3 * ((size_t) zptr[pos-1]) *
+                                       sizeof *out->node_coordinates);
+        if ((out->node_coordinates == NULL) && (zptr[pos-1] > 0)) {
+            fprintf(stderr, "Could not allocate node coordinates\n");
+            ok = 0;
         }
     }
-    out->number_of_nodes_on_pillars = zptr[pos-1];
-    out->number_of_nodes            = zptr[pos-1];
-
-    /* Loop over all vertical sets of zcorn values, assign point
-     * numbers */
-    p = plist;
-    for (j=0; j < 2*g->dims[1]; ++j){
-        for (i=0; i < 2*g->dims[0]; ++i){
-
-            /* pillar index */
-            pix = (i+1)/2 + (g->dims[0]+1)*((j+1)/2);
-
-            /* cell column position */
-            cix = g->dims[2]*((i/2) + (j/2)*g->dims[0]);
-
-            /* zcorn column position */
-            zix = 2*g->dims[2]*(i+2*g->dims[0]*j);
-
-            if (!assignPointNumbers(zptr[pix], zptr[pix+1], zlist,
-                                    2*g->dims[2],
-                                    g->zcorn  + zix, g->actnum + cix,
-                                    p, tolerance)){
-                fprintf(stderr, "Something went wrong in assignPointNumbers");
-                return 0;
+
+    /* Second pass: compute the nodes on each pillar and assign point
+     * numbers to the corners of the two adjacent corner rows. */
+    if (ok) {
+        pt    = out->node_coordinates;
+        coord = g->coord;
+        p     = plist;
+        for (j=0; ok && (j < ny+1); ++j){
+            if (!load_pillar_row(g, sign, j, &row)) { ok = 0; break; }
+            for (i=0; i < nx+1; ++i){
+                getpillarvectors(g->dims, i, &row, z, a);
+
+                len = createSortedList(     zsorted, 2*nz, 4, z, a);
+                len = uniquify        (len, zsorted, tolerance);
+                assert (len == zptr[j*(nx+1) + i + 1] - zptr[j*(nx+1) + i]);
+
+                /* Assign unique points */
+                for (k=0; k<len; ++k){
+                    pt[2] = zsorted[k];
+                    interpolate_pillar(coord, pt);
+                    pt += 3;
+                }
+
+                coord += 6;
             }
 
-            p += 2 + 2*g->dims[2];
+            /* Corner rows 2j-1 and 2j both attach to pillar row j. */
+            for (r = 0; ok && (r < 2); ++r) {
+                jz = 2*j - 1 + r;
+                if ((jz < 0) || (jz >= 2*ny)) { continue; }
+
+                for (i=0; i < 2*nx; ++i){
+
+                    /* pillar index */
+                    pix = (i+1)/2 + (nx+1)*j;
+
+                    if (!assignPointNumbers(zptr[pix], zptr[pix+1],
+                                            out->node_coordinates + 2,
+                                            2*nz,
+                                            row.zcorn  + (r*2*((size_t) nx) + i)*2*nz,
+                                            row.actnum + (r*((size_t) nx) + i/2)*nz,
+                                            p, tolerance)){
+                        fprintf(stderr, "Something went wrong in assignPointNumbers");
+                        ok = 0;
+                        break;
+                    }
+
+                    p += 2 + 2*nz;
+                }
+            }
         }
     }
 
+    free(row.ainput);
+    free(row.zinput);
+    free(row.actnum);
+    free(row.zcorn);
+    free(zsorted);
     free(zptr);
-    free(zlist);
 
-    return 1;
+    return ok;
 }
 
 /* Local Variables:    */
@@ -35,7 +35,8 @@
 #ifndef OPM_UNIQUEPOINTS_HEADER
 #define OPM_UNIQUEPOINTS_HEADER
 
-int finduniquepoints(const struct grdecl *g,  /* input */
+int finduniquepoints(const struct grdecl_rows *g, /* row-wise input */
+                     double            sign,  /* ZCORN sign, see process_grdecl */
                      int                 *p,  /* for each z0 in zcorn, z0 = z[p0] */
                      double               t,  /* tolerance*/
                      struct processed_grid *out);
@@ -0,0 +1,130 @@
+/*
+  This file is part of The Open Porous Media project  (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef OPM_CPGRID_CELLCONNECTIONS_HEADER
+#define OPM_CPGRID_CELLCONNECTIONS_HEADER
+
+#include <boost/range/iterator_range.hpp>
+
+#include <cassert>
+#include <vector>
+
+namespace Dune
+{
+namespace cpgrid
+{
+
+/// \brief Cell-centric list of the connections between the cells of a grid.
+///
+/// The connections of all cells are stored in compressed row format:
+/// the connections of cell c are the entries rowBegin(c) to rowEnd(c) - 1
+/// of the neighbour, face and sign arrays. Every face with two cells on
+/// this process (including NNC faces and faces between interior and
+/// overlap cells) appears once in the row of each of its cells.
+/// Faces on the boundary of the (local) grid are not included.
+///
+/// The rows are ordered as the cell's faces in CpGrid::cellFaceRow(), and
+/// can be used directly as the sparsity pattern of a cell-centred matrix.
+class CellConnections
+{
+public:
+    typedef boost::iterator_range<const int*> row_type;
+    typedef boost::iterator_range<const signed char*> sign_row_type;
+
+    /// \brief The number of cells.
+    int size() const
+    {
+        return row_start_.empty() ? 0 : row_start_.size() - 1;
+    }
+
+    /// \brief The total number of connections, i.e. twice the number of
+    ///        faces between two cells.
+    int numConnections() const
+    {
+        return neighbour_.size();
+    }
+
+    /// \brief Index of the first connection of a cell.
+    int rowBegin(int cell) const
+    {
+        assert(cell >= 0 && cell < size());
+        return row_start_[cell];
+    }
+
+    /// \brief One past the index of the last connection of a cell.
+    int rowEnd(int cell) const
+    {
+        assert(cell >= 0 && cell < size());
+        return row_start_[cell + 1];
+    }
+
+    /// \brief The cells connected to a cell.
+    row_type neighbours(int cell) const
+    {
+        return row_type(neighbour_.data() + rowBegin(cell), neighbour_.data() + rowEnd(cell));
+    }
+
+    /// \brief The faces through which a cell is connected to its neighbours.
+    row_type faces(int cell) const
+    {
+        return row_type(face_.data() + rowBegin(cell), face_.data() + rowEnd(cell));
+    }
+
+    /// \brief The orientation of the faces of a cell: +1 if the face
+    ///        normal points out of the cell, i.e. the cell is
+    ///        faceCell(face, 0), and -1 otherwise.
+    sign_row_type signs(int cell) const
+    {
+        return sign_row_type(sign_.data() + rowBegin(cell), sign_.data() + rowEnd(cell));
+    }
+
+    /// \brief The row starts, of size size() + 1.
+    const std::vector<int>& rowStart() const
+    {
+        return row_start_;
+    }
+
+    /// \brief The neighbour cell of every connection.
+    const std::vector<int>& neighbour() const
+    {
+        return neighbour_;
+    }
+
+    /// \brief The face of every connection.
+    const std::vector<int>& face() const
+    {
+        return face_;
+    }
+
+    /// \brief The orientation sign of every connection.
+    const std::vector<signed char>& sign() const
+    {
+        return sign_;
+    }
+
+private:
+    friend class CpGridData;
+
+    std::vector<int> row_start_;
+    std::vector<int> neighbour_;
+    std::vector<int> face_;
+    std::vector<signed char> sign_;
+};
+
+} // end namespace cpgrid
+} // end namespace Dune
+
+#endif
@@ -49,8 +49,10 @@
 #include <opm/grid/common/GridPartitioning.hpp>
 #include <opm/grid/common/WellConnections.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <numeric>
 
 namespace Dune
 {
@@ -59,7 +61,9 @@ namespace Dune
         : data_( new cpgrid::CpGridData(*this)),
           current_view_data_(data_.get()),
           distributed_data_(),
-          cell_scatter_gather_interfaces_(new InterfaceMap)
+          cell_scatter_gather_interfaces_(new InterfaceMap),
+          parallel_partitioning_(false),
+          geometric_partitioning_(false)
     {}
 
 
@@ -68,11 +72,14 @@ namespace Dune
 
 std::pair<bool, std::unordered_set<std::string> >
 CpGrid::scatterGrid(EdgeWeightMethod method, const std::vector<cpgrid::OpmWellType> * wells,
-                    const double* transmissibilities, int overlapLayers)
+                    const double* transmissibilities,
+                    const std::vector<std::vector<double> >& cellWeights,
+                    int overlapLayers)
 {
     // Silence any unused argument warnings that could occur with various configurations.
     static_cast<void>(wells);
     static_cast<void>(transmissibilities);
+    static_cast<void>(cellWeights);
     static_cast<void>(overlapLayers);
     static_cast<void>(method);
 #if HAVE_MPI
@@ -86,46 +93,149 @@ CpGrid::scatterGrid(EdgeWeightMethod method, const std::vector<cpgrid::OpmWellTy
     CollectiveCommunication cc(MPI_COMM_WORLD);
 
     int my_num=cc.rank();
-#ifdef HAVE_ZOLTAN
-    auto part_and_wells =
-        cpgrid::zoltanGraphPartitionGridOnRoot(*this, wells, transmissibilities, cc, method, 0);
-    int num_parts = cc.size();
-    using std::get;
-    auto cell_part = std::get<0>(part_and_wells);
-    auto defunct_wells = std::get<1>(part_and_wells);
-#else
+
+    // The global grid may only have been set up on the root process. Then it
+    // is partitioned there and each process only receives its own part.
+    const int root = 0;
+    const bool grid_on_root_only = cc.min(numCells()) != cc.max(numCells());
+    if ( grid_on_root_only && cc.max(my_num == root ? 0 : numCells()) > 0 )
+    {
+        OPM_THROW(std::logic_error, "If the global grid is not present on all processes,"
+                  << " it may only be present on process " << root << ".");
+    }
+    // The weights are checked on the processes holding the global grid, but
+    // all processes throw together, as the others would otherwise block in
+    // the next collective operation.
+    const int num_weights = cc.max(static_cast<int>(cellWeights.size()));
+    int weights_ok = 1;
+    if ( numCells() > 0 )
+    {
+        if ( static_cast<int>(cellWeights.size()) != num_weights )
+        {
+            weights_ok = 0;
+        }
+        for ( const auto& weights : cellWeights )
+        {
+            if ( static_cast<int>(weights.size()) != numCells() )
+            {
+                weights_ok = 0;
+            }
+        }
+    }
+    if ( !cc.min(weights_ok) )
+    {
+        OPM_THROW(std::logic_error, "All processes holding the global grid have to provide"
+                  << " the same number of cell weight vectors, each with one weight per cell.");
+    }
     std::vector<int> cell_part(current_view_data_->global_cell_.size());
     int  num_parts=-1;
-    std::array<int, 3> initial_split;
-    initial_split[1]=initial_split[2]=std::pow(cc.size(), 1.0/3.0);
-    initial_split[0]=cc.size()/(initial_split[1]*initial_split[2]);
-    partition(*this, initial_split, num_parts, cell_part, false, false);
-    const auto& cpgdim =  logicalCartesianSize();
-    std::vector<int> cartesian_to_compressed(cpgdim[0]*cpgdim[1]*cpgdim[2], -1);
-    for( int i=0; i < numCells(); ++i )
+    std::unordered_set<std::string> defunct_wells;
+#ifdef HAVE_ZOLTAN
+    const bool partition_in_parallel = parallel_partitioning_ && !geometric_partitioning_;
+    // The slab of process r consists of the cells [slab_begin[r], slab_begin[r+1]).
+    std::vector<int> slab_begin;
+    if ( partition_in_parallel )
     {
-        cartesian_to_compressed[globalCell()[i]] = i;
+        // repartition() only builds one layer of overlap cells and the graph
+        // is partitioned with uniform edge weights. All processes need to agree,
+        // as only some of them might have been passed other arguments.
+        if ( cc.max(overlapLayers) != 1 || cc.min(overlapLayers) != 1 )
+        {
+            OPM_THROW(std::logic_error, "Partitioning in parallel only supports one layer of"
+                      << " overlap cells, but " << overlapLayers << " were requested.");
+        }
+        if ( cc.max(static_cast<int>(transmissibilities != nullptr)) && my_num == root )
+        {
+            std::cerr << "Warning: Partitioning in parallel uses uniform edge weights,"
+                      << " the transmissibilities are ignored." << std::endl;
+        }
+        // Distribute the grid in slabs of the logical cartesian grid first,
+        // which needs no graph partitioning at all. The graph is then
+        // partitioned in parallel from the distributed grid below, which
+        // needs the face neighbours of the interior cells.
+        num_parts = cc.size();
+        const long long no_global_cells = cc.max(numCells());
+        slab_begin.resize(num_parts + 1);
+        for ( int r = 0; r <= num_parts; ++r )
+        {
+            slab_begin[r] = static_cast<int>(no_global_cells * r / num_parts);
+        }
+        for ( int r = 0; r < num_parts; ++r )
+        {
+            for ( int i = slab_begin[r]; i < std::min(slab_begin[r + 1], numCells()); ++i )
+            {
+                cell_part[i] = r;
+            }
+        }
     }
-
-    std::unordered_set<std::string> defunct_wells;
-
-    if ( wells )
+    else if ( !geometric_partitioning_ )
     {
-        cpgrid::WellConnections well_connections(*wells,
-                                                 cpgdim,
-                                                 cartesian_to_compressed);
-
-        auto wells_on_proc =
-            cpgrid::postProcessPartitioningForWells(cell_part,
-                                                    *wells,
-                                                    well_connections,
-                                                    cc.size());
-        defunct_wells = cpgrid::computeDefunctWellNames(wells_on_proc,
-                                                        *wells,
-                                                        cc,
-                                                        0);
+        auto part_and_wells =
+            cpgrid::zoltanGraphPartitionGridOnRoot(*this, wells, transmissibilities, cc, method, root, cellWeights);
+        num_parts = cc.size();
+        cell_part = std::get<0>(part_and_wells);
+        defunct_wells = std::get<1>(part_and_wells);
     }
+    else
 #endif
+    {
+        std::vector<std::vector<int> > wells_on_proc;
+
+        if ( !grid_on_root_only || my_num == root )
+        {
+            if ( geometric_partitioning_ )
+            {
+                num_parts = cc.size();
+                partitionGeometric(*this, num_parts, cell_part, cellWeights);
+            }
+            else
+            {
+                std::array<int, 3> initial_split;
+                initial_split[1]=initial_split[2]=std::pow(cc.size(), 1.0/3.0);
+                initial_split[0]=cc.size()/(initial_split[1]*initial_split[2]);
+                if ( cellWeights.empty() )
+                {
+                    partition(*this, initial_split, num_parts, cell_part, false, false);
+                }
+                else
+                {
+                    partition(*this, initial_split, num_parts, cell_part, cellWeights, false, false);
+                }
+            }
+            const auto& cpgdim =  logicalCartesianSize();
+            std::vector<int> cartesian_to_compressed(cpgdim[0]*cpgdim[1]*cpgdim[2], -1);
+            for( int i=0; i < numCells(); ++i )
+            {
+                cartesian_to_compressed[globalCell()[i]] = i;
+            }
+
+            if ( wells )
+            {
+                cpgrid::WellConnections well_connections(*wells,
+                                                         cpgdim,
+                                                         cartesian_to_compressed);
+
+                wells_on_proc =
+                    cpgrid::postProcessPartitioningForWells(cell_part,
+                                                            *wells,
+                                                            well_connections,
+                                                            cc.size());
+            }
+        }
+
+        if ( grid_on_root_only )
+        {
+            cc.broadcast(&num_parts, 1, root);
+        }
+
+        if ( wells )
+        {
+            defunct_wells = cpgrid::computeDefunctWellNames(wells_on_proc,
+                                                            *wells,
+                                                            cc,
+                                                            root);
+        }
+    }
 
     MPI_Comm new_comm = MPI_COMM_NULL;
 
@@ -148,8 +258,16 @@ CpGrid::scatterGrid(EdgeWeightMethod method, const std::vector<cpgrid::OpmWellTy
     if(my_num<cc.size())
     {
         distributed_data_.reset(new cpgrid::CpGridData(new_comm));
-        distributed_data_->distributeGlobalGrid(*this,*this->current_view_data_, cell_part,
-                                                overlapLayers);
+        if ( grid_on_root_only )
+        {
+            distributed_data_->distributeGlobalGridFromRoot(*this, *this->current_view_data_,
+                                                            cell_part, overlapLayers, root);
+        }
+        else
+        {
+            distributed_data_->distributeGlobalGrid(*this,*this->current_view_data_, cell_part,
+                                                    overlapLayers);
+        }
         int num_cells = distributed_data_->cell_to_face_.size();
         std::ostringstream message;
         message << "After loadbalancing process " << my_num << " has " << num_cells << " cells.";
@@ -165,7 +283,7 @@ CpGrid::scatterGrid(EdgeWeightMethod method, const std::vector<cpgrid::OpmWellTy
 
         auto rank = distributed_data_->ccobj_.rank();
 
-        if ( rank == 0)
+        if ( rank == root)
         {
             std::map<int, std::size_t> proc_to_no_cells;
             for(auto cell_owner = cell_part.begin(); cell_owner != cell_part.end();
@@ -205,6 +323,42 @@ CpGrid::scatterGrid(EdgeWeightMethod method, const std::vector<cpgrid::OpmWellTy
         }
     }
     current_view_data_ = distributed_data_.get();
+
+#ifdef HAVE_ZOLTAN
+    if ( partition_in_parallel )
+    {
+        // Send each process the weights of the cells of its slab.
+        const int weight_dim = cc.max(static_cast<int>(cellWeights.size()));
+        std::vector<int> slab_size(cc.size());
+        for ( int r = 0; r < cc.size(); ++r )
+        {
+            slab_size[r] = slab_begin[r + 1] - slab_begin[r];
+        }
+        std::vector<std::vector<double> > local_weights(weight_dim);
+        for ( int w = 0; w < weight_dim; ++w )
+        {
+            std::vector<double> slab_weights(slab_size[my_num]);
+            MPI_Scatterv(my_num == root ? const_cast<double*>(cellWeights[w].data()) : nullptr,
+                         slab_size.data(), slab_begin.data(), MPI_DOUBLE,
+                         slab_weights.data(), slab_size[my_num], MPI_DOUBLE, root, cc);
+            local_weights[w].resize(numCells(), 0.0);
+            for ( const auto& index : distributed_data_->cell_indexset_ )
+            {
+                typedef typename cpgrid::CpGridData::AttributeSet AttributeSet;
+                if ( index.local().attribute() == AttributeSet::owner )
+                {
+                    local_weights[w][index.local()] = slab_weights[index.global() - slab_begin[my_num]];
+                }
+            }
+        }
+
+        auto part_and_wells = cpgrid::zoltanGraphPartitionGridInParallel(*this, wells, local_weights,
+                                                                         cc, root);
+        defunct_wells = std::get<1>(part_and_wells);
+        repartition(std::get<0>(part_and_wells));
+    }
+#endif
+
     return std::make_pair(true, defunct_wells);
 
 #else // #if HAVE_MPI
@@ -215,6 +369,174 @@ CpGrid::scatterGrid(EdgeWeightMethod method, const std::vector<cpgrid::OpmWellTy
 #endif
 }
 
+std::vector<int> CpGrid::renumber(CellOrdering ordering, std::vector<int>* facePermutation)
+{
+    if(distributed_data_)
+        OPM_THROW(std::logic_error, "Only grids that are not distributed can be renumbered.");
+    const std::vector<int> cell_order = ordering == hilbertCurveOrdering ?
+        data_->hilbertOrder() : data_->reverseCuthillMcKeeOrder();
+    std::vector<int> face_order = data_->renumber(cell_order);
+    if(facePermutation)
+        facePermutation->swap(face_order);
+    return cell_order;
+}
+
+std::vector<int>
+CpGrid::computeRepartitioning(const std::vector<std::vector<double> >& cellWeights) const
+{
+    static_cast<void>(cellWeights);
+#if HAVE_MPI
+    if(!distributed_data_ || current_view_data_ != distributed_data_.get())
+        OPM_THROW(std::runtime_error, "Computing a repartitioning requires the distributed view"
+                  << " of a load balanced grid.");
+    const cpgrid::CpGridData& data = *distributed_data_;
+    // All processes throw together if the weights do not fit on any of them.
+    const int num_weights = data.ccobj_.max(static_cast<int>(cellWeights.size()));
+    int weights_ok = static_cast<int>(cellWeights.size()) == num_weights;
+    for ( const auto& weights : cellWeights )
+    {
+        if ( static_cast<int>(weights.size()) != data.cell_to_face_.size() )
+        {
+            weights_ok = 0;
+        }
+    }
+    if ( !data.ccobj_.min(weights_ok) )
+    {
+        OPM_THROW(std::logic_error, "All processes have to provide the same number of cell"
+                  << " weight vectors, each with one weight per cell of the distributed grid.");
+    }
+#ifdef HAVE_ZOLTAN
+    return cpgrid::zoltanRepartitionDistributedGrid(*this, cellWeights, data.ccobj_);
+#else
+    return std::vector<int>(data.cell_to_face_.size(), data.ccobj_.rank());
+#endif
+#else
+    return std::vector<int>(numCells(), 0);
+#endif
+}
+
+bool CpGrid::repartition(const std::vector<int>& cellPart)
+{
+#if HAVE_MPI
+    InterfaceMap migration;
+    std::vector<std::pair<int,int> > local_moves;
+    auto old_data = repartitionGrid(cellPart, migration, local_moves);
+    for(auto& interface: migration)
+    {
+        interface.second.first.free();
+        interface.second.second.free();
+    }
+    return static_cast<bool>(old_data);
+#else
+    static_cast<void>(cellPart);
+    std::cerr << "CpGrid::repartition() is non-trivial only with MPI support.\n";
+    return false;
+#endif
+}
+
+#if HAVE_MPI
+std::shared_ptr<cpgrid::CpGridData>
+CpGrid::repartitionGrid(const std::vector<int>& cellPart, InterfaceMap& migration,
+                        std::vector<std::pair<int,int> >& localMoves)
+{
+    if(!distributed_data_)
+        OPM_THROW(std::runtime_error, "Repartitioning is only possible for a load balanced grid.");
+    const CollectiveCommunication& cc = distributed_data_->ccobj_;
+    const int num_cells = distributed_data_->cell_to_face_.size();
+
+    // Only the owners decide about the new owner of a cell.
+    int size_mismatch = static_cast<int>(cellPart.size()) != num_cells;
+    if ( cc.max(size_mismatch) )
+    {
+        OPM_THROW(std::logic_error, "The new partitioning has to have an entry for each"
+                  << " cell of the distributed grid.");
+    }
+    std::vector<int> cell_part(cellPart);
+    distributed_data_->haloExchangePlan<int>(InteriorBorder_All_Interface, 0, 1,
+                                             ForwardCommunication)->exchange(cell_part);
+
+    std::vector<int> cells_per_rank(cc.size(), 0);
+    int invalid_rank = 0;
+    for( const auto& index: distributed_data_->cell_indexset_ )
+    {
+        typedef typename cpgrid::CpGridData::AttributeSet AttributeSet;
+        if ( index.local().attribute() != AttributeSet::owner )
+            continue;
+        const int rank = cell_part[index.local()];
+        if ( rank < 0 || rank >= cc.size() )
+            invalid_rank = 1;
+        else
+            ++cells_per_rank[rank];
+    }
+    if ( cc.max(invalid_rank) )
+    {
+        OPM_THROW(std::logic_error, "The new partitioning contains invalid ranks.");
+    }
+    cc.sum(cells_per_rank.data(), cells_per_rank.size());
+    if ( *std::min_element(cells_per_rank.begin(), cells_per_rank.end()) == 0 )
+    {
+        OPM_THROW(std::logic_error, "Each process has to keep at least one cell"
+                  << " when repartitioning.");
+    }
+
+    std::shared_ptr<cpgrid::CpGridData> old_data = distributed_data_;
+    std::shared_ptr<cpgrid::CpGridData> new_data(new cpgrid::CpGridData(cc));
+    new_data->repartitionDistributedGrid(*old_data, cell_part, migration, localMoves);
+    const bool view_was_distributed = current_view_data_ == old_data.get();
+    distributed_data_ = new_data;
+    if ( view_was_distributed )
+        current_view_data_ = distributed_data_.get();
+
+    // Update the interface for gathering/scattering data. The owned cells
+    // of each process in index set order are collected on the root.
+    const int root = 0;
+    std::vector<int> owned_cells;
+    for( const auto& index: distributed_data_->cell_indexset_ )
+    {
+        typedef typename cpgrid::CpGridData::AttributeSet AttributeSet;
+        if ( index.local().attribute() == AttributeSet::owner )
+            owned_cells.push_back(index.global());
+    }
+    int no_owned = owned_cells.size();
+    std::vector<int> no_owned_per_rank(cc.rank() == root ? cc.size() : 0);
+    cc.gather(&no_owned, no_owned_per_rank.data(), 1, root);
+    std::vector<int> displ;
+    std::vector<int> all_owned_cells;
+    if ( cc.rank() == root )
+    {
+        displ.resize(cc.size() + 1, 0);
+        std::partial_sum(no_owned_per_rank.begin(), no_owned_per_rank.end(), displ.begin() + 1);
+        all_owned_cells.resize(displ.back());
+    }
+    cc.gatherv(owned_cells.data(), no_owned, all_owned_cells.data(),
+               no_owned_per_rank.data(), displ.data(), root);
+
+    cell_scatter_gather_interfaces_.reset(new InterfaceMap);
+    if ( cc.rank() == root )
+    {
+        for ( int rank = 0; rank < cc.size(); ++rank )
+        {
+            auto& indices = (*cell_scatter_gather_interfaces_)[rank].first;
+            indices.reserve(no_owned_per_rank[rank]);
+            for ( int i = displ[rank]; i < displ[rank + 1]; ++i )
+                indices.add(all_owned_cells[i]);
+        }
+    }
+    (*cell_scatter_gather_interfaces_)[0].second.reserve(no_owned);
+    for( const auto& index: distributed_data_->cell_indexset_ )
+    {
+        typedef typename cpgrid::CpGridData::AttributeSet AttributeSet;
+        if ( index.local().attribute() == AttributeSet::owner )
+            (*cell_scatter_gather_interfaces_)[0].second.add(index.local());
+    }
+
+    int num_new_cells = distributed_data_->cell_to_face_.size();
+    std::cout << "After repartitioning process " << cc.rank() << " has "
+              << num_new_cells << " cells.\n";
+    return old_data;
+}
+#endif // #if HAVE_MPI
+
 
     void CpGrid::createCartesian(const std::array<int, 3>& dims,
                                  const std::array<double, 3>& cellsize)
@@ -267,6 +589,25 @@ CpGrid::scatterGrid(EdgeWeightMethod method, const std::vector<cpgrid::OpmWellTy
         current_view_data_->writeSintefLegacyFormat(grid_prefix);
     }
 
+    void CpGrid::writeBinaryCache(const std::string& filename, std::uint64_t input_hash) const
+    {
+        current_view_data_->writeBinaryCache(filename, input_hash);
+    }
+    bool CpGrid::readBinaryCache(const std::string& filename, std::uint64_t input_hash)
+    {
+        return current_view_data_->readBinaryCache(filename, input_hash);
+    }
+    std::uint64_t CpGrid::inputHash(const grdecl& input_data, double z_tolerance,
+                                    bool remove_ij_boundary, bool turn_normals)
+    {
+        return cpgrid::CpGridData::inputHash(input_data, {}, z_tolerance,
+                                             remove_ij_boundary, turn_normals);
+    }
+    void CpGrid::setBinaryCacheFile(const std::string& filename)
+    {
+        current_view_data_->setBinaryCacheFile(filename);
+    }
+
 
 #if HAVE_ECL_INPUT
     void CpGrid::processEclipseFormat(const Opm::EclipseGrid& ecl_grid,
@@ -287,4 +628,10 @@ CpGrid::scatterGrid(EdgeWeightMethod method, const std::vector<cpgrid::OpmWellTy
         current_view_data_->processEclipseFormat(input_data, {}, z_tolerance, remove_ij_boundary, turn_normals);
     }
 
+    void CpGrid::processEclipseFormat(const grdecl_rows& input_data, double z_tolerance,
+                                      bool remove_ij_boundary, bool turn_normals)
+    {
+        current_view_data_->processEclipseFormat(input_data, z_tolerance, remove_ij_boundary, turn_normals);
+    }
+
 } // namespace Dune
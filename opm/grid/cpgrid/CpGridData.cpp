@@ -1,6 +1,10 @@
 #include"config.h"
 #include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
 #include <map>
+#include <numeric>
 #include <vector>
 #include"CpGridData.hpp"
 #include"Intersection.hpp"
@@ -13,6 +17,7 @@
 #include <opm/grid/utility/platform_dependent/disable_warnings.h>
 
 #include <opm/grid/common/GridPartitioning.hpp>
+#include <opm/grid/common/p2pcommunicator.hh>
 #include <dune/common/parallel/remoteindices.hh>
 #include <dune/common/enumset.hh>
 #include <opm/grid/utility/SparseTable.hpp>
@@ -27,7 +32,8 @@ namespace cpgrid
 
 CpGridData::CpGridData(const CpGridData& g)
     : index_set_(new IndexSet(*this)), local_id_set_(new IdSet(*this)),
-      global_id_set_(new GlobalIdSet(local_id_set_)), partition_type_indicator_(new PartitionTypeIndicator(*this)), ccobj_(g.ccobj_)
+      global_id_set_(new GlobalIdSet(local_id_set_)), partition_type_indicator_(new PartitionTypeIndicator(*this)), ccobj_(g.ccobj_),
+      communication_pending_(false)
 {
 #if HAVE_MPI
     ccobj_=CollectiveCommunication(MPI_COMM_SELF);
@@ -38,7 +44,8 @@ CpGridData::CpGridData(const CpGridData& g)
 CpGridData::CpGridData()
     : index_set_(new IndexSet(*this)), local_id_set_(new IdSet(*this)),
       global_id_set_(new GlobalIdSet(local_id_set_)), partition_type_indicator_(new PartitionTypeIndicator(*this)),
-      ccobj_(Dune::MPIHelper::getCommunicator()), use_unique_boundary_ids_(false)
+      ccobj_(Dune::MPIHelper::getCommunicator()), use_unique_boundary_ids_(false),
+      communication_pending_(false)
 {
 #if HAVE_MPI
     ccobj_=CollectiveCommunication(MPI_COMM_SELF);
@@ -50,7 +57,8 @@ CpGridData::CpGridData()
 CpGridData::CpGridData(MPI_Comm comm)
     : index_set_(new IndexSet(*this)), local_id_set_(new IdSet(*this)),
       global_id_set_(new GlobalIdSet(local_id_set_)), partition_type_indicator_(new PartitionTypeIndicator(*this)),
-      ccobj_(comm), use_unique_boundary_ids_(false)
+      ccobj_(comm), use_unique_boundary_ids_(false),
+      communication_pending_(false)
 {
     cell_interfaces_=std::make_tuple(Interface(ccobj_),Interface(ccobj_),Interface(ccobj_),Interface(ccobj_),Interface(ccobj_));
 }
@@ -59,7 +67,8 @@ CpGridData::CpGridData(MPI_Comm comm)
 CpGridData::CpGridData(CpGrid&)
   : index_set_(new IndexSet(*this)),   local_id_set_(new IdSet(*this)),
     global_id_set_(new GlobalIdSet(local_id_set_)),  partition_type_indicator_(new PartitionTypeIndicator(*this)),
-    ccobj_(Dune::MPIHelper::getCommunicator()), use_unique_boundary_ids_(false)
+    ccobj_(Dune::MPIHelper::getCommunicator()), use_unique_boundary_ids_(false),
+    communication_pending_(false)
 {
 #if HAVE_MPI
     ccobj_=CollectiveCommunication(MPI_COMM_SELF);
@@ -129,6 +138,407 @@ void CpGridData::computeUniqueBoundaryIds()
 #endif
 }
 
+const CellConnections& CpGridData::cellConnections() const
+{
+    if (cell_connections_) {
+        return *cell_connections_;
+    }
+    std::unique_ptr<CellConnections> conn(new CellConnections);
+    const int num_cells = cell_to_face_.size();
+    const int invalid = std::numeric_limits<int>::max();
+
+    // The other cell attached to a face, or -1 for boundary faces.
+    auto otherCell = [this, invalid](int face, int cell)
+    {
+        for (const auto& c : face_to_cell_[EntityRep<1>(face, true)]) {
+            if (c.index() != cell && c.index() != invalid) {
+                return c.index();
+            }
+        }
+        return -1;
+    };
+
+    // First pass: count the connections of each cell.
+    conn->row_start_.resize(num_cells + 1);
+    conn->row_start_[0] = 0;
+#pragma omp parallel for schedule(static)
+    for (int cell = 0; cell < num_cells; ++cell) {
+        int count = 0;
+        for (const auto& f : cell_to_face_[EntityRep<0>(cell, true)]) {
+            count += otherCell(f.index(), cell) >= 0;
+        }
+        conn->row_start_[cell + 1] = count;
+    }
+    std::partial_sum(conn->row_start_.begin(), conn->row_start_.end(),
+                     conn->row_start_.begin());
+
+    // Second pass: fill in the connections.
+    const int num_conn = conn->row_start_.back();
+    conn->neighbour_.resize(num_conn);
+    conn->face_.resize(num_conn);
+    conn->sign_.resize(num_conn);
+#pragma omp parallel for schedule(static)
+    for (int cell = 0; cell < num_cells; ++cell) {
+        int pos = conn->row_start_[cell];
+        for (const auto& f : cell_to_face_[EntityRep<0>(cell, true)]) {
+            const int other = otherCell(f.index(), cell);
+            if (other >= 0) {
+                conn->neighbour_[pos] = other;
+                conn->face_[pos] = f.index();
+                conn->sign_[pos] = f.orientation() ? 1 : -1;
+                ++pos;
+            }
+        }
+        assert(pos == conn->row_start_[cell + 1]);
+    }
+    cell_connections_ = std::move(conn);
+    return *cell_connections_;
+}
+
+const std::vector<int>& CpGridData::interiorCellsNotTouchingOverlap() const
+{
+    if (!interior_cell_split_) {
+        const auto& conn = cellConnections();
+        std::unique_ptr<InteriorCellSplit> split(new InteriorCellSplit);
+        auto isInterior = [this](int cell)
+        {
+            return partition_type_indicator_->getPartitionType(EntityRep<0>(cell, true))
+                == InteriorEntity;
+        };
+        for (int cell = 0; cell < conn.size(); ++cell) {
+            if (!isInterior(cell)) {
+                continue;
+            }
+            bool touches_overlap = false;
+            for (const int nb : conn.neighbours(cell)) {
+                touches_overlap = touches_overlap || !isInterior(nb);
+            }
+            if (touches_overlap) {
+                split->touching_overlap.push_back(cell);
+            } else {
+                split->not_touching_overlap.push_back(cell);
+            }
+        }
+        interior_cell_split_ = std::move(split);
+    }
+    return interior_cell_split_->not_touching_overlap;
+}
+
+const std::vector<int>& CpGridData::interiorCellsTouchingOverlap() const
+{
+    interiorCellsNotTouchingOverlap();
+    return interior_cell_split_->touching_overlap;
+}
+
+const std::vector<std::pair<int,int> >*
+CpGridData::partitionIndexRanges(int codim, PartitionIteratorType pitype) const
+{
+    // Faces and edges are not iterated over, see size().
+    if (partition_type_indicator_->cell_indicator_.empty() || (codim != 0 && codim != 3)) {
+        return nullptr;
+    }
+    if (pitype > Overlap_Partition) {
+        OPM_THROW(std::logic_error, "No index ranges for partition " << pitype);
+    }
+    return &partition_index_ranges_[codim == 0 ? 0 : 1][pitype];
+}
+
+std::vector<int> CpGridData::reverseCuthillMcKeeOrder() const
+{
+    const CellConnections& conn = cellConnections();
+    const int num_cells = cell_to_face_.size();
+    auto degree = [&conn](int cell)
+    {
+        return conn.rowEnd(cell) - conn.rowBegin(cell);
+    };
+
+    // Breadth first search from a cell. Returns the number of levels and
+    // the start of the last level in queue.
+    std::vector<int> mark(num_cells, -1);
+    int stamp = 0;
+    std::vector<int> queue;
+    queue.reserve(num_cells);
+    auto breadthFirstSearch = [&](int root, std::size_t& last_level)
+    {
+        ++stamp;
+        queue.assign(1, root);
+        mark[root] = stamp;
+        int levels = 0;
+        std::size_t level_begin = 0;
+        while (level_begin < queue.size()) {
+            const std::size_t level_end = queue.size();
+            last_level = level_begin;
+            for (std::size_t i = level_begin; i < level_end; ++i) {
+                for (int n : conn.neighbours(queue[i])) {
+                    if (mark[n] != stamp) {
+                        mark[n] = stamp;
+                        queue.push_back(n);
+                    }
+                }
+            }
+            level_begin = level_end;
+            ++levels;
+        }
+        return levels;
+    };
+
+    std::vector<int> order;
+    order.reserve(num_cells);
+    std::vector<char> numbered(num_cells, false);
+    std::vector<int> neighbours;
+    for (int start = 0; start < num_cells; ++start) {
+        if (numbered[start]) {
+            continue;
+        }
+        // Find a pseudo-peripheral cell of the component (George and Liu).
+        int root = start;
+        std::size_t last_level = 0;
+        int levels = breadthFirstSearch(root, last_level);
+        while (true) {
+            int candidate = queue[last_level];
+            for (std::size_t i = last_level + 1; i < queue.size(); ++i) {
+                if (degree(queue[i]) < degree(candidate)) {
+                    candidate = queue[i];
+                }
+            }
+            const int candidate_levels = breadthFirstSearch(candidate, last_level);
+            if (candidate_levels <= levels) {
+                break;
+            }
+            root = candidate;
+            levels = candidate_levels;
+        }
+
+        // Cuthill-McKee: number the neighbours in order of increasing degree.
+        std::size_t head = order.size();
+        order.push_back(root);
+        numbered[root] = true;
+        while (head < order.size()) {
+            const int cell = order[head++];
+            neighbours.clear();
+            for (int n : conn.neighbours(cell)) {
+                if (!numbered[n]) {
+                    numbered[n] = true;
+                    neighbours.push_back(n);
+                }
+            }
+            std::sort(neighbours.begin(), neighbours.end(),
+                      [&degree](int a, int b)
+                      {
+                          return degree(a) < degree(b) || (degree(a) == degree(b) && a < b);
+                      });
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+namespace
+{
+/// \brief The index of a point with the given coordinates on a 3D Hilbert curve.
+///
+/// Uses the algorithm of J. Skilling, Programming the Hilbert curve,
+/// AIP Conf. Proc. 707 (2004).
+std::uint64_t hilbertIndex(std::array<std::uint32_t, 3> x, int bits)
+{
+    const std::uint32_t m = 1u << (bits - 1);
+    // Inverse undo of the excess work.
+    for (std::uint32_t q = m; q > 1; q >>= 1) {
+        const std::uint32_t p = q - 1;
+        for (int i = 0; i < 3; ++i) {
+            if (x[i] & q) {
+                x[0] ^= p;
+            } else {
+                const std::uint32_t t = (x[0] ^ x[i]) & p;
+                x[0] ^= t;
+                x[i] ^= t;
+            }
+        }
+    }
+    // Gray encode.
+    x[1] ^= x[0];
+    x[2] ^= x[1];
+    std::uint32_t t = 0;
+    for (std::uint32_t q = m; q > 1; q >>= 1) {
+        if (x[2] & q) {
+            t ^= q - 1;
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        x[i] ^= t;
+    }
+    // Interleave the bits of the transposed index, most significant first.
+    std::uint64_t index = 0;
+    for (int b = bits - 1; b >= 0; --b) {
+        for (int i = 0; i < 3; ++i) {
+            index = (index << 1) | ((x[i] >> b) & 1u);
+        }
+    }
+    return index;
+}
+
+/// \brief Reorder the entries of a vector.
+template<class T>
+void permuteEntries(std::vector<T>& values, const std::vector<int>& new_to_old)
+{
+    if (values.empty()) {
+        return;
+    }
+    std::vector<T> permuted;
+    permuted.reserve(new_to_old.size());
+    for (int old : new_to_old) {
+        permuted.push_back(values[old]);
+    }
+    values.swap(permuted);
+}
+} // end anonymous namespace
+
+std::vector<int> CpGridData::hilbertOrder() const
+{
+    const int num_cells = cell_to_face_.size();
+    const auto& cell_geom = geomVector<0>();
+    std::array<double, 3> lower, upper;
+    lower.fill(std::numeric_limits<double>::max());
+    upper.fill(-std::numeric_limits<double>::max());
+    for (int c = 0; c < num_cells; ++c) {
+        const auto& center = cell_geom.get(c).center();
+        for (int d = 0; d < 3; ++d) {
+            lower[d] = std::min(lower[d], center[d]);
+            upper[d] = std::max(upper[d], center[d]);
+        }
+    }
+    // Use the same scaling in all directions to keep the curve isotropic.
+    const int bits = 21;
+    double extent = 0.0;
+    for (int d = 0; d < 3; ++d) {
+        extent = std::max(extent, upper[d] - lower[d]);
+    }
+    const double scale = extent > 0.0 ? ((1u << bits) - 1)/extent : 0.0;
+
+    std::vector<std::pair<std::uint64_t, int> > keys(num_cells);
+#pragma omp parallel for schedule(static)
+    for (int c = 0; c < num_cells; ++c) {
+        const auto& center = cell_geom.get(c).center();
+        std::array<std::uint32_t, 3> x;
+        for (int d = 0; d < 3; ++d) {
+            x[d] = static_cast<std::uint32_t>((center[d] - lower[d])*scale);
+        }
+        keys[c] = std::make_pair(hilbertIndex(x, bits), c);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<int> order(num_cells);
+    for (int c = 0; c < num_cells; ++c) {
+        order[c] = keys[c].second;
+    }
+    return order;
+}
+
+std::vector<int> CpGridData::renumber(const std::vector<int>& new_to_old_cell)
+{
+#if HAVE_MPI
+    if (cell_indexset_.size() > 0) {
+        OPM_THROW(std::logic_error, "Only grids that are not distributed can be renumbered.");
+    }
+#endif
+    const int num_cells = cell_to_face_.size();
+    const int num_faces = face_to_cell_.size();
+    if (static_cast<int>(new_to_old_cell.size()) != num_cells) {
+        OPM_THROW(std::invalid_argument, "The new cell order has " << new_to_old_cell.size()
+                  << " entries but the grid has " << num_cells << " cells.");
+    }
+    std::vector<int> old_to_new_cell(num_cells, -1);
+    for (int c = 0; c < num_cells; ++c) {
+        const int old = new_to_old_cell[c];
+        if (old < 0 || old >= num_cells || old_to_new_cell[old] != -1) {
+            OPM_THROW(std::invalid_argument, "The new cell order is not a permutation.");
+        }
+        old_to_new_cell[old] = c;
+    }
+
+    // Order the faces by the lowest new index of their cells (stable counting sort).
+    const int invalid = std::numeric_limits<int>::max();
+    const Opm::SparseTable<EntityRep<0> >& f2c = face_to_cell_;
+    std::vector<int> face_key(num_faces, num_cells);
+    std::vector<int> key_start(num_cells + 2, 0);
+    for (int f = 0; f < num_faces; ++f) {
+        for (const auto& cell : f2c[f]) {
+            if (cell.index() != invalid) {
+                face_key[f] = std::min(face_key[f], old_to_new_cell[cell.index()]);
+            }
+        }
+        ++key_start[face_key[f] + 1];
+    }
+    std::partial_sum(key_start.begin(), key_start.end(), key_start.begin());
+    std::vector<int> new_to_old_face(num_faces), old_to_new_face(num_faces);
+    for (int f = 0; f < num_faces; ++f) {
+        const int new_face = key_start[face_key[f]]++;
+        new_to_old_face[new_face] = f;
+        old_to_new_face[f] = new_face;
+    }
+
+    // Topology.
+    const Opm::SparseTable<EntityRep<1> >& c2f = cell_to_face_;
+    Opm::SparseTable<EntityRep<1> > new_c2f;
+    new_c2f.reserve(num_cells, c2f.dataSize());
+    std::vector<EntityRep<1> > face_row;
+    for (int c = 0; c < num_cells; ++c) {
+        face_row.clear();
+        for (const auto& face : c2f[new_to_old_cell[c]]) {
+            face_row.push_back(EntityRep<1>(old_to_new_face[face.index()], face.orientation()));
+        }
+        new_c2f.appendRow(face_row.begin(), face_row.end());
+    }
+    static_cast<Opm::SparseTable<EntityRep<1> >&>(cell_to_face_).swap(new_c2f);
+
+    Opm::SparseTable<EntityRep<0> > new_f2c;
+    new_f2c.reserve(num_faces, f2c.dataSize());
+    std::vector<EntityRep<0> > cell_row;
+    for (int f = 0; f < num_faces; ++f) {
+        cell_row.clear();
+        for (const auto& cell : f2c[new_to_old_face[f]]) {
+            const int index = cell.index() != invalid ? old_to_new_cell[cell.index()] : invalid;
+            cell_row.push_back(EntityRep<0>(index, cell.orientation()));
+        }
+        new_f2c.appendRow(cell_row.begin(), cell_row.end());
+    }
+    static_cast<Opm::SparseTable<EntityRep<0> >&>(face_to_cell_).swap(new_f2c);
+
+    Opm::SparseTable<int> new_f2p;
+    new_f2p.reserve(num_faces, face_to_point_.dataSize());
+    for (int f = 0; f < num_faces; ++f) {
+        const auto& row = face_to_point_[new_to_old_face[f]];
+        new_f2p.appendRow(row.begin(), row.end());
+    }
+    face_to_point_.swap(new_f2p);
+
+    permuteEntries(cell_to_point_, new_to_old_cell);
+    permuteEntries(global_cell_, new_to_old_cell);
+    permuteEntries(static_cast<std::vector<enum face_tag>&>(face_tag_), new_to_old_face);
+    permuteEntries(static_cast<std::vector<PointType>&>(face_normals_), new_to_old_face);
+    permuteEntries(static_cast<std::vector<int>&>(unique_boundary_ids_), new_to_old_face);
+    permuteEntries(global_id_set_->getMapping<0>(), new_to_old_cell);
+    permuteEntries(global_id_set_->getMapping<1>(), new_to_old_face);
+
+    // Geometry. The cell geometries refer to the corners in cell_to_point_.
+    EntityVariable<cpgrid::Geometry<2, 3>, 1>& face_geom = geometry_.geomVector(std::integral_constant<int,1>());
+    permuteEntries(static_cast<std::vector<cpgrid::Geometry<2, 3> >&>(face_geom), new_to_old_face);
+    EntityVariable<cpgrid::Geometry<0, 3>, 3>& point_geom = geometry_.geomVector(std::integral_constant<int,3>());
+    EntityVariable<cpgrid::Geometry<3, 3>, 0>& cell_geom = geometry_.geomVector(std::integral_constant<int,0>());
+    const std::vector<cpgrid::Geometry<3, 3> > old_cell_geom(cell_geom.begin(), cell_geom.end());
+    for (int c = 0; c < num_cells; ++c) {
+        const auto& geom = old_cell_geom[new_to_old_cell[c]];
+        cell_geom.get(c) = Geometry<3,3>(geom.center(), geom.volume(), point_geom,
+                                         cell_to_point_[c].data());
+    }
+    geometry_.updateGeometryArrays(face_normals_);
+
+    cell_connections_.reset();
+    interior_cell_split_.reset();
+    return new_to_old_face;
+}
+
 int CpGridData::size(int codim) const
 {
     switch (codim) {
@@ -166,12 +576,12 @@ struct AssignAndIncrement
  * @brief Counts the number of global ids and sets them up.
  * @param indicator A vector indicating whether an entity exists.
  * @param ids A vector to the the global ids in.
- * @param idSet The idSet of the global grid.
+ * @param idSet The global id set of the grid that is extracted from.
  * @return the number of entities that exist.
  */
-template<int codim>
+template<int codim, class IdSetType>
 int setupAndCountGlobalIds(const std::vector<int>& indicator, std::vector<int>& ids,
-                           const IdSet& idSet)
+                           const IdSetType& idSet)
 {
     int count = std::count_if(indicator.begin(),
                               indicator.end(),
@@ -226,13 +636,80 @@ int getIndex(T i)
     return i->index();
 }
 
+/// \brief The attributes of entities on other processes, stored as
+/// (rank, attribute) pairs in compressed row format.
+///
+/// The pairs are first collected unsorted with add(). finalize() sorts
+/// them by entity with a counting sort and by rank within each entity,
+/// keeping only the first pair received for each rank.
+struct RemoteAttributes
+{
+    explicit RemoteAttributes(std::size_t size)
+        : row_start_(size + 1, 0)
+    {}
+
+    void add(int index, int rank, char attribute)
+    {
+        unsorted_.push_back(Entry{index, rank, attribute});
+    }
+
+    void finalize()
+    {
+        const std::size_t size = row_start_.size() - 1;
+        for(const auto& entry: unsorted_)
+            ++row_start_[entry.index + 1];
+        for(std::size_t i=0; i<size; ++i)
+            row_start_[i+1] += row_start_[i];
+
+        std::vector<std::pair<int,char> > sorted(unsorted_.size());
+        std::vector<int> position(row_start_.begin(), row_start_.end() - 1);
+        for(const auto& entry: unsorted_)
+            sorted[position[entry.index]++] = std::make_pair(entry.rank, entry.attribute);
+        std::vector<Entry>().swap(unsorted_);
+
+        auto byRank = [](const std::pair<int,char>& a, const std::pair<int,char>& b)
+                      { return a.first < b.first; };
+        auto sameRank = [](const std::pair<int,char>& a, const std::pair<int,char>& b)
+                        { return a.first == b.first; };
+        std::size_t out = 0;
+        for(std::size_t i=0; i<size; ++i)
+        {
+            auto begin = sorted.begin() + row_start_[i];
+            auto end = sorted.begin() + row_start_[i+1];
+            std::stable_sort(begin, end, byRank);
+            end = std::unique(begin, end, sameRank);
+            row_start_[i] = out;
+            for(auto e = begin; e != end; ++e)
+                sorted[out++] = *e;
+        }
+        row_start_[size] = out;
+        sorted.resize(out);
+        entries_.swap(sorted);
+    }
+
+    std::size_t size() const
+    {
+        return row_start_.size() - 1;
+    }
+
+    struct Entry
+    {
+        int index;
+        int rank;
+        char attribute;
+    };
+    std::vector<Entry> unsorted_;
+    std::vector<int> row_start_;
+    std::vector<std::pair<int,char> > entries_;
+};
+
 template<class T>
 struct AttributeDataHandle
 {
     typedef std::pair<int,char> DataType;
 
     AttributeDataHandle(int rank, const PartitionTypeIndicator& indicator,
-                        std::vector<std::map<int, char> >& vals,
+                        RemoteAttributes& vals,
                         const T& cell_to_entity,
                         const CpGridData& grid)
         : rank_(rank), indicator_(indicator), vals_(vals),
@@ -267,12 +744,12 @@ struct AttributeDataHandle
         {
             std::pair<int,char> rank_attr;
             buffer.read(rank_attr);
-            vals_[getIndex(f)].insert(rank_attr);
+            vals_.add(getIndex(f), rank_attr.first, rank_attr.second);
         }
     }
     int rank_;
     const PartitionTypeIndicator& indicator_;
-    std::vector<std::map<int, char> >& vals_;
+    RemoteAttributes& vals_;
     const T& c2e_;
     const CpGridData& grid_;
 };
@@ -448,23 +925,21 @@ private:
 /**
  * \brief Applies a functor the each pair of the interface.
  * \tparam Functor The type of the functor to apply.
- * \param attributes[in] A vector that contains for each index a map from other
- * process ranks to the attribute there.
+ * \param attributes[in] The finalized ranks and attributes of each index on
+ * other processes, sorted by rank.
  * \param my_attributes[in] A vector with the attributes of each index on this process.
  * \param func The functor.
  */
 template<class Functor, class T>
-void iterate_over_attributes(std::vector<std::map<int,char> >& attributes,
+void iterate_over_attributes(const RemoteAttributes& attributes,
                              T my_attribute_iter, Functor& func)
 {
-    typedef typename std::vector<std::map<int,char> >::const_iterator Iter;
-    for(Iter begin=attributes.begin(), i=begin, end=attributes.end(); i!=end;
-        ++i, ++my_attribute_iter)
+    for(std::size_t i=0, end=attributes.size(); i!=end; ++i, ++my_attribute_iter)
     {
-        typedef typename std::map<int,char>::const_iterator MIter;
-        for(MIter m=i->begin(), mend=i->end(); m!=mend; ++m)
+        for(int e=attributes.row_start_[i]; e!=attributes.row_start_[i+1]; ++e)
         {
-            func(m->first,i-begin,PartitionType(*my_attribute_iter), PartitionType(m->second));
+            const auto& m = attributes.entries_[e];
+            func(m.first, i, PartitionType(*my_attribute_iter), PartitionType(m.second));
         }
     }
 }
@@ -478,7 +953,7 @@ void iterate_over_attributes(std::vector<std::map<int,char> >& attributes,
  * \param[out] interfaces The tuple with the interface maps for communication.
  */
 template<class InterfaceMap,class T>
-void createInterfaces(std::vector<std::map<int,char> >& attributes,
+void createInterfaces(const RemoteAttributes& attributes,
                       T partition_type_iterator,
                       std::tuple<InterfaceMap,InterfaceMap,InterfaceMap,InterfaceMap,InterfaceMap>&
                       interfaces)
@@ -530,10 +1005,8 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
         if(*i>=size)
             OPM_THROW(std::runtime_error, "rank for cell is too big");
 #endif // #ifdef DEBUG
-    // vector with the set of ranks that
-    std::vector<std::set<int> > overlap;
-
-    overlap.resize(cell_part.size());
+    // For each cell the sorted ranks that it is shared with.
+    Opm::SparseTable<int> overlap;
     addOverlapLayer(grid, cell_part, overlap, my_rank, overlap_layers, false);
     // count number of cells
     struct CellCounter
@@ -564,11 +1037,11 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
         /**
          * @brief Adds an index that is present on more than one processor to the index set.
          * @param i The global index.
-         * @param ov The set of ranks where the index is in the overlap
+         * @param ov The sorted ranks where the index is in the overlap
          * region.
          * @param rank The rank that owns this index.
          */
-        void operator() (int i, const std::set<int>& ov, int rank)
+        void operator() (int i, const Opm::SparseTable<int>::row_type& ov, int rank)
         {
             if(rank==myrank)
             {
@@ -578,9 +1051,8 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
             }
             else
             {
-                std::set<int>::const_iterator iter=
-                    ov.find(myrank);
-                if(iter!=ov.end())
+                const int* iter=std::lower_bound(ov.begin(), ov.end(), myrank);
+                if(iter!=ov.end() && *iter==myrank)
                 {
                     global2local.push_back(count);
                     indexset->add(i, Index(count++, AttributeSet::copy, true));
@@ -598,16 +1070,14 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
     cell_counter.indexset=&cell_indexset_;
     // set up the index set.
     cell_counter.indexset->beginResize();
-    typedef std::vector<std::set<int> >::const_iterator OIterator;
-    std::vector<int>::const_iterator ci=cell_part.begin();
-    for(OIterator end=overlap.end(), begin=overlap.begin(), i=begin; i!=end; ++i, ++ci)
+    for(int i=0, end=cell_part.size(); i!=end; ++i)
     {
-        if(i->size())
+        if(overlap.rowSize(i))
             // Cell is shared between different processors
-            cell_counter(i-begin, *i, *ci);
+            cell_counter(i, overlap[i], cell_part[i]);
         else
             // cell is not shared
-            cell_counter(i-begin, *ci);
+            cell_counter(i, cell_part[i]);
     }
     cell_counter.indexset->endResize();
     // setup the remote indices.
@@ -635,22 +1105,14 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
             }
             else
             {
-                typedef std::set<int>::const_iterator SIter;
-                SIter mine =overlap[i->global()].find(my_rank);
-                for(SIter iter=overlap[i->global()].begin(); iter!=mine; ++iter)
+                for(int rank: overlap[i->global()])
                 {
-                    std::map<int,Modifier>::iterator mod=modifiers.find(*iter);
+                    if(rank==my_rank)
+                        continue;
+                    std::map<int,Modifier>::iterator mod=modifiers.find(rank);
                     assert(mod!=modifiers.end());
                     mod->second.insert(RemoteIndex(AttributeSet::copy, &(*i)));
                 }
-                SIter end2=overlap[i->global()].end();
-                if(mine!=end2)
-                    for(++mine; mine!=end2; ++mine)
-                    {
-                        std::map<int,Modifier>::iterator mod=modifiers.find(*mine);
-                        assert(mod!=modifiers.end());
-                        mod->second.insert(RemoteIndex(AttributeSet::copy, &(*i)));
-                    }
             }
         }
     }
@@ -660,23 +1122,40 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
         cell_remote_indices_.getModifier<false,false>(0);
     }
 
-    // We can identify existing cells with the help of the index set.
+    std::vector<int> local_to_global_cell(cell_indexset_.size());
+    for(const auto& index: cell_indexset_)
+        local_to_global_cell[index.local()] = index.global();
+    extractLocalGrid(view_data, local_to_global_cell);
+    setupPartitionTypesAndInterfaces();
+
+#else // #if HAVE_MPI
+    static_cast<void>(grid);
+    static_cast<void>(view_data);
+    static_cast<void>(cell_part);
+    static_cast<void>(overlap_layers);
+#endif
+}
+
+#if HAVE_MPI
+void CpGridData::extractLocalGrid(const CpGridData& view_data,
+                                  const std::vector<int>& local_to_global_cell)
+{
+    // We can identify existing cells with the help of local_to_global_cell.
     // Now we need to compute the existing faces and points. Either exist
     // if they are reachable from an existing cell.
     // We use std::numeric_limits<int>::max() to indicate non-existent entities.
+    const int no_cells = local_to_global_cell.size();
     std::vector<int> face_indicator(view_data.geometry_.geomVector<1>().size(),
                                     std::numeric_limits<int>::max());
     std::vector<int> point_indicator(view_data.geometry_.geomVector<3>().size(),
                                      std::numeric_limits<int>::max());
-    for(ParallelIndexSet::iterator i=cell_indexset_.begin(), end=cell_indexset_.end();
-            i!=end; ++i)
+    // Somehow g++-4.4 does not find functions of father even if we
+    // change inheritance of OrientedEntityTable to public.
+    // Therfore we use an ugly cast to base class here.
+    const Opm::SparseTable<EntityRep<1> >& c2f=view_data.cell_to_face_;
+    for(int row_index : local_to_global_cell)
     {
         typedef boost::iterator_range<const EntityRep<1>*>::iterator RowIter;
-        int row_index=i->global();
-        // Somehow g++-4.4 does not find functions of father even if we
-        // change inheritance of OrientedEntityTable to public.
-        // Therfore we use an ugly cast to base class here.
-        const Opm::SparseTable<EntityRep<1> >& c2f=view_data.cell_to_face_;
         for(RowIter f=c2f[row_index].begin(), fend=c2f[row_index].end();
             f!=fend; ++f)
         {
@@ -698,16 +1177,17 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
     std::for_each(point_indicator.begin(), point_indicator.end(), AssignAndIncrement());
 
     std::vector<int> map2GlobalFaceId;
+    // Use the global ids of view_data, such that pieces extracted from an
+    // already distributed grid keep the ids of the global grid.
     int noExistingFaces = setupAndCountGlobalIds<1>(face_indicator, map2GlobalFaceId,
-                                                    *view_data.local_id_set_);
+                                                    *view_data.global_id_set_);
     std::vector<int> map2GlobalPointId;
     int noExistingPoints = setupAndCountGlobalIds<3>(point_indicator, map2GlobalPointId,
-                                                     *view_data.local_id_set_);
-    std::vector<int> map2GlobalCellId(cell_indexset_.size());
-    for(ParallelIndexSet::const_iterator i=cell_indexset_.begin(), end=cell_indexset_.end();
-        i!=end; ++i)
+                                                     *view_data.global_id_set_);
+    std::vector<int> map2GlobalCellId(no_cells);
+    for(int c=0; c<no_cells; ++c)
     {
-        map2GlobalCellId[i->local()]=view_data.local_id_set_->id(EntityRep<0>(i->global(), true));
+        map2GlobalCellId[c]=view_data.global_id_set_->id(EntityRep<0>(local_to_global_cell[c], true));
     }
 
     global_id_set_->swap(map2GlobalCellId, map2GlobalFaceId, map2GlobalPointId);
@@ -715,25 +1195,21 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
     // Create the topology information. This is stored in sparse matrix like data structures.
     // First conunt the size of the nonzeros of the cell_to_face data.
     int data_size=0;
-    for(auto i=cell_indexset_.begin(), end=cell_indexset_.end();
-        i!=end; ++i)
+    for(int row_index : local_to_global_cell)
     {
-        const Opm::SparseTable<EntityRep<1> >& c2f=view_data.cell_to_face_;
-        data_size+=c2f.rowSize(i->global());
+        data_size+=c2f.rowSize(row_index);
     }
 
     //- cell_to_face_ : extract owner/overlap rows from cell_to_face_
     // Construct the sparse matrix like data structure.
     //OrientedEntityTable<0, 1> cell_to_face;
-    cell_to_face_.reserve(cell_indexset_.size(), data_size);
-    cell_to_point_.resize(cell_indexset_.size());
+    cell_to_face_.reserve(no_cells, data_size);
+    cell_to_point_.resize(no_cells);
 
-    for(auto i=cell_indexset_.begin(), end=cell_indexset_.end();
-        i!=end; ++i)
+    for(int c=0; c<no_cells; ++c)
     {
         typedef boost::iterator_range<const EntityRep<1>*>::const_iterator RowIter;
-        const Opm::SparseTable<EntityRep<1> >& c2f=view_data.cell_to_face_;
-        auto row=c2f[i->global()];
+        auto row=c2f[local_to_global_cell[c]];
         // create the new row, i.e. copy orientation and use new face indicator.
         std::vector<EntityRep<1> > new_row(row.size());
         std::vector<EntityRep<1> >::iterator  nface=new_row.begin();
@@ -742,7 +1218,7 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
         // Append the new row to the matrix
         cell_to_face_.appendRow(new_row.begin(), new_row.end());
         for(int j=0; j<8; ++j)
-            cell_to_point_[i->local()][j]=point_indicator[view_data.cell_to_point_[i->global()][j]];
+            cell_to_point_[c][j]=point_indicator[view_data.cell_to_point_[local_to_global_cell[c]][j]];
     }
 
     // Calculate the number of nonzeros needed for the face_to_cell sparse matrix
@@ -758,8 +1234,8 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
     //- face_to cell_ : extract rows that connect to an existent cell
     std::vector<int> cell_indicator(view_data.cell_to_face_.size(),
                                     std::numeric_limits<int>::max());
-    for(auto i=cell_indexset_.begin(), end=cell_indexset_.end(); i!=end; ++i)
-        cell_indicator[i->global()]=i->local();
+    for(int c=0; c<no_cells; ++c)
+        cell_indicator[local_to_global_cell[c]]=c;
 
     for(auto begin=face_indicator.begin(), f=begin, fend=face_indicator.end(); f!=fend; ++f)
     {
@@ -779,8 +1255,10 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
                 // Note that along the front partition there are invalid neighbours
                 // marked with index std::numeric_limits<int>::max()
                 // Still they inherit the orientation to make CpGrid::faceCell happy
-                new_row.push_back(EntityRep<0>(cell_indicator[cell->index()],
-                                                   cell->orientation()));
+                // If view_data is distributed itself, it has such neighbours already.
+                const int index = cell->index() < static_cast<int>(cell_indicator.size()) ?
+                    cell_indicator[cell->index()] : std::numeric_limits<int>::max();
+                new_row.push_back(EntityRep<0>(index, cell->orientation()));
             }
             face_to_cell_.appendRow(new_row.begin(), new_row.end());
         }
@@ -832,18 +1310,17 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
 
 
     EntityVariable<cpgrid::Geometry<3, 3>, 0>& cell_geom = geometry_.geomVector(std::integral_constant<int,0>());
-    std::vector<cpgrid::Geometry<3, 3> > tmp_cell_geom(cell_indexset_.size());
-    auto global_cell_geom=view_data.geomVector<0>();
-    global_cell_.resize(cell_indexset_.size());
-    cell_geom.resize(cell_indexset_.size());
+    const auto& global_cell_geom=view_data.geomVector<0>();
+    global_cell_.resize(no_cells);
+    cell_geom.resize(no_cells);
     // Copy the existing cells.
-    for (auto i = cell_indexset_.begin(), end = cell_indexset_.end(); i != end; ++i)
+    for (int c = 0; c < no_cells; ++c)
     {
-        const auto& geom = global_cell_geom.get(i->global());
-        cell_geom.get(i->local()) = Geometry<3,3>(geom.center(), geom.volume(),
-                                                  point_geom,
-                                                  cell_to_point_[i->local()].data());
-        global_cell_[i->local()]=view_data.global_cell_[i->global()];
+        const auto& geom = global_cell_geom.get(local_to_global_cell[c]);
+        cell_geom.get(c) = Geometry<3,3>(geom.center(), geom.volume(),
+                                         point_geom,
+                                         cell_to_point_[c].data());
+        global_cell_[c]=view_data.global_cell_[local_to_global_cell[c]];
     }
 
     // count the existing faces, renumber, and allocate space.
@@ -871,6 +1348,7 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
     }
     static_cast<std::vector<PointType>&>(face_normals_).swap(tmp_face_normals);
     static_cast<std::vector<enum face_tag>&>(face_tag_).swap(tmp_face_tag);
+    geometry_.updateGeometryArrays(face_normals_);
 
     // - unique_boundary_ids_ : extract the ones that correspond existent faces
     if(view_data.unique_boundary_ids_.size())
@@ -886,6 +1364,47 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
             }
         }
     }
+}
+
+namespace
+{
+/// \brief Compute the index ranges of the interior, interior-border and
+///        overlap partitions from the partition types of the entities.
+void computePartitionIndexRanges(const std::vector<char>& partition_types,
+                                 std::array<std::vector<std::pair<int,int> >, 3>& ranges)
+{
+    // Mirrors PartitionIteratorRule.
+    auto inPartition = [](int pitype, PartitionType type)
+    {
+        switch (pitype) {
+        case Interior_Partition:
+            return type == InteriorEntity;
+        case InteriorBorder_Partition:
+            return type == InteriorEntity || type == BorderEntity;
+        default:
+            return type != FrontEntity;
+        }
+    };
+    const int num_entities = partition_types.size();
+    for (int pitype = Interior_Partition; pitype <= Overlap_Partition; ++pitype) {
+        auto& partition_ranges = ranges[pitype];
+        partition_ranges.clear();
+        for (int i = 0; i < num_entities; ++i) {
+            if (!inPartition(pitype, PartitionType(partition_types[i]))) {
+                continue;
+            }
+            if (!partition_ranges.empty() && partition_ranges.back().second == i) {
+                ++partition_ranges.back().second;
+            } else {
+                partition_ranges.emplace_back(i, i + 1);
+            }
+        }
+    }
+}
+} // anon namespace
+
+void CpGridData::setupPartitionTypesAndInterfaces()
+{
     // Compute the partition type for cell
     partition_type_indicator_->cell_indicator_.resize(cell_indexset_.size());
     for(ParallelIndexSet::const_iterator i=cell_indexset_.begin(), end=cell_indexset_.end();
@@ -922,6 +1441,12 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
         }
     }
 
+    // Precompute the ranges used by the partition iterators.
+    computePartitionIndexRanges(partition_type_indicator_->cell_indicator_,
+                                partition_index_ranges_[0]);
+    computePartitionIndexRanges(partition_type_indicator_->point_indicator_,
+                                partition_index_ranges_[1]);
+
     // Compute the interface information for cells
     std::get<InteriorBorder_All_Interface>(cell_interfaces_)
         .build(cell_remote_indices_, EnumItem<AttributeSet, AttributeSet::owner>(),
@@ -958,7 +1483,7 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
     /*
       // code deactivated, because users cannot access face indices and therefore
       // communication on faces makes no sense!
-    std::vector<std::map<int,char> > face_attributes(noExistingFaces);
+    RemoteAttributes face_attributes(noExistingFaces);
     AttributeDataHandle<Opm::SparseTable<EntityRep<1> > >
         face_handle(ccobj_.rank(), *partition_type_indicator_,
                     face_attributes, static_cast<Opm::SparseTable<EntityRep<1> >&>(cell_to_face_),
@@ -967,11 +1492,11 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
     {
         comm.forward(face_handle);
     }
+    face_attributes.finalize();
     createInterfaces(face_attributes, FacePartitionTypeIterator(partition_type_indicator_),
                      face_interfaces_);
-    std::vector<std::map<int,char> >().swap(face_attributes);
     */
-    std::vector<std::map<int,char> > point_attributes(noExistingPoints);
+    RemoteAttributes point_attributes(geometry_.geomVector<3>().size());
     AttributeDataHandle<std::vector<std::array<int,8> > >
         point_handle(ccobj_.rank(), *partition_type_indicator_,
                      point_attributes, cell_to_point_, *this);
@@ -980,15 +1505,703 @@ void CpGridData::distributeGlobalGrid(const CpGrid& grid,
     {
         comm.forward(point_handle);
     }
+    point_attributes.finalize();
     createInterfaces(point_attributes, partition_type_indicator_->point_indicator_.begin(),
                      point_interfaces_);
-#else // #if HAVE_MPI
-    static_cast<void>(grid);
-    static_cast<void>(view_data);
-    static_cast<void>(cell_part);
-    static_cast<void>(overlap_layers);
-#endif
 }
 
+namespace
+{
+/// \brief Append a vector of POD values (preceded by its size) to a message buffer.
+template<class T>
+void writeVector(Dune::SimpleMessageBuffer& buffer, const std::vector<T>& values)
+{
+    buffer.write(static_cast<int>(values.size()));
+    for(const auto& v: values)
+        buffer.write(v);
+}
+
+/// \brief Read a vector written by writeVector from a message buffer.
+template<class T>
+void readVector(Dune::SimpleMessageBuffer& buffer, std::vector<T>& values)
+{
+    int size;
+    buffer.read(size);
+    values.resize(size);
+    for(auto& v: values)
+        buffer.read(v);
+}
+
+/// \brief Append a sparse table (row sizes followed by the data) to a message buffer.
+template<class T, class F>
+void writeSparseTable(Dune::SimpleMessageBuffer& buffer, const Opm::SparseTable<T>& table,
+                      F&& toInt)
+{
+    buffer.write(static_cast<int>(table.size()));
+    buffer.write(static_cast<int>(table.dataSize()));
+    for(int row=0; row<table.size(); ++row)
+        buffer.write(static_cast<int>(table.rowSize(row)));
+    for(int row=0; row<table.size(); ++row)
+        for(const auto& entry: table[row])
+            buffer.write(toInt(entry));
+}
+
+/// \brief Read a sparse table written by writeSparseTable from a message buffer.
+template<class T, class F>
+void readSparseTable(Dune::SimpleMessageBuffer& buffer, Opm::SparseTable<T>& table,
+                     F&& fromInt)
+{
+    int rows, data_size;
+    buffer.read(rows);
+    buffer.read(data_size);
+    std::vector<int> row_sizes(rows);
+    for(auto& s: row_sizes)
+        buffer.read(s);
+    table.reserve(rows, data_size);
+    std::vector<T> row;
+    for(int s: row_sizes)
+    {
+        row.resize(s);
+        for(auto& entry: row)
+        {
+            int value;
+            buffer.read(value);
+            entry=fromInt(value);
+        }
+        table.appendRow(row.begin(), row.end());
+    }
+}
+
+/// \brief Encode an oriented entity as ~index for negative orientation.
+template<int codim>
+int encodeEntity(const EntityRep<codim>& e)
+{
+    return e.orientation() ? e.index() : ~e.index();
+}
+
+template<int codim>
+EntityRep<codim> decodeEntity(int value)
+{
+    return value >= 0 ? EntityRep<codim>(value, true) : EntityRep<codim>(~value, false);
+}
+} // end anonymous namespace
+
+void CpGridData::packLocalGrid(SimpleMessageBuffer& buffer) const
+{
+    writeSparseTable(buffer, static_cast<const Opm::SparseTable<EntityRep<1> >&>(cell_to_face_),
+                     encodeEntity<1>);
+    writeSparseTable(buffer, static_cast<const Opm::SparseTable<EntityRep<0> >&>(face_to_cell_),
+                     [](const EntityRep<0>& e)
+                     {
+                         // Non-existent neighbours are marked with
+                         // std::numeric_limits<int>::max(), which does not
+                         // survive the ~index encoding.
+                         return e.index() == std::numeric_limits<int>::max() ?
+                             std::numeric_limits<int>::max() : encodeEntity<0>(e);
+                     });
+    writeSparseTable(buffer, face_to_point_, [](int p){ return p; });
+    writeVector(buffer, cell_to_point_);
+    buffer.write(logical_cartesian_size_);
+    writeVector(buffer, global_cell_);
+    writeVector(buffer, static_cast<const std::vector<enum face_tag>&>(face_tag_));
+    writeVector(buffer, static_cast<const std::vector<PointType>&>(face_normals_));
+    writeVector(buffer, static_cast<const std::vector<int>&>(unique_boundary_ids_));
+    writeVector(buffer, global_id_set_->getMapping<0>());
+    writeVector(buffer, global_id_set_->getMapping<1>());
+    writeVector(buffer, global_id_set_->getMapping<3>());
+
+    const auto& point_geom = geomVector<3>();
+    buffer.write(static_cast<int>(point_geom.size()));
+    for(const auto& geom: point_geom)
+        buffer.write(geom.center());
+    const auto& face_geom = geomVector<1>();
+    buffer.write(static_cast<int>(face_geom.size()));
+    for(const auto& geom: face_geom)
+    {
+        buffer.write(geom.center());
+        buffer.write(geom.volume());
+    }
+    const auto& cell_geom = geomVector<0>();
+    buffer.write(static_cast<int>(cell_geom.size()));
+    for(const auto& geom: cell_geom)
+    {
+        buffer.write(geom.center());
+        buffer.write(geom.volume());
+    }
+}
+
+void CpGridData::unpackLocalGrid(SimpleMessageBuffer& buffer)
+{
+    readSparseTable(buffer, static_cast<Opm::SparseTable<EntityRep<1> >&>(cell_to_face_),
+                    decodeEntity<1>);
+    readSparseTable(buffer, static_cast<Opm::SparseTable<EntityRep<0> >&>(face_to_cell_),
+                    [](int value)
+                    {
+                        return value == std::numeric_limits<int>::max() ?
+                            EntityRep<0>(value, true) : decodeEntity<0>(value);
+                    });
+    readSparseTable(buffer, face_to_point_, [](int p){ return p; });
+    readVector(buffer, cell_to_point_);
+    buffer.read(logical_cartesian_size_);
+    readVector(buffer, global_cell_);
+    readVector(buffer, static_cast<std::vector<enum face_tag>&>(face_tag_));
+    readVector(buffer, static_cast<std::vector<PointType>&>(face_normals_));
+    readVector(buffer, static_cast<std::vector<int>&>(unique_boundary_ids_));
+    std::vector<int> map2GlobalCellId, map2GlobalFaceId, map2GlobalPointId;
+    readVector(buffer, map2GlobalCellId);
+    readVector(buffer, map2GlobalFaceId);
+    readVector(buffer, map2GlobalPointId);
+    global_id_set_->swap(map2GlobalCellId, map2GlobalFaceId, map2GlobalPointId);
+
+    int size;
+    PointType center;
+    double volume;
+    EntityVariable<cpgrid::Geometry<0, 3>, 3>& point_geom = geometry_.geomVector(std::integral_constant<int,3>());
+    buffer.read(size);
+    point_geom.reserve(size);
+    for(int i=0; i<size; ++i)
+    {
+        buffer.read(center);
+        point_geom.emplace_back(center);
+    }
+    EntityVariable<cpgrid::Geometry<2, 3>, 1>&  face_geom = geometry_.geomVector(std::integral_constant<int,1>());
+    buffer.read(size);
+    face_geom.reserve(size);
+    for(int i=0; i<size; ++i)
+    {
+        buffer.read(center);
+        buffer.read(volume);
+        face_geom.emplace_back(center, volume);
+    }
+    // The cell geometries refer to the point geometries, which therefore
+    // have to be complete at this point.
+    EntityVariable<cpgrid::Geometry<3, 3>, 0>& cell_geom = geometry_.geomVector(std::integral_constant<int,0>());
+    buffer.read(size);
+    cell_geom.resize(size);
+    for(int i=0; i<size; ++i)
+    {
+        buffer.read(center);
+        buffer.read(volume);
+        cell_geom.get(i) = Geometry<3,3>(center, volume, point_geom,
+                                         cell_to_point_[i].data());
+    }
+    geometry_.updateGeometryArrays(face_normals_);
+}
+
+void CpGridData::distributeGlobalGridFromRoot(const CpGrid& grid,
+                                              const CpGridData& view_data,
+                                              const std::vector<int>& cell_part,
+                                              int overlap_layers,
+                                              int root)
+{
+    const int my_rank = ccobj_.rank();
+    const int size = ccobj_.size();
+
+    // For each of our cells: its global index, its owner, and for owned
+    // cells the ranks that hold it as an overlap cell. This is all that is
+    // needed to set up the parallel index set and the remote indices.
+    std::vector<int> local_to_global_cell;
+    std::vector<int> cell_owner;
+    std::vector<int> copy_ranks_start(1, 0);
+    std::vector<int> copy_ranks;
+
+    // The pieces are sent one at a time with a blocking send. Thus the
+    // peak memory on the root is the global grid plus the serialized
+    // local grid of a single process.
+    const int piece_tag = 267554;
+
+    if(my_rank == root)
+    {
+        // Compute the overlap of all partitions at once. This is the only
+        // place where the global grid is traversed.
+        Opm::SparseTable<int> overlap;
+        addOverlapLayer(grid, cell_part, overlap, root, overlap_layers, true);
+
+        // The cells of each rank in ascending global order.
+        std::vector<std::vector<int> > rank_cells(size);
+        for(std::size_t i=0; i<cell_part.size(); ++i)
+        {
+            rank_cells[cell_part[i]].push_back(i);
+            for(int r: overlap[i])
+                if(r != cell_part[i])
+                    rank_cells[r].push_back(i);
+        }
+
+        auto packCellInformation = [&](int rank, std::vector<int>& cells,
+                                       std::vector<int>& owners,
+                                       std::vector<int>& start,
+                                       std::vector<int>& ranks)
+        {
+            owners.reserve(rank_cells[rank].size());
+            for(int c: rank_cells[rank])
+            {
+                owners.push_back(cell_part[c]);
+                if(cell_part[c] == rank)
+                    for(int r: overlap[c])
+                        if(r != rank)
+                            ranks.push_back(r);
+                start.push_back(ranks.size());
+            }
+            cells.swap(rank_cells[rank]);
+        };
+
+        for(int rank=0; rank<size; ++rank)
+        {
+            if(rank == root)
+                continue;
+            // Extract the piece of this rank, send it, and release it
+            // before the next one is extracted.
+            SimpleMessageBuffer buffer;
+            {
+                std::vector<int> cells, owners, start(1, 0), ranks;
+                packCellInformation(rank, cells, owners, start, ranks);
+                CpGridData piece;
+                piece.extractLocalGrid(view_data, cells);
+                writeVector(buffer, cells);
+                writeVector(buffer, owners);
+                writeVector(buffer, start);
+                writeVector(buffer, ranks);
+                piece.packLocalGrid(buffer);
+            }
+            auto data = buffer.buffer();
+            MPI_Send(data.first, data.second, MPI_BYTE, rank, piece_tag, ccobj_);
+        }
+        packCellInformation(root, local_to_global_cell, cell_owner, copy_ranks_start, copy_ranks);
+        extractLocalGrid(view_data, local_to_global_cell);
+    }
+    else
+    {
+        MPI_Status stat;
+        MPI_Probe(root, piece_tag, ccobj_, &stat);
+        int msg_size;
+        MPI_Get_count(&stat, MPI_BYTE, &msg_size);
+        SimpleMessageBuffer buffer;
+        buffer.resize(msg_size);
+        auto data = buffer.buffer();
+        MPI_Recv(data.first, msg_size, MPI_BYTE, root, piece_tag, ccobj_, &stat);
+        buffer.resetReadPosition();
+        readVector(buffer, local_to_global_cell);
+        readVector(buffer, cell_owner);
+        readVector(buffer, copy_ranks_start);
+        readVector(buffer, copy_ranks);
+        unpackLocalGrid(buffer);
+    }
+
+    setupCellIndexSet(local_to_global_cell, cell_owner, copy_ranks_start, copy_ranks);
+    setupPartitionTypesAndInterfaces();
+}
+
+void CpGridData::setupCellIndexSet(const std::vector<int>& local_to_global_cell,
+                                   const std::vector<int>& cell_owner,
+                                   const std::vector<int>& copy_ranks_start,
+                                   const std::vector<int>& copy_ranks)
+{
+    const int my_rank = ccobj_.rank();
+
+    // Set up the index set. Local indices are assigned in ascending global order.
+    const int no_cells = local_to_global_cell.size();
+    std::set<int> neighbors;
+    cell_indexset_.beginResize();
+    for(int c=0; c<no_cells; ++c)
+    {
+        typedef Dune::ParallelLocalIndex<AttributeSet> Index;
+        if(cell_owner[c] == my_rank)
+        {
+            cell_indexset_.add(local_to_global_cell[c], Index(c, AttributeSet::owner, true));
+            neighbors.insert(copy_ranks.begin()+copy_ranks_start[c],
+                             copy_ranks.begin()+copy_ranks_start[c+1]);
+        }
+        else
+        {
+            cell_indexset_.add(local_to_global_cell[c], Index(c, AttributeSet::copy, true));
+            neighbors.insert(cell_owner[c]);
+        }
+    }
+    cell_indexset_.endResize();
+
+    // setup the remote indices.
+    typedef RemoteIndexListModifier<RemoteIndices::ParallelIndexSet, RemoteIndices::Allocator,
+                                    false> Modifier;
+    typedef RemoteIndices::RemoteIndex RemoteIndex;
+    cell_remote_indices_.setIndexSets(cell_indexset_, cell_indexset_, ccobj_);
+
+    if(neighbors.size()){ //extra scope to call destructor of the Modifiers
+        std::map<int,Modifier> modifiers;
+        for(int n: neighbors)
+            modifiers.insert(std::make_pair(n, cell_remote_indices_.getModifier<false,false>(n)));
+        for(ParallelIndexSet::const_iterator i=cell_indexset_.begin(), end=cell_indexset_.end();
+            i!=end; ++i)
+        {
+            const int c = i->local();
+            if(i->local().attribute()!=AttributeSet::owner)
+            {
+                modifiers.find(cell_owner[c])->second
+                    .insert(RemoteIndex(AttributeSet::owner,&(*i)));
+            }
+            else
+            {
+                for(int k=copy_ranks_start[c]; k<copy_ranks_start[c+1]; ++k)
+                    modifiers.find(copy_ranks[k])->second
+                        .insert(RemoteIndex(AttributeSet::copy, &(*i)));
+            }
+        }
+    }
+    else
+    {
+        // Force update of the sync counter in the remote indices.
+        cell_remote_indices_.getModifier<false,false>(0);
+    }
+}
+
+void CpGridData::repartitionDistributedGrid(const CpGridData& view_data,
+                                            const std::vector<int>& cell_part,
+                                            VariableSizeCommunicator<>::InterfaceMap& migration,
+                                            std::vector<std::pair<int,int> >& local_moves)
+{
+    const int my_rank = ccobj_.rank();
+    const int size = ccobj_.size();
+    const int no_view_cells = view_data.cell_to_face_.size();
+    if(static_cast<int>(cell_part.size()) != no_view_cells)
+        OPM_THROW(std::runtime_error, "The partitioning has " << cell_part.size()
+                  << " entries but the grid has " << no_view_cells << " cells.");
+
+    std::vector<int> view_global_cell(no_view_cells);
+    std::vector<char> view_owned(no_view_cells, false);
+    for(const auto& index: view_data.cell_indexset_)
+    {
+        view_global_cell[index.local()] = index.global();
+        view_owned[index.local()] = index.local().attribute()==AttributeSet::owner;
+    }
+
+    // Each owned cell is sent to its new owner and to the owners of its
+    // neighbours, where it becomes an overlap cell. As the current overlap
+    // contains at least one layer, all neighbours of owned cells are present.
+    const auto& conn = view_data.cellConnections();
+    std::vector<std::vector<int> > send_cells(size);
+    std::vector<int> targets_start(no_view_cells + 1, 0);
+    std::vector<int> targets;
+    std::vector<int> cell_targets;
+    for(int c=0; c<no_view_cells; ++c)
+    {
+        targets_start[c + 1] = targets_start[c];
+        if(!view_owned[c])
+            continue;
+        if(cell_part[c] < 0 || cell_part[c] >= size)
+            OPM_THROW(std::runtime_error, "Invalid rank " << cell_part[c] << " for cell "
+                      << view_global_cell[c]);
+        cell_targets.assign(1, cell_part[c]);
+        for(int n: conn.neighbours(c))
+            cell_targets.push_back(cell_part[n]);
+        std::sort(cell_targets.begin() + 1, cell_targets.end());
+        cell_targets.erase(std::unique(cell_targets.begin() + 1, cell_targets.end()),
+                           cell_targets.end());
+        for(std::size_t t=0; t<cell_targets.size(); ++t)
+        {
+            const int r = cell_targets[t];
+            if(t > 0 && r == cell_targets[0])
+                continue;
+            send_cells[r].push_back(c);
+            targets.push_back(r);
+        }
+        targets_start[c + 1] = targets.size();
+    }
+
+    // Who receives from whom.
+    std::vector<int> send_flags(size), recv_flags(size);
+    for(int r=0; r<size; ++r)
+        send_flags[r] = r != my_rank && !send_cells[r].empty();
+    MPI_Alltoall(send_flags.data(), 1, MPI_INT, recv_flags.data(), 1, MPI_INT, ccobj_);
+    std::set<int> send_ranks, recv_ranks;
+    for(int r=0; r<size; ++r)
+    {
+        if(send_flags[r])
+            send_ranks.insert(r);
+        if(recv_flags[r])
+            recv_ranks.insert(r);
+    }
+
+    // For each cell sent: its global index, its new owner, and the ranks
+    // that will hold it as an overlap cell.
+    auto packCellInformation = [&](int rank, std::vector<int>& cells,
+                                   std::vector<int>& owners,
+                                   std::vector<int>& start,
+                                   std::vector<int>& ranks)
+    {
+        start.assign(1, 0);
+        for(int c: send_cells[rank])
+        {
+            cells.push_back(view_global_cell[c]);
+            owners.push_back(cell_part[c]);
+            if(cell_part[c] == rank)
+                for(int k=targets_start[c]+1; k<targets_start[c+1]; ++k)
+                    ranks.push_back(targets[k]);
+            start.push_back(ranks.size());
+        }
+    };
+
+    Point2PointCommunicator<SimpleMessageBuffer> p2p(ccobj_);
+    p2p.insertRequest(send_ranks, recv_ranks);
+    std::vector<SimpleMessageBuffer> send_buffers(p2p.sendLinks());
+    for(int link=0; link<p2p.sendLinks(); ++link)
+    {
+        const int rank = p2p.sendDest()[link];
+        std::vector<int> cells, owners, start, ranks;
+        packCellInformation(rank, cells, owners, start, ranks);
+        CpGridData piece;
+        piece.extractLocalGrid(view_data, send_cells[rank]);
+        auto& buffer = send_buffers[link];
+        writeVector(buffer, cells);
+        writeVector(buffer, owners);
+        writeVector(buffer, start);
+        writeVector(buffer, ranks);
+        piece.packLocalGrid(buffer);
+    }
+    std::vector<SimpleMessageBuffer> recv_buffers = p2p.exchange(send_buffers);
+    send_buffers.clear();
+
+    // The pieces of the new grid: the one kept from our own cells first,
+    // then the ones received.
+    struct Piece
+    {
+        std::unique_ptr<CpGridData> grid;
+        int source;
+        std::vector<int> cells, owners, start, ranks;
+    };
+    std::vector<Piece> pieces;
+    if(!send_cells[my_rank].empty())
+    {
+        pieces.emplace_back();
+        Piece& piece = pieces.back();
+        piece.grid.reset(new CpGridData);
+        piece.grid->extractLocalGrid(view_data, send_cells[my_rank]);
+        piece.source = my_rank;
+        packCellInformation(my_rank, piece.cells, piece.owners, piece.start, piece.ranks);
+    }
+    for(int link=0; link<p2p.recvLinks(); ++link)
+    {
+        auto& buffer = recv_buffers[link];
+        buffer.resetReadPosition();
+        pieces.emplace_back();
+        Piece& piece = pieces.back();
+        piece.source = p2p.recvSource()[link];
+        readVector(buffer, piece.cells);
+        readVector(buffer, piece.owners);
+        readVector(buffer, piece.start);
+        readVector(buffer, piece.ranks);
+        piece.grid.reset(new CpGridData);
+        piece.grid->unpackLocalGrid(buffer);
+        buffer.clear();
+    }
+    const int no_pieces = pieces.size();
+
+    // Number the cells in ascending global order. Each cell is received
+    // at most once as it is only sent by its current owner.
+    std::vector<std::array<int,3> > all_cells; // global index, piece, cell
+    for(int p=0; p<no_pieces; ++p)
+        for(std::size_t c=0; c<pieces[p].cells.size(); ++c)
+            all_cells.push_back({{pieces[p].cells[c], p, static_cast<int>(c)}});
+    std::sort(all_cells.begin(), all_cells.end());
+    const int no_cells = all_cells.size();
+    std::vector<std::vector<int> > cell_map(no_pieces);
+    for(int p=0; p<no_pieces; ++p)
+        cell_map[p].resize(pieces[p].cells.size());
+    std::vector<int> local_to_global_cell(no_cells), cell_owner(no_cells);
+    std::vector<int> copy_ranks_start(1, 0), copy_ranks;
+    for(int c=0; c<no_cells; ++c)
+    {
+        const Piece& piece = pieces[all_cells[c][1]];
+        const int pc = all_cells[c][2];
+        assert(c == 0 || all_cells[c-1][0] < all_cells[c][0]);
+        cell_map[all_cells[c][1]][pc] = c;
+        local_to_global_cell[c] = all_cells[c][0];
+        cell_owner[c] = piece.owners[pc];
+        copy_ranks.insert(copy_ranks.end(), piece.ranks.begin() + piece.start[pc],
+                          piece.ranks.begin() + piece.start[pc+1]);
+        copy_ranks_start.push_back(copy_ranks.size());
+    }
+
+    // Faces and points shared by several pieces are identified by their global ids.
+    // Returns for each piece the new index of its entities and, for each new
+    // entity, the piece and index it is taken from.
+    auto mergeEntities = [&](const std::vector<const std::vector<int>*>& piece_ids,
+                             std::vector<std::vector<int> >& map,
+                             std::vector<std::pair<int,int> >& representative,
+                             std::vector<int>& ids)
+    {
+        std::vector<std::array<int,3> > all; // global id, piece, index
+        for(int p=0; p<no_pieces; ++p)
+        {
+            const std::vector<int>& piece_ids = *piece_ids[p];
+            map[p].resize(piece_ids.size());
+            for(std::size_t i=0; i<piece_ids.size(); ++i)
+                all.push_back({{piece_ids[i], p, static_cast<int>(i)}});
+        }
+        std::sort(all.begin(), all.end());
+        for(std::size_t k=0; k<all.size(); ++k)
+        {
+            if(k == 0 || all[k][0] != all[k-1][0])
+            {
+                ids.push_back(all[k][0]);
+                representative.emplace_back(all[k][1], all[k][2]);
+            }
+            map[all[k][1]][all[k][2]] = ids.size() - 1;
+        }
+    };
+    std::vector<std::vector<int> > face_map(no_pieces), point_map(no_pieces);
+    std::vector<std::pair<int,int> > face_rep, point_rep;
+    std::vector<int> map2GlobalCellId(no_cells), map2GlobalFaceId, map2GlobalPointId;
+    std::vector<const std::vector<int>*> face_ids(no_pieces), point_ids(no_pieces);
+    for(int p=0; p<no_pieces; ++p)
+    {
+        face_ids[p] = &pieces[p].grid->global_id_set_->getMapping<1>();
+        point_ids[p] = &pieces[p].grid->global_id_set_->getMapping<3>();
+    }
+    mergeEntities(face_ids, face_map, face_rep, map2GlobalFaceId);
+    mergeEntities(point_ids, point_map, point_rep, map2GlobalPointId);
+    const int no_faces = face_rep.size();
+    const int no_points = point_rep.size();
+
+    // Cell topology and global ids.
+    int data_size = 0;
+    for(const auto& cell: all_cells)
+        data_size += pieces[cell[1]].grid->cell_to_face_.rowSize(cell[2]);
+    cell_to_face_.reserve(no_cells, data_size);
+    cell_to_point_.resize(no_cells);
+    global_cell_.resize(no_cells);
+    std::vector<EntityRep<1> > face_row;
+    for(int c=0; c<no_cells; ++c)
+    {
+        const int p = all_cells[c][1];
+        const int pc = all_cells[c][2];
+        const CpGridData& grid = *pieces[p].grid;
+        const Opm::SparseTable<EntityRep<1> >& c2f = grid.cell_to_face_;
+        face_row.clear();
+        for(const auto& face: c2f[pc])
+            face_row.push_back(EntityRep<1>(face_map[p][face.index()], face.orientation()));
+        cell_to_face_.appendRow(face_row.begin(), face_row.end());
+        for(int j=0; j<8; ++j)
+            cell_to_point_[c][j] = point_map[p][grid.cell_to_point_[pc][j]];
+        global_cell_[c] = grid.global_cell_[pc];
+        map2GlobalCellId[c] = grid.global_id_set_->getMapping<0>()[pc];
+    }
+
+    // The cells attached to a face are collected from all pieces holding it,
+    // as each piece only knows its own cells.
+    std::vector<std::vector<EntityRep<0> > > face_cells(no_faces);
+    for(int f=0; f<no_faces; ++f)
+    {
+        const CpGridData& grid = *pieces[face_rep[f].first].grid;
+        const Opm::SparseTable<EntityRep<0> >& f2c = grid.face_to_cell_;
+        for(const auto& cell: f2c[face_rep[f].second])
+            face_cells[f].push_back(EntityRep<0>(std::numeric_limits<int>::max(), cell.orientation()));
+    }
+    for(int p=0; p<no_pieces; ++p)
+    {
+        const Opm::SparseTable<EntityRep<0> >& f2c = pieces[p].grid->face_to_cell_;
+        for(int f=0; f<f2c.size(); ++f)
+        {
+            auto& row = face_cells[face_map[p][f]];
+            int k = 0;
+            for(const auto& cell: f2c[f])
+            {
+                assert(k < static_cast<int>(row.size()));
+                if(cell.index() != std::numeric_limits<int>::max())
+                    row[k] = EntityRep<0>(cell_map[p][cell.index()], cell.orientation());
+                ++k;
+            }
+        }
+    }
+    data_size = 0;
+    for(const auto& row: face_cells)
+        data_size += row.size();
+    face_to_cell_.reserve(no_faces, data_size);
+    for(const auto& row: face_cells)
+        face_to_cell_.appendRow(row.begin(), row.end());
+    std::vector<std::vector<EntityRep<0> > >().swap(face_cells);
+
+    // Face topology, tags and normals are taken from the representative.
+    data_size = 0;
+    for(const auto& rep: face_rep)
+        data_size += pieces[rep.first].grid->face_to_point_.rowSize(rep.second);
+    face_to_point_.reserve(no_faces, data_size);
+    std::vector<enum face_tag> tmp_face_tag(no_faces);
+    std::vector<PointType> tmp_face_normals(no_faces);
+    const bool has_boundary_ids = !view_data.unique_boundary_ids_.empty();
+    std::vector<int> tmp_boundary_ids(has_boundary_ids ? no_faces : 0);
+    std::vector<int> point_row;
+    for(int f=0; f<no_faces; ++f)
+    {
+        const int p = face_rep[f].first;
+        const int pf = face_rep[f].second;
+        const CpGridData& grid = *pieces[p].grid;
+        point_row.clear();
+        for(int point: grid.face_to_point_[pf])
+            point_row.push_back(point_map[p][point]);
+        face_to_point_.appendRow(point_row.begin(), point_row.end());
+        tmp_face_tag[f] = static_cast<const std::vector<enum face_tag>&>(grid.face_tag_)[pf];
+        tmp_face_normals[f] = static_cast<const std::vector<PointType>&>(grid.face_normals_)[pf];
+        if(has_boundary_ids)
+            tmp_boundary_ids[f] = static_cast<const std::vector<int>&>(grid.unique_boundary_ids_)[pf];
+    }
+    static_cast<std::vector<enum face_tag>&>(face_tag_).swap(tmp_face_tag);
+    static_cast<std::vector<PointType>&>(face_normals_).swap(tmp_face_normals);
+    static_cast<std::vector<int>&>(unique_boundary_ids_).swap(tmp_boundary_ids);
+    logical_cartesian_size_ = view_data.logical_cartesian_size_;
+
+    // Geometry. The cell geometries refer to the point geometries, which
+    // therefore have to be complete first.
+    EntityVariable<cpgrid::Geometry<0, 3>, 3>& point_geom = geometry_.geomVector(std::integral_constant<int,3>());
+    point_geom.reserve(no_points);
+    for(const auto& rep: point_rep)
+        point_geom.emplace_back(pieces[rep.first].grid->geomVector<3>()[rep.second]);
+    EntityVariable<cpgrid::Geometry<2, 3>, 1>& face_geom = geometry_.geomVector(std::integral_constant<int,1>());
+    face_geom.reserve(no_faces);
+    for(const auto& rep: face_rep)
+        face_geom.push_back(pieces[rep.first].grid->geomVector<1>()[rep.second]);
+    EntityVariable<cpgrid::Geometry<3, 3>, 0>& cell_geom = geometry_.geomVector(std::integral_constant<int,0>());
+    cell_geom.resize(no_cells);
+    for(int c=0; c<no_cells; ++c)
+    {
+        const auto& geom = pieces[all_cells[c][1]].grid->geomVector<0>().get(all_cells[c][2]);
+        cell_geom.get(c) = Geometry<3,3>(geom.center(), geom.volume(), point_geom,
+                                         cell_to_point_[c].data());
+    }
+    geometry_.updateGeometryArrays(face_normals_);
+    global_id_set_->swap(map2GlobalCellId, map2GlobalFaceId, map2GlobalPointId);
+
+    setupCellIndexSet(local_to_global_cell, cell_owner, copy_ranks_start, copy_ranks);
+    setupPartitionTypesAndInterfaces();
+
+    // The cells of view_data that were sent and where they ended up, for
+    // migrating attached data.
+    local_moves.clear();
+    for(int p=0; p<no_pieces; ++p)
+    {
+        const int source = pieces[p].source;
+        if(source == my_rank)
+        {
+            const auto& sent = send_cells[my_rank];
+            for(std::size_t i=0; i<sent.size(); ++i)
+                local_moves.emplace_back(sent[i], cell_map[p][i]);
+        }
+        else
+        {
+            auto& recv = migration[source].second;
+            recv.reserve(cell_map[p].size());
+            for(int c: cell_map[p])
+                recv.add(c);
+        }
+    }
+    for(int r: send_ranks)
+    {
+        auto& send = migration[r].first;
+        send.reserve(send_cells[r].size());
+        for(int c: send_cells[r])
+            send.add(c);
+    }
+}
+
+#endif // #if HAVE_MPI
+
 } // end namespace cpgrid
 } // end namespace Dune
@@ -67,10 +67,16 @@
 
 
 #include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 #include <algorithm>
 #include <set>
 
+#include "CellConnections.hpp"
 #include "OrientedEntityTable.hpp"
 #include "DefaultGeometryPolicy.hpp"
 #include <opm/grid/cpgpreprocess/preprocess.h>
@@ -78,11 +84,14 @@
 #include <opm/grid/utility/OpmParserIncludes.hpp>
 
 #include "Entity2IndexDataHandle.hpp"
+#include "HaloExchangePlan.hpp"
+#include "PendingCommunication.hpp"
 #include "GlobalIdMapping.hpp"
 
 namespace Dune
 {
 class CpGrid;
+class SimpleMessageBuffer;
 
 namespace cpgrid
 {
@@ -164,6 +173,38 @@ public:
     /// found in <grid_prefix>-topo.dat etc.
     void writeSintefLegacyFormat(const std::string& grid_prefix) const;
 
+    /// Write a binary snapshot of the processed grid.
+    /// \param filename the name of the cache file.
+    /// \param input_hash hash of the input the grid was built from, see inputHash().
+    void writeBinaryCache(const std::string& filename, std::uint64_t input_hash) const;
+
+    /// Read a binary snapshot written by writeBinaryCache().
+    /// The file is memory mapped and copied into the grid's structures.
+    /// \param filename the name of the cache file.
+    /// \param input_hash hash of the input the grid should be built from.
+    /// \return false, leaving the grid untouched, if the file does not
+    ///         exist, has a different format version or was written for
+    ///         another input.
+    bool readBinaryCache(const std::string& filename, std::uint64_t input_hash);
+
+    /// Compute a content hash of the COORD, ZCORN and ACTNUM data of a
+    /// corner-point specification together with the options it is
+    /// processed with (see processEclipseFormat()) and the version of
+    /// the cache format.
+    static std::uint64_t inputHash(const grdecl& input_data,
+                                   const std::array<std::set<std::pair<int, int>>, 2>& nnc,
+                                   double z_tolerance, bool remove_ij_boundary,
+                                   bool turn_normals);
+
+    /// Set the binary cache used when processing the Eclipse grid format.
+    /// If the file holds the grid built from the same input with the same
+    /// options, it is read instead of processing the input. Otherwise the
+    /// processed grid is written to it. An empty name disables the cache.
+    void setBinaryCacheFile(const std::string& filename)
+    {
+        binary_cache_file_ = filename;
+    }
+
     /// Read the Eclipse grid format ('grdecl').
     /// \param filename the name of the file to read.
     /// \param periodic_extension if true, the grid will be (possibly) refined, so that
@@ -202,6 +243,14 @@ public:
     /// \param remove_ij_boundary if true, will remove (i, j) boundaries. Used internally.
     void processEclipseFormat(const grdecl& input_data, const std::array<std::set<std::pair<int, int>>, 2>& nnc, double z_tolerance, bool remove_ij_boundary, bool turn_normals = false);
 
+    /// Read the Eclipse grid format ('grdecl') one row of corners at a time.
+    /// Only a few rows of ZCORN and ACTNUM are held in memory at once.
+    /// \param input_data the row-wise reader of the grid, declared in preprocess.h.
+    /// \param z_tolerance points along a pillar that are closer together in z
+    ///        coordinate than this parameter, will be replaced by a single point.
+    /// \param remove_ij_boundary if true, will remove (i, j) boundaries. Used internally.
+    void processEclipseFormat(const grdecl_rows& input_data, double z_tolerance, bool remove_ij_boundary, bool turn_normals = false);
+
 
     /// @brief
     ///    Extract Cartesian index triplet (i,j,k) of an active cell.
@@ -221,6 +270,67 @@ public:
     // Make unique boundary ids for all intersections.
     void computeUniqueBoundaryIds();
 
+    // Build topology and geometry from the output of the corner-point
+    // preprocessing and free that output.
+    void buildFromProcessedGrid(processed_grid& output, const std::array<std::set<std::pair<int, int>>, 2>& nnc,
+                                bool remove_ij_boundary, bool turn_normals);
+
+    /// \brief The cell-to-cell connections of the grid in compressed row format.
+    ///
+    /// The connections are computed on the first call and cached.
+    /// The first call must not happen concurrently with other calls.
+    const CellConnections& cellConnections() const;
+
+    /// \brief The interior cells that have no overlap cell as neighbour.
+    ///
+    /// The cells are in ascending order. Computations on these cells only
+    /// need data of interior cells and may be done between
+    /// communicateBegin() and communicateEnd() of an exchange that
+    /// updates the overlap. For a serial grid this contains all cells.
+    /// Computed together with interiorCellsTouchingOverlap() on the first
+    /// call and cached.
+    const std::vector<int>& interiorCellsNotTouchingOverlap() const;
+
+    /// \brief The interior cells that have at least one overlap cell as
+    ///        neighbour, in ascending order.
+    const std::vector<int>& interiorCellsTouchingOverlap() const;
+
+    /// \brief The index ranges of the entities of a partition.
+    ///
+    /// For a distributed grid the ranges are computed for cells and points
+    /// together with the partition types. They are used by the partition
+    /// iterators to skip the entities outside the partition without
+    /// checking the partition type of each entity.
+    /// \param codim The codimension of the entities.
+    /// \param pitype Interior_Partition, InteriorBorder_Partition or Overlap_Partition.
+    /// \return The sorted and disjoint ranges [first, second) of the indices of the
+    ///         entities in the partition, or a null pointer if the grid is not
+    ///         distributed and therefore all entities are interior, or if
+    ///         there are no entities of the codimension.
+    const std::vector<std::pair<int,int> >* partitionIndexRanges(int codim,
+                                                                 PartitionIteratorType pitype) const;
+
+    /// \brief An ordering of the cells with a small bandwidth of the cell graph.
+    ///
+    /// Computed by the reverse Cuthill-McKee algorithm, started in each
+    /// connected component from a pseudo-peripheral cell.
+    /// \return The old index of each cell in the new order.
+    std::vector<int> reverseCuthillMcKeeOrder() const;
+
+    /// \brief An ordering of the cells along a Hilbert curve through their centroids.
+    /// \return The old index of each cell in the new order.
+    std::vector<int> hilbertOrder() const;
+
+    /// \brief Renumber the cells and faces of a grid that is not distributed.
+    ///
+    /// The topology, the geometry, the face tags, normals and boundary ids,
+    /// and global_cell_ are permuted in place. The faces are ordered by
+    /// the lowest new index of their cells, such that the faces of a cell
+    /// are close to each other. Points are not renumbered.
+    /// \param new_to_old_cell The old index of each cell in the new order.
+    /// \return The old index of each face in the new order.
+    std::vector<int> renumber(const std::vector<int>& new_to_old_cell);
+
     /// Is the grid currently using unique boundary ids?
     /// \return true if each boundary intersection has a unique id
     ///         false if we use the (default) 1-6 ids for i- i+ j- j+ k- k+ boundaries.
@@ -269,6 +379,40 @@ public:
                               const std::vector<int>& cell_part,
                               int overlap_layers);
 
+#if HAVE_MPI
+    /// \brief Redistribute a global grid that is only present on one process.
+    ///
+    /// The global grid and the partitioning are only needed on the root
+    /// process. It computes the overlap for all partitions, extracts
+    /// the local grid of each process and sends it there. The other
+    /// processes may pass an empty grid and partitioning. The local grids
+    /// are sent one after the other, so the peak memory on the root is the
+    /// global grid plus the serialized local grid of a single process.
+    /// \param root The rank of the process that holds the global grid.
+    void distributeGlobalGridFromRoot(const CpGrid& grid,
+                                      const CpGridData& view_data,
+                                      const std::vector<int>& cell_part,
+                                      int overlap_layers,
+                                      int root);
+
+    /// \brief Set up this grid as a new partitioning of a distributed grid.
+    ///
+    /// Cells, faces, points and their geometry are sent directly from their
+    /// current owners to their new ones. No process needs the global grid.
+    /// The new overlap consists of one layer of face neighbours.
+    /// \param view_data The distributed grid to repartition.
+    /// \param cell_part For each cell of view_data its new owner. Only the
+    ///        entries of the interior cells are used.
+    /// \param migration Filled with the cells of view_data sent to each other
+    ///        process (first) and the cells of this grid received from it (second).
+    /// \param local_moves Filled with pairs of the index of a cell in view_data
+    ///        and its index in this grid for cells staying on this process.
+    void repartitionDistributedGrid(const CpGridData& view_data,
+                                    const std::vector<int>& cell_part,
+                                    VariableSizeCommunicator<>::InterfaceMap& migration,
+                                    std::vector<std::pair<int,int> >& local_moves);
+#endif
+
     /// \brief communicate objects for all codims on a given level
     /// \param data The data handle describing the data. Has to adhere to the
     /// Dune::DataHandleIF interface.
@@ -277,10 +421,72 @@ public:
     template<class DataHandle>
     void communicate(DataHandle& data, InterfaceType iftype, CommunicationDirection dir);
 
+    /// \brief Create a reusable plan for exchanging fixed-size data.
+    ///
+    /// This is a collective operation. See HaloExchangePlan for the layout
+    /// of the data.
+    /// \param iftype The interface to use for the communication.
+    /// \param codim The codimension of the entities (0 or 3).
+    /// \param values_per_entity The number of values for each entity.
+    /// \param dir The direction of the communication along the interface.
+    template<class T>
+    std::unique_ptr<HaloExchangePlan<T> >
+    haloExchangePlan(InterfaceType iftype, int codim, std::size_t values_per_entity,
+                     CommunicationDirection dir);
+
+    /// \brief Start communicating objects for all codims.
+    ///
+    /// Gathers the data to send and posts non-blocking sends and receives.
+    /// The communication is completed by communicateEnd(), which must be
+    /// called with the same arguments before another communication is
+    /// started with communicateBegin(). In between, the data of the
+    /// entities that are received must neither be read nor written.
+    /// Data handles with a variable size are communicated completely
+    /// within communicateBegin().
+    /// \param data The data handle describing the data. Has to adhere to the
+    /// Dune::DataHandleIF interface.
+    /// \param iftype The interface to use for the communication.
+    /// \param dir The direction of the communication along the interface (forward or backward).
+    template<class DataHandle>
+    void communicateBegin(DataHandle& data, InterfaceType iftype, CommunicationDirection dir);
+
+    /// \brief Finish a communication started by communicateBegin().
+    ///
+    /// Waits for the messages and scatters the received data.
+    template<class DataHandle>
+    void communicateEnd(DataHandle& data, InterfaceType iftype, CommunicationDirection dir);
+
 private:
 
 #if HAVE_MPI
 
+    /// \brief Extract the topology and geometry of a subset of the cells of a grid.
+    /// \param view_data The grid to extract from.
+    /// \param local_to_global_cell The cells to extract in ascending order. Position
+    ///        i holds the index in view_data of the local cell i.
+    void extractLocalGrid(const CpGridData& view_data,
+                          const std::vector<int>& local_to_global_cell);
+
+    /// \brief Compute the partition types of cells and points and the
+    /// communication interfaces from the cell index set and remote indices.
+    void setupPartitionTypesAndInterfaces();
+
+    /// \brief Write the topology, geometry and global ids to a message buffer.
+    void packLocalGrid(SimpleMessageBuffer& buffer) const;
+
+    /// \brief Read the topology, geometry and global ids from a message buffer.
+    void unpackLocalGrid(SimpleMessageBuffer& buffer);
+
+    /// \brief Set up the cell index set and remote indices.
+    /// \param local_to_global_cell The global index of each local cell in ascending order.
+    /// \param cell_owner The owner of each local cell.
+    /// \param copy_ranks_start Start of the copy ranks of each cell in copy_ranks.
+    /// \param copy_ranks For each owned cell the processes holding a copy of it.
+    void setupCellIndexSet(const std::vector<int>& local_to_global_cell,
+                           const std::vector<int>& cell_owner,
+                           const std::vector<int>& copy_ranks_start,
+                           const std::vector<int>& copy_ranks);
+
     /// \brief Gather data on a global grid representation.
     /// \param data A data handle for getting or setting the data
     /// \param global_view The view of the global grid (to gather the data on)
@@ -314,6 +520,17 @@ private:
     void scatterData(DataHandle& data, CpGridData* global_data,
                      CpGridData* distributed_data, const InterfaceMap& inf);
 
+    /// \brief Move cell data from a distributed grid to its repartitioned version.
+    /// \param data A data handle for getting or setting the data
+    /// \param old_data The grid before repartitioning.
+    /// \param new_data The grid after repartitioning.
+    /// \param migration The cells sent and received, see repartitionDistributedGrid.
+    /// \param local_moves The cells staying on this process, see repartitionDistributedGrid.
+    template<class DataHandle>
+    void migrateData(DataHandle& data, CpGridData* old_data, CpGridData* new_data,
+                     const InterfaceMap& migration,
+                     const std::vector<std::pair<int,int> >& local_moves);
+
     /// \brief Scatter data specific to given codimension from a global grid representation
     /// to a distributed representation of the same grid.
     /// \param data A data handle for getting or setting the data
@@ -413,6 +630,30 @@ private:
     /// copy here to be able to create an EclipseGrid for output.
     std::vector<double> zcorn;
 
+    /// The binary cache used by processEclipseFormat(), if not empty.
+    std::string binary_cache_file_;
+
+    /// Cached cell-to-cell connections, see cellConnections().
+    mutable std::unique_ptr<CellConnections> cell_connections_;
+
+    /// The interior cells split by whether they touch the overlap, see
+    /// interiorCellsNotTouchingOverlap().
+    struct InteriorCellSplit
+    {
+        std::vector<int> not_touching_overlap;
+        std::vector<int> touching_overlap;
+    };
+    /// Cached interior cell split.
+    mutable std::unique_ptr<InteriorCellSplit> interior_cell_split_;
+
+    /// The index ranges of the interior, interior-border and overlap
+    /// partitions of cells (first index 0) and points (first index 1),
+    /// see partitionIndexRanges().
+    std::array<std::array<std::vector<std::pair<int,int> >, 3>, 2> partition_index_ranges_;
+
+    /// Whether communicateBegin() was called without communicateEnd().
+    bool communication_pending_;
+
 #ifdef HAVE_DUNE_ISTL
     typedef Dune::OwnerOverlapCopyAttributeSet::AttributeSet AttributeSet;
 #else
@@ -447,6 +688,18 @@ private:
     std::tuple<InterfaceMap,InterfaceMap,InterfaceMap,InterfaceMap,InterfaceMap>
     point_interfaces_;
 
+    /// \brief The communications of cells and points started by
+    ///        communicateBegin().
+    std::array<std::unique_ptr<PendingCommunicationBase>, 2> pending_communication_;
+
+    /// \brief Start the communication of data of a given codimension.
+    template<int codim, class DataHandle>
+    void communicateCodimBegin(DataHandle& data, CommunicationDirection dir,
+                               const InterfaceMap& interface);
+
+    /// \brief Finish the communication of data of a given codimension.
+    template<int codim, class DataHandle>
+    void communicateCodimEnd(DataHandle& data);
 #endif
 
     // Return the geometry vector corresponding to the given codim.
@@ -590,6 +843,31 @@ void CpGridData::communicateCodim(Entity2IndexDataHandle<DataHandle, codim>& dat
     else
         comm.backward(data_wrapper);
 }
+
+template<int codim, class DataHandle>
+void CpGridData::communicateCodimBegin(DataHandle& data_wrapper, CommunicationDirection dir,
+                                       const InterfaceMap& interface)
+{
+    typedef PendingCommunication<typename DataHandle::DataType> Pending;
+    std::unique_ptr<Pending> pending(new Pending);
+    // Use distinct tags for cells and points, such that both
+    // communications may be in flight at the same time.
+    pending->start(ccobj_, data_wrapper, interface, dir, 8143 + codim);
+    pending_communication_[codim == 0 ? 0 : 1] = std::move(pending);
+}
+
+template<int codim, class DataHandle>
+void CpGridData::communicateCodimEnd(DataHandle& data_wrapper)
+{
+    typedef PendingCommunication<typename DataHandle::DataType> Pending;
+    auto& pending = pending_communication_[codim == 0 ? 0 : 1];
+    if (pending)
+    {
+        // Variable size data was already communicated in communicateBegin().
+        static_cast<Pending&>(*pending).finish(data_wrapper);
+        pending.reset();
+    }
+}
 #endif
 
 template<class DataHandle>
@@ -614,6 +892,96 @@ void CpGridData::communicate(DataHandle& data, InterfaceType iftype,
     (void) dir;
 #endif
 }
+
+template<class DataHandle>
+void CpGridData::communicateBegin(DataHandle& data, InterfaceType iftype,
+                                  CommunicationDirection dir)
+{
+    if (communication_pending_)
+    {
+        OPM_THROW(std::logic_error, "communicateBegin() called while another communication is pending");
+    }
+    communication_pending_ = true;
+#if HAVE_MPI
+    if(data.contains(3,0))
+    {
+        Entity2IndexDataHandle<DataHandle, 0> data_wrapper(*this, data);
+        if (data_wrapper.fixedsize())
+            communicateCodimBegin<0>(data_wrapper, dir, getInterface(iftype, cell_interfaces_).interfaces());
+        else
+            communicateCodim<0>(data_wrapper, dir, getInterface(iftype, cell_interfaces_));
+    }
+    if(data.contains(3,3))
+    {
+        Entity2IndexDataHandle<DataHandle, 3> data_wrapper(*this, data);
+        if (data_wrapper.fixedsize())
+            communicateCodimBegin<3>(data_wrapper, dir, getInterface(iftype, point_interfaces_));
+        else
+            communicateCodim<3>(data_wrapper, dir, getInterface(iftype, point_interfaces_));
+    }
+#else
+    // Suppress warnings for unused arguments.
+    (void) data;
+    (void) iftype;
+    (void) dir;
+#endif
+}
+
+template<class DataHandle>
+void CpGridData::communicateEnd(DataHandle& data, InterfaceType iftype,
+                                CommunicationDirection dir)
+{
+    if (!communication_pending_)
+    {
+        OPM_THROW(std::logic_error, "communicateEnd() called without communicateBegin()");
+    }
+    communication_pending_ = false;
+    // The interface and direction were already used by communicateBegin().
+    (void) iftype;
+    (void) dir;
+#if HAVE_MPI
+    if(data.contains(3,0))
+    {
+        Entity2IndexDataHandle<DataHandle, 0> data_wrapper(*this, data);
+        communicateCodimEnd<0>(data_wrapper);
+    }
+    if(data.contains(3,3))
+    {
+        Entity2IndexDataHandle<DataHandle, 3> data_wrapper(*this, data);
+        communicateCodimEnd<3>(data_wrapper);
+    }
+#else
+    (void) data;
+#endif
+}
+
+template<class T>
+std::unique_ptr<HaloExchangePlan<T> >
+CpGridData::haloExchangePlan(InterfaceType iftype, int codim, std::size_t values_per_entity,
+                             CommunicationDirection dir)
+{
+    if (codim != 0 && codim != 3)
+    {
+        OPM_THROW(std::logic_error, "Halo exchange is only supported for cells and points");
+    }
+#if HAVE_MPI
+    if (codim == 0)
+    {
+        return std::unique_ptr<HaloExchangePlan<T> >(
+            new HaloExchangePlan<T>(ccobj_, getInterface(iftype, cell_interfaces_).interfaces(),
+                                    values_per_entity, dir));
+    }
+    return std::unique_ptr<HaloExchangePlan<T> >(
+        new HaloExchangePlan<T>(ccobj_, getInterface(iftype, point_interfaces_),
+                                values_per_entity, dir));
+#else
+    // Suppress warnings for unused arguments.
+    (void) iftype;
+    (void) values_per_entity;
+    (void) dir;
+    return std::unique_ptr<HaloExchangePlan<T> >(new HaloExchangePlan<T>());
+#endif
+}
 }}
 
 #if HAVE_MPI
@@ -755,11 +1123,41 @@ void CpGridData::scatterData(DataHandle& data, CpGridData* global_data,
     }
     if(data.contains(3,3))
     {
+        // Only the non-root processes can detect a missing global grid,
+        // but all of them need to throw.
+        if(ccobj_.max(int(global_data->size(0) < distributed_data->size(0))))
+            OPM_THROW(std::runtime_error, "Scattering point data is only supported if the"
+                      << " global grid is present on all processes.");
         scatterCodimData<3>(data, global_data, distributed_data);
     }
 #endif
 }
 
+template<class DataHandle>
+void CpGridData::migrateData(DataHandle& data, CpGridData* old_data, CpGridData* new_data,
+                             const InterfaceMap& migration,
+                             const std::vector<std::pair<int,int> >& local_moves)
+{
+#if HAVE_MPI
+    if(data.contains(3,3))
+        OPM_THROW(std::runtime_error, "Migrating point data during repartitioning is not supported.");
+    if(data.contains(3,0))
+    {
+        mover::Mover<DataHandle,0> mover(data, old_data, new_data);
+        for(const auto& move: local_moves)
+            mover(move.first, move.second);
+        Entity2IndexDataHandle<DataHandle, 0> data_wrapper(*old_data, *new_data, data);
+        communicateCodim<0>(data_wrapper, ForwardCommunication, migration);
+    }
+#else
+    (void) data;
+    (void) old_data;
+    (void) new_data;
+    (void) migration;
+    (void) local_moves;
+#endif
+}
+
 template<int codim, class DataHandle>
 void CpGridData::scatterCodimData(DataHandle& data, CpGridData* global_data,
                           CpGridData* distributed_data)
@@ -930,6 +1328,11 @@ void CpGridData::gatherCodimData(DataHandle& data, CpGridData* global_data,
                    &(global_data_buffer.buffer_[0]), &(no_data_send[0]), &(displ[0]),
                    MPITraits<typename DataHandle::DataType>::getType(),
                    distributed_data->ccobj_);
+    if ( global_data->size(0) == 0 )
+    {
+        // The global grid is only present on the root process.
+        return;
+    }
     Entity2IndexDataHandle<DataHandle, codim> edata(*global_data, data);
     int offset=0;
     for(int i=0; i< codim; ++i)
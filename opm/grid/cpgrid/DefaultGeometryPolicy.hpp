@@ -39,6 +39,9 @@ along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 #include "Geometry.hpp"
 #include "EntityRep.hpp"
 
+#include <array>
+#include <vector>
+
 namespace Dune
 {
     namespace cpgrid
@@ -77,6 +80,71 @@ namespace Dune
                 return geomVector(std::integral_constant<int,codim>());
             }
 
+            /// \brief Recompute the contiguous geometry arrays.
+            ///
+            /// Has to be called whenever the cell or face geometries or the
+            /// face normals have changed.
+            /// \param face_normals The unit normals of the faces.
+            void updateGeometryArrays(const EntityVariableBase<FieldVector<double, 3> >& face_normals)
+            {
+                const int num_cells = cell_geom_.size();
+                for (auto& coord : cell_centroids_) {
+                    coord.resize(num_cells);
+                }
+                cell_volumes_.resize(num_cells);
+                for (int c = 0; c < num_cells; ++c) {
+                    const auto& geom = cell_geom_.get(c);
+                    const auto& center = geom.center();
+                    for (int d = 0; d < 3; ++d) {
+                        cell_centroids_[d][c] = center[d];
+                    }
+                    cell_volumes_[c] = geom.volume();
+                }
+
+                const int num_faces = face_geom_.size();
+                for (int d = 0; d < 3; ++d) {
+                    face_centroids_[d].resize(num_faces);
+                    face_normals_[d].resize(num_faces);
+                }
+                face_areas_.resize(num_faces);
+                for (int f = 0; f < num_faces; ++f) {
+                    const auto& geom = face_geom_.get(f);
+                    const auto& center = geom.center();
+                    const auto& normal = face_normals.get(f);
+                    for (int d = 0; d < 3; ++d) {
+                        face_centroids_[d][f] = center[d];
+                        face_normals_[d][f] = normal[d];
+                    }
+                    face_areas_[f] = geom.volume();
+                }
+            }
+
+            /// \brief Coordinate d of the cell centroids (one value per cell).
+            const std::vector<double>& cellCentroids(int d) const
+            {
+                return cell_centroids_[d];
+            }
+            /// \brief The cell volumes (one value per cell).
+            const std::vector<double>& cellVolumes() const
+            {
+                return cell_volumes_;
+            }
+            /// \brief Coordinate d of the face centroids (one value per face).
+            const std::vector<double>& faceCentroids(int d) const
+            {
+                return face_centroids_[d];
+            }
+            /// \brief The face areas (one value per face).
+            const std::vector<double>& faceAreas() const
+            {
+                return face_areas_;
+            }
+            /// \brief Component d of the unit face normals (one value per face).
+            const std::vector<double>& faceNormals(int d) const
+            {
+                return face_normals_[d];
+            }
+
         private:
             /// \brief Get cell geometry
             const EntityVariable<cpgrid::Geometry<3, 3>, 0>& geomVector(const std::integral_constant<int, 0>&) const
@@ -115,6 +183,13 @@ namespace Dune
             EntityVariable<cpgrid::Geometry<3, 3>, 0> cell_geom_;
             EntityVariable<cpgrid::Geometry<2, 3>, 1> face_geom_;
             EntityVariable<cpgrid::Geometry<0, 3>, 3> point_geom_;
+            // Structure of arrays copies of the cell and face geometries
+            // for loops that only need some of the quantities.
+            std::array<std::vector<double>, 3> cell_centroids_;
+            std::vector<double> cell_volumes_;
+            std::array<std::vector<double>, 3> face_centroids_;
+            std::vector<double> face_areas_;
+            std::array<std::vector<double>, 3> face_normals_;
         };
 
 
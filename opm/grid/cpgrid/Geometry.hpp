@@ -315,6 +315,10 @@ namespace Dune
 
             /// Mapping from the cell to the reference domain.
             /// May be slow.
+            /// Newton's method is stopped after 100 iterations. If it has not
+            /// converged by then, e.g. for a point far outside a distorted
+            /// cell, the last iterate is returned without notice. Callers that
+            /// need an accurate result should compare global() of it with y.
             LocalCoordinate local(const GlobalCoordinate& y) const
             {
                 static_assert(mydimension == 3, "");
@@ -330,6 +334,10 @@ namespace Dune
 #endif
                 LocalCoordinate x = refElement.position(0,0);
                 LocalCoordinate dx;
+                // Bound the iterations, the point may lie far outside a
+                // distorted cell where Newton's method does not converge.
+                const int max_iterations = 100;
+                int iteration = 0;
                 do {
                     // DF^n dx^n = F^n, x^{n+1} -= dx^n
                     JacobianTransposed JT = jacobianTransposed(x);
@@ -337,7 +345,7 @@ namespace Dune
                     z -= y;
                     MatrixHelperType::template xTRightInvA<3, 3>(JT, z, dx );
                     x -= dx;
-                } while (dx.two_norm2() > epsilon*epsilon);
+                } while (dx.two_norm2() > epsilon*epsilon && ++iteration < max_iterations);
                 return x;
             }
 
@@ -0,0 +1,270 @@
+/*
+  This file is part of The Open Porous Media project  (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef OPM_CPGRID_HALOEXCHANGEPLAN_HEADER
+#define OPM_CPGRID_HALOEXCHANGEPLAN_HEADER
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <opm/common/ErrorMacros.hpp>
+
+#include <dune/grid/common/gridenums.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Dune
+{
+namespace cpgrid
+{
+
+/// \brief A reusable plan for exchanging fixed-size data along a
+///        communication interface of a CpGrid.
+///
+/// The plan is set up once for an interface, a codimension, a data type
+/// and the number of values per entity. It stores the send and receive
+/// index lists of all neighbouring processes in flat arrays, owns the
+/// packed message buffers and uses persistent MPI requests. Each
+/// exchange therefore only packs, starts the requests, waits for them
+/// and unpacks, without any allocation or setup.
+///
+/// The data is a contiguous array with numValues() consecutive values
+/// for each entity, indexed by the local index of the entity (the cell
+/// index for codimension 0, the point index for codimension 3). Received
+/// values overwrite the local ones.
+///
+/// Creating a plan is a collective operation on the communicator of the
+/// grid. Plans are not copyable. Without MPI all operations are no-ops.
+///
+/// \tparam T The type of the values. Must be trivially copyable.
+template<class T>
+class HaloExchangePlan
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "HaloExchangePlan requires a trivially copyable data type");
+public:
+#if HAVE_MPI
+    /// \brief Set up a plan.
+    /// \param comm The communicator of the grid.
+    /// \param interface The interface map as used by VariableSizeCommunicator.
+    /// \param values_per_entity The number of values for each entity.
+    /// \param dir The direction of the communication along the interface.
+    template<class InterfaceMap>
+    HaloExchangePlan(MPI_Comm comm, const InterfaceMap& interface,
+                     std::size_t values_per_entity, CommunicationDirection dir)
+        : values_per_entity_(values_per_entity), active_(false)
+    {
+        send_start_.push_back(0);
+        recv_start_.push_back(0);
+        for (const auto& entry : interface)
+        {
+            const auto& send_list = (dir == ForwardCommunication) ? entry.second.first : entry.second.second;
+            const auto& recv_list = (dir == ForwardCommunication) ? entry.second.second : entry.second.first;
+            if (send_list.size() == 0 && recv_list.size() == 0)
+            {
+                continue;
+            }
+            ranks_.push_back(entry.first);
+            for (std::size_t i = 0; i < send_list.size(); ++i)
+            {
+                send_index_.push_back(send_list[i]);
+            }
+            for (std::size_t i = 0; i < recv_list.size(); ++i)
+            {
+                recv_index_.push_back(recv_list[i]);
+            }
+            send_start_.push_back(send_index_.size());
+            recv_start_.push_back(recv_index_.size());
+        }
+        // Check the sizes of all messages before the buffers and any MPI
+        // resources are acquired. All processes have to agree on the error,
+        // as the others would otherwise block in MPI_Comm_dup.
+        int too_large = 0;
+        for (std::size_t n = 0; n < ranks_.size(); ++n)
+        {
+            if (!fitsCount((recv_start_[n+1] - recv_start_[n]) * values_per_entity_) ||
+                !fitsCount((send_start_[n+1] - send_start_[n]) * values_per_entity_))
+            {
+                too_large = 1;
+            }
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &too_large, 1, MPI_INT, MPI_MAX, comm);
+        if (too_large)
+        {
+            OPM_THROW(std::overflow_error, "Message of HaloExchangePlan exceeds the MPI count limit");
+        }
+
+        send_buffer_.resize(send_index_.size() * values_per_entity_);
+        recv_buffer_.resize(recv_index_.size() * values_per_entity_);
+
+        // Use a private communicator such that messages of different
+        // plans that are in flight at the same time cannot be mixed up.
+        MPI_Comm_dup(comm, &comm_);
+
+        const int tag = 9874;
+        requests_.reserve(2 * ranks_.size());
+        for (std::size_t n = 0; n < ranks_.size(); ++n)
+        {
+            const std::size_t recv_count = (recv_start_[n+1] - recv_start_[n]) * values_per_entity_;
+            if (recv_count > 0)
+            {
+                requests_.emplace_back();
+                MPI_Recv_init(recv_buffer_.data() + recv_start_[n] * values_per_entity_,
+                              byteCount(recv_count), MPI_BYTE, ranks_[n], tag, comm_,
+                              &requests_.back());
+            }
+        }
+        for (std::size_t n = 0; n < ranks_.size(); ++n)
+        {
+            const std::size_t send_count = (send_start_[n+1] - send_start_[n]) * values_per_entity_;
+            if (send_count > 0)
+            {
+                requests_.emplace_back();
+                MPI_Send_init(send_buffer_.data() + send_start_[n] * values_per_entity_,
+                              byteCount(send_count), MPI_BYTE, ranks_[n], tag, comm_,
+                              &requests_.back());
+            }
+        }
+    }
+
+    ~HaloExchangePlan()
+    {
+        if (active_)
+        {
+            MPI_Waitall(requests_.size(), requests_.data(), MPI_STATUSES_IGNORE);
+        }
+        for (auto& request : requests_)
+        {
+            MPI_Request_free(&request);
+        }
+        MPI_Comm_free(&comm_);
+    }
+#else
+    HaloExchangePlan()
+        : values_per_entity_(1), active_(false)
+    {}
+#endif
+
+    HaloExchangePlan(const HaloExchangePlan&) = delete;
+    HaloExchangePlan& operator=(const HaloExchangePlan&) = delete;
+
+    /// \brief The number of values exchanged for each entity.
+    std::size_t numValues() const
+    {
+        return values_per_entity_;
+    }
+
+    /// \brief Pack the values to send and start the communication.
+    ///
+    /// The values must not be modified for the entities that are
+    /// received until end() has been called.
+    void begin(const T* values)
+    {
+        if (active_)
+        {
+            OPM_THROW(std::logic_error, "HaloExchangePlan::begin() called twice without end()");
+        }
+#if HAVE_MPI
+        const std::size_t n = values_per_entity_;
+        for (std::size_t i = 0; i < send_index_.size(); ++i)
+        {
+            const T* src = values + static_cast<std::size_t>(send_index_[i]) * n;
+            std::copy(src, src + n, send_buffer_.begin() + i * n);
+        }
+        if (!requests_.empty())
+        {
+            MPI_Startall(requests_.size(), requests_.data());
+        }
+#else
+        (void) values;
+#endif
+        active_ = true;
+    }
+
+    /// \brief Wait for the communication started by begin() and store
+    ///        the received values.
+    void end(T* values)
+    {
+        if (!active_)
+        {
+            OPM_THROW(std::logic_error, "HaloExchangePlan::end() called without begin()");
+        }
+#if HAVE_MPI
+        if (!requests_.empty())
+        {
+            MPI_Waitall(requests_.size(), requests_.data(), MPI_STATUSES_IGNORE);
+        }
+        const std::size_t n = values_per_entity_;
+        for (std::size_t i = 0; i < recv_index_.size(); ++i)
+        {
+            std::copy(recv_buffer_.begin() + i * n, recv_buffer_.begin() + (i + 1) * n,
+                      values + static_cast<std::size_t>(recv_index_[i]) * n);
+        }
+#else
+        (void) values;
+#endif
+        active_ = false;
+    }
+
+    /// \brief Exchange the values, i.e. begin() followed by end().
+    void exchange(T* values)
+    {
+        begin(values);
+        end(values);
+    }
+
+    /// \brief Exchange the values stored in a vector.
+    void exchange(std::vector<T>& values)
+    {
+        exchange(values.data());
+    }
+
+private:
+#if HAVE_MPI
+    static bool fitsCount(std::size_t count)
+    {
+        return count <= static_cast<std::size_t>(std::numeric_limits<int>::max()) / sizeof(T);
+    }
+
+    static int byteCount(std::size_t count)
+    {
+        return static_cast<int>(count * sizeof(T));
+    }
+
+    MPI_Comm comm_;
+    std::vector<int> ranks_;
+    std::vector<std::size_t> send_start_;
+    std::vector<std::size_t> recv_start_;
+    std::vector<int> send_index_;
+    std::vector<int> recv_index_;
+    std::vector<T> send_buffer_;
+    std::vector<T> recv_buffer_;
+    std::vector<MPI_Request> requests_;
+#endif
+    std::size_t values_per_entity_;
+    bool active_;
+};
+
+} // end namespace cpgrid
+} // end namespace Dune
+
+#endif
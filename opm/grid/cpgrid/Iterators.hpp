@@ -36,6 +36,8 @@ along with OPM.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef OPM_ITERATORS_HEADER
 #define OPM_ITERATORS_HEADER
 
+#include <algorithm>
+#include <utility>
 #include <dune/grid/common/gridenums.hh>
 #include "PartitionIteratorRule.hpp"
 #include <opm/grid/utility/ErrorMacros.hpp>
@@ -69,16 +71,26 @@ namespace Dune
             Iterator& operator++()
             {
                 EntityRep<cd>::increment();
-                if(rule_.fullSet || rule_.emptySet)
+                if(rule_.fullSet || rule_.emptySet || !range_)
                     return *this;
-                while(this->index()<noEntities_ && rule_.isInvalid(*this))
-                    EntityRep<cd>::increment();
+                // Jump to the start of the next range of the partition.
+                if(this->index()==range_->second)
+                {
+                    ++range_;
+                    this->setValue(range_!=rangeEnd_ ? range_->first : noEntities_,
+                                   this->orientation());
+                }
                 return *this;
             }
         private:
             /// \brief The number of Entities with codim cd.
             int noEntities_;
             PartitionIteratorRule<pitype> rule_;
+            /// \brief The index range of the partition containing the current
+            ///        entity, or nullptr if all entities are in the partition.
+            const std::pair<int,int>* range_;
+            /// \brief The end of the index ranges of the partition.
+            const std::pair<int,int>* rangeEnd_;
         };
 
 
@@ -151,13 +163,25 @@ Iterator<cd, pitype>::Iterator(const CpGridData& grid, int index, bool orientati
                         // If the partition is empty, goto to end iterator!
                         EntityRep<cd>(PartitionIteratorRule<pitype>::emptySet?grid.size(cd):index,
                                       orientation)),
-      noEntities_(grid.size(cd))
+      noEntities_(grid.size(cd)), range_(nullptr), rangeEnd_(nullptr)
 {
     if(rule_.fullSet || rule_.emptySet)
         return;
 
-    while(this->index()<noEntities_ && rule_.isInvalid(*this))
-        EntityRep<cd>::increment();
+    const auto* ranges = grid.partitionIndexRanges(cd, pitype);
+    if(!ranges)
+        return;
+    rangeEnd_ = ranges->data() + ranges->size();
+    // The first range that ends after index.
+    range_ = std::upper_bound(ranges->data(), rangeEnd_, this->index(),
+                              [](int i, const std::pair<int,int>& range)
+                              {
+                                  return i < range.second;
+                              });
+    if(range_==rangeEnd_)
+        this->setValue(noEntities_, orientation);
+    else if(this->index()<range_->first)
+        this->setValue(range_->first, orientation);
 }
 }}
 
@@ -0,0 +1,173 @@
+/*
+  This file is part of The Open Porous Media project  (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef OPM_CPGRID_PENDINGCOMMUNICATION_HEADER
+#define OPM_CPGRID_PENDINGCOMMUNICATION_HEADER
+
+#if HAVE_MPI
+#include <mpi.h>
+
+#include <opm/common/ErrorMacros.hpp>
+
+#include <dune/grid/common/gridenums.hh>
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace Dune
+{
+namespace cpgrid
+{
+
+/// \brief Type independent base of PendingCommunication.
+class PendingCommunicationBase
+{
+public:
+    virtual ~PendingCommunicationBase()
+    {}
+};
+
+/// \brief The state of a started, but not yet finished, exchange of
+///        fixed-size data of one codimension.
+///
+/// The data of the entities to send is gathered into one buffer per
+/// neighbouring process and the messages are sent and received with
+/// non-blocking MPI calls by start(). finish() waits for the messages
+/// and scatters the received data.
+///
+/// \tparam T The data type of the data handle.
+template<class T>
+class PendingCommunication : public PendingCommunicationBase
+{
+    /// \brief Message buffer passed to gather and scatter of the data handle.
+    class Buffer
+    {
+    public:
+        explicit Buffer(std::vector<T>& data)
+            : data_(data), index_(0)
+        {}
+        void write(const T& value)
+        {
+            data_.push_back(value);
+        }
+        void read(T& value)
+        {
+            value = data_[index_++];
+        }
+    private:
+        std::vector<T>& data_;
+        std::size_t index_;
+    };
+
+public:
+    ~PendingCommunication()
+    {
+        if (!requests_.empty())
+        {
+            // Never leave requests that reference our buffers behind.
+            MPI_Waitall(requests_.size(), requests_.data(), MPI_STATUSES_IGNORE);
+        }
+    }
+
+    /// \brief Gather the data to send and start sending and receiving.
+    /// \param comm The communicator to use.
+    /// \param data The data handle mapping entity indices to data. Must
+    ///        have a fixed size.
+    /// \param interface The interface map as used by VariableSizeCommunicator.
+    /// \param dir The direction of the communication.
+    /// \param tag The tag of the messages.
+    template<class DataHandle, class InterfaceMap>
+    void start(MPI_Comm comm, DataHandle& data, const InterfaceMap& interface,
+               CommunicationDirection dir, int tag)
+    {
+        for (const auto& entry : interface)
+        {
+            const auto& send_list = (dir == ForwardCommunication) ? entry.second.first : entry.second.second;
+            const auto& recv_list = (dir == ForwardCommunication) ? entry.second.second : entry.second.first;
+            if (send_list.size() > 0)
+            {
+                send_buffers_.emplace_back();
+                auto& send_data = send_buffers_.back();
+                send_data.reserve(send_list.size() * data.size(send_list[0]));
+                Buffer buffer(send_data);
+                for (std::size_t i = 0; i < send_list.size(); ++i)
+                {
+                    data.gather(buffer, send_list[i]);
+                }
+                requests_.emplace_back();
+                MPI_Isend(send_data.data(), byteCount(send_data.size()), MPI_BYTE,
+                          entry.first, tag, comm, &requests_.back());
+            }
+            if (recv_list.size() > 0)
+            {
+                recv_buffers_.emplace_back(recv_list.size() * data.size(recv_list[0]));
+                recv_indices_.emplace_back(recv_list.size());
+                for (std::size_t i = 0; i < recv_list.size(); ++i)
+                {
+                    recv_indices_.back()[i] = recv_list[i];
+                }
+                requests_.emplace_back();
+                MPI_Irecv(recv_buffers_.back().data(), byteCount(recv_buffers_.back().size()),
+                          MPI_BYTE, entry.first, tag, comm, &requests_.back());
+            }
+        }
+    }
+
+    /// \brief Wait for the messages and scatter the received data.
+    template<class DataHandle>
+    void finish(DataHandle& data)
+    {
+        if (!requests_.empty())
+        {
+            MPI_Waitall(requests_.size(), requests_.data(), MPI_STATUSES_IGNORE);
+            requests_.clear();
+        }
+        for (std::size_t n = 0; n < recv_buffers_.size(); ++n)
+        {
+            const auto& indices = recv_indices_[n];
+            const std::size_t size = recv_buffers_[n].size() / indices.size();
+            Buffer buffer(recv_buffers_[n]);
+            for (const int index : indices)
+            {
+                data.scatter(buffer, index, size);
+            }
+        }
+    }
+
+private:
+    static int byteCount(std::size_t count)
+    {
+        const std::size_t bytes = count * sizeof(T);
+        if (bytes > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+        {
+            OPM_THROW(std::overflow_error, "Message size exceeds the MPI count limit");
+        }
+        return static_cast<int>(bytes);
+    }
+
+    std::vector<std::vector<T> > send_buffers_;
+    std::vector<std::vector<T> > recv_buffers_;
+    std::vector<std::vector<int> > recv_indices_;
+    std::vector<MPI_Request> requests_;
+};
+
+} // end namespace cpgrid
+} // end namespace Dune
+
+#endif // HAVE_MPI
+#endif
@@ -0,0 +1,573 @@
+//===========================================================================
+//
+// File: binaryCacheFormat.cpp
+//
+// Created: Fri Oct 16 2026
+//
+//===========================================================================
+
+/*
+  This file is part of The Open Porous Media project  (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <opm/grid/utility/ErrorMacros.hpp>
+#include <opm/grid/cpgpreprocess/preprocess.h>
+#include "CpGridData.hpp"
+
+namespace Dune
+{
+
+    namespace
+    {
+        // Layout of a cache file:
+        //   CacheHeader
+        //   a sequence of blocks, each consisting of a std::uint64_t
+        //   byte count followed by the raw data, padded to a multiple
+        //   of eight bytes.
+        // All data is stored in native byte order; the endianness
+        // marker is used to reject files written on other platforms.
+        const char cache_magic[8] = { 'O', 'P', 'M', 'C', 'P', 'G', 'R', 'D' };
+        const std::uint32_t cache_version = 1;
+        const std::uint32_t cache_endian_marker = 0x01020304;
+
+        struct CacheHeader
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t endian_marker;
+            std::uint64_t input_hash;
+            std::uint64_t file_size;
+        };
+
+        std::size_t paddedSize(std::size_t bytes)
+        {
+            return (bytes + 7) & ~std::size_t(7);
+        }
+
+        /// Read-only memory mapping of a whole file.
+        class MappedFile
+        {
+        public:
+            explicit MappedFile(const std::string& filename)
+                : data_(nullptr), size_(0)
+            {
+                const int fd = ::open(filename.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    return;
+                }
+                struct stat st;
+                if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                    void* addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (addr != MAP_FAILED) {
+                        data_ = static_cast<const char*>(addr);
+                        size_ = st.st_size;
+                    }
+                }
+                ::close(fd);
+            }
+            ~MappedFile()
+            {
+                if (data_) {
+                    ::munmap(const_cast<char*>(data_), size_);
+                }
+            }
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            const char* data() const
+            {
+                return data_;
+            }
+            std::size_t size() const
+            {
+                return size_;
+            }
+        private:
+            const char* data_;
+            std::size_t size_;
+        };
+
+        /// Sequential writer of cache blocks.
+        class CacheWriter
+        {
+        public:
+            CacheWriter(const std::string& filename, std::uint64_t input_hash)
+                : filename_(filename), file_(filename.c_str(), std::ios::binary | std::ios::trunc)
+            {
+                if (!file_) {
+                    OPM_THROW(std::runtime_error, "Could not open file " << filename);
+                }
+                CacheHeader header;
+                std::memcpy(header.magic, cache_magic, sizeof(cache_magic));
+                header.version = cache_version;
+                header.endian_marker = cache_endian_marker;
+                header.input_hash = input_hash;
+                header.file_size = 0; // Set in finish().
+                file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            }
+
+            template <typename T>
+            void writeBlock(const T* data, std::size_t num)
+            {
+                const std::uint64_t bytes = num * sizeof(T);
+                const char padding[8] = { 0 };
+                file_.write(reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+                if (bytes > 0) {
+                    file_.write(reinterpret_cast<const char*>(data), bytes);
+                }
+                file_.write(padding, paddedSize(bytes) - bytes);
+            }
+
+            template <typename T>
+            void writeBlock(const std::vector<T>& data)
+            {
+                writeBlock(data.data(), data.size());
+            }
+
+            /// Write the final file size into the header. A file with a
+            /// wrong size (e.g. from an interrupted write) is rejected
+            /// when read.
+            void finish()
+            {
+                const std::uint64_t file_size = file_.tellp();
+                file_.seekp(offsetof(CacheHeader, file_size));
+                file_.write(reinterpret_cast<const char*>(&file_size), sizeof(file_size));
+                file_.flush();
+                if (!file_) {
+                    OPM_THROW(std::runtime_error, "Failed writing file " << filename_);
+                }
+            }
+        private:
+            std::string filename_;
+            std::ofstream file_;
+        };
+
+        /// Sequential reader of cache blocks from a mapped file.
+        /// A block that does not fit into the file is reported as
+        /// missing (a null pointer), never by an exception.
+        class CacheReader
+        {
+        public:
+            explicit CacheReader(const MappedFile& file)
+                : file_(file), pos_(sizeof(CacheHeader))
+            {
+            }
+
+            /// Return a pointer to the next block and its number of
+            /// elements, or null if the file is corrupt.
+            template <typename T>
+            const T* nextBlock(std::size_t& num)
+            {
+                std::uint64_t bytes;
+                num = 0;
+                if (pos_ + sizeof(bytes) > file_.size()) {
+                    return nullptr;
+                }
+                std::memcpy(&bytes, file_.data() + pos_, sizeof(bytes));
+                pos_ += sizeof(bytes);
+                if (bytes % sizeof(T) != 0 || bytes > file_.size() - pos_
+                    || pos_ + paddedSize(bytes) > file_.size()) {
+                    return nullptr;
+                }
+                const T* data = reinterpret_cast<const T*>(file_.data() + pos_);
+                pos_ += paddedSize(bytes);
+                num = bytes / sizeof(T);
+                return data;
+            }
+
+            template <typename T>
+            bool readBlock(std::vector<T>& values)
+            {
+                std::size_t num;
+                const T* data = nextBlock<T>(num);
+                if (!data) {
+                    return false;
+                }
+                values.assign(data, data + num);
+                return true;
+            }
+
+            template <typename T>
+            bool readBlock(T* values, std::size_t num)
+            {
+                std::size_t num_in_file;
+                const T* data = nextBlock<T>(num_in_file);
+                if (!data || num_in_file != num) {
+                    return false;
+                }
+                std::copy(data, data + num, values);
+                return true;
+            }
+        private:
+            const MappedFile& file_;
+            std::size_t pos_;
+        };
+
+        template <typename T, class F>
+        void writeTable(CacheWriter& writer, const Opm::SparseTable<T>& table, F&& toInt)
+        {
+            std::vector<int> row_sizes(table.size());
+            std::vector<int> data;
+            data.reserve(table.dataSize());
+            for (int row = 0; row < table.size(); ++row) {
+                row_sizes[row] = table.rowSize(row);
+                for (const auto& entry : table[row]) {
+                    data.push_back(toInt(entry));
+                }
+            }
+            writer.writeBlock(row_sizes);
+            writer.writeBlock(data);
+        }
+
+        /// Read a table. Returns false for corrupt data.
+        template <typename T, class F>
+        bool readTable(CacheReader& reader, Opm::SparseTable<T>& table, F&& fromInt)
+        {
+            std::size_t num_rows, num_data;
+            const int* row_sizes = reader.nextBlock<int>(num_rows);
+            const int* data = reader.nextBlock<int>(num_data);
+            if (!row_sizes || !data) {
+                return false;
+            }
+            std::size_t total = 0;
+            for (std::size_t row = 0; row < num_rows; ++row) {
+                if (row_sizes[row] < 0) {
+                    return false;
+                }
+                total += row_sizes[row];
+            }
+            if (total != num_data) {
+                return false;
+            }
+            std::vector<T> entries(num_data);
+            for (std::size_t i = 0; i < num_data; ++i) {
+                entries[i] = fromInt(data[i]);
+            }
+            table.assign(entries.begin(), entries.end(), row_sizes, row_sizes + num_rows);
+            return true;
+        }
+
+        // The EntityRep encoding (~index for negative orientation) is
+        // used as is. This keeps the INT_MAX marker of missing
+        // neighbours in face_to_cell_ intact.
+        template <int codim>
+        int encodeEntity(const cpgrid::EntityRep<codim>& e)
+        {
+            return e.orientation() ? e.index() : ~e.index();
+        }
+
+        template <int codim>
+        cpgrid::EntityRep<codim> decodeEntity(int value)
+        {
+            return value >= 0 ? cpgrid::EntityRep<codim>(value, true)
+                              : cpgrid::EntityRep<codim>(~value, false);
+        }
+
+        /// 64 bit FNV-1a hash.
+        class ContentHash
+        {
+        public:
+            ContentHash()
+                : hash_(14695981039346656037ULL)
+            {
+            }
+            void add(const void* data, std::size_t bytes)
+            {
+                const unsigned char* p = static_cast<const unsigned char*>(data);
+                for (std::size_t i = 0; i < bytes; ++i) {
+                    hash_ ^= p[i];
+                    hash_ *= 1099511628211ULL;
+                }
+            }
+            std::uint64_t value() const
+            {
+                return hash_;
+            }
+        private:
+            std::uint64_t hash_;
+        };
+
+    } // anon namespace
+
+
+
+    std::uint64_t cpgrid::CpGridData::inputHash(const grdecl& input_data,
+                                                const std::array<std::set<std::pair<int, int>>, 2>& nnc,
+                                                double z_tolerance, bool remove_ij_boundary,
+                                                bool turn_normals)
+    {
+        const std::size_t nx = input_data.dims[0];
+        const std::size_t ny = input_data.dims[1];
+        const std::size_t nz = input_data.dims[2];
+        ContentHash hash;
+        // A new version of the format invalidates all existing caches.
+        hash.add(&cache_version, sizeof(cache_version));
+        hash.add(input_data.dims, sizeof(input_data.dims));
+        hash.add(input_data.coord, 6*(nx + 1)*(ny + 1)*sizeof(double));
+        hash.add(input_data.zcorn, 8*nx*ny*nz*sizeof(double));
+        const char has_actnum = input_data.actnum != nullptr;
+        hash.add(&has_actnum, 1);
+        if (has_actnum) {
+            hash.add(input_data.actnum, nx*ny*nz*sizeof(int));
+        }
+        // The processing options.
+        hash.add(&z_tolerance, sizeof(z_tolerance));
+        const char flags[2] = { remove_ij_boundary, turn_normals };
+        hash.add(flags, sizeof(flags));
+        for (const auto& connections : nnc) {
+            const std::uint64_t num = connections.size();
+            hash.add(&num, sizeof(num));
+            for (const auto& cells : connections) {
+                hash.add(&cells.first, sizeof(cells.first));
+                hash.add(&cells.second, sizeof(cells.second));
+            }
+        }
+        return hash.value();
+    }
+
+
+
+    /// Write the binary grid cache format.
+    void cpgrid::CpGridData::writeBinaryCache(const std::string& filename, std::uint64_t input_hash) const
+    {
+        CacheWriter writer(filename, input_hash);
+
+        // Topology.
+        writer.writeBlock(logical_cartesian_size_.data(), 3);
+        writeTable(writer, static_cast<const Opm::SparseTable<EntityRep<1> >&>(cell_to_face_),
+                   encodeEntity<1>);
+        writeTable(writer, static_cast<const Opm::SparseTable<EntityRep<0> >&>(face_to_cell_),
+                   encodeEntity<0>);
+        writeTable(writer, face_to_point_, [](int p) { return p; });
+        writer.writeBlock(cell_to_point_);
+        writer.writeBlock(global_cell_);
+        std::vector<int> tags(face_tag_.begin(), face_tag_.end());
+        writer.writeBlock(tags);
+        writer.writeBlock(static_cast<const std::vector<int>&>(unique_boundary_ids_));
+        writer.writeBlock(zcorn);
+
+        // Geometry, stored as plain doubles.
+        std::vector<double> values;
+        values.reserve(3*face_normals_.size());
+        for (const auto& n : face_normals_) {
+            values.insert(values.end(), n.begin(), n.end());
+        }
+        writer.writeBlock(values);
+        const auto& point_geom = geometry_.geomVector<3>();
+        values.clear();
+        for (const auto& g : point_geom) {
+            values.insert(values.end(), g.center().begin(), g.center().end());
+        }
+        writer.writeBlock(values);
+        const auto& face_geom = geometry_.geomVector<1>();
+        values.clear();
+        for (const auto& g : face_geom) {
+            values.insert(values.end(), g.center().begin(), g.center().end());
+            values.push_back(g.volume());
+        }
+        writer.writeBlock(values);
+        const auto& cell_geom = geometry_.geomVector<0>();
+        values.clear();
+        for (const auto& g : cell_geom) {
+            values.insert(values.end(), g.center().begin(), g.center().end());
+            values.push_back(g.volume());
+        }
+        writer.writeBlock(values);
+
+        writer.finish();
+    }
+
+
+
+    /// Read the binary grid cache format.
+    bool cpgrid::CpGridData::readBinaryCache(const std::string& filename, std::uint64_t input_hash)
+    {
+        MappedFile file(filename);
+        if (!file.data() || file.size() < sizeof(CacheHeader)) {
+            return false;
+        }
+        CacheHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0
+            || header.version != cache_version
+            || header.endian_marker != cache_endian_marker
+            || header.input_hash != input_hash
+            || header.file_size != file.size()) {
+            return false;
+        }
+
+        // Everything is decoded into temporaries first and only moved
+        // into the grid once the whole file turned out to be valid.
+        CacheReader reader(file);
+        std::array<int, 3> logical_cartesian_size;
+        OrientedEntityTable<0, 1> cell_to_face;
+        OrientedEntityTable<1, 0> face_to_cell;
+        Opm::SparseTable<int> face_to_point;
+        std::vector<std::array<int,8> > cell_to_point;
+        std::vector<int> global_cell;
+        std::vector<int> unique_boundary_ids;
+        std::vector<double> zcorn_values;
+        std::size_t num, num_normals, num_points, num_faces, num_cells;
+        const int* tags = nullptr;
+        const double* normal_values = nullptr;
+        const double* point_values = nullptr;
+        const double* face_values = nullptr;
+        const double* cell_values = nullptr;
+
+        // The number of faces and points is only known from the
+        // geometry blocks, so the indices are checked afterwards.
+        auto& cell_to_face_table = static_cast<Opm::SparseTable<EntityRep<1> >&>(cell_to_face);
+        auto& face_to_cell_table = static_cast<Opm::SparseTable<EntityRep<0> >&>(face_to_cell);
+        if (!reader.readBlock(logical_cartesian_size.data(), 3)
+            || !readTable(reader, cell_to_face_table, decodeEntity<1>)
+            || !readTable(reader, face_to_cell_table,
+                          [](int value)
+                          {
+                              return value == std::numeric_limits<int>::max() ?
+                                  EntityRep<0>(value, true) : decodeEntity<0>(value);
+                          })
+            || !readTable(reader, face_to_point, [](int p) { return p; })
+            || !reader.readBlock(cell_to_point)
+            || !reader.readBlock(global_cell)
+            || !(tags = reader.nextBlock<int>(num))
+            || !reader.readBlock(unique_boundary_ids)
+            || !reader.readBlock(zcorn_values)
+            || !(normal_values = reader.nextBlock<double>(num_normals))
+            || !(point_values = reader.nextBlock<double>(num_points))
+            || !(face_values = reader.nextBlock<double>(num_faces))
+            || !(cell_values = reader.nextBlock<double>(num_cells))) {
+            return false;
+        }
+        num_normals /= 3;
+        num_points /= 3;
+        num_faces /= 4;
+        num_cells /= 4;
+
+        // Consistency of the sizes and of all indices.
+        auto inRange = [](int index, std::size_t bound)
+        {
+            return index >= 0 && static_cast<std::size_t>(index) < bound;
+        };
+        if (cell_to_face_table.size() != static_cast<int>(num_cells)
+            || cell_to_point.size() != num_cells
+            || global_cell.size() != num_cells
+            || face_to_cell_table.size() != static_cast<int>(num_faces)
+            || face_to_point.size() != static_cast<int>(num_faces)
+            || num != num_faces || num_normals != num_faces
+            || (!unique_boundary_ids.empty() && unique_boundary_ids.size() != num_faces)) {
+            return false;
+        }
+        for (int cell = 0; cell < cell_to_face_table.size(); ++cell) {
+            for (const auto& face : cell_to_face_table[cell]) {
+                if (!inRange(face.index(), num_faces)) {
+                    return false;
+                }
+            }
+        }
+        for (int face = 0; face < face_to_cell_table.size(); ++face) {
+            for (const auto& cell : face_to_cell_table[face]) {
+                if (cell.index() != std::numeric_limits<int>::max()
+                    && !inRange(cell.index(), num_cells)) {
+                    return false;
+                }
+            }
+            for (int point : face_to_point[face]) {
+                if (!inRange(point, num_points)) {
+                    return false;
+                }
+            }
+        }
+        for (const auto& corners : cell_to_point) {
+            for (int point : corners) {
+                if (!inRange(point, num_points)) {
+                    return false;
+                }
+            }
+        }
+
+        // Geometry.
+        EntityVariable<enum face_tag, 1> face_tags;
+        auto& face_tag_vector = static_cast<std::vector<enum face_tag>&>(face_tags);
+        face_tag_vector.resize(num_faces);
+        for (std::size_t i = 0; i < num_faces; ++i) {
+            face_tag_vector[i] = static_cast<enum face_tag>(tags[i]);
+        }
+        SignedEntityVariable<PointType, 1> face_normals;
+        auto& normals = static_cast<std::vector<PointType>&>(face_normals);
+        normals.resize(num_faces);
+        for (std::size_t i = 0; i < num_faces; ++i, normal_values += 3) {
+            normals[i] = { normal_values[0], normal_values[1], normal_values[2] };
+        }
+        EntityVariable<cpgrid::Geometry<0, 3>, 3> point_geom;
+        point_geom.reserve(num_points);
+        for (std::size_t i = 0; i < num_points; ++i, point_values += 3) {
+            point_geom.emplace_back(PointType{ point_values[0], point_values[1], point_values[2] });
+        }
+        EntityVariable<cpgrid::Geometry<2, 3>, 1> face_geom;
+        face_geom.reserve(num_faces);
+        for (std::size_t i = 0; i < num_faces; ++i, face_values += 4) {
+            face_geom.emplace_back(PointType{ face_values[0], face_values[1], face_values[2] },
+                                   face_values[3]);
+        }
+        // The cell geometries refer to the data of the point geometries
+        // and of cell_to_point, which stays in place when moved below.
+        EntityVariable<cpgrid::Geometry<3, 3>, 0> cell_geom;
+        cell_geom.reserve(num_cells);
+        for (std::size_t i = 0; i < num_cells; ++i, cell_values += 4) {
+            cell_geom.emplace_back(PointType{ cell_values[0], cell_values[1], cell_values[2] },
+                                   cell_values[3], point_geom, cell_to_point[i].data());
+        }
+
+        // Commit.
+        cell_connections_.reset();
+        interior_cell_split_.reset();
+        logical_cartesian_size_ = logical_cartesian_size;
+        cell_to_face_ = std::move(cell_to_face);
+        face_to_cell_ = std::move(face_to_cell);
+        face_to_point_ = std::move(face_to_point);
+        cell_to_point_ = std::move(cell_to_point);
+        global_cell_ = std::move(global_cell);
+        face_tag_ = std::move(face_tags);
+        static_cast<std::vector<int>&>(unique_boundary_ids_) = std::move(unique_boundary_ids);
+        zcorn = std::move(zcorn_values);
+        face_normals_ = std::move(face_normals);
+        geometry_.geomVector(std::integral_constant<int,3>()) = std::move(point_geom);
+        geometry_.geomVector(std::integral_constant<int,1>()) = std::move(face_geom);
+        geometry_.geomVector(std::integral_constant<int,0>()) = std::move(cell_geom);
+        geometry_.updateGeometryArrays(face_normals_);
+        return true;
+    }
+
+} // namespace Dune
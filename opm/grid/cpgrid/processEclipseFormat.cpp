@@ -50,12 +50,14 @@
 
 #include <opm/grid/utility/OpmParserIncludes.hpp>
 
+#include <cassert>
 #include <cstddef>
 #include <fstream>
 #include <iostream>
 #include <initializer_list>
 #include <set>
 #include <utility>
+#include <vector>
 
 namespace Dune
 {
@@ -247,8 +249,41 @@ namespace cpgrid
 #ifdef VERBOSE
         std::cout << "Processing eclipse data." << std::endl;
 #endif
+        std::uint64_t input_hash = 0;
+        if (!binary_cache_file_.empty()) {
+            input_hash = inputHash(input_data, nnc, z_tolerance, remove_ij_boundary, turn_normals);
+            if (readBinaryCache(binary_cache_file_, input_hash)) {
+                return;
+            }
+        }
         processed_grid output;
         process_grdecl(&input_data, z_tolerance, &output);
+        buildFromProcessedGrid(output, nnc, remove_ij_boundary, turn_normals);
+        if (!binary_cache_file_.empty()) {
+            writeBinaryCache(binary_cache_file_, input_hash);
+        }
+    }
+
+
+    /// Read the Eclipse grid format row by row.
+    void CpGridData::processEclipseFormat(const grdecl_rows& input_data, double z_tolerance, bool remove_ij_boundary, bool turn_normals)
+    {
+        // Process.
+#ifdef VERBOSE
+        std::cout << "Processing eclipse data row by row." << std::endl;
+#endif
+        processed_grid output;
+        if (!process_grdecl_rows(&input_data, z_tolerance, &output)) {
+            OPM_THROW(std::runtime_error, "Failed to process the corner-point grid read row by row.");
+        }
+        buildFromProcessedGrid(output, NNCMaps(), remove_ij_boundary, turn_normals);
+    }
+
+
+    void CpGridData::buildFromProcessedGrid(processed_grid& output, const NNCMaps& nnc, bool remove_ij_boundary, bool turn_normals)
+    {
+        cell_connections_.reset();
+        interior_cell_split_.reset();
         if (remove_ij_boundary) {
             removeOuterCellLayer(output);
             // removeUnusedNodes(output);
@@ -268,6 +303,7 @@ namespace cpgrid
         buildGeom(output, cell_to_face_, cell_to_point_, face_to_output_face, geometry_.geomVector(std::integral_constant<int,0>()),
                   geometry_.geomVector(std::integral_constant<int,1>()), geometry_.geomVector(std::integral_constant<int,3>()),
                   face_normals_, turn_normals);
+        geometry_.updateGeometryArrays(face_normals_);
 
 #ifdef VERBOSE
         std::cout << "Assigning face tags." << std::endl;
@@ -922,68 +958,33 @@ namespace cpgrid
 #endif
         }
 
-        /// Encapsulate a vector<T>, and a permutation array used for access.
+        /// A short list of points, gathered from a larger point set.
+        /// The storage is kept between uses, so that refilling it for
+        /// every face or cell does not allocate.
         template <typename T>
-        class IndirectArray
+        class GatheredArray
         {
         public:
-            IndirectArray(const std::vector<T>& data, const int* beg, const int* end)
-                : data_(data), beg_(beg), end_(end)
-            {
-            }
             const T& operator[](int index) const
             {
                 assert(index >= 0 && index < size());
-                return data_[beg_[index]];
+                return data_[index];
             }
             int size() const
             {
-                return end_ - beg_;
+                return data_.size();
             }
-            typedef T value_type;
-        private:
-            const std::vector<T>& data_;
-            const int* beg_;
-            const int* end_;
-        };
-
-
-        // Helper template for making Geometry objects.
-        // The generic one is suitable for dim == 0 (vertices).
-        template <int dim>
-        struct MakeGeometry
-        {
-            cpgrid::Geometry<dim, 3> operator()(const FieldVector<double, 3>& pos)
-            {
-                return cpgrid::Geometry<dim, 3>(pos);
-            }
-        };
-
-        // Specialization for cells.
-        template <>
-        struct MakeGeometry<3>
-        {
-            const cpgrid::EntityVariable<cpgrid::Geometry<0, 3>, 3>& allcorners_;
-            MakeGeometry(const cpgrid::EntityVariable<cpgrid::Geometry<0, 3>, 3>& allcorners)
-                : allcorners_(allcorners)
+            void clear()
             {
+                data_.clear();
             }
-            cpgrid::Geometry<3, 3> operator()(const FieldVector<double, 3>& pos,
-                                                      double vol,
-                                                      const std::array<int,8>& corner_indices)
+            void push_back(const T& t)
             {
-                return cpgrid::Geometry<3, 3>(pos, vol, allcorners_, &corner_indices[0]);
-            }
-        };
-
-        // Specialization for intersections.
-        template <>
-        struct MakeGeometry<2>
-        {
-            cpgrid::Geometry<2, 3> operator()(const FieldVector<double, 3>& pos, double vol)
-            {
-                return cpgrid::Geometry<2, 3>(pos, vol);
+                data_.push_back(t);
             }
+            typedef T value_type;
+        private:
+            std::vector<T> data_;
         };
 
 
@@ -999,155 +1000,129 @@ namespace cpgrid
                        bool turn_normals)
         {
             typedef FieldVector<double, 3> point_t;
-            std::vector<point_t> points;
-            std::vector<point_t> face_normals;
-            std::vector<point_t> face_centroids;
-            std::vector<double>  face_areas;
-            std::vector<point_t> cell_centroids;
-            std::vector<double>  cell_volumes;
             using namespace GeometryHelpers;
 #ifdef VERBOSE
             Opm::time::StopWatch clock;
             clock.start();
 #endif
+            const int np = output.number_of_nodes;
+            const int nf = face_to_output_face.size();
+            const int nc = output.number_of_cells;
+            const double* coords = output.node_coordinates;
+            const int* fn = output.face_nodes;
+            const int* fp = output.face_ptr;
+
+            // All geometry is written directly into its final storage,
+            // which is sized once here. The loops below only assign to
+            // distinct entries, and may therefore run in parallel.
+            // Note that the cell geometries keep a pointer into
+            // point_geom, which must not be reallocated afterwards.
+            point_geom.assign(np, cpgrid::Geometry<0, 3>());
+            face_geom.assign(nf, cpgrid::Geometry<2, 3>());
+            normals.assign(nf, point_t(0.0));
+            cell_geom.assign(nc, cpgrid::Geometry<3, 3>());
+
+            auto gatherFacePoints = [coords, fn, fp](int output_face, GatheredArray<point_t>& pts)
+            {
+                pts.clear();
+                for (int i = fp[output_face]; i < fp[output_face + 1]; ++i) {
+                    const double* x = coords + 3*fn[i];
+                    pts.push_back({ x[0], x[1], x[2] });
+                }
+            };
+
             // Get the points.
-            int np = output.number_of_nodes;
-            points.clear();
-            points.reserve(np);
+#pragma omp parallel for schedule(static)
             for (int i = 0; i < np; ++i) {
-                // \TODO add a convenience explicit constructor
-                // for FieldVector taking an iterator.
-                point_t pt;
-                for (int dd = 0; dd < 3; ++dd) {
-                    pt[dd] = output.node_coordinates[3*i + dd];
-                }
-                points.push_back(pt);
+                const double* x = coords + 3*i;
+                const point_t pt = { x[0], x[1], x[2] };
+                point_geom.get(i) = cpgrid::Geometry<0, 3>(pt);
             }
 #ifdef VERBOSE
             std::cout << "Points:             " << clock.secsSinceLast() << std::endl;
 #endif
 
             // Get the face data.
-            // \TODO Both the face and (especially) the cell section
-            // is not very efficient. It could be rewritten easily
-            // (focus on the polygonCellXXX methods first).
             // \TODO Use exact geometry instead of these approximations.
-            int nf = face_to_output_face.size();
-            const int* fn = output.face_nodes;
-            const int* fp = output.face_ptr;
-            for (int face = 0; face < nf; ++face) {
-                // Computations in this loop could be speeded up
-                // by doing more of them simultaneously.
-                int output_face = face_to_output_face[face];
-                if (output_face == cpgrid::NNCFace) {
-                    // NNC faces are purely topological constructs,
-                    // and do not have any embedded geometry.
-                    // However, since the ewoms code will multiply and
-                    // divide by the face area even if not necessary
-                    // for the cell-centered FV discretization (because
-                    // it wants to deal with velocities rather than fluxes),
-                    // we have to set the areas to 1 to avoid trouble.
-                    face_normals.push_back({-1e100, -1e100, -1e100});
-                    face_centroids.push_back({-1e100, -1e100, -1e100});
-                    face_areas.push_back(1.0);
-                } else {
-                    IndirectArray<point_t> face_pts(points, fn + fp[output_face], fn + fp[output_face+1]);
-                    point_t avg = average(face_pts);
-                    point_t centroid = polygonCentroid(face_pts, avg);
-                    point_t normal = polygonNormal(face_pts, centroid);
-                    double area = polygonArea(face_pts, centroid);
-                    face_normals.push_back(normal);
-                    face_centroids.push_back(centroid);
-                    face_areas.push_back(area);
+            const double normal_sign = turn_normals ? -1.0 : 1.0;
+#pragma omp parallel
+            {
+                GatheredArray<point_t> face_pts;
+#pragma omp for schedule(static)
+                for (int face = 0; face < nf; ++face) {
+                    int output_face = face_to_output_face[face];
+                    if (output_face == cpgrid::NNCFace) {
+                        // NNC faces are purely topological constructs,
+                        // and do not have any embedded geometry.
+                        // However, since the ewoms code will multiply and
+                        // divide by the face area even if not necessary
+                        // for the cell-centered FV discretization (because
+                        // it wants to deal with velocities rather than fluxes),
+                        // we have to set the areas to 1 to avoid trouble.
+                        const point_t undefined = { -1e100, -1e100, -1e100 };
+                        normals.get(face) = undefined;
+                        normals.get(face) *= normal_sign;
+                        face_geom.get(face) = cpgrid::Geometry<2, 3>(undefined, 1.0);
+                    } else {
+                        gatherFacePoints(output_face, face_pts);
+                        point_t avg = average(face_pts);
+                        point_t centroid = polygonCentroid(face_pts, avg);
+                        point_t normal = polygonNormal(face_pts, centroid);
+                        normal *= normal_sign;
+                        normals.get(face) = normal;
+                        face_geom.get(face) = cpgrid::Geometry<2, 3>(centroid, polygonArea(face_pts, centroid));
+                    }
                 }
             }
 #ifdef VERBOSE
             std::cout << "Faces:              " << clock.secsSinceLast() << std::endl;
 #endif
+
             // Get the cell data.
-            int nc = output.number_of_cells;
-            std::vector<int> face_indices;
-            for (int cell = 0; cell < nc; ++cell) {
-                cpgrid::EntityRep<0> cell_ent(cell, true);
-                cpgrid::OrientedEntityTable<0, 1>::row_type cf = c2f[cell_ent];
-                face_indices.clear();
-                for (int local_index = 0; local_index < cf.size(); ++local_index) {
-                    face_indices.push_back(cf[local_index].index());
-                }
-                IndirectArray<point_t> cell_pts(face_centroids, &face_indices[0], &face_indices[0] + cf.size());
-                point_t cell_avg = average(cell_pts);
-                point_t cell_centroid(0.0);
-                double tot_cell_vol = 0.0;
-                for (int local_index = 0; local_index < cf.size(); ++local_index) {
-                    int face = cf[local_index].index();
-                    int output_face = face_to_output_face[face];
-                    if (output_face == cpgrid::NNCFace) {
-                        // Skip NNC face, do not contribute to cell geometry.
-                        continue;
+#pragma omp parallel
+            {
+                GatheredArray<point_t> cell_pts;
+                GatheredArray<point_t> face_pts;
+#pragma omp for schedule(static)
+                for (int cell = 0; cell < nc; ++cell) {
+                    cpgrid::EntityRep<0> cell_ent(cell, true);
+                    cpgrid::OrientedEntityTable<0, 1>::row_type cf = c2f[cell_ent];
+                    cell_pts.clear();
+                    for (int local_index = 0; local_index < cf.size(); ++local_index) {
+                        cell_pts.push_back(face_geom.get(cf[local_index].index()).center());
                     }
-                    IndirectArray<point_t> face_pts(points, fn + fp[output_face], fn + fp[output_face+1]);
-                    double small_vol = polygonCellVolume(face_pts, face_centroids[face], cell_avg);
-                    tot_cell_vol += small_vol;
-                    point_t face_contrib = polygonCellCentroid(face_pts, face_centroids[face], cell_avg);
-                    face_contrib *= small_vol;
-                    cell_centroid += face_contrib;
-                }
-                cell_centroid /= tot_cell_vol;
+                    point_t cell_avg = average(cell_pts);
+                    point_t cell_centroid(0.0);
+                    double tot_cell_vol = 0.0;
+                    for (int local_index = 0; local_index < cf.size(); ++local_index) {
+                        int face = cf[local_index].index();
+                        int output_face = face_to_output_face[face];
+                        if (output_face == cpgrid::NNCFace) {
+                            // Skip NNC face, do not contribute to cell geometry.
+                            continue;
+                        }
+                        gatherFacePoints(output_face, face_pts);
+                        const point_t& face_centroid = face_geom.get(face).center();
+                        double small_vol = polygonCellVolume(face_pts, face_centroid, cell_avg);
+                        tot_cell_vol += small_vol;
+                        point_t face_contrib = polygonCellCentroid(face_pts, face_centroid, cell_avg);
+                        face_contrib *= small_vol;
+                        cell_centroid += face_contrib;
+                    }
+                    cell_centroid /= tot_cell_vol;
 // #define HACK_CELL_CENTROIDS     // when this is defined, you get the average of top and bottom face centroids.
 #ifdef HACK_CELL_CENTROIDS
-                int numf = cf.size();
-                cell_centroid = face_centroids[face_indices[numf - 2]];
-                cell_centroid += face_centroids[face_indices[numf - 1]];
-                cell_centroid *= 0.5;
-#endif
-                cell_centroids.push_back(cell_centroid);
-                cell_volumes.push_back(tot_cell_vol);
-            }
-#ifdef VERBOSE
-            std::cout << "Cells:              " << clock.secsSinceLast() << std::endl;
+                    int numf = cf.size();
+                    cell_centroid = cell_pts[numf - 2];
+                    cell_centroid += cell_pts[numf - 1];
+                    cell_centroid *= 0.5;
 #endif
-
-
-            // \TODO Fix the code below , as it is:
-            // A) wasteful
-            // B) wordy,
-            // C) slow
-            // D) copied from readSintefLegacyFormat.cpp
-            // Points
-            // Points
-            point_geom.reserve(points.size());
-            MakeGeometry<0> mpointg;
-            std::transform(points.begin(), points.end(),
-                           std::back_inserter(point_geom), mpointg);
-            // Cells
-            cell_geom.reserve(nc);
-            MakeGeometry<3> mcellg(point_geom);
-//             std::transform(cell_centroids.begin(), cell_centroids.end(),
-//                            cell_volumes.begin(),
-//                            std::back_inserter(cell_geom, mcellg);
-            for (int c = 0;  c < nc; ++c) {
-                cell_geom.push_back(mcellg(cell_centroids[c], cell_volumes[c], c2p[c]));
-            }
-            // Faces
-            face_geom.reserve(face_centroids.size());
-            MakeGeometry<2> mfaceg;
-            std::transform(face_centroids.begin(), face_centroids.end(),
-                           face_areas.begin(),
-                           std::back_inserter(face_geom), mfaceg);
-#ifdef VERBOSE
-            std::cout << "Transforms/copies:  " << clock.secsSinceLast() << std::endl;
-#endif
-
-            // The final, combined object (yes, a lot of copying goes on here).
-            if (turn_normals) {
-                int num_normals = face_normals.size();
-                for (int i = 0; i < num_normals; ++i) {
-                    face_normals[i] *= -1.0;
+                    cell_geom.get(cell) = cpgrid::Geometry<3, 3>(cell_centroid, tot_cell_vol,
+                                                                 point_geom, &c2p[cell][0]);
                 }
             }
-            normals.assign(face_normals.begin(), face_normals.end());
 #ifdef VERBOSE
-            std::cout << "Final construction: " << clock.secsSinceLast() << std::endl;
+            std::cout << "Cells:              " << clock.secsSinceLast() << std::endl;
 #endif
         }
     } // anon namespace
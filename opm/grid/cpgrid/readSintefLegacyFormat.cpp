@@ -65,6 +65,8 @@ namespace Dune
     /// Read the Sintef legacy grid format ('topogeom').
     void cpgrid::CpGridData::readSintefLegacyFormat(const std::string& grid_prefix)
     {
+        cell_connections_.reset();
+        interior_cell_split_.reset();
         std::string topofilename = grid_prefix + "-topo.dat";
         {
             std::ifstream file(topofilename.c_str());
@@ -80,6 +82,7 @@ namespace Dune
                 OPM_THROW(std::runtime_error, "Could not open file " << geomfilename);
             }
             readGeom(file, geometry_, face_normals_);
+            geometry_.updateGeometryArrays(face_normals_);
         }
         std::string mapfilename = grid_prefix + "-map.dat";
         {
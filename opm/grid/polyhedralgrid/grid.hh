@@ -3,8 +3,14 @@
 #ifndef DUNE_POLYHEDRALGRID_GRID_HH
 #define DUNE_POLYHEDRALGRID_GRID_HH
 
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstdlib>
+#include <map>
+#include <memory>
 #include <set>
+#include <utility>
 #include <vector>
 
 // Warning suppression for Dune includes.
@@ -16,6 +22,18 @@
 //- dune-grid includes
 #include <dune/grid/common/grid.hh>
 #include <dune/common/parallel/collectivecommunication.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#if HAVE_MPI
+#include <dune/common/enumset.hh>
+#include <dune/common/parallel/indexset.hh>
+#include <dune/common/parallel/interface.hh>
+#include <dune/common/parallel/plocalindex.hh>
+#include <dune/common/parallel/remoteindices.hh>
+#include <dune/common/parallel/variablesizecommunicator.hh>
+#endif
+#ifdef HAVE_DUNE_ISTL
+#include <dune/istl/owneroverlapcopy.hh>
+#endif
 
 //- polyhedralgrid includes
 #include <opm/grid/polyhedralgrid/capabilities.hh>
@@ -35,6 +53,8 @@
 #include <opm/grid/GridManager.hpp>
 #include <opm/grid/cornerpoint_grid.h>
 #include <opm/grid/MinpvProcessor.hpp>
+#include <opm/grid/common/GridPartitioning.hpp>
+#include <opm/grid/utility/SparseTable.hpp>
 
 namespace Dune
 {
@@ -125,7 +145,7 @@ namespace Dune
       typedef PolyhedralGridIdSet< dim, dimworld, ctype > GlobalIdSet;
       typedef GlobalIdSet  LocalIdSet;
 
-      typedef Dune::CollectiveCommunication< Grid > CollectiveCommunication;
+      typedef Dune::CollectiveCommunication< MPIHelper::MPICommunicator > CollectiveCommunication;
 
       template< PartitionIteratorType pitype >
       struct Partition
@@ -303,8 +323,9 @@ namespace Dune
     explicit PolyhedralGrid ( const Opm::Deck& deck,
                               const  std::vector<double>& poreVolumes = std::vector<double> ())
     : gridPtr_( createGrid( deck, poreVolumes ) ),
-      grid_( *gridPtr_ ),
-      comm_( *this ),
+      grid_( gridPtr_.get() ),
+      comm_( MPIHelper::getLocalCommunicator() ),
+      overlapLayers_( 0 ),
       leafIndexSet_( *this ),
       globalIdSet_( *this ),
       localIdSet_( *this )
@@ -322,8 +343,9 @@ namespace Dune
      */
     explicit PolyhedralGrid ( const UnstructuredGridType& grid )
     : gridPtr_(),
-      grid_( grid ),
-      comm_( *this ),
+      grid_( &grid ),
+      comm_( MPIHelper::getLocalCommunicator() ),
+      overlapLayers_( 0 ),
       leafIndexSet_( *this ),
       globalIdSet_( *this ),
       localIdSet_( *this )
@@ -335,7 +357,7 @@ namespace Dune
 
     /** \name Casting operators
      *  \{ */
-    operator const UnstructuredGridType& () const { return grid_; }
+    operator const UnstructuredGridType& () const { return *grid_; }
 
     /** \} */
 
@@ -377,15 +399,15 @@ namespace Dune
     {
       if( codim == 0 )
       {
-        return grid_.number_of_cells;
+        return grid_->number_of_cells;
       }
       else if ( codim == 1 )
       {
-        return grid_.number_of_faces;
+        return grid_->number_of_faces;
       }
       else if ( codim == dim )
       {
-        return grid_.number_of_nodes;
+        return grid_->number_of_nodes;
       }
       else
       {
@@ -550,9 +572,9 @@ namespace Dune
      *
      *  \param[in]  codim  codimension for with the information is desired
      */
-    int overlapSize ( int /* codim */) const
+    int overlapSize ( int codim ) const
     {
-      return 0;
+      return ( codim == 0 ) ? overlapLayers_ : 0;
     }
 
     /** \brief obtain size of ghost region for the leaf grid
@@ -569,9 +591,9 @@ namespace Dune
      *  \param[in]  level  grid level (0, ..., maxLevel())
      *  \param[in]  codim  codimension (0, ..., dimension)
      */
-    int overlapSize ( int /* level */, int /* codim */ ) const
+    int overlapSize ( int /* level */, int codim ) const
     {
-      return 0;
+      return overlapSize( codim );
     }
 
     /** \brief obtain size of ghost region for a grid level
@@ -598,12 +620,12 @@ namespace Dune
      *  \param[in]  level       grid level to communicate
      */
     template< class DataHandle, class Data >
-    void communicate ( CommDataHandleIF< DataHandle, Data >& /* dataHandle */,
-                       InterfaceType /* interface */,
-                       CommunicationDirection /* direction */,
+    void communicate ( CommDataHandleIF< DataHandle, Data >& dataHandle,
+                       InterfaceType interface,
+                       CommunicationDirection direction,
                        int /* level */ ) const
     {
-       //levelGridView( level ).communicate( dataHandle, interface, direction );
+      communicate( dataHandle, interface, direction );
     }
 
     /** \brief communicate information on leaf entities
@@ -617,13 +639,60 @@ namespace Dune
      *                          All_All_Interface)
      *  \param[in]  direction   communication direction (one of
      *                          ForwardCommunication, BackwardCommunication)
+     *
+     *  \note Only data attached to cells is communicated. There is nothing
+     *        to communicate unless the grid has been distributed by
+     *        loadBalance().
      */
     template< class DataHandle, class Data >
-    void communicate ( CommDataHandleIF< DataHandle, Data >& /* dataHandle */,
-                       InterfaceType /* interface */,
-                       CommunicationDirection /* direction */ ) const
+    void communicate ( CommDataHandleIF< DataHandle, Data >& dataHandle,
+                       InterfaceType interface,
+                       CommunicationDirection direction ) const
     {
-      //leafGridView().communicate( dataHandle, interface, direction );
+#if HAVE_MPI
+      if( overlapLayers_ == 0 || !dataHandle.contains( dim, 0 ) )
+        return;
+
+      const auto& interfaceMap = cellInterfaces_[ interface ].interfaces();
+      if( interfaceMap.empty() )
+      {
+        // Nothing to do. Otherwise VariableSizeCommunicator produces
+        // a memory error prior to DUNE 2.4.
+        return;
+      }
+
+      typedef CellDataHandle< CommDataHandleIF< DataHandle, Data > > CellData;
+      CellData cellData( *this, dataHandle );
+#if DUNE_VERSION_NEWER_REV(DUNE_GRID, 2, 5, 2)
+      VariableSizeCommunicator<> communicator( comm_, interfaceMap );
+#else
+      // Work around a deadlock in DUNE <= 2.5.1 which happens if the
+      // buffer cannot hold all data that needs to be sent, see
+      // CpGridData::communicateCodim().
+      std::size_t maxItems = 0;
+      for( const auto& entry : interfaceMap )
+      {
+        std::size_t sendItems = 0;
+        for( std::size_t i = 0; i < entry.second.first.size(); ++i )
+          sendItems += cellData.size( entry.second.first[ i ] );
+        std::size_t recvItems = 0;
+        for( std::size_t i = 0; i < entry.second.second.size(); ++i )
+          recvItems += cellData.size( entry.second.second[ i ] );
+        maxItems = std::max( maxItems, std::max( sendItems, recvItems ) );
+      }
+      maxItems = comm_.max( maxItems );
+      VariableSizeCommunicator<> communicator( comm_, interfaceMap,
+                                               maxItems * sizeof( typename CellData::DataType ) );
+#endif
+      if( direction == ForwardCommunication )
+        communicator.forward( cellData );
+      else
+        communicator.backward( cellData );
+#else
+      static_cast< void >( dataHandle );
+      static_cast< void >( interface );
+      static_cast< void >( direction );
+#endif
     }
 
     /** \brief obtain CollectiveCommunication object
@@ -641,18 +710,22 @@ namespace Dune
 
     // data handle interface different between geo and interface
 
-    /** \brief rebalance the load each process has to handle
+    /** \brief distribute the grid over the processes
      *
-     *  A parallel grid is redistributed such that each process has about
-     *  the same load (e.g., the same number of leaf entites).
+     *  The grid has to be available on all processes. The cells are
+     *  partitioned by recursive coordinate bisection of their centroids,
+     *  balancing the number of cells. Each process keeps the cells it
+     *  owns (interior cells) and the given number of layers of
+     *  neighbouring cells (overlap cells). Faces and vertices get the
+     *  partition types interior, border, overlap or front accordingly.
      *
-     *  \note DUNE does not specify, how the load is measured.
+     *  \param[in]  overlapLayers  the number of layers of overlap cells
      *
      *  \returns \b true, if the grid has changed.
      */
-    bool loadBalance ()
+    bool loadBalance ( int overlapLayers = 1 )
     {
-      return false ;
+      return distributeGrid( overlapLayers );
     }
 
     /** \brief rebalance the load each process has to handle
@@ -665,15 +738,37 @@ namespace Dune
      *
      *  \note DUNE does not specify, how the load is measured.
      *
-     *  \param  datahandle  communication data handle (user defined)
+     *  \param  dataHandle  communication data handle (user defined)
+     *  \param[in]  overlapLayers  the number of layers of overlap cells
+     *
+     *  \note Only data attached to cells is moved. As every process
+     *        has the global grid, the data of each local cell is copied
+     *        from the corresponding cell of the global grid.
      *
      *  \returns \b true, if the grid has changed.
      */
 
     template< class DataHandle, class Data >
-    bool loadBalance ( CommDataHandleIF< DataHandle, Data >& /* datahandle */ )
+    bool loadBalance ( CommDataHandleIF< DataHandle, Data >& dataHandle, int overlapLayers = 1 )
     {
-      return false;
+      const UnstructuredGridType& globalGrid = *grid_;
+      if( !distributeGrid( overlapLayers ) )
+        return false;
+
+      if( dataHandle.contains( dim, 0 ) )
+      {
+        typedef typename Codim< 0 >::EntitySeed EntitySeed;
+        const PolyhedralGrid globalView( globalGrid );
+        MoveBuffer< typename CommDataHandleIF< DataHandle, Data >::DataType > buffer;
+        for( int cell = 0; cell < size( 0 ); ++cell )
+        {
+          const auto globalEntity = globalView.entity( EntitySeed( globalIndex_[ 0 ][ cell ] ) );
+          buffer.clear();
+          dataHandle.gather( buffer, globalEntity );
+          dataHandle.scatter( buffer, entity( EntitySeed( cell ) ), dataHandle.size( globalEntity ) );
+        }
+      }
+      return true;
     }
 
     /** \brief rebalance the load each process has to handle
@@ -774,8 +869,8 @@ namespace Dune
 
     const int* globalCell() const
     {
-      assert( grid_.global_cell != 0 );
-      return grid_.global_cell;
+      assert( grid_->global_cell != 0 );
+      return grid_->global_cell;
     }
 
     void getIJK(const int c, std::array<int,3>& ijk) const
@@ -786,6 +881,444 @@ namespace Dune
       ijk[2] = gc / logicalCartesianSize()[1];
     }
 
+    /** \brief obtain the partition type of an entity */
+    template <class EntitySeed>
+    PartitionType partitionType( const EntitySeed& seed ) const
+    {
+      const std::vector< char >& types = partitionTypes_[ codimIndex( EntitySeed::codimension ) ];
+      return types.empty() ? InteriorEntity : PartitionType( types[ seed.index() ] );
+    }
+
+    /** \brief obtain the index an entity had in the grid before it was distributed */
+    int globalEntityIndex( const int codim, const int index ) const
+    {
+      const std::vector< int >& indices = globalIndex_[ codimIndex( codim ) ];
+      return indices.empty() ? index : indices[ index ];
+    }
+
+    /** \brief check whether an intersection lies on the boundary between processes
+     *
+     *  Such an intersection has no neighbor, but is not on the domain boundary either.
+     */
+    bool processorBoundary( const typename Codim<0>::EntitySeed& seed, const int i ) const
+    {
+      if( processorBoundary_.empty() )
+        return false;
+      return processorBoundary_[ this->template subEntitySeed<1>( seed, i ).index() ];
+    }
+
+  protected:
+    static int codimIndex( const int codim )
+    {
+      return ( codim == 0 ) ? 0 : ( ( codim == 1 ) ? 1 : 2 );
+    }
+
+#if HAVE_MPI
+    /** \brief wrapper turning a data handle for cells into one for cell indices,
+     *         as required by VariableSizeCommunicator */
+    template< class DataHandle >
+    class CellDataHandle
+    {
+    public:
+      typedef typename DataHandle::DataType DataType;
+
+      CellDataHandle ( const PolyhedralGrid& grid, DataHandle& data )
+      : grid_( grid ), data_( data )
+      {}
+
+      bool fixedsize ()
+      {
+        return data_.fixedsize( dim, 0 );
+      }
+
+      std::size_t size ( std::size_t i )
+      {
+        return data_.size( entity( i ) );
+      }
+
+      template< class Buffer >
+      void gather ( Buffer& buffer, std::size_t i )
+      {
+        data_.gather( buffer, entity( i ) );
+      }
+
+      template< class Buffer >
+      void scatter ( Buffer& buffer, std::size_t i, std::size_t n )
+      {
+        data_.scatter( buffer, entity( i ), n );
+      }
+
+    private:
+      typename Traits::template Codim< 0 >::Entity entity ( std::size_t i ) const
+      {
+        return grid_.entity( typename Traits::template Codim< 0 >::EntitySeed( i ) );
+      }
+
+      const PolyhedralGrid& grid_;
+      DataHandle& data_;
+    };
+#endif
+
+    /** \brief message buffer used to move the data of cells in loadBalance() */
+    template< class T >
+    class MoveBuffer
+    {
+    public:
+      MoveBuffer () : pos_( 0 ) {}
+
+      void write ( const T& value ) { data_.push_back( value ); }
+      void read ( T& value ) { value = data_[ pos_++ ]; }
+      void clear () { data_.clear(); pos_ = 0; }
+
+    private:
+      std::vector< T > data_;
+      std::size_t pos_;
+    };
+
+    /** \brief the neighbor of a cell across a face, or -1 if there is none */
+    static int neighborCell ( const UnstructuredGridType& grid, const int cell, const int face )
+    {
+      const int nb = grid.face_cells[ 2*face ];
+      return ( nb == cell ) ? grid.face_cells[ 2*face + 1 ] : nb;
+    }
+
+    /** \brief distribute the grid, see loadBalance() */
+    bool distributeGrid ( const int overlapLayers )
+    {
+#if HAVE_MPI
+      const CollectiveCommunication globalComm( MPIHelper::getCommunicator() );
+      if( globalComm.size() == 1 )
+        return false;
+      if( overlapLayers_ > 0 )
+        OPM_THROW(std::logic_error, "PolyhedralGrid is already distributed.");
+      if( overlapLayers < 1 )
+        OPM_THROW(std::logic_error, "PolyhedralGrid needs at least one layer of overlap cells.");
+
+      const UnstructuredGridType& globalGrid = *grid_;
+      const int numCells = globalGrid.number_of_cells;
+      const int rank = globalComm.rank();
+
+      // Partition on the root process and broadcast the result.
+      std::vector< int > cellPart( numCells );
+      if( rank == 0 )
+        partitionGeometric( globalGrid.cell_centroids, numCells, globalGrid.dimensions,
+                            globalComm.size(), cellPart );
+      globalComm.broadcast( cellPart.data(), numCells, 0 );
+
+      // The local cells are the owned ones and the ones that are at most
+      // overlapLayers faces away from them.
+      std::vector< char > isLocal( numCells, 0 );
+      std::vector< int > front, next;
+      for( int c = 0; c < numCells; ++c )
+      {
+        if( cellPart[ c ] == rank )
+        {
+          isLocal[ c ] = 1;
+          front.push_back( c );
+        }
+      }
+      for( int layer = 0; layer < overlapLayers; ++layer )
+      {
+        next.clear();
+        for( const int c : front )
+        {
+          for( int hf = globalGrid.cell_facepos[ c ]; hf < globalGrid.cell_facepos[ c+1 ]; ++hf )
+          {
+            const int nb = neighborCell( globalGrid, c, globalGrid.cell_faces[ hf ] );
+            if( nb >= 0 && !isLocal[ nb ] )
+            {
+              isLocal[ nb ] = 1;
+              next.push_back( nb );
+            }
+          }
+        }
+        front.swap( next );
+      }
+      std::vector< int > localCells;
+      for( int c = 0; c < numCells; ++c )
+      {
+        if( isLocal[ c ] )
+          localCells.push_back( c );
+      }
+
+      // A cell is present on all processes that own a cell at most
+      // overlapLayers faces away from it. Compute these sorted ranks
+      // for all local cells.
+      Opm::SparseTable< int > cellRanks;
+      std::set< int > neighborRanks;
+      {
+        std::vector< int > visitedBy( numCells, -1 );
+        std::vector< int > ranks;
+        for( const int cell : localCells )
+        {
+          ranks.assign( 1, cellPart[ cell ] );
+          front.assign( 1, cell );
+          visitedBy[ cell ] = cell;
+          for( int layer = 0; layer < overlapLayers; ++layer )
+          {
+            next.clear();
+            for( const int c : front )
+            {
+              for( int hf = globalGrid.cell_facepos[ c ]; hf < globalGrid.cell_facepos[ c+1 ]; ++hf )
+              {
+                const int nb = neighborCell( globalGrid, c, globalGrid.cell_faces[ hf ] );
+                if( nb >= 0 && visitedBy[ nb ] != cell )
+                {
+                  visitedBy[ nb ] = cell;
+                  next.push_back( nb );
+                  ranks.push_back( cellPart[ nb ] );
+                }
+              }
+            }
+            front.swap( next );
+          }
+          std::sort( ranks.begin(), ranks.end() );
+          ranks.erase( std::unique( ranks.begin(), ranks.end() ), ranks.end() );
+          cellRanks.appendRow( ranks.begin(), ranks.end() );
+          for( const int r : ranks )
+          {
+            if( r != rank )
+              neighborRanks.insert( r );
+          }
+        }
+      }
+
+      // Set up the parallel index set with the global cell indices.
+      typedef typename ParallelIndexSet::LocalIndex LocalIndex;
+      cellIndexSet_.beginResize();
+      for( std::size_t i = 0; i < localCells.size(); ++i )
+      {
+        const int cell = localCells[ i ];
+        cellIndexSet_.add( cell, LocalIndex( i, ( cellPart[ cell ] == rank ) ?
+                                             AttributeSet::owner : AttributeSet::copy, true ) );
+      }
+      cellIndexSet_.endResize();
+
+      // Set up the remote indices. Both the owner and all copies of a
+      // cell know each other.
+      typedef RemoteIndexListModifier< ParallelIndexSet, typename RemoteIndices::Allocator, false > Modifier;
+      typedef typename RemoteIndices::RemoteIndex RemoteIndex;
+      cellRemoteIndices_.setIndexSets( cellIndexSet_, cellIndexSet_, globalComm );
+      if( !neighborRanks.empty() )
+      {
+        // extra scope to call the destructors of the modifiers
+        std::map< int, Modifier > modifiers;
+        for( const int r : neighborRanks )
+          modifiers.insert( std::make_pair( r, cellRemoteIndices_.template getModifier< false, false >( r ) ) );
+        for( auto i = cellIndexSet_.begin(), end = cellIndexSet_.end(); i != end; ++i )
+        {
+          for( const int r : cellRanks[ i->local().local() ] )
+          {
+            if( r == rank )
+              continue;
+            auto mod = modifiers.find( r );
+            assert( mod != modifiers.end() );
+            mod->second.insert( RemoteIndex( ( cellPart[ i->global() ] == r ) ?
+                                             AttributeSet::owner : AttributeSet::copy, &( *i ) ) );
+          }
+        }
+      }
+      else
+      {
+        // Force update of the sync counter in the remote indices.
+        cellRemoteIndices_.template getModifier< false, false >( 0 );
+      }
+
+      // The communication interfaces. There are no border cells, hence
+      // InteriorBorder_InteriorBorder_Interface stays empty.
+      cellInterfaces_[ InteriorBorder_All_Interface ]
+        .build( cellRemoteIndices_, EnumItem< AttributeSet, AttributeSet::owner >(),
+                AllSet< AttributeSet >() );
+      cellInterfaces_[ Overlap_OverlapFront_Interface ]
+        .build( cellRemoteIndices_, EnumItem< AttributeSet, AttributeSet::copy >(),
+                EnumItem< AttributeSet, AttributeSet::copy >() );
+      cellInterfaces_[ Overlap_All_Interface ]
+        .build( cellRemoteIndices_, EnumItem< AttributeSet, AttributeSet::copy >(),
+                AllSet< AttributeSet >() );
+      cellInterfaces_[ All_All_Interface ]
+        .build( cellRemoteIndices_, AllSet< AttributeSet >(), AllSet< AttributeSet >() );
+
+      // Switch to the local grid.
+      distributedGridPtr_.reset( extractLocalGrid( globalGrid, localCells, globalIndex_, processorBoundary_ ) );
+      grid_ = distributedGridPtr_.get();
+      comm_ = globalComm;
+      overlapLayers_ = overlapLayers;
+
+      std::vector< char > cellTypes( localCells.size() );
+      for( std::size_t i = 0; i < localCells.size(); ++i )
+        cellTypes[ i ] = ( cellPart[ localCells[ i ] ] == rank ) ? InteriorEntity : OverlapEntity;
+      computePartitionTypes( cellTypes );
+
+      init();
+      return true;
+#else
+      static_cast< void >( overlapLayers );
+      return false;
+#endif
+    }
+
+    /** \brief create the grid of the given cells of a grid
+     *
+     *  The faces and nodes are numbered in the order of their first
+     *  appearance. Neighbors that are not among the cells are replaced by
+     *  -1, such faces are marked in processorBoundary.
+     *
+     *  \param[in]  global  the grid to extract from
+     *  \param[in]  cells   the cells to extract in ascending order
+     *  \param[out] globalIndex  the indices in global of the cells, faces and nodes
+     *  \param[out] processorBoundary  whether a face lost a neighbor
+     */
+    static UnstructuredGridType*
+    extractLocalGrid ( const UnstructuredGridType& global, const std::vector< int >& cells,
+                       std::array< std::vector< int >, 3 >& globalIndex,
+                       std::vector< char >& processorBoundary )
+    {
+      const int dimension = global.dimensions;
+      std::vector< int > localCell( global.number_of_cells, -1 );
+      std::vector< int > localFace( global.number_of_faces, -1 );
+      std::vector< int > localNode( global.number_of_nodes, -1 );
+      std::vector< int >& faces = globalIndex[ 1 ];
+      std::vector< int >& nodes = globalIndex[ 2 ];
+      globalIndex[ 0 ] = cells;
+      faces.clear();
+      nodes.clear();
+
+      std::size_t numCellFaces = 0;
+      std::size_t numFaceNodes = 0;
+      for( std::size_t i = 0; i < cells.size(); ++i )
+      {
+        const int c = cells[ i ];
+        localCell[ c ] = i;
+        numCellFaces += global.cell_facepos[ c+1 ] - global.cell_facepos[ c ];
+        for( int hf = global.cell_facepos[ c ]; hf < global.cell_facepos[ c+1 ]; ++hf )
+        {
+          const int f = global.cell_faces[ hf ];
+          if( localFace[ f ] >= 0 )
+            continue;
+          localFace[ f ] = faces.size();
+          faces.push_back( f );
+          numFaceNodes += global.face_nodepos[ f+1 ] - global.face_nodepos[ f ];
+          for( int fn = global.face_nodepos[ f ]; fn < global.face_nodepos[ f+1 ]; ++fn )
+          {
+            const int n = global.face_nodes[ fn ];
+            if( localNode[ n ] < 0 )
+            {
+              localNode[ n ] = nodes.size();
+              nodes.push_back( n );
+            }
+          }
+        }
+      }
+
+      UnstructuredGridType* local = allocate_grid( dimension, cells.size(), faces.size(),
+                                                   numFaceNodes, numCellFaces, nodes.size() );
+      if( local )
+      {
+        local->global_cell = static_cast< int* >( std::malloc( cells.size() * sizeof( int ) ) );
+        if( !global.cell_facetag )
+        {
+          std::free( local->cell_facetag );
+          local->cell_facetag = nullptr;
+        }
+      }
+      if( !local || !local->global_cell )
+      {
+        destroy_grid( local );
+        OPM_THROW(std::runtime_error, "Failed to allocate the local grid.");
+      }
+      std::copy( global.cartdims, global.cartdims + 3, local->cartdims );
+
+      local->cell_facepos[ 0 ] = 0;
+      for( std::size_t i = 0; i < cells.size(); ++i )
+      {
+        const int c = cells[ i ];
+        int pos = local->cell_facepos[ i ];
+        for( int hf = global.cell_facepos[ c ]; hf < global.cell_facepos[ c+1 ]; ++hf, ++pos )
+        {
+          local->cell_faces[ pos ] = localFace[ global.cell_faces[ hf ] ];
+          if( local->cell_facetag )
+            local->cell_facetag[ pos ] = global.cell_facetag[ hf ];
+        }
+        local->cell_facepos[ i+1 ] = pos;
+        std::copy( global.cell_centroids + dimension*c, global.cell_centroids + dimension*(c+1),
+                   local->cell_centroids + dimension*i );
+        local->cell_volumes[ i ] = global.cell_volumes[ c ];
+        local->global_cell[ i ] = global.global_cell ? global.global_cell[ c ] : c;
+      }
+
+      processorBoundary.assign( faces.size(), 0 );
+      local->face_nodepos[ 0 ] = 0;
+      for( std::size_t i = 0; i < faces.size(); ++i )
+      {
+        const int f = faces[ i ];
+        int pos = local->face_nodepos[ i ];
+        for( int fn = global.face_nodepos[ f ]; fn < global.face_nodepos[ f+1 ]; ++fn, ++pos )
+          local->face_nodes[ pos ] = localNode[ global.face_nodes[ fn ] ];
+        local->face_nodepos[ i+1 ] = pos;
+        for( int k = 0; k < 2; ++k )
+        {
+          const int c = global.face_cells[ 2*f + k ];
+          local->face_cells[ 2*i + k ] = ( c >= 0 ) ? localCell[ c ] : -1;
+          if( c >= 0 && localCell[ c ] < 0 )
+            processorBoundary[ i ] = 1;
+        }
+        std::copy( global.face_centroids + dimension*f, global.face_centroids + dimension*(f+1),
+                   local->face_centroids + dimension*i );
+        std::copy( global.face_normals + dimension*f, global.face_normals + dimension*(f+1),
+                   local->face_normals + dimension*i );
+        local->face_areas[ i ] = global.face_areas[ f ];
+      }
+
+      for( std::size_t i = 0; i < nodes.size(); ++i )
+      {
+        std::copy( global.node_coordinates + dimension*nodes[ i ],
+                   global.node_coordinates + dimension*(nodes[ i ]+1),
+                   local->node_coordinates + dimension*i );
+      }
+      return local;
+    }
+
+    /** \brief compute the partition types of faces and nodes from the ones of the cells */
+    void computePartitionTypes ( const std::vector< char >& cellTypes )
+    {
+      partitionTypes_[ 0 ] = cellTypes;
+
+      // A face is of type front if it lost a neighbor, of type border
+      // if it is between an interior and an overlap cell, and of the
+      // type of its cells otherwise.
+      std::vector< char >& faceTypes = partitionTypes_[ 1 ];
+      faceTypes.resize( grid_->number_of_faces );
+      for( int face = 0; face < grid_->number_of_faces; ++face )
+      {
+        const int c0 = grid_->face_cells[ 2*face ];
+        const int c1 = grid_->face_cells[ 2*face + 1 ];
+        if( processorBoundary_[ face ] )
+          faceTypes[ face ] = FrontEntity;
+        else if( c0 >= 0 && c1 >= 0 )
+          faceTypes[ face ] = ( cellTypes[ c0 ] == cellTypes[ c1 ] ) ? cellTypes[ c0 ] : char( BorderEntity );
+        else
+          faceTypes[ face ] = cellTypes[ std::max( c0, c1 ) ];
+      }
+
+      // As for CpGrid: A node gets the type of its faces, where border
+      // takes precedence over interior and front, and these over overlap.
+      std::vector< char >& nodeTypes = partitionTypes_[ 2 ];
+      nodeTypes.assign( grid_->number_of_nodes, OverlapEntity );
+      for( int face = 0; face < grid_->number_of_faces; ++face )
+      {
+        const PartitionType newType = PartitionType( faceTypes[ face ] );
+        for( int fn = grid_->face_nodepos[ face ]; fn < grid_->face_nodepos[ face+1 ]; ++fn )
+        {
+          char& nodeType = nodeTypes[ grid_->face_nodes[ fn ] ];
+          const PartitionType oldType = PartitionType( nodeType );
+          if( ( oldType == InteriorEntity && newType != OverlapEntity ) ||
+              oldType == OverlapEntity ||
+              ( oldType == FrontEntity && newType == BorderEntity ) )
+            nodeType = newType;
+        }
+      }
+    }
+
   protected:
 
 #if HAVE_ECL_INPUT
@@ -857,11 +1390,11 @@ namespace Dune
       {
         case 0:
           {
-            return cellVertices_[ index ].size();
+            return cellVertices_.rowSize( index );
           }
         case 1:
           {
-            return 0;//grid_.cell_facepos[ index+1 ] - grid_.cell_facepos[ index ];
+            return 0;//grid_->cell_facepos[ index+1 ] - grid_->cell_facepos[ index ];
           }
         case dim:
           {
@@ -881,17 +1414,17 @@ namespace Dune
         case 0:
           {
             const int coordIndex = GlobalCoordinate :: dimension * cellVertices_[ seed.index() ][ i ];
-            return copyToGlobalCoordinate( grid_.node_coordinates + coordIndex );
+            return copyToGlobalCoordinate( grid_->node_coordinates + coordIndex );
           }
         case 1:
           {
-            const int faceVertex = grid_.face_nodes[grid_.face_nodepos[seed.index()] + i];
-            return copyToGlobalCoordinate( grid_.node_coordinates + GlobalCoordinate :: dimension * faceVertex );
+            const int faceVertex = grid_->face_nodes[grid_->face_nodepos[seed.index()] + i];
+            return copyToGlobalCoordinate( grid_->node_coordinates + GlobalCoordinate :: dimension * faceVertex );
           }
         case dim:
           {
             const int coordIndex = GlobalCoordinate :: dimension * seed.index();
-            return copyToGlobalCoordinate( grid_.node_coordinates + coordIndex );
+            return copyToGlobalCoordinate( grid_->node_coordinates + coordIndex );
           }
       }
       return GlobalCoordinate( 0 );
@@ -906,9 +1439,9 @@ namespace Dune
         case 0:
           return 1;
         case 1:
-          return grid_.cell_facepos[ index+1 ] - grid_.cell_facepos[ index ];
+          return grid_->cell_facepos[ index+1 ] - grid_->cell_facepos[ index ];
         case dim:
-          return cellVertices_[ index ].size();
+          return cellVertices_.rowSize( index );
       }
       return 0;
     }
@@ -931,7 +1464,7 @@ namespace Dune
       {
         if ( codim == 1 )
         {
-          return EntitySeed( grid_.cell_faces[ grid_.cell_facepos[ baseSeed.index() ] + i ] );
+          return EntitySeed( grid_->cell_faces[ grid_->cell_facepos[ baseSeed.index() ] + i ] );
         }
         else if ( codim == dim )
         {
@@ -940,7 +1473,7 @@ namespace Dune
       }
       else if ( EntitySeedArg::codimension == 1 && codim == dim )
       {
-        return EntitySeed( grid_.face_nodes[ grid_.face_nodepos[ baseSeed.index() + i ] ]);
+        return EntitySeed( grid_->face_nodes[ grid_->face_nodepos[ baseSeed.index() + i ] ]);
       }
 
       DUNE_THROW(NotImplemented,"codimension not available");
@@ -960,23 +1493,23 @@ namespace Dune
 
     int indexInInside( const typename Codim<0>::EntitySeed& seed, const int i ) const
     {
-      return ( grid_.cell_facetag ) ? cartesianIndexInInside( seed, i ) : i;
+      return ( grid_->cell_facetag ) ? cartesianIndexInInside( seed, i ) : i;
     }
 
     int cartesianIndexInInside( const typename Codim<0>::EntitySeed& seed, const int i ) const
     {
       assert( i>= 0 && i<subEntities( seed, 1 ) );
-      return grid_.cell_facetag[ grid_.cell_facepos[ seed.index() ] + i ] ;
+      return grid_->cell_facetag[ grid_->cell_facepos[ seed.index() ] + i ] ;
     }
 
     typename Codim<0>::EntitySeed
     neighbor( const typename Codim<0>::EntitySeed& seed, const int i ) const
     {
       const int face = this->template subEntitySeed<1>( seed, i ).index();
-      int nb = grid_.face_cells[ 2 * face ];
+      int nb = grid_->face_cells[ 2 * face ];
       if( nb == seed.index() )
       {
-        nb = grid_.face_cells[ 2 * face + 1 ];
+        nb = grid_->face_cells[ 2 * face + 1 ];
       }
 
       typedef typename Codim<0>::EntitySeed EntitySeed;
@@ -986,7 +1519,7 @@ namespace Dune
     int
     indexInOutside( const typename Codim<0>::EntitySeed& seed, const int i ) const
     {
-      if( grid_.cell_facetag )
+      if( grid_->cell_facetag )
       {
         // if cell_facetag is present we assume pseudo Cartesian corner point case
         const int in_inside = cartesianIndexInInside( seed, i );
@@ -1015,8 +1548,8 @@ namespace Dune
     {
       const int face  = this->template subEntitySeed<1>( seed, i ).index();
       const int normalIdx = face * GlobalCoordinate :: dimension ;
-      GlobalCoordinate normal = copyToGlobalCoordinate( grid_.face_normals + normalIdx );
-      const int nb = grid_.face_cells[ 2*face ];
+      GlobalCoordinate normal = copyToGlobalCoordinate( grid_->face_normals + normalIdx );
+      const int nb = grid_->face_cells[ 2*face ];
       if( nb != seed.index() )
       {
         normal *= -1.0;
@@ -1029,7 +1562,7 @@ namespace Dune
     unitOuterNormal( const EntitySeed& seed, const int i ) const
     {
       const int face  = this->template subEntitySeed<1>( seed, i ).index();
-      if( seed.index() == grid_.face_cells[ 2*face ] )
+      if( seed.index() == grid_->face_cells[ 2*face ] )
       {
         return unitOuterNormals_[ face ];
       }
@@ -1050,15 +1583,15 @@ namespace Dune
 
       if( codim == 0 )
       {
-        return copyToGlobalCoordinate( grid_.cell_centroids + index );
+        return copyToGlobalCoordinate( grid_->cell_centroids + index );
       }
       else if ( codim == 1 )
       {
-        return copyToGlobalCoordinate( grid_.face_centroids + index );
+        return copyToGlobalCoordinate( grid_->face_centroids + index );
       }
       else if( codim == dim )
       {
-        return copyToGlobalCoordinate( grid_.node_coordinates + index );
+        return copyToGlobalCoordinate( grid_->node_coordinates + index );
       }
       else
       {
@@ -1084,11 +1617,11 @@ namespace Dune
       const int codim = EntitySeed::codimension;
       if( codim == 0 )
       {
-        return grid_.cell_volumes[ index ];
+        return grid_->cell_volumes[ index ];
       }
       else if ( codim == 1 )
       {
-        return grid_.face_areas[ index ];
+        return grid_->face_areas[ index ];
       }
       else if ( codim == dim )
       {
@@ -1101,110 +1634,126 @@ namespace Dune
       }
     }
 
+    /** \brief the sorted, distinct nodes of the faces of a cell
+     *
+     *  \param[in]  cell   index of the cell
+     *  \param[out] nodes  node indices, overwritten
+     */
+    void collectCellNodes ( const int cell, std::vector< int >& nodes ) const
+    {
+      nodes.clear();
+      for (int hf=grid_->cell_facepos[ cell ]; hf < grid_->cell_facepos[cell+1]; ++hf)
+      {
+        const int f = grid_->cell_faces[ hf ];
+        nodes.insert( nodes.end(), grid_->face_nodes + grid_->face_nodepos[f],
+                      grid_->face_nodes + grid_->face_nodepos[f+1] );
+      }
+      std::sort( nodes.begin(), nodes.end() );
+      nodes.erase( std::unique( nodes.begin(), nodes.end() ), nodes.end() );
+    }
+
     void init()
     {
       // copy Cartesian dimensions
       for( int i=0; i<3; ++i )
       {
-        cartDims_[ i ] = grid_.cartdims[ i ];
+        cartDims_[ i ] = grid_->cartdims[ i ];
       }
 
       // setup list of cell vertices
       const int numCells = size( 0 );
-      cellVertices_.resize( numCells );
+      cellVertices_.clear();
 
       // sort vertices such that they comply with the dune cube reference element
-      if( grid_.cell_facetag )
+      if( grid_->cell_facetag )
       {
-        typedef std::array<int, 3> KeyType;
-        std::map< const KeyType, const int > vertexFaceTags;
-        const int vertexFacePattern [8][3] = {
-                                { 0, 2, 4 }, // vertex 0
-                                { 1, 2, 4 }, // vertex 1
-                                { 0, 3, 4 }, // vertex 2
-                                { 1, 3, 4 }, // vertex 3
-                                { 0, 2, 5 }, // vertex 4
-                                { 1, 2, 5 }, // vertex 5
-                                { 0, 3, 5 }, // vertex 6
-                                { 1, 3, 5 }  // vertex 7
-                               };
-
-        for( int i=0; i<8; ++i )
+        // A corner of a cell is a node that appears exactly once among the
+        // faces of a lower or an upper face tag in each coordinate
+        // direction. The tags determine the position in the reference
+        // element: the lower faces 0, 2, 4 give a zero bit and the upper
+        // faces 1, 3, 5 a one bit in the local vertex number. A node of a
+        // collapsed cell, e.g. at a pinched pillar, is on the lower and the
+        // upper faces of a direction and takes both positions. Nodes that
+        // appear in more than one face of a tag (hanging nodes of faults)
+        // are not corners.
+        const int numCorners = 1 << dim;
+        std::vector< int > rowSizes( numCells, numCorners );
+        cellVertices_.allocate( rowSizes.begin(), rowSizes.end() );
+
+        int incompleteCells = 0;
+#pragma omp parallel
         {
-          KeyType key; key.fill( 4 ); // default is 4 which is the first z coord (for the 2d case)
-          for( int j=0; j<dim; ++j )
+          // (node, face tag) pairs of the current cell, reused for all cells
+          std::vector< std::pair< int, int > > nodeTags;
+          nodeTags.reserve( 32 );
+#pragma omp for schedule(static) reduction(+:incompleteCells)
+          for (int c = 0; c < numCells; ++c)
           {
-            key[ j ] = vertexFacePattern[ i ][ j ];
-          }
-
-          vertexFaceTags.insert( std::make_pair( key, i ) );
-        }
-
-        for (int c = 0; c < numCells; ++c)
-        {
-          typedef std::map<int,int> vertexmap_t;
-          typedef typename vertexmap_t :: iterator iterator;
-
-          std::vector< vertexmap_t > cell_pts( dim*2 );
-
-          for (int hf=grid_.cell_facepos[ c ]; hf < grid_.cell_facepos[c+1]; ++hf)
-          {
-            const int f = grid_.cell_faces[ hf ];
-            const int faceTag = grid_.cell_facetag[ hf ];
-
-            for( int nodepos=grid_.face_nodepos[f]; nodepos<grid_.face_nodepos[f+1]; ++nodepos )
+            nodeTags.clear();
+            for (int hf=grid_->cell_facepos[ c ]; hf < grid_->cell_facepos[c+1]; ++hf)
             {
-              const int node = grid_.face_nodes[ nodepos ];
-              iterator it = cell_pts[ faceTag ].find( node );
-              if( it == cell_pts[ faceTag ].end() )
-              {
-                 cell_pts[ faceTag ].insert( std::make_pair( node, 1 ) );
-              }
-              else
+              const int f = grid_->cell_faces[ hf ];
+              const int faceTag = grid_->cell_facetag[ hf ];
+              for( int nodepos=grid_->face_nodepos[f]; nodepos<grid_->face_nodepos[f+1]; ++nodepos )
               {
-                // increase vertex reference counter
-                (*it).second++;
+                nodeTags.emplace_back( grid_->face_nodes[ nodepos ], faceTag );
               }
             }
-          }
+            std::sort( nodeTags.begin(), nodeTags.end() );
 
-          typedef std::map< int, std::set<int> > vertexlist_t;
-          vertexlist_t vertexList;
+            auto row = cellVertices_[ c ];
+            std::fill( row.begin(), row.end(), -1 );
 
-          for( int faceTag = 0; faceTag<6; ++faceTag )
-          {
-            for( iterator it = cell_pts[ faceTag ].begin(),
-                 end = cell_pts[ faceTag ].end(); it != end; ++it )
+            const int numPairs = nodeTags.size();
+            for( int i = 0; i < numPairs; )
             {
-              // only consider vertices with one appearance
-              if( (*it).second == 1 )
+              const int node = nodeTags[ i ].first;
+              // bit t is set if the node appears exactly once in faces of tag t
+              int cornerTags = 0;
+              while( i < numPairs && nodeTags[ i ].first == node )
               {
-                vertexList[ (*it).first ].insert( faceTag );
+                const int faceTag = nodeTags[ i ].second;
+                int count = 0;
+                for( ; i < numPairs && nodeTags[ i ].first == node && nodeTags[ i ].second == faceTag; ++i )
+                {
+                  ++count;
+                }
+                if( count == 1 )
+                {
+                  cornerTags |= 1 << faceTag;
+                }
               }
-            }
-          }
-
-          assert( int(vertexList.size()) == ( dim == 2 ) ? 4 : 8 );
-
-          cellVertices_[ c ].resize( vertexList.size() );
-          for( auto it = vertexList.begin(), end = vertexList.end(); it != end; ++it )
-          {
-            assert( (*it).second.size() == dim );
-            KeyType key; key.fill( 4 ); // fill with 4 which is the first z coord
 
-            std::copy( (*it).second.begin(), (*it).second.end(), key.begin() );
-            auto vx = vertexFaceTags.find( key );
-            assert( vx != vertexFaceTags.end() );
-            if( vx != vertexFaceTags.end() )
+              for( int vertex = 0; vertex < numCorners; ++vertex )
+              {
+                bool isCorner = true;
+                for( int d = 0; d < dim; ++d )
+                {
+                  const int upper = (vertex >> d) & 1;
+                  isCorner = isCorner && (cornerTags & (1 << (2*d + upper)));
+                }
+                if( isCorner )
+                {
+                  // store node number on correct local position
+                  row[ vertex ] = node;
+                }
+              }
+            }
+            if( std::find( row.begin(), row.end(), -1 ) != row.end() )
             {
-              if( (*vx).second >= int(cellVertices_[ c ].size()) )
-                cellVertices_[ c ].resize( (*vx).second+1 );
-              // store node number on correct local position
-              cellVertices_[ c ][ (*vx).second ] = (*it).first ;
+              ++incompleteCells;
             }
           }
         }
+        // Cells whose faces do not determine all corners would be accessed
+        // out of bounds by corner(), hence they are rejected here.
+        if( incompleteCells > 0 )
+        {
+          OPM_THROW(std::runtime_error, "The face tags of " << incompleteCells
+                    << " cells do not determine all of their " << numCorners << " corners.");
+        }
         // if face_tag is available we assume that the elements follow a cube-like structure
+        geomTypes_.clear();
         geomTypes_.resize(dim + 1);
         GeometryType tmp;
         for (int codim = 0; codim <= dim; ++codim)
@@ -1213,24 +1762,36 @@ namespace Dune
           geomTypes_[codim].push_back(tmp);
         }
       }
-      else // if ( grid_.cell_facetag )
+      else // if ( grid_->cell_facetag )
       {
-        for (int c = 0; c < numCells; ++c)
+        // The vertices of a cell are the distinct nodes of its faces, in
+        // ascending order. Count them first, then fill the rows.
+        std::vector< int > rowSizes( numCells );
+#pragma omp parallel
         {
-          std::set<int> cell_pts;
-          for (int hf=grid_.cell_facepos[ c ]; hf < grid_.cell_facepos[c+1]; ++hf)
+          std::vector< int > cellNodes;
+#pragma omp for schedule(static)
+          for (int c = 0; c < numCells; ++c)
           {
-             int f = grid_.cell_faces[ hf ];
-             const int* fnbeg = grid_.face_nodes + grid_.face_nodepos[f];
-             const int* fnend = grid_.face_nodes + grid_.face_nodepos[f+1];
-             cell_pts.insert(fnbeg, fnend);
+            collectCellNodes( c, cellNodes );
+            rowSizes[ c ] = cellNodes.size();
+          }
+        }
+        cellVertices_.allocate( rowSizes.begin(), rowSizes.end() );
+#pragma omp parallel
+        {
+          std::vector< int > cellNodes;
+#pragma omp for schedule(static)
+          for (int c = 0; c < numCells; ++c)
+          {
+            collectCellNodes( c, cellNodes );
+            auto row = cellVertices_[ c ];
+            std::copy( cellNodes.begin(), cellNodes.end(), row.begin() );
           }
-
-          cellVertices_[ c ].resize( cell_pts.size() );
-          std::copy(cell_pts.begin(), cell_pts.end(), cellVertices_[ c ].begin() );
         }
         // if no face_tag is available we assume that no reference element can be
         // assigned to the elements
+        geomTypes_.clear();
         geomTypes_.resize(dim + 1);
         GeometryType tmp;
         for (int codim = 0; codim <= dim; ++codim)
@@ -1245,13 +1806,14 @@ namespace Dune
           }
           geomTypes_[codim].push_back(tmp);
         }
-      } // end else of ( grid_.cell_facetag )
+      } // end else of ( grid_->cell_facetag )
 
-      unitOuterNormals_.resize( grid_.number_of_faces );
-      for( int face = 0; face < grid_.number_of_faces; ++face )
+      unitOuterNormals_.resize( grid_->number_of_faces );
+#pragma omp parallel for schedule(static)
+      for( int face = 0; face < grid_->number_of_faces; ++face )
       {
          const int normalIdx = face * GlobalCoordinate :: dimension ;
-         GlobalCoordinate normal = copyToGlobalCoordinate( grid_.face_normals + normalIdx );
+         GlobalCoordinate normal = copyToGlobalCoordinate( grid_->face_normals + normalIdx );
          normal /= normal.two_norm();
 
          unitOuterNormals_[ face ] = normal;
@@ -1259,13 +1821,42 @@ namespace Dune
     }
 
   protected:
+#ifdef HAVE_DUNE_ISTL
+    typedef Dune::OwnerOverlapCopyAttributeSet::AttributeSet AttributeSet;
+#else
+    /// \brief The type of the set of the attributes
+    enum AttributeSet{owner, overlap, copy};
+#endif
+
     std::unique_ptr< UnstructuredGridType, UnstructuredGridDeleter > gridPtr_;
-    const UnstructuredGridType& grid_;
+    //! the grid of this process, either the global or the distributed one
+    const UnstructuredGridType* grid_;
+    //! the local part of the grid after loadBalance()
+    std::unique_ptr< UnstructuredGridType, UnstructuredGridDeleter > distributedGridPtr_;
 
     CollectiveCommunication comm_;
+    //! the number of layers of overlap cells, 0 if the grid is not distributed
+    int overlapLayers_;
+    //! partition types of cells, faces and nodes, empty if not distributed
+    std::array< std::vector< char >, 3 > partitionTypes_;
+    //! indices of cells, faces and nodes in the global grid, empty if not distributed
+    std::array< std::vector< int >, 3 > globalIndex_;
+    //! whether a face lies on the boundary to another process
+    std::vector< char > processorBoundary_;
+#if HAVE_MPI
+    typedef Dune::ParallelIndexSet< int, ParallelLocalIndex< AttributeSet >, 512 > ParallelIndexSet;
+    typedef Dune::RemoteIndices< ParallelIndexSet > RemoteIndices;
+    //! the parallel index set of the cells, with the global cell indices
+    ParallelIndexSet cellIndexSet_;
+    //! the remote index information of the cells
+    RemoteIndices cellRemoteIndices_;
+    //! the communication interfaces of the cells, by InterfaceType
+    std::array< Interface, 5 > cellInterfaces_;
+#endif
     std::array< int, 3 > cartDims_;
     std::vector< std::vector< GeometryType > > geomTypes_;
-    std::vector< std::vector< int > > cellVertices_;
+    //! vertices of the cells, ordered as in the reference element if face tags are present
+    Opm::SparseTable< int > cellVertices_;
 
     std::vector< GlobalCoordinate > unitOuterNormals_;
 
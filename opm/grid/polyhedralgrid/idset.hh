@@ -35,7 +35,7 @@ namespace Dune
       if (codim == 0)
         return grid_.globalCell()[ index ];
       else
-        return index;
+        return grid_.globalEntityIndex( codim, index );
     }
 
     //! id method of all entities
@@ -92,7 +92,10 @@ namespace Dune
              (intersectionIdx_ == other.intersectionIdx_);
     }
 
-    bool boundary () const { return !neighbor(); }
+    bool boundary () const
+    {
+      return !neighbor() && !data()->processorBoundary(seed_, intersectionIdx_);
+    }
 
     bool conforming () const { return false; }
 
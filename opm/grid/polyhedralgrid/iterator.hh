@@ -34,7 +34,7 @@ namespace Dune
     : Base( data )
     {
       if( beginIterator )
-        entityImpl() = EntityImpl( data, EntitySeed( 0 ) );
+        moveTo( data, 0 );
     }
 
     PolyhedralGridIterator ( const This& other )
@@ -44,13 +44,41 @@ namespace Dune
     /** \brief increment */
     void increment ()
     {
-      int index = entityImpl().seed().index();
-      ++index;
+      moveTo( entityImpl().data(), entityImpl().seed().index() + 1 );
+    }
+
+  protected:
+    /** \brief move to the first entity of the partition with at least the given index */
+    void moveTo ( ExtraData data, int index )
+    {
+      const int size = data->size( codim );
+      while( index < size && !inPartition( data->partitionType( EntitySeed( index ) ) ) )
+        ++index;
 
-      if( index >= entityImpl().data()->size( codim ) )
-        entityImpl() = EntityImpl( entityImpl().data() );
+      if( index >= size )
+        entityImpl() = EntityImpl( data );
       else
-        entityImpl() = EntityImpl( entityImpl().data(), EntitySeed( index ) );
+        entityImpl() = EntityImpl( data, EntitySeed( index ) );
+    }
+
+    static bool inPartition ( const PartitionType type )
+    {
+      switch( pitype )
+      {
+        case Interior_Partition:
+          return type == InteriorEntity;
+        case InteriorBorder_Partition:
+          return type == InteriorEntity || type == BorderEntity;
+        case Overlap_Partition:
+          return type == InteriorEntity || type == BorderEntity || type == OverlapEntity;
+        case OverlapFront_Partition:
+          return type != GhostEntity;
+        case All_Partition:
+          return true;
+        case Ghost_Partition:
+          return type == GhostEntity;
+      }
+      return false;
     }
   };
 
@@ -1,8 +1,9 @@
-#include <opm/common/utility/numeric/blas_lapack.h>
 #include <opm/grid/transmissibility/trans_tpfa.h>
 #include <opm/grid/GridHelpers.hpp>
 
+#include <cassert>
 #include <cmath>
+#include <vector>
 
 namespace Dune
 {
@@ -21,29 +22,18 @@ double faceArea(const Dune::CpGrid&, int);
 
 namespace
 {
-inline const double* multiplyFaceNormalWithArea(const Dune::CpGrid& grid, int face_index, const double* in)
+/// \brief The factor that turns the face normal into an area weighted one.
+///
+/// CpGrid stores unit normals, UnstructuredGrid area weighted ones.
+inline double faceNormalAreaFactor(const Dune::CpGrid& grid, int face_index)
 {
-    int d=Opm::UgGridHelpers::dimensions(grid);
-    double* out=new double[d];
-    double area=Opm::UgGridHelpers::faceArea(grid, face_index);
-    
-    for(int i=0;i<d;++i)
-        out[i]=in[i]*area;
-    return out;
+    return Opm::UgGridHelpers::faceArea(grid, face_index);
 }
 
-inline void maybeFreeFaceNormal(const Dune::CpGrid&, const double* array)
+inline double faceNormalAreaFactor(const UnstructuredGrid&, int)
 {
-    delete[] array;
+    return 1.0;
 }
-
-inline const double* multiplyFaceNormalWithArea(const UnstructuredGrid&, int, const double* in)
-{
-    return in;
-}
-
-inline void maybeFreeFaceNormal(const UnstructuredGrid&, const double*)
-{}
 }
 
 /* ---------------------------------------------------------------------- */
@@ -55,57 +45,59 @@ tpfa_htrans_compute(const Grid* G, const double *perm, double *htrans)
 /* ---------------------------------------------------------------------- */
 {
     using namespace Opm::UgGridHelpers;
-    int    d, j;
-    double s, dist, denom;
 
-    double Kn[3];
-    typename CellCentroidTraits<Grid>::IteratorType cc = beginCellCentroids(*G);
+    const int d  = dimensions(*G);
+    const int nc = numCells(*G);
     typename Cell2FacesTraits<Grid>::Type c2f = cell2Faces(*G);
     typename FaceCellTraits<Grid>::Type face_cells = faceCells(*G);
-    
-    const double *n;
-    const double *K;
+    typedef typename Cell2FacesTraits<Grid>::Type::row_type FaceRow;
 
-    MAT_SIZE_T nrows, ncols, ldA, incx, incy;
-    double a1, a2;
-
-    d = dimensions(*G);
+    /* Position of the first half-face of each cell in htrans, such
+     * that the cells can be processed independently. */
+    std::vector<int> hf_start(nc + 1, 0);
+    for (int c = 0; c < nc; c++) {
+        FaceRow faces = c2f[c];
+        hf_start[c + 1] = hf_start[c] + (faces.end() - faces.begin());
+    }
 
-    nrows = ncols    = ldA = d;
-    incx  = incy     = 1      ;
-    a1    = 1.0;  a2 = 0.0    ;
+#pragma omp parallel for schedule(static)
+    for (int c = 0; c < nc; c++) {
+        const double *K = perm + (c * d * d);
+        const typename CellCentroidTraits<Grid>::IteratorType cc =
+            increment(beginCellCentroids(*G), c, d);
 
-    for (int c =0, i = 0; c < numCells(*G); c++) {
-        K  = perm + (c * d * d);
-        
-        typedef typename Cell2FacesTraits<Grid>::Type::row_type FaceRow;
         FaceRow faces = c2f[c];
-        
+        int i = hf_start[c];
+
         for(typename FaceRow::const_iterator f=faces.begin(), end=faces.end();
             f!=end; ++f, ++i)
         {
-            s = 2.0*(face_cells(*f, 0) == c) - 1.0;
-            n = faceNormal(*G, *f);
-            const double* nn=multiplyFaceNormalWithArea(*G, *f, n);
+            const double s = 2.0*(face_cells(*f, 0) == c) - 1.0;
+            const double *n = faceNormal(*G, *f);
+            const double area = faceNormalAreaFactor(*G, *f);
             const double* fc = &(faceCentroid(*G, *f)[0]);
-            dgemv_("No Transpose", &nrows, &ncols,
-                   &a1, K, &ldA, nn, &incx, &a2, &Kn[0], &incy);
-            maybeFreeFaceNormal(*G, nn);
-            
-            htrans[i] = denom = 0.0;
-            for (j = 0; j < d; j++) {
-                dist = fc[j] - getCoordinate(cc, j);
-
-                htrans[i] += s * dist * Kn[j];
-                denom     +=     dist * dist;
+
+            /* Kn <- K * (area * n), K column major. The summation
+             * order is the one of the reference dgemv. */
+            double Kn[3] = { 0.0, 0.0, 0.0 };
+            for (int col = 0; col < d; col++) {
+                const double nn = n[col] * area;
+                for (int row = 0; row < d; row++) {
+                    Kn[row] += nn * K[row + col*d];
+                }
+            }
+
+            double h = 0.0, denom = 0.0;
+            for (int j = 0; j < d; j++) {
+                const double dist = fc[j] - getCoordinate(cc, j);
+
+                h     += s * dist * Kn[j];
+                denom +=     dist * dist;
             }
 
             assert (denom > 0);
-            htrans[i] /= denom;
-            htrans[i]  = std::abs(htrans[i]);
+            htrans[i] = std::abs(h / denom);
         }
-        // Move to next cell centroid.
-        cc = increment(cc, 1, d);
     }
 }
 
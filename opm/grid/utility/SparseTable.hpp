@@ -38,6 +38,9 @@
 #include <vector>
 #include <numeric>
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 #include <boost/range/iterator_range.hpp>
 #include <opm/grid/utility/ErrorMacros.hpp>
 
@@ -50,10 +53,21 @@ namespace Opm
     /// as efficiently as possible.
     /// It is supposed to behave similarly to a vector of vectors.
     /// Its behaviour is similar to compressed row sparse matrices.
-    template <typename T>
+    ///
+    /// The row start offsets are stored with type OffsetType. The
+    /// default (int) keeps small tables compact; tables with more than
+    /// std::numeric_limits<int>::max() data elements must use a wider
+    /// type such as std::int64_t. Exceeding the range of OffsetType
+    /// raises an exception rather than silently wrapping around.
+    template <typename T, typename OffsetType = int>
     class SparseTable
     {
+        static_assert(std::is_integral<OffsetType>::value && std::is_signed<OffsetType>::value,
+                      "SparseTable offsets must be of signed integral type.");
     public:
+        /// The type of the row start offsets.
+        typedef OffsetType offset_type;
+
         /// Default constructor. Yields an empty SparseTable.
         SparseTable()
         {
@@ -97,6 +111,7 @@ namespace Opm
             typedef typename std::vector<T>::size_type sz_t;
 
             sz_t ndata = std::accumulate(rowsize_beg, rowsize_end, sz_t(0));
+            checkOffsetRange(ndata);
             data_.resize(ndata);
             setRowStartsFromSizes(rowsize_beg, rowsize_end);
         }
@@ -106,12 +121,19 @@ namespace Opm
         template <typename DataIter>
         void appendRow(DataIter row_beg, DataIter row_end)
         {
+            const std::size_t old_size = data_.size();
             data_.insert(data_.end(), row_beg, row_end);
+            if (data_.size() > maxOffset()) {
+                // Leave the table as it was.
+                const std::size_t new_size = data_.size();
+                data_.resize(old_size);
+                checkOffsetRange(new_size);
+            }
             if (row_start_.empty()) {
                 row_start_.reserve(2);
                 row_start_.push_back(0);
             }
-            row_start_.push_back(data_.size());
+            row_start_.push_back(static_cast<OffsetType>(data_.size()));
         }
 
         /// True if the table contains no rows.
@@ -127,21 +149,21 @@ namespace Opm
         }
 
         /// Allocate storage for table of expected size
-        void reserve(int exptd_nrows, int exptd_ndata)
+        void reserve(int exptd_nrows, OffsetType exptd_ndata)
         {
             row_start_.reserve(exptd_nrows + 1);
             data_.reserve(exptd_ndata);
         }
 
         /// Swap contents for other SparseTable<T>
-        void swap(SparseTable<T>& other)
+        void swap(SparseTable& other)
         {
             row_start_.swap(other.row_start_);
             data_.swap(other.data_);
         }
 
         /// Returns the number of data elements.
-        int dataSize() const
+        OffsetType dataSize() const
         {
             return data_.size();
         }
@@ -152,7 +174,7 @@ namespace Opm
 #ifndef NDEBUG
             OPM_ERROR_IF(row < 0 || row >= size(), "Row index " << row << " is out of range");
 #endif
-            return row_start_[row + 1] - row_start_[row];
+            return static_cast<int>(row_start_[row + 1] - row_start_[row]);
         }
 
         /// Makes the table empty().
@@ -195,7 +217,7 @@ namespace Opm
 
             os << "Row starts = [";
             std::copy(row_start_.begin(), row_start_.end(),
-                      std::ostream_iterator<int>(os, " "));
+                      std::ostream_iterator<OffsetType>(os, " "));
             os << "\b]\n";
 
             os << "Data values = [";
@@ -203,7 +225,7 @@ namespace Opm
                       std::ostream_iterator<T>(os, " "));
             os << "\b]\n";
         }
-        const T data(int i)const {
+        const T data(OffsetType i)const {
         	return data_[i];
         }
 
@@ -211,7 +233,23 @@ namespace Opm
         std::vector<T> data_;
         // Like in the compressed row sparse matrix format,
         // row_start_.size() is equal to the number of rows + 1.
-        std::vector<int> row_start_;
+        std::vector<OffsetType> row_start_;
+
+        /// The largest number of data elements the table can hold.
+        static std::size_t maxOffset()
+        {
+            return static_cast<std::size_t>(std::numeric_limits<OffsetType>::max());
+        }
+
+        /// Throws if num_data cannot be represented as an OffsetType.
+        static void checkOffsetRange(std::size_t num_data)
+        {
+            if (num_data > maxOffset()) {
+                OPM_THROW(std::overflow_error, "SparseTable with " << num_data
+                          << " data elements exceeds the range of its offset type ("
+                          << std::numeric_limits<OffsetType>::max() << ").");
+            }
+        }
 
 	template <class IntegerIter>
 	void setRowStartsFromSizes(IntegerIter rowsize_beg, IntegerIter rowsize_end)
@@ -227,11 +265,20 @@ namespace Opm
                 OPM_THROW(std::runtime_error, "All row sizes must be at least 0.");
             }
 #endif
+            checkOffsetRange(data_.size());
             row_start_.resize(num_rows + 1);
             row_start_[0] = 0;
-            std::partial_sum(rowsize_beg, rowsize_end, row_start_.begin() + 1);
+            // Accumulate in 64 bits, so that a mismatch between row sizes
+            // and data size is detected even if the sum would overflow
+            // OffsetType.
+            std::int64_t offset = 0;
+            IntegerIter rowsize = rowsize_beg;
+            for (int row = 0; row < num_rows; ++row, ++rowsize) {
+                offset += *rowsize;
+                row_start_[row + 1] = static_cast<OffsetType>(offset);
+            }
             // Check that data_ and row_start_ match.
-            if (int(data_.size()) != row_start_.back()) {
+            if (offset != static_cast<std::int64_t>(data_.size())) {
                 OPM_THROW(std::runtime_error, "End of row start indices different from data size.");
             }
 
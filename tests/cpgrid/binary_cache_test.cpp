@@ -0,0 +1,211 @@
+/*
+  This file is part of The Open Porous Media project  (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <config.h>
+
+#define NVERBOSE // to suppress our messages when throwing
+
+
+#define BOOST_TEST_MODULE BinaryCacheTests
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/unit_test.hpp>
+#include <opm/grid/CpGrid.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+    // A 3x2x2 grid with a sloping top and one inactive cell.
+    struct Input
+    {
+        Input()
+        {
+            const std::array<int, 3> dims = {{ 3, 2, 2 }};
+            for (int j = 0; j <= dims[1]; ++j) {
+                for (int i = 0; i <= dims[0]; ++i) {
+                    const double pillar[6] = { double(i), double(j), 0.0,
+                                               double(i), double(j), 3.0 };
+                    coord.insert(coord.end(), pillar, pillar + 6);
+                }
+            }
+            for (int k = 0; k < 2*dims[2]; ++k) {
+                for (int j = 0; j < 2*dims[1]; ++j) {
+                    for (int i = 0; i < 2*dims[0]; ++i) {
+                        zcorn.push_back(((k + 1)/2) + 0.1*((i + 1)/2));
+                    }
+                }
+            }
+            actnum.assign(dims[0]*dims[1]*dims[2], 1);
+            actnum[4] = 0;
+            g.dims[0] = dims[0];
+            g.dims[1] = dims[1];
+            g.dims[2] = dims[2];
+            g.coord = coord.data();
+            g.zcorn = zcorn.data();
+            g.actnum = actnum.data();
+            g.mapaxes = nullptr;
+        }
+        std::vector<double> coord;
+        std::vector<double> zcorn;
+        std::vector<int> actnum;
+        grdecl g;
+    };
+}
+
+BOOST_AUTO_TEST_CASE(roundtrip)
+{
+    Input input;
+    Dune::CpGrid grid;
+    grid.processEclipseFormat(input.g, 0.0, false);
+    const auto hash = Dune::CpGrid::inputHash(input.g);
+    const std::string filename = "binary_cache_test.grid";
+    grid.writeBinaryCache(filename, hash);
+
+    Dune::CpGrid stale;
+    BOOST_CHECK(!stale.readBinaryCache(filename, hash + 1));
+    BOOST_CHECK_EQUAL(stale.numCells(), 0);
+    BOOST_CHECK(!stale.readBinaryCache("does_not_exist.grid", hash));
+
+    Dune::CpGrid cached;
+    BOOST_REQUIRE(cached.readBinaryCache(filename, hash));
+    std::remove(filename.c_str());
+
+    BOOST_REQUIRE_EQUAL(cached.numCells(), grid.numCells());
+    BOOST_REQUIRE_EQUAL(cached.numFaces(), grid.numFaces());
+    BOOST_CHECK(cached.globalCell() == grid.globalCell());
+    BOOST_CHECK(cached.logicalCartesianSize() == grid.logicalCartesianSize());
+    for (int c = 0; c < grid.numCells(); ++c) {
+        BOOST_CHECK_EQUAL(cached.cellVolume(c), grid.cellVolume(c));
+        BOOST_CHECK_EQUAL(cached.numCellFaces(c), grid.numCellFaces(c));
+        for (int lf = 0; lf < grid.numCellFaces(c); ++lf) {
+            BOOST_CHECK_EQUAL(cached.cellFace(c, lf), grid.cellFace(c, lf));
+        }
+        for (int d = 0; d < 3; ++d) {
+            BOOST_CHECK_EQUAL(cached.cellCentroid(c)[d], grid.cellCentroid(c)[d]);
+        }
+    }
+    for (int f = 0; f < grid.numFaces(); ++f) {
+        BOOST_CHECK_EQUAL(cached.faceArea(f), grid.faceArea(f));
+        BOOST_CHECK_EQUAL(cached.faceCell(f, 0), grid.faceCell(f, 0));
+        BOOST_CHECK_EQUAL(cached.faceCell(f, 1), grid.faceCell(f, 1));
+        BOOST_CHECK_EQUAL(cached.numFaceVertices(f), grid.numFaceVertices(f));
+        for (int d = 0; d < 3; ++d) {
+            BOOST_CHECK_EQUAL(cached.faceNormal(f)[d], grid.faceNormal(f)[d]);
+        }
+    }
+    BOOST_CHECK(cached.cellCentroidsX() == grid.cellCentroidsX());
+    BOOST_CHECK(cached.faceAreas() == grid.faceAreas());
+}
+
+BOOST_AUTO_TEST_CASE(hash)
+{
+    Input input;
+    const auto hash = Dune::CpGrid::inputHash(input.g);
+    BOOST_CHECK_EQUAL(hash, Dune::CpGrid::inputHash(input.g));
+    const double z = input.zcorn[5];
+    input.zcorn[5] += 1e-10;
+    BOOST_CHECK(hash != Dune::CpGrid::inputHash(input.g));
+    input.zcorn[5] = z;
+    input.actnum[4] = 1;
+    BOOST_CHECK(hash != Dune::CpGrid::inputHash(input.g));
+    input.actnum[4] = 0;
+
+    // The processing options are part of the hash.
+    BOOST_CHECK(hash != Dune::CpGrid::inputHash(input.g, 0.1));
+    BOOST_CHECK(hash != Dune::CpGrid::inputHash(input.g, 0.0, true));
+    BOOST_CHECK(hash != Dune::CpGrid::inputHash(input.g, 0.0, false, true));
+    BOOST_CHECK_EQUAL(hash, Dune::CpGrid::inputHash(input.g, 0.0, false, false));
+}
+
+BOOST_AUTO_TEST_CASE(corruptFile)
+{
+    Input input;
+    Dune::CpGrid grid;
+    grid.processEclipseFormat(input.g, 0.0, false);
+    const auto hash = Dune::CpGrid::inputHash(input.g);
+    const std::string filename = "binary_cache_corrupt_test.grid";
+    grid.writeBinaryCache(filename, hash);
+
+    // Damage the last block (the cell geometry) by making its byte
+    // count larger than the file, keeping the header valid.
+    std::vector<char> content;
+    {
+        std::ifstream in(filename.c_str(), std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const std::size_t cell_block = content.size() - 8*(4*grid.numCells() + 1);
+    const std::uint64_t bytes = content.size();
+    std::memcpy(&content[cell_block], &bytes, sizeof(bytes));
+    {
+        std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+        out.write(content.data(), content.size());
+    }
+
+    // The grid read before stays untouched.
+    Dune::CpGrid cached;
+    cached.processEclipseFormat(input.g, 0.0, false);
+    BOOST_CHECK(!cached.readBinaryCache(filename, hash));
+    std::remove(filename.c_str());
+    BOOST_REQUIRE_EQUAL(cached.numCells(), grid.numCells());
+    BOOST_REQUIRE_EQUAL(cached.numFaces(), grid.numFaces());
+    for (int c = 0; c < grid.numCells(); ++c) {
+        BOOST_CHECK_EQUAL(cached.cellVolume(c), grid.cellVolume(c));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(processWithCache)
+{
+    Input input;
+    const std::string filename = "binary_cache_process_test.grid";
+    std::remove(filename.c_str());
+
+    // The first run writes the cache, the second one reads it.
+    Dune::CpGrid grid;
+    grid.setBinaryCacheFile(filename);
+    grid.processEclipseFormat(input.g, 0.0, false);
+    Dune::CpGrid stale;
+    BOOST_CHECK(!stale.readBinaryCache(filename, Dune::CpGrid::inputHash(input.g, 0.0, false, true)));
+    Dune::CpGrid cached;
+    BOOST_REQUIRE(cached.readBinaryCache(filename, Dune::CpGrid::inputHash(input.g)));
+
+    Dune::CpGrid again;
+    again.setBinaryCacheFile(filename);
+    again.processEclipseFormat(input.g, 0.0, false);
+    std::remove(filename.c_str());
+    BOOST_REQUIRE_EQUAL(again.numCells(), grid.numCells());
+    for (int c = 0; c < grid.numCells(); ++c) {
+        BOOST_CHECK_EQUAL(again.cellVolume(c), grid.cellVolume(c));
+    }
+}
+
+bool
+init_unit_test_func()
+{
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+    boost::unit_test::unit_test_main(&init_unit_test_func,
+                                     argc, argv);
+}
@@ -7,6 +7,9 @@
 #include <boost/test/unit_test.hpp>
 
 #include <opm/grid/CpGrid.hpp>
+#include <opm/grid/common/GridPartitioning.hpp>
+
+#include <algorithm>
 
 
 // Warning suppression for Dune includes.
@@ -493,6 +496,492 @@ BOOST_AUTO_TEST_CASE(intersectionOverlap)
     }
 }
 
+// Distributing a grid that is only present on the root process
+// has to result in the same local grids as distributing a grid
+// that is present on all processes.
+BOOST_AUTO_TEST_CASE(distributeFromRoot)
+{
+    std::array<int, 3> dims={{8, 4, 2}};
+    std::array<double, 3> size={{ 8.0, 4.0, 2.0}};
+    int rank = 0;
+#if HAVE_MPI
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+    Dune::CpGrid grid, root_grid;
+    grid.createCartesian(dims, size);
+    if ( rank == 0 )
+    {
+        root_grid.createCartesian(dims, size);
+    }
+
+    grid.loadBalance();
+    root_grid.loadBalance();
+
+    BOOST_REQUIRE(grid.numCells() == root_grid.numCells());
+    BOOST_REQUIRE(grid.numFaces() == root_grid.numFaces());
+    BOOST_REQUIRE(grid.globalCell() == root_grid.globalCell());
+
+    for ( int c = 0; c < grid.numCells(); ++c )
+    {
+        BOOST_CHECK(grid.cellCentroid(c) == root_grid.cellCentroid(c));
+        BOOST_CHECK(grid.cellVolume(c) == root_grid.cellVolume(c));
+    }
+    for ( int f = 0; f < grid.numFaces(); ++f )
+    {
+        BOOST_CHECK(grid.faceCentroid(f) == root_grid.faceCentroid(f));
+    }
+
+    auto gridView = grid.leafGridView();
+    auto rootGridView = root_grid.leafGridView();
+    BOOST_REQUIRE(gridView.size(3) == rootGridView.size(3));
+    auto rootElement = rootGridView.begin<0>();
+    for ( auto element = gridView.begin<0>(); element != gridView.end<0>();
+          ++element, ++rootElement )
+    {
+        BOOST_CHECK(element->partitionType() == rootElement->partitionType());
+    }
+}
+
+/// \brief Sums a weight of the global cell index over the interior cells of a grid.
+template<class Weight>
+double interiorLoad(const Dune::CpGrid& grid, const Weight& weight)
+{
+    double load = 0.0;
+    auto gridView = grid.leafGridView();
+    for ( auto element = gridView.begin<0>(); element != gridView.end<0>(); ++element )
+    {
+        if ( element->partitionType() == Dune::InteriorEntity )
+        {
+            load += weight(grid.globalCell()[gridView.indexSet().index(*element)]);
+        }
+    }
+    return load;
+}
+
+/// \brief Checks that every process owns interior cells and that together they own all cells.
+void checkInteriorCells(const Dune::CpGrid& grid, int global_cells)
+{
+    const int interior_cells = static_cast<int>(interiorLoad(grid, [](int) { return 1.0; }));
+    BOOST_CHECK(interior_cells > 0);
+    BOOST_CHECK_EQUAL(grid.comm().sum(interior_cells), global_cells);
+}
+
+BOOST_AUTO_TEST_CASE(distributeWithParallelPartitioning)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3> dims={{8, 8, 4}};
+    std::array<double, 3> size={{ 8.0, 8.0, 4.0}};
+    grid.createCartesian(dims, size);
+    const int global_cells = grid.numCells();
+    grid.setParallelPartitioning(true);
+    grid.loadBalance();
+
+    checkInteriorCells(grid, global_cells);
+}
+
+#if HAVE_MPI && defined(HAVE_ZOLTAN)
+// The parallel partitioning only builds one layer of overlap cells,
+// hence requesting more has to throw on all processes.
+BOOST_AUTO_TEST_CASE(parallelPartitioningRejectsOverlapLayers)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3> dims={{8, 8, 4}};
+    std::array<double, 3> size={{ 8.0, 8.0, 4.0}};
+    grid.createCartesian(dims, size);
+    grid.setParallelPartitioning(true);
+    BOOST_CHECK_THROW(grid.loadBalance(2), std::logic_error);
+}
+#endif
+
+// The parallel partitioning must also work if the global grid is
+// only present on the root process.
+BOOST_AUTO_TEST_CASE(distributeFromRootWithParallelPartitioning)
+{
+    std::array<int, 3> dims={{8, 8, 4}};
+    std::array<double, 3> size={{ 8.0, 8.0, 4.0}};
+    int rank = 0;
+#if HAVE_MPI
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+    Dune::CpGrid grid;
+    if ( rank == 0 )
+    {
+        grid.createCartesian(dims, size);
+    }
+    const int global_cells = dims[0]*dims[1]*dims[2];
+    grid.setParallelPartitioning(true);
+    grid.loadBalance();
+
+    checkInteriorCells(grid, global_cells);
+}
+
+// The cells in the first two columns in i direction are three times as
+// expensive as the others, which the partitioning has to balance.
+double heavyColumnsWeight(int global_cell)
+{
+    return global_cell % 8 < 2 ? 3.0 : 1.0;
+}
+
+BOOST_AUTO_TEST_CASE(distributeWithCellWeights)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3> dims={{8, 8, 4}};
+    std::array<double, 3> size={{ 8.0, 8.0, 4.0}};
+    grid.createCartesian(dims, size);
+    const int global_cells = grid.numCells();
+
+    std::vector<std::vector<double> > weights(1, std::vector<double>(global_cells));
+    for ( int c = 0; c < global_cells; ++c )
+    {
+        weights[0][c] = heavyColumnsWeight(grid.globalCell()[c]);
+    }
+    grid.loadBalance(Dune::EdgeWeightMethod::uniformEdgeWgt, nullptr, weights);
+
+    checkInteriorCells(grid, global_cells);
+    // Splitting the cells evenly in i direction would give one of four
+    // processes both heavy columns, i.e. twice the average load.
+    const auto& cc = grid.comm();
+    const double load = interiorLoad(grid, heavyColumnsWeight);
+    BOOST_CHECK_CLOSE(cc.sum(load), 384.0, 1e-10);
+    BOOST_CHECK_LE(cc.max(load), 1.3 * cc.sum(load) / cc.size());
+}
+
+BOOST_AUTO_TEST_CASE(distributeWithMultipleCellWeights)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3> dims={{8, 8, 4}};
+    std::array<double, 3> size={{ 8.0, 8.0, 4.0}};
+    grid.createCartesian(dims, size);
+    const int global_cells = grid.numCells();
+
+    // Two constraints: the number of cells and an expensive top layer.
+    std::vector<std::vector<double> > weights(2, std::vector<double>(global_cells, 1.0));
+    for ( int c = 0; c < global_cells; ++c )
+    {
+        if ( grid.globalCell()[c] < dims[0]*dims[1] )
+        {
+            weights[1][c] = 10.0;
+        }
+    }
+    grid.loadBalance(Dune::EdgeWeightMethod::uniformEdgeWgt, nullptr, weights);
+
+    checkInteriorCells(grid, global_cells);
+}
+
+// The partitioning by ijk coordinates, which is used without Zoltan,
+// has to move the cuts to balance the weights.
+BOOST_AUTO_TEST_CASE(weightedCartesianPartitioning)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3> dims={{8, 8, 4}};
+    std::array<double, 3> size={{ 8.0, 8.0, 4.0}};
+    grid.createCartesian(dims, size);
+    const int global_cells = grid.numCells();
+
+    // The i slices weigh 96, 96, 32, ..., 32, hence a cut in the middle
+    // would give 256 and 128, but the balanced cut is after the second slice.
+    std::vector<std::vector<double> > weights(1, std::vector<double>(global_cells));
+    for ( int c = 0; c < global_cells; ++c )
+    {
+        weights[0][c] = heavyColumnsWeight(grid.globalCell()[c]);
+    }
+    int num_parts = 0;
+    std::vector<int> cell_part;
+    Dune::partition(grid, {{2, 1, 1}}, num_parts, cell_part, weights, false, false);
+    BOOST_REQUIRE_EQUAL(num_parts, 2);
+    BOOST_REQUIRE_EQUAL(int(cell_part.size()), global_cells);
+
+    std::vector<double> part_load(num_parts, 0.0);
+    for ( int c = 0; c < global_cells; ++c )
+    {
+        BOOST_CHECK_EQUAL(cell_part[c], grid.globalCell()[c] % dims[0] < 2 ? 0 : 1);
+        part_load[cell_part[c]] += weights[0][c];
+    }
+    BOOST_CHECK_CLOSE(part_load[0], 192.0, 1e-10);
+    BOOST_CHECK_CLOSE(part_load[1], 192.0, 1e-10);
+
+    // Without weights the cut stays in the middle.
+    Dune::partition(grid, {{2, 1, 1}}, num_parts, cell_part, false, false);
+    BOOST_REQUIRE_EQUAL(num_parts, 2);
+    for ( int c = 0; c < global_cells; ++c )
+    {
+        BOOST_CHECK_EQUAL(cell_part[c], grid.globalCell()[c] % dims[0] < 4 ? 0 : 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(geometricPartitioning)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3> dims={{8, 8, 4}};
+    std::array<double, 3> size={{ 8.0, 8.0, 4.0}};
+    grid.createCartesian(dims, size);
+    const int global_cells = grid.numCells();
+
+    // With uniform weights the parts have the same number of cells.
+    std::vector<int> cell_part;
+    Dune::partitionGeometric(grid, 4, cell_part);
+    BOOST_REQUIRE_EQUAL(int(cell_part.size()), global_cells);
+    std::vector<int> part_size(4, 0);
+    for ( int part : cell_part )
+    {
+        BOOST_REQUIRE(part >= 0 && part < 4);
+        ++part_size[part];
+    }
+    for ( int s : part_size )
+    {
+        BOOST_CHECK_EQUAL(s, global_cells/4);
+    }
+
+    grid.setGeometricPartitioning(true);
+    grid.loadBalance();
+
+    checkInteriorCells(grid, global_cells);
+}
+
+/// \brief A data handle moving a value per cell during repartitioning.
+class RepartitionCellDataHandle
+{
+public:
+    RepartitionCellDataHandle(const std::vector<int>& old_values,
+                              std::vector<int>& new_values)
+        : old_values_(old_values), new_values_(new_values)
+    {}
+    typedef int DataType;
+    bool fixedsize(int /*dim*/, int /*codim*/)
+    {
+        return true;
+    }
+
+    template<class T>
+    std::size_t size(const T&)
+    {
+        return 1;
+    }
+    template<class B, class T>
+    void gather(B& buffer, const T& t)
+    {
+        buffer.write(old_values_[t.index()]);
+    }
+    template<class B, class T>
+    void scatter(B& buffer, const T& t, std::size_t)
+    {
+        if ( t.index() >= static_cast<int>(new_values_.size()) )
+        {
+            new_values_.resize(t.index() + 1, -1);
+        }
+        buffer.read(new_values_[t.index()]);
+    }
+    bool contains(int dim, int codim)
+    {
+        return dim==3 && codim==0;
+    }
+private:
+    const std::vector<int>& old_values_;
+    std::vector<int>& new_values_;
+};
+
+void checkGeometryArrays(const Dune::CpGrid& grid);
+void checkCellConnections(const Dune::CpGrid& grid);
+
+BOOST_AUTO_TEST_CASE(repartition)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3> dims={{8, 8, 4}};
+    std::array<double, 3> size={{ 8.0, 8.0, 4.0}};
+    grid.createCartesian(dims, size);
+    const int global_cells = grid.numCells();
+    grid.loadBalance();
+
+    // The grid and its communicator object are replaced by repartition().
+    const auto cc = grid.comm();
+    auto gridView = grid.leafGridView();
+
+    // Hand every second interior cell to the next process.
+    std::vector<int> cell_part(grid.numCells(), cc.rank());
+    std::vector<int> old_ids(grid.numCells(), -1);
+    for ( auto element = gridView.begin<0>(); element != gridView.end<0>(); ++element )
+    {
+        const int index = gridView.indexSet().index(*element);
+        old_ids[index] = grid.globalIdSet().id(*element);
+        if ( element->partitionType() == Dune::InteriorEntity && old_ids[index] % 2 )
+        {
+            cell_part[index] = (cc.rank() + 1) % cc.size();
+        }
+    }
+
+    std::vector<int> new_ids;
+    RepartitionCellDataHandle handle(old_ids, new_ids);
+    BOOST_REQUIRE(grid.repartition(cell_part, handle));
+
+    gridView = grid.leafGridView();
+    BOOST_REQUIRE_EQUAL(int(new_ids.size()), grid.numCells());
+    for ( auto element = gridView.begin<0>(); element != gridView.end<0>(); ++element )
+    {
+        const int index = gridView.indexSet().index(*element);
+        BOOST_CHECK_EQUAL(new_ids[index], int(grid.globalIdSet().id(*element)));
+    }
+    checkInteriorCells(grid, global_cells);
+    checkGeometryArrays(grid);
+    checkCellConnections(grid);
+
+    // A repartitioning computed from the distributed grid only.
+    const auto new_part = grid.computeRepartitioning();
+    BOOST_REQUIRE_EQUAL(int(new_part.size()), grid.numCells());
+    BOOST_REQUIRE(grid.repartition(new_part));
+    checkInteriorCells(grid, global_cells);
+}
+
+void checkGeometryArrays(const Dune::CpGrid& grid)
+{
+    BOOST_REQUIRE(grid.cellVolumes().size() == std::size_t(grid.numCells()));
+    BOOST_REQUIRE(grid.faceAreas().size() == std::size_t(grid.numFaces()));
+    for ( int c = 0; c < grid.numCells(); ++c )
+    {
+        const auto& centroid = grid.cellCentroid(c);
+        BOOST_CHECK(grid.cellVolumes()[c] == grid.cellVolume(c));
+        BOOST_CHECK(grid.cellCentroidsX()[c] == centroid[0]);
+        BOOST_CHECK(grid.cellCentroidsY()[c] == centroid[1]);
+        BOOST_CHECK(grid.cellCentroidsZ()[c] == centroid[2]);
+    }
+    for ( int f = 0; f < grid.numFaces(); ++f )
+    {
+        const auto& centroid = grid.faceCentroid(f);
+        const auto& normal = grid.faceNormal(f);
+        BOOST_CHECK(grid.faceAreas()[f] == grid.faceArea(f));
+        BOOST_CHECK(grid.faceCentroidsX()[f] == centroid[0]);
+        BOOST_CHECK(grid.faceCentroidsY()[f] == centroid[1]);
+        BOOST_CHECK(grid.faceCentroidsZ()[f] == centroid[2]);
+        BOOST_CHECK(grid.faceNormalsX()[f] == normal[0]);
+        BOOST_CHECK(grid.faceNormalsY()[f] == normal[1]);
+        BOOST_CHECK(grid.faceNormalsZ()[f] == normal[2]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(geometryArrays)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3> dims={{8, 4, 2}};
+    std::array<double, 3> size={{ 8.0, 4.0, 2.0}};
+    grid.createCartesian(dims, size);
+    checkGeometryArrays(grid);
+    grid.loadBalance();
+    checkGeometryArrays(grid);
+}
+
+void checkCellConnections(const Dune::CpGrid& grid)
+{
+    const auto& conn = grid.cellConnections();
+    BOOST_REQUIRE_EQUAL(conn.size(), grid.numCells());
+    int num_interior_faces = 0;
+    for (int face = 0; face < grid.numFaces(); ++face) {
+        num_interior_faces += grid.faceCell(face, 0) >= 0 && grid.faceCell(face, 1) >= 0;
+    }
+    BOOST_CHECK_EQUAL(conn.numConnections(), 2 * num_interior_faces);
+    for (int cell = 0; cell < grid.numCells(); ++cell) {
+        const auto nbs = conn.neighbours(cell);
+        const auto faces = conn.faces(cell);
+        const auto signs = conn.signs(cell);
+        BOOST_REQUIRE_EQUAL(nbs.size(), faces.size());
+        for (int i = 0; i < int(nbs.size()); ++i) {
+            const int face = faces[i];
+            const int first = signs[i] > 0 ? 0 : 1;
+            BOOST_CHECK_EQUAL(grid.faceCell(face, first), cell);
+            BOOST_CHECK_EQUAL(grid.faceCell(face, 1 - first), nbs[i]);
+        }
+    }
+    // The cached object is returned on subsequent calls.
+    BOOST_CHECK_EQUAL(&conn, &grid.cellConnections());
+}
+
+BOOST_AUTO_TEST_CASE(cellConnections)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3> dims={{8, 4, 2}};
+    std::array<double, 3> size={{ 8.0, 4.0, 2.0}};
+    grid.createCartesian(dims, size);
+    checkCellConnections(grid);
+    grid.loadBalance();
+    checkCellConnections(grid);
+}
+
+BOOST_AUTO_TEST_CASE(haloExchangePlan)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3> dims={{8, 4, 2}};
+    std::array<double, 3> size={{ 8.0, 4.0, 2.0}};
+    grid.createCartesian(dims, size);
+    grid.loadBalance();
+
+    auto plan = grid.haloExchangePlan<double>(Dune::InteriorBorder_All_Interface, 0, 2);
+    BOOST_CHECK_EQUAL(plan->numValues(), 2u);
+    const auto& gridView = grid.leafGridView();
+    const auto& globalCell = grid.globalCell();
+    // Exchange twice to make sure that the plan can be reused.
+    for (int iteration = 0; iteration < 2; ++iteration) {
+        std::vector<double> values(2 * grid.numCells(), -1.0);
+        for (auto it = gridView.begin<0>(), end = gridView.end<0>(); it != end; ++it) {
+            if (it->partitionType() == Dune::InteriorEntity) {
+                const int index = gridView.indexSet().index(*it);
+                values[2 * index] = globalCell[index];
+                values[2 * index + 1] = iteration;
+            }
+        }
+        plan->exchange(values);
+        for (int cell = 0; cell < grid.numCells(); ++cell) {
+            BOOST_CHECK_EQUAL(values[2 * cell], globalCell[cell]);
+            BOOST_CHECK_EQUAL(values[2 * cell + 1], iteration);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(splitPhaseCommunication)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3> dims={{8, 4, 2}};
+    std::array<double, 3> size={{ 8.0, 4.0, 2.0}};
+    grid.createCartesian(dims, size);
+    BOOST_CHECK_EQUAL(int(grid.interiorCellsNotTouchingOverlap().size()), grid.numCells());
+    BOOST_CHECK(grid.interiorCellsTouchingOverlap().empty());
+    grid.loadBalance();
+
+    const auto& gridView = grid.leafGridView();
+    std::vector<int> interior(grid.numCells(), 0);
+    for (auto it = gridView.begin<0>(), end = gridView.end<0>(); it != end; ++it) {
+        interior[gridView.indexSet().index(*it)] = it->partitionType() == Dune::InteriorEntity;
+    }
+    const auto& inner = grid.interiorCellsNotTouchingOverlap();
+    const auto& border = grid.interiorCellsTouchingOverlap();
+    BOOST_CHECK_EQUAL(int(inner.size() + border.size()),
+                      std::count(interior.begin(), interior.end(), 1));
+    const auto& conn = grid.cellConnections();
+    for (const int cell : inner) {
+        BOOST_CHECK(interior[cell]);
+        for (const int nb : conn.neighbours(cell)) {
+            BOOST_CHECK(interior[nb]);
+        }
+    }
+    for (const int cell : border) {
+        BOOST_CHECK(interior[cell]);
+        const auto nbs = conn.neighbours(cell);
+        BOOST_CHECK(std::any_of(nbs.begin(), nbs.end(), [&](int nb) { return !interior[nb]; }));
+    }
+
+    std::vector<int> point_ids(grid.size(3), -1);
+    std::vector<int> cell_ids(grid.size(0), -1);
+    LoadBalanceGlobalIdDataHandle data(grid.globalIdSet(), grid, point_ids, cell_ids);
+    grid.communicateBegin(data, Dune::InteriorBorder_All_Interface, Dune::ForwardCommunication);
+    BOOST_CHECK_THROW(grid.communicateBegin(data, Dune::InteriorBorder_All_Interface,
+                                            Dune::ForwardCommunication),
+                      std::logic_error);
+    grid.communicateEnd(data, Dune::InteriorBorder_All_Interface, Dune::ForwardCommunication);
+    for (auto it = gridView.begin<0>(), end = gridView.end<0>(); it != end; ++it) {
+        if (it->partitionType() != Dune::InteriorEntity) {
+            BOOST_CHECK_EQUAL(cell_ids[gridView.indexSet().index(*it)],
+                              grid.globalIdSet().id(*it));
+        }
+    }
+}
+
 bool
 init_unit_test_func()
 {
@@ -10,6 +10,8 @@
 #include <dune/geometry/referenceelements.hh>
 #include <dune/common/fvector.hh>
 
+#include <vector>
+
 #if HAVE_DUNE_GRID_CHECKS
 
 #include <dune/grid/test/checkpartition.hh>
@@ -58,6 +60,48 @@ void testPartitionIteratorsOnSequentialGrid(const Dune::CpGrid& grid)
     BOOST_REQUIRE((ait==grid.leafend<codim,Dune::All_Partition>()));
 }
 
+template<int codim, Dune::PartitionIteratorType pitype>
+void testPartitionIteratorAgainstPartitionTypes(const Dune::CpGrid& grid)
+{
+    // Visit all entities and check the partition type of each of them
+    // to get the ones the partition iterator has to visit.
+    std::vector<int> expected;
+    for(auto it=grid.leafbegin<codim,Dune::All_Partition>(),
+            end=grid.leafend<codim,Dune::All_Partition>(); it!=end; ++it)
+    {
+        Dune::PartitionType type=it->partitionType();
+        bool valid;
+        switch(pitype)
+        {
+        case Dune::Interior_Partition:
+            valid = type==Dune::InteriorEntity;
+            break;
+        case Dune::InteriorBorder_Partition:
+            valid = type==Dune::InteriorEntity || type==Dune::BorderEntity;
+            break;
+        default:
+            valid = type!=Dune::FrontEntity;
+        }
+        if(valid)
+            expected.push_back(it->index());
+    }
+    std::vector<int> visited;
+    for(auto it=grid.leafbegin<codim,pitype>(), end=grid.leafend<codim,pitype>();
+        it!=end; ++it)
+    {
+        visited.push_back(it->index());
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(visited.begin(), visited.end(),
+                                  expected.begin(), expected.end());
+}
+
+template<int codim>
+void testPartitionIteratorsAgainstPartitionTypes(const Dune::CpGrid& grid)
+{
+    testPartitionIteratorAgainstPartitionTypes<codim,Dune::Interior_Partition>(grid);
+    testPartitionIteratorAgainstPartitionTypes<codim,Dune::InteriorBorder_Partition>(grid);
+    testPartitionIteratorAgainstPartitionTypes<codim,Dune::Overlap_Partition>(grid);
+}
 
 BOOST_AUTO_TEST_CASE(partitionIteratorTest)
 {
@@ -90,6 +134,8 @@ BOOST_AUTO_TEST_CASE(partitionIteratorTest)
     testPartitionIteratorsBasic<0>(grid, parallel);
     testPartitionIteratorsBasic<1>(grid, parallel);
     testPartitionIteratorsBasic<3>(grid, parallel);
+    testPartitionIteratorsAgainstPartitionTypes<0>(grid);
+    testPartitionIteratorsAgainstPartitionTypes<3>(grid);
     if(!parallel)
     {
         testPartitionIteratorsOnSequentialGrid<0>(grid);
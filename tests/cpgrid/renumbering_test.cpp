@@ -0,0 +1,143 @@
+/*
+  This file is part of The Open Porous Media project  (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <config.h>
+
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE RenumberingTests
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/unit_test.hpp>
+#include <opm/grid/CpGrid.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+int bandwidth(const Dune::CpGrid& grid)
+{
+    int width = 0;
+    for (int face = 0; face < grid.numFaces(); ++face) {
+        const int c0 = grid.faceCell(face, 0);
+        const int c1 = grid.faceCell(face, 1);
+        if (c0 >= 0 && c1 >= 0) {
+            width = std::max(width, std::abs(c0 - c1));
+        }
+    }
+    return width;
+}
+
+void checkRenumbering(Dune::CellOrdering ordering)
+{
+    Dune::CpGrid grid;
+    std::array<int, 3>    dims     = {{ 6, 5, 4 }};
+    std::array<double, 3> cellsize = {{ 1., 2., 3. }};
+    grid.createCartesian(dims, cellsize);
+
+    const int num_cells = grid.numCells();
+    const int num_faces = grid.numFaces();
+    const std::vector<int> old_global = grid.globalCell();
+    const int old_bandwidth = bandwidth(grid);
+    std::vector<Dune::CpGrid::Vector> old_cell_centroid, old_face_centroid;
+    std::vector<double> old_volume, old_area;
+    std::vector<std::array<int, 2> > old_face_cells;
+    for (int c = 0; c < num_cells; ++c) {
+        old_cell_centroid.push_back(grid.cellCentroid(c));
+        old_volume.push_back(grid.cellVolume(c));
+    }
+    for (int f = 0; f < num_faces; ++f) {
+        old_face_centroid.push_back(grid.faceCentroid(f));
+        old_area.push_back(grid.faceArea(f));
+        old_face_cells.push_back({{ grid.faceCell(f, 0), grid.faceCell(f, 1) }});
+    }
+
+    std::vector<int> face_order;
+    const std::vector<int> cell_order = grid.renumber(ordering, &face_order);
+    BOOST_REQUIRE_EQUAL(int(cell_order.size()), num_cells);
+    BOOST_REQUIRE_EQUAL(int(face_order.size()), num_faces);
+    BOOST_REQUIRE_EQUAL(grid.numCells(), num_cells);
+    BOOST_REQUIRE_EQUAL(grid.numFaces(), num_faces);
+    std::vector<int> sorted(cell_order);
+    std::sort(sorted.begin(), sorted.end());
+    for (int c = 0; c < num_cells; ++c) {
+        BOOST_REQUIRE_EQUAL(sorted[c], c);
+    }
+
+    std::vector<int> old_to_new(num_cells);
+    for (int c = 0; c < num_cells; ++c) {
+        old_to_new[cell_order[c]] = c;
+        BOOST_CHECK_EQUAL(grid.globalCell()[c], old_global[cell_order[c]]);
+        BOOST_CHECK_EQUAL(grid.cellVolume(c), old_volume[cell_order[c]]);
+        BOOST_CHECK(grid.cellCentroid(c) == old_cell_centroid[cell_order[c]]);
+        BOOST_CHECK_EQUAL(grid.cellVolumes()[c], old_volume[cell_order[c]]);
+    }
+
+    int previous_first_cell = 0;
+    for (int f = 0; f < num_faces; ++f) {
+        const int old = face_order[f];
+        BOOST_CHECK_EQUAL(grid.faceArea(f), old_area[old]);
+        BOOST_CHECK(grid.faceCentroid(f) == old_face_centroid[old]);
+        int first_cell = num_cells;
+        for (int i = 0; i < 2; ++i) {
+            const int old_cell = old_face_cells[old][i];
+            BOOST_CHECK_EQUAL(grid.faceCell(f, i), old_cell < 0 ? -1 : old_to_new[old_cell]);
+            if (old_cell >= 0) {
+                first_cell = std::min(first_cell, old_to_new[old_cell]);
+            }
+        }
+        // The faces are ordered by their first cell.
+        BOOST_CHECK(first_cell >= previous_first_cell);
+        previous_first_cell = first_cell;
+    }
+
+    for (int c = 0; c < num_cells; ++c) {
+        for (int i = 0; i < grid.numCellFaces(c); ++i) {
+            const int face = grid.cellFace(c, i);
+            BOOST_CHECK(grid.faceCell(face, 0) == c || grid.faceCell(face, 1) == c);
+        }
+    }
+
+    if (ordering == Dune::reverseCuthillMcKeeOrdering) {
+        BOOST_CHECK(bandwidth(grid) <= old_bandwidth);
+    }
+}
+} // end anonymous namespace
+
+BOOST_AUTO_TEST_CASE(reverseCuthillMcKee)
+{
+    checkRenumbering(Dune::reverseCuthillMcKeeOrdering);
+}
+
+BOOST_AUTO_TEST_CASE(hilbertCurve)
+{
+    checkRenumbering(Dune::hilbertCurveOrdering);
+}
+
+bool
+init_unit_test_func()
+{
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+    boost::unit_test::unit_test_main(&init_unit_test_func,
+                                     argc, argv);
+}
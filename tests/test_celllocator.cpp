@@ -0,0 +1,303 @@
+/*
+  This file is part of The Open Porous Media project  (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <config.h>
+
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE CellLocatorTests
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <opm/grid/CpGrid.hpp>
+#include <opm/grid/cpgrid/GridHelpers.hpp>
+#include <opm/grid/GridHelpers.hpp>
+#include <opm/grid/UnstructuredGrid.h>
+#include <opm/grid/cart_grid.h>
+#include <opm/grid/cornerpoint_grid.h>
+#include <opm/grid/common/CellLocator.hpp>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+template <class Grid>
+void checkCentroids(const Grid& grid, const Opm::CellLocator<Grid>& locator)
+{
+    typedef typename Opm::CellLocator<Grid>::Point Point;
+    const int nc = Opm::UgGridHelpers::numCells(grid);
+    std::vector<Point> points(nc);
+    for (int c = 0; c < nc; ++c) {
+        for (int d = 0; d < 3; ++d) {
+            points[c][d] = Opm::UgGridHelpers::cellCentroidCoordinate(grid, c, d);
+        }
+    }
+    const std::vector<int> cells = locator.locate(points);
+    BOOST_REQUIRE_EQUAL(cells.size(), points.size());
+    for (int c = 0; c < nc; ++c) {
+        BOOST_CHECK_EQUAL(cells[c], c);
+        BOOST_CHECK_EQUAL(locator.locate(points[c]), c);
+    }
+}
+
+/// The cells that may contain a point at height z in a column of cells
+/// firstCell + k*stride, k = 0, ..., nz-1. The surface s between the
+/// cells k = s-1 and k = s lies between lower[s] and upper[s], and a point
+/// in that range may be in either of them, or outside for s = 0 and s = nz.
+std::vector<int> cellsInColumn(const double z,
+                               const std::vector<double>& lower,
+                               const std::vector<double>& upper,
+                               const int firstCell, const int stride)
+{
+    const int nz = lower.size() - 1;
+    for (int s = 0; s <= nz; ++s) {
+        const int above = s > 0 ? firstCell + (s - 1) * stride : -1;
+        if (z < lower[s]) {
+            return { above };
+        }
+        if (z <= upper[s]) {
+            return { above, s < nz ? firstCell + s * stride : -1 };
+        }
+    }
+    return { -1 };
+}
+
+/// Locate random points in [lower, upper] and compare with the cartesian
+/// indices of the cells that may contain them, given by expected(point).
+template <class Grid, class Expected>
+void checkRandomPoints(const Grid& grid, const Opm::CellLocator<Grid>& locator,
+                       const typename Opm::CellLocator<Grid>::Point& lower,
+                       const typename Opm::CellLocator<Grid>::Point& upper,
+                       const Expected& expected)
+{
+    typedef typename Opm::CellLocator<Grid>::Point Point;
+    const int* global_cell = Opm::UgGridHelpers::globalCell(grid);
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    std::vector<Point> points(500);
+    for (auto& point : points) {
+        for (int d = 0; d < 3; ++d) {
+            point[d] = lower[d] + (upper[d] - lower[d]) * distribution(generator);
+        }
+    }
+    const std::vector<int> cells = locator.locate(points);
+    BOOST_REQUIRE_EQUAL(cells.size(), points.size());
+    int inside = 0;
+    int outside = 0;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        BOOST_CHECK_EQUAL(locator.locate(points[i]), cells[i]);
+        const int cell = (cells[i] == -1 || !global_cell) ? cells[i] : global_cell[cells[i]];
+        const std::vector<int> candidates = expected(points[i]);
+        BOOST_CHECK_MESSAGE(std::find(candidates.begin(), candidates.end(), cell) != candidates.end(),
+                            "The point " << points[i] << " was located in the cell " << cell);
+        if (candidates.size() == 1) {
+            ++(cell == -1 ? outside : inside);
+        }
+    }
+    BOOST_CHECK(inside > 0);
+    BOOST_CHECK(outside > 0);
+}
+
+/// The index of the interval [v[i], v[i+1]) containing a, -1 if there is none.
+int interval(const std::vector<double>& v, const double a)
+{
+    if (a < v.front() || a >= v.back()) {
+        return -1;
+    }
+    return std::upper_bound(v.begin(), v.end(), a) - v.begin() - 1;
+}
+
+BOOST_AUTO_TEST_CASE(unstructuredGridWithTopography)
+{
+    const int nx = 6;
+    const int ny = 4;
+    const int nz = 3;
+    std::vector<double> x(nx + 1), y(ny + 1), z(nz + 1), depthz((nx + 1) * (ny + 1));
+    for (int i = 0; i <= nx; ++i) {
+        x[i] = i + 0.3 * std::sin(i);
+    }
+    for (int j = 0; j <= ny; ++j) {
+        y[j] = 2.0 * j;
+    }
+    for (int k = 0; k <= nz; ++k) {
+        z[k] = 0.5 * k * k + k;
+    }
+    for (int j = 0; j <= ny; ++j) {
+        for (int i = 0; i <= nx; ++i) {
+            depthz[i + (nx + 1) * j] = 0.7 * std::sin(0.8 * i) + 0.3 * j;
+        }
+    }
+    std::unique_ptr<UnstructuredGrid, void (*)(UnstructuredGrid*)>
+        grid(create_grid_tensor3d(nx, ny, nz, x.data(), y.data(), z.data(), depthz.data()),
+             destroy_grid);
+    BOOST_REQUIRE(grid);
+
+    Opm::CellLocator<UnstructuredGrid> locator(*grid, 2);
+    checkCentroids(*grid, locator);
+
+    typedef Opm::CellLocator<UnstructuredGrid>::Point Point;
+    Point outside;
+    outside[0] = x[nx] + 1.0;
+    outside[1] = y[ny] / 2;
+    outside[2] = z[nz] / 2;
+    BOOST_CHECK_EQUAL(locator.locate(outside), -1);
+
+    // The columns are bounded by the planes of the tensor grid. The layer
+    // surfaces are shifted by depthz, which varies within a column.
+    const auto expected = [&](const Point& p) -> std::vector<int>
+    {
+        const int i = interval(x, p[0]);
+        const int j = interval(y, p[1]);
+        if (i == -1 || j == -1) {
+            return { -1 };
+        }
+        std::vector<double> lower(nz + 1), upper(nz + 1);
+        for (int k = 0; k <= nz; ++k) {
+            lower[k] = std::numeric_limits<double>::max();
+            upper[k] = -std::numeric_limits<double>::max();
+            for (int b = 0; b < 2; ++b) {
+                for (int a = 0; a < 2; ++a) {
+                    const double depth = z[k] + depthz[i + a + (nx + 1) * (j + b)];
+                    lower[k] = std::min(lower[k], depth);
+                    upper[k] = std::max(upper[k], depth);
+                }
+            }
+        }
+        return cellsInColumn(p[2], lower, upper, i + nx * j, nx * ny);
+    };
+    Point lower, upper;
+    lower[0] = -1.0; lower[1] = -1.0; lower[2] = -2.0;
+    upper[0] = x[nx] + 1.0; upper[1] = y[ny] + 1.0; upper[2] = z[nz] + 3.0;
+    checkRandomPoints(*grid, locator, lower, upper, expected);
+}
+
+// A 2x2x2 corner-point grid with unit cells on vertical pillars. The
+// depths alternate by 0.2 between neighbouring pillars, hence no face is
+// planar, and the second column in x direction is shifted down by half a
+// cell, i.e. there is a fault with a throw of 0.5 at x = 1.
+BOOST_AUTO_TEST_CASE(faultedCornerPointGrid)
+{
+    const int n = 2;
+    const double twist = 0.2;
+    const double shift = 0.5;
+    std::vector<double> coord;
+    for (int j = 0; j <= n; ++j) {
+        for (int i = 0; i <= n; ++i) {
+            const double pillar[] = { double(i), double(j), -1.0, double(i), double(j), n + 2.0 };
+            coord.insert(coord.end(), pillar, pillar + 6);
+        }
+    }
+    std::vector<double> zcorn;
+    for (int k = 0; k < n; ++k) {
+        for (int t = 0; t < 2; ++t) {
+            for (int jj = 0; jj < 2 * n; ++jj) {
+                for (int ii = 0; ii < 2 * n; ++ii) {
+                    const int px = ii / 2 + ii % 2;
+                    const int py = jj / 2 + jj % 2;
+                    zcorn.push_back(k + t + twist * ((px + py) % 2) + (ii / 2 == 1 ? shift : 0.0));
+                }
+            }
+        }
+    }
+    grdecl g;
+    g.dims[0] = n;
+    g.dims[1] = n;
+    g.dims[2] = n;
+    g.coord = coord.data();
+    g.zcorn = zcorn.data();
+    g.actnum = nullptr;
+    g.mapaxes = nullptr;
+    std::unique_ptr<UnstructuredGrid, void (*)(UnstructuredGrid*)>
+        grid(create_grid_cornerpoint(&g, 0.0), destroy_grid);
+    BOOST_REQUIRE(grid);
+    BOOST_REQUIRE_EQUAL(grid->number_of_cells, n * n * n);
+
+    Opm::CellLocator<UnstructuredGrid> locator(*grid);
+    checkCentroids(*grid, locator);
+
+    typedef Opm::CellLocator<UnstructuredGrid>::Point Point;
+    const auto expected = [&](const Point& p) -> std::vector<int>
+    {
+        if (p[0] < 0.0 || p[0] >= n || p[1] < 0.0 || p[1] >= n) {
+            return { -1 };
+        }
+        const int i = static_cast<int>(p[0]);
+        const int j = static_cast<int>(p[1]);
+        std::vector<double> lower(n + 1), upper(n + 1);
+        for (int k = 0; k <= n; ++k) {
+            lower[k] = k + (i == 1 ? shift : 0.0);
+            upper[k] = lower[k] + twist;
+        }
+        return cellsInColumn(p[2], lower, upper, i + n * j, n * n);
+    };
+    Point lower, upper;
+    lower[0] = -0.5; lower[1] = -0.5; lower[2] = -0.5;
+    upper[0] = n + 0.5; upper[1] = n + 0.5; upper[2] = n + 1.0;
+    checkRandomPoints(*grid, locator, lower, upper, expected);
+}
+
+BOOST_AUTO_TEST_CASE(cpGrid)
+{
+    Dune::CpGrid grid;
+    const std::array<int, 3> dims = {{ 5, 4, 3 }};
+    const std::array<double, 3> size = {{ 1.0, 2.0, 0.5 }};
+    grid.createCartesian(dims, size);
+
+    Opm::CellLocator<Dune::CpGrid> locator(grid);
+    checkCentroids(grid, locator);
+
+    typedef Opm::CellLocator<Dune::CpGrid>::Point Point;
+    Point lower(std::numeric_limits<double>::max());
+    Point upper(-std::numeric_limits<double>::max());
+    for (int v = 0; v < grid.size(3); ++v) {
+        const double* x = Opm::UgGridHelpers::vertexCoordinates(grid, v);
+        for (int d = 0; d < 3; ++d) {
+            lower[d] = std::min(lower[d], x[d] - 1.0);
+            upper[d] = std::max(upper[d], x[d] + 1.0);
+        }
+    }
+    // The cell (i, j, k) is the box [i, i+1] x [2j, 2j+2] x [k/2, k/2+1/2].
+    const auto expected = [&](const Point& p) -> std::vector<int>
+    {
+        std::array<int, 3> ijk;
+        for (int d = 0; d < 3; ++d) {
+            ijk[d] = static_cast<int>(std::floor(p[d] / size[d]));
+            if (ijk[d] < 0 || ijk[d] >= dims[d]) {
+                return { -1 };
+            }
+        }
+        return { ijk[0] + dims[0] * (ijk[1] + dims[1] * ijk[2]) };
+    };
+    checkRandomPoints(grid, locator, lower, upper, expected);
+}
+
+bool
+init_unit_test_func()
+{
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+    boost::unit_test::unit_test_main(&init_unit_test_func,
+                                     argc, argv);
+}
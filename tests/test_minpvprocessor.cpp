@@ -122,3 +122,82 @@ BOOST_AUTO_TEST_CASE(Processing)
     BOOST_CHECK_EQUAL(nnc6.size(), 1);
     BOOST_CHECK_EQUAL_COLLECTIONS(z6.begin(), z6.end(), zcorn4after.begin(), zcorn4after.end());
 }
+
+BOOST_AUTO_TEST_CASE(ProcessingColumns)
+{
+    // Columns of a 3x2x4 grid are copies of the single column of the
+    // test above, with different minpv values. Each must be processed as
+    // if it was alone.
+    const std::vector<double> column_zcorn = { 0, 0, 0, 0,
+                                               2, 2, 2, 2,
+                                               2, 2, 2, 2,
+                                               3, 3, 3, 3,
+                                               3, 3, 3, 3,
+                                               3, 3, 3, 3,
+                                               3, 3, 3, 3,
+                                               6, 6, 6, 6 };
+    const std::vector<double> column_pv = { 2, 1, 0, 3 };
+    const std::vector<int> column_actnum = { 1, 1, 0, 1 };
+    const std::vector<double> column_thickness = { 2, 1, 0, 3 };
+    const std::vector<std::vector<double>> column_minpvv = { std::vector<double>(4, 0.5),
+                                                             std::vector<double>(4, 1.5),
+                                                             std::vector<double>(4, 2.5),
+                                                             { 1, 2, 2, 1 } };
+    const double z_threshold = 0.0;
+    const int nx = 3;
+    const int ny = 2;
+    const int nz = 4;
+    const int layer = nx * ny;
+
+    // Index in ZCORN of corner (a, b, c) of cell (i, j, k).
+    auto zcornIndex = [&](int i, int j, int k, int a, int b, int c) {
+        return (2*i + a) + 2*nx*((2*j + b) + 2*ny*(2*k + c));
+    };
+
+    for (const bool fill_removed_cells : { true, false }) {
+        std::vector<double> zcorn(8 * nx * ny * nz);
+        std::vector<double> pv(nx * ny * nz);
+        std::vector<double> minpvv(pv.size());
+        std::vector<int> actnum(pv.size());
+        std::vector<double> thickness(pv.size());
+        for (int column = 0; column < layer; ++column) {
+            const auto& col_minpvv = column_minpvv[column % column_minpvv.size()];
+            for (int k = 0; k < nz; ++k) {
+                const int c = column + layer * k;
+                pv[c] = column_pv[k];
+                minpvv[c] = col_minpvv[k];
+                actnum[c] = column_actnum[k];
+                thickness[c] = column_thickness[k];
+                for (int corner = 0; corner < 8; ++corner) {
+                    zcorn[zcornIndex(column % nx, column / nx, k, corner % 2, (corner / 2) % 2, corner / 4)]
+                        = column_zcorn[8*k + corner];
+                }
+            }
+        }
+
+        Opm::MinpvProcessor mp(nx, ny, nz);
+        const auto nnc = mp.process(thickness, z_threshold, pv, minpvv, actnum, fill_removed_cells, zcorn.data());
+
+        std::size_t expected_nnc_size = 0;
+        for (int column = 0; column < layer; ++column) {
+            Opm::MinpvProcessor column_mp(1, 1, nz);
+            auto z = column_zcorn;
+            const auto column_nnc = column_mp.process(column_thickness, z_threshold, column_pv,
+                                                      column_minpvv[column % column_minpvv.size()],
+                                                      column_actnum, fill_removed_cells, z.data());
+            for (int k = 0; k < nz; ++k) {
+                for (int corner = 0; corner < 8; ++corner) {
+                    BOOST_CHECK_EQUAL(zcorn[zcornIndex(column % nx, column / nx, k, corner % 2, (corner / 2) % 2, corner / 4)],
+                                      z[8*k + corner]);
+                }
+            }
+            for (const auto& conn : column_nnc) {
+                const auto it = nnc.find(column + layer * conn.first);
+                BOOST_REQUIRE(it != nnc.end());
+                BOOST_CHECK_EQUAL(it->second, column + layer * conn.second);
+            }
+            expected_nnc_size += column_nnc.size();
+        }
+        BOOST_CHECK_EQUAL(nnc.size(), expected_nnc_size);
+    }
+}
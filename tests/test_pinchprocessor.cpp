@@ -0,0 +1,255 @@
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE PinchProcessorTest
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <dune/common/parallel/mpihelper.hh>
+#include <opm/grid/CpGrid.hpp>
+#include <opm/grid/cpgrid/GridHelpers.hpp>
+#include <opm/grid/cornerpoint_grid.h>
+#include <opm/grid/UnstructuredGrid.h>
+#include <opm/grid/PinchProcessor.hpp>
+
+#include <iterator>
+#include <memory>
+#include <vector>
+
+typedef std::unique_ptr<UnstructuredGrid, void (*)(UnstructuredGrid*)> GridPtr;
+
+/// The half-face transmissibilities of each cell are its cartesian index plus one.
+template <class Grid>
+std::vector<double> halfTrans(const Grid& grid)
+{
+    const int* global_cell = Opm::UgGridHelpers::globalCell(grid);
+    const auto cell_faces = Opm::UgGridHelpers::cell2Faces(grid);
+    std::vector<double> htrans;
+    for (int c = 0; c < Opm::UgGridHelpers::numCells(grid); ++c) {
+        const auto faces = cell_faces[c];
+        htrans.insert(htrans.end(), std::distance(faces.begin(), faces.end()),
+                      (global_cell ? global_cell[c] : c) + 1.0);
+    }
+    return htrans;
+}
+
+/// Map values per cartesian cell to the cells of the grid.
+template <class Grid>
+std::vector<double> activeValues(const Grid& grid, const std::vector<double>& values)
+{
+    const int* global_cell = Opm::UgGridHelpers::globalCell(grid);
+    std::vector<double> active(Opm::UgGridHelpers::numCells(grid));
+    for (int c = 0; c < static_cast<int>(active.size()); ++c) {
+        active[c] = values[global_cell ? global_cell[c] : c];
+    }
+    return active;
+}
+
+// A 2x1x6 grid of unit cells. The cells (0,0,2), (0,0,3) and (1,0,2) are
+// below MINPV, and the cells (1,0,1) and (1,0,3) are inactive, i.e. the
+// search for the top and bottom cell of the second column has to skip them:
+//
+//   k   x = 0   x = 1
+//   0             top
+//   1    top    inactive
+//   2   pinch    pinch
+//   3   pinch   inactive
+//   4    bot      bot
+//   5
+struct PinchedColumns
+{
+    PinchedColumns()
+        : actnum{ 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 1 },
+          pv(12, 10.0),
+          multz(12, 1.0),
+          grid(nullptr, destroy_grid)
+    {
+        for (int j = 0; j < 2; ++j) {
+            for (int i = 0; i < 3; ++i) {
+                const double pillar[] = { double(i), double(j), 0.0, double(i), double(j), 6.0 };
+                coord.insert(coord.end(), pillar, pillar + 6);
+            }
+        }
+        for (int k = 0; k < 6; ++k) {
+            zcorn.insert(zcorn.end(), 8, double(k));
+            zcorn.insert(zcorn.end(), 8, double(k + 1));
+        }
+        pv[4] = pv[6] = pv[5] = 0.1;
+
+        // The multipliers of the cells above and in the segments.
+        multz[2] = 0.5;
+        multz[4] = 0.25;
+        multz[6] = 0.8;
+        multz[1] = 0.9;
+        multz[5] = 0.3;
+
+        grdecl g;
+        g.dims[0] = 2;
+        g.dims[1] = 1;
+        g.dims[2] = 6;
+        g.coord = coord.data();
+        g.zcorn = zcorn.data();
+        g.actnum = actnum.data();
+        g.mapaxes = nullptr;
+        grid.reset(create_grid_cornerpoint(&g, 0.0));
+        BOOST_REQUIRE(grid);
+        BOOST_REQUIRE_EQUAL(grid->number_of_cells, 10);
+    }
+
+    Opm::NNC process(Opm::PinchMode::ModeEnum multzMode,
+                     const std::vector<int>& pinchActnum)
+    {
+        Opm::PinchProcessor<UnstructuredGrid> processor(1.0, 0.001, Opm::PinchMode::ModeEnum::TOPBOT, multzMode);
+        Opm::NNC nnc;
+        processor.process(*grid, halfTrans(*grid), pinchActnum, activeValues(*grid, multz), pv, nnc);
+        return nnc;
+    }
+
+    std::vector<double> coord;
+    std::vector<double> zcorn;
+    std::vector<int> actnum;
+    std::vector<double> pv;
+    std::vector<double> multz;
+    GridPtr grid;
+};
+
+void checkNNC(const Opm::NNCdata& nnc, int cell1, int cell2, double trans)
+{
+    BOOST_CHECK_EQUAL(nnc.cell1, std::size_t(cell1));
+    BOOST_CHECK_EQUAL(nnc.cell2, std::size_t(cell2));
+    BOOST_CHECK_CLOSE(nnc.trans, trans, 1e-10);
+}
+
+// The NNCs are ordered by the first cell of the segments. Their
+// transmissibility is 1/(1/(2 + 1) + 1/(8 + 1)) = 9/4 for the first
+// and 1/(1/(1 + 1) + 1/(9 + 1)) = 5/3 for the second column.
+BOOST_FIXTURE_TEST_CASE(MultzTop, PinchedColumns)
+{
+    const auto nnc = process(Opm::PinchMode::ModeEnum::TOP, actnum).nncdata();
+    BOOST_REQUIRE_EQUAL(nnc.size(), 2U);
+    checkNNC(nnc[0], 2, 8, 9.0/4.0 * 0.5);
+    checkNNC(nnc[1], 1, 9, 5.0/3.0 * 0.9);
+}
+
+// With ALL the smallest multiplier of the top cell and the segment is used.
+BOOST_FIXTURE_TEST_CASE(MultzAll, PinchedColumns)
+{
+    const auto nnc = process(Opm::PinchMode::ModeEnum::ALL, actnum).nncdata();
+    BOOST_REQUIRE_EQUAL(nnc.size(), 2U);
+    checkNNC(nnc[0], 2, 8, 9.0/4.0 * 0.25);
+    checkNNC(nnc[1], 1, 9, 5.0/3.0 * 0.3);
+}
+
+// Cells that are active in ACTNUM but not in the grid, e.g. because they
+// were removed when building the grid, do not get connections in a serial grid.
+BOOST_FIXTURE_TEST_CASE(MissingCells, PinchedColumns)
+{
+    auto pinchActnum = actnum;
+    pinchActnum[3] = 1;
+    auto nnc = process(Opm::PinchMode::ModeEnum::TOP, pinchActnum).nncdata();
+    BOOST_REQUIRE_EQUAL(nnc.size(), 1U);
+    checkNNC(nnc[0], 2, 8, 9.0/4.0 * 0.5);
+
+    pinchActnum = actnum;
+    pinchActnum[7] = 1;
+    nnc = process(Opm::PinchMode::ModeEnum::TOP, pinchActnum).nncdata();
+    BOOST_REQUIRE_EQUAL(nnc.size(), 1U);
+    checkNNC(nnc[0], 2, 8, 9.0/4.0 * 0.5);
+
+    // Without an active cell above the segment there is no connection.
+    pinchActnum = actnum;
+    pinchActnum[1] = 0;
+    nnc = process(Opm::PinchMode::ModeEnum::TOP, pinchActnum).nncdata();
+    BOOST_REQUIRE_EQUAL(nnc.size(), 1U);
+    checkNNC(nnc[0], 2, 8, 9.0/4.0 * 0.5);
+}
+
+// On a distributed grid every connection is created by exactly one
+// process, with the same transmissibility as on the global grid.
+BOOST_AUTO_TEST_CASE(DistributedGrid)
+{
+    const std::array<int, 3> dims = {{ 3, 2, 5 }};
+    const std::array<double, 3> size = {{ 3.0, 2.0, 5.0 }};
+    const int numColumns = dims[0] * dims[1];
+    const int numCartesianCells = numColumns * dims[2];
+    // Each column is pinched at k = 2, the first one also at k = 3.
+    std::vector<double> pv(numCartesianCells, 10.0);
+    std::vector<double> multz(numCartesianCells, 1.0);
+    for (int column = 0; column < numColumns; ++column) {
+        pv[column + 2*numColumns] = 0.1;
+        multz[column + numColumns] = 0.5 + 0.1*column;
+    }
+    pv[3*numColumns] = 0.1;
+    const std::vector<int> actnum(numCartesianCells, 1);
+    Opm::PinchProcessor<Dune::CpGrid> processor(1.0, 0.001, Opm::PinchMode::ModeEnum::TOPBOT,
+                                                Opm::PinchMode::ModeEnum::TOP);
+
+    Dune::CpGrid grid;
+    grid.createCartesian(dims, size);
+    Opm::NNC globalNNC;
+    processor.process(grid, halfTrans(grid), actnum, activeValues(grid, multz), pv, globalNNC);
+    const auto expected = globalNNC.nncdata();
+    BOOST_REQUIRE_EQUAL(expected.size(), std::size_t(numColumns));
+    checkNNC(expected[0], numColumns, 4*numColumns, 1.0/(1.0/(numColumns + 1) + 1.0/(4*numColumns + 1)) * 0.5);
+
+    if (!grid.loadBalance()) {
+        return;
+    }
+    // The bottom cells have to be on the process owning the top cells,
+    // hence whole columns are moved to one process. The communicator of
+    // the grid is replaced by repartition().
+    const auto cc = grid.comm();
+    std::vector<int> cellPart(grid.numCells());
+    for (int c = 0; c < grid.numCells(); ++c) {
+        cellPart[c] = (grid.globalCell()[c] % numColumns) % cc.size();
+    }
+    grid.repartition(cellPart);
+
+    Opm::NNC localNNC;
+    processor.process(grid, halfTrans(grid), actnum, activeValues(grid, multz), pv, localNNC);
+    std::vector<int> found(expected.size(), 0);
+    for (const auto& nnc : localNNC.nncdata()) {
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            if (nnc.cell1 == expected[i].cell1 && nnc.cell2 == expected[i].cell2) {
+                BOOST_CHECK_CLOSE(nnc.trans, expected[i].trans, 1e-10);
+                ++found[i];
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(cc.sum(static_cast<int>(localNNC.nncdata().size())), numColumns);
+    cc.sum(found.data(), found.size());
+    for (const int count : found) {
+        BOOST_CHECK_EQUAL(count, 1);
+    }
+}
+
+bool
+init_unit_test_func()
+{
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+    boost::unit_test::unit_test_main(&init_unit_test_func,
+                                     argc, argv);
+}
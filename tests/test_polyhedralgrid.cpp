@@ -0,0 +1,103 @@
+/*
+  This file is part of The Open Porous Media project  (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <config.h>
+
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE PolyhedralGridTests
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <dune/common/parallel/mpihelper.hh>
+#include <opm/grid/polyhedralgrid.hh>
+#include <opm/grid/cornerpoint_grid.h>
+#include <opm/grid/UnstructuredGrid.h>
+
+#include <memory>
+#include <vector>
+
+typedef Dune::PolyhedralGrid<3, 3> Grid;
+
+// Checks that the corners of all cells of a 2x1x1 grid with unit cells
+// are in the order of the cube reference element. The corners on the
+// pillar at the origin have the depth zero, at all other pillars the top
+// corners are at depth zero and the bottom corners at depth one.
+void checkCorners(const Grid& grid)
+{
+    BOOST_REQUIRE_EQUAL(grid.size(0), 2);
+    const auto view = grid.leafGridView();
+    for (auto it = view.begin<0>(), end = view.end<0>(); it != end; ++it) {
+        const auto geometry = it->geometry();
+        BOOST_REQUIRE_EQUAL(geometry.corners(), 8);
+        const double x0 = geometry.center()[0] < 1.0 ? 0.0 : 1.0;
+        for (int v = 0; v < 8; ++v) {
+            const double x = x0 + (v & 1);
+            const double y = (v >> 1) & 1;
+            const bool pinched = x == 0.0 && y == 0.0;
+            const double z = (v & 4) && !pinched ? 1.0 : 0.0;
+            const auto corner = geometry.corner(v);
+            BOOST_CHECK_EQUAL(corner[0], x);
+            BOOST_CHECK_EQUAL(corner[1], y);
+            BOOST_CHECK_EQUAL(corner[2], z);
+        }
+    }
+}
+
+// The first cell is collapsed at one pillar, where its top and bottom
+// corner are the same node. That node is on the top and the bottom face
+// and has to take both positions in the reference element.
+BOOST_AUTO_TEST_CASE(collapsedCellCorners)
+{
+    const std::vector<double> coord = { 0, 0, 0, 0, 0, 1,
+                                        1, 0, 0, 1, 0, 1,
+                                        2, 0, 0, 2, 0, 1,
+                                        0, 1, 0, 0, 1, 1,
+                                        1, 1, 0, 1, 1, 1,
+                                        2, 1, 0, 2, 1, 1 };
+    const std::vector<double> zcorn = { 0, 0, 0, 0,
+                                        0, 0, 0, 0,
+                                        0, 1, 1, 1,
+                                        1, 1, 1, 1 };
+    grdecl g;
+    g.dims[0] = 2;
+    g.dims[1] = 1;
+    g.dims[2] = 1;
+    g.coord = coord.data();
+    g.zcorn = zcorn.data();
+    g.actnum = nullptr;
+    g.mapaxes = nullptr;
+
+    std::unique_ptr<UnstructuredGrid, void (*)(UnstructuredGrid*)>
+        ug(create_grid_cornerpoint(&g, 0.0), destroy_grid);
+    BOOST_REQUIRE(ug);
+    BOOST_REQUIRE(ug->cell_facetag);
+    Grid grid(*ug);
+    checkCorners(grid);
+}
+
+bool
+init_unit_test_func()
+{
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+    boost::unit_test::unit_test_main(&init_unit_test_func,
+                                     argc, argv);
+}
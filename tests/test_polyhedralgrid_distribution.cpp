@@ -0,0 +1,156 @@
+/*
+  This file is part of The Open Porous Media project  (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <config.h>
+
+#define NVERBOSE // to suppress our messages when throwing
+
+#define BOOST_TEST_MODULE PolyhedralGridDistributionTests
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/common/datahandleif.hh>
+#include <opm/grid/polyhedralgrid.hh>
+#include <opm/grid/cart_grid.h>
+#include <opm/grid/UnstructuredGrid.h>
+
+#include <memory>
+#include <vector>
+
+typedef Dune::PolyhedralGrid<3, 3> Grid;
+
+/// Copies one integer per cell from a source to a target vector,
+/// both indexed by the index of the cell in its grid.
+class CellDataHandle
+    : public Dune::CommDataHandleIF<CellDataHandle, int>
+{
+public:
+    CellDataHandle(const std::vector<int>& source, std::vector<int>& target)
+        : source_(source), target_(target)
+    {}
+    bool contains(int dim, int codim)
+    {
+        return dim == 3 && codim == 0;
+    }
+    bool fixedsize(int, int)
+    {
+        return true;
+    }
+    template<class E>
+    std::size_t size(const E&)
+    {
+        return 1;
+    }
+    template<class B, class E>
+    void gather(B& buffer, const E& e)
+    {
+        buffer.write(source_[e.seed().index()]);
+    }
+    template<class B, class E>
+    void scatter(B& buffer, const E& e, std::size_t)
+    {
+        buffer.read(target_[e.seed().index()]);
+    }
+private:
+    const std::vector<int>& source_;
+    std::vector<int>& target_;
+};
+
+BOOST_AUTO_TEST_CASE(distributeAndCommunicate)
+{
+    std::unique_ptr<UnstructuredGrid, void (*)(UnstructuredGrid*)>
+        ug(create_grid_cart3d(8, 6, 4), destroy_grid);
+    BOOST_REQUIRE(ug);
+    {
+        Grid grid(*ug);
+        const int global_cells = grid.size(0);
+        std::vector<int> global_data(global_cells);
+        for (int c = 0; c < global_cells; ++c) {
+            global_data[c] = 2*c;
+        }
+        std::vector<int> local_data(global_cells);
+        CellDataHandle move_handle(global_data, local_data);
+        const bool distributed = grid.loadBalance(move_handle);
+        const auto& comm = Dune::MPIHelper::getCollectiveCommunication();
+        BOOST_CHECK_EQUAL(distributed, comm.size() > 1);
+        if (!distributed) {
+            return;
+        }
+        BOOST_CHECK_EQUAL(grid.overlapSize(0), 1);
+
+        // The data of the local cells was taken from the global cells.
+        const int local_cells = grid.size(0);
+        local_data.resize(local_cells);
+        for (int c = 0; c < local_cells; ++c) {
+            BOOST_CHECK_EQUAL(local_data[c], 2*grid.globalEntityIndex(0, c));
+        }
+
+        // Each cell is interior on exactly one process.
+        const auto view = grid.leafGridView();
+        int interior = 0;
+        int overlap = 0;
+        for (auto it = view.begin<0, Dune::Interior_Partition>(),
+                 end = view.end<0, Dune::Interior_Partition>(); it != end; ++it) {
+            BOOST_CHECK(it->partitionType() == Dune::InteriorEntity);
+            ++interior;
+        }
+        for (auto it = view.begin<0>(), end = view.end<0>(); it != end; ++it) {
+            if (it->partitionType() == Dune::OverlapEntity) {
+                ++overlap;
+            }
+        }
+        BOOST_CHECK_EQUAL(interior + overlap, local_cells);
+        BOOST_CHECK(overlap > 0);
+        BOOST_CHECK_EQUAL(comm.sum(interior), global_cells);
+
+        // Faces to cells that are not present are neither boundary nor
+        // neighbor intersections. Only overlap cells have such faces.
+        for (auto it = view.begin<0>(), end = view.end<0>(); it != end; ++it) {
+            for (auto is = view.ibegin(*it), iend = view.iend(*it); is != iend; ++is) {
+                if (!is->neighbor() && !is->boundary()) {
+                    BOOST_CHECK(it->partitionType() == Dune::OverlapEntity);
+                }
+            }
+        }
+
+        // Overlap cells receive the values of their owners.
+        std::vector<int> values(local_cells, -1);
+        for (auto it = view.begin<0, Dune::Interior_Partition>(),
+                 end = view.end<0, Dune::Interior_Partition>(); it != end; ++it) {
+            values[it->seed().index()] = grid.globalEntityIndex(0, it->seed().index());
+        }
+        CellDataHandle comm_handle(values, values);
+        grid.communicate(comm_handle, Dune::InteriorBorder_All_Interface,
+                         Dune::ForwardCommunication);
+        for (int c = 0; c < local_cells; ++c) {
+            BOOST_CHECK_EQUAL(values[c], grid.globalEntityIndex(0, c));
+        }
+    }
+}
+
+bool
+init_unit_test_func()
+{
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+    boost::unit_test::unit_test_main(&init_unit_test_func,
+                                     argc, argv);
+}
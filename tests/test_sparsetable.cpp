@@ -42,6 +42,9 @@
 
 #include <opm/grid/utility/SparseTable.hpp>
 
+#include <cstdint>
+#include <vector>
+
 using namespace Opm;
 
 BOOST_AUTO_TEST_CASE(construction_and_queries)
@@ -127,3 +130,35 @@ BOOST_AUTO_TEST_CASE(construction_and_queries)
     BOOST_CHECK_THROW(const SparseTable<int> st6(elem, elem + num_elem, err_rs, err_rs + num_rows), std::exception);
 #endif
 }
+
+BOOST_AUTO_TEST_CASE(offset_types)
+{
+    const int num_elem = 10;
+    const int elem[num_elem] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    const int num_rows = 5;
+    const int rowsizes[num_rows] = { 1, 0, 2, 4, 3 };
+    const SparseTable<int> st(elem, elem + num_elem, rowsizes, rowsizes + num_rows);
+    const SparseTable<int, std::int64_t> st64(elem, elem + num_elem, rowsizes, rowsizes + num_rows);
+    BOOST_CHECK_EQUAL(st64.size(), st.size());
+    BOOST_CHECK_EQUAL(st64.dataSize(), st.dataSize());
+    for (int row = 0; row < num_rows; ++row) {
+        BOOST_CHECK_EQUAL(st64.rowSize(row), st.rowSize(row));
+        BOOST_CHECK_EQUAL_COLLECTIONS(st64[row].begin(), st64[row].end(),
+                                      st[row].begin(), st[row].end());
+    }
+
+    // A narrow offset type must refuse tables it cannot index.
+    const std::vector<int> many(200, 1);
+    SparseTable<int, std::int8_t> st8;
+    st8.appendRow(many.begin(), many.begin() + 100);
+    BOOST_CHECK_EQUAL(st8.dataSize(), 100);
+    BOOST_CHECK_THROW(st8.appendRow(many.begin() + 100, many.end()), std::overflow_error);
+    BOOST_CHECK_EQUAL(st8.size(), 1);
+    BOOST_CHECK_EQUAL(st8.dataSize(), 100);
+    const int big_rowsizes[2] = { 100, 100 };
+    BOOST_CHECK_THROW((SparseTable<int, std::int8_t>(many.begin(), many.end(),
+                                                     big_rowsizes, big_rowsizes + 2)),
+                      std::overflow_error);
+    SparseTable<int, std::int8_t> st8_allocate;
+    BOOST_CHECK_THROW(st8_allocate.allocate(big_rowsizes, big_rowsizes + 2), std::overflow_error);
+}
@@ -12,8 +12,16 @@
 
 /* --- our own headers --- */
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
 #include <vector>
 #include <opm/grid/UnstructuredGrid.h>
+#include <opm/grid/cart_grid.h>
 #include <opm/grid/cornerpoint_grid.h>  /* compute_geometry */
 #include <opm/grid/GridManager.hpp>  /* compute_geometry */
 #include <opm/grid/GridHelpers.hpp>
@@ -162,3 +170,363 @@ BOOST_AUTO_TEST_CASE(TOPS_Fully_Specified) {
 
     Opm::EclipseGrid grid = Opm::UgGridHelpers::createEclipseGrid( *cgrid1 , es1.getInputGrid( ) );
 }
+
+
+BOOST_AUTO_TEST_CASE(BinaryRoundTrip) {
+    const std::string filename = "CORNERPOINT_ACTNUM.DATA";
+    Opm::Parser parser;
+    Opm::Deck deck = parser.parseFile( filename);
+    Opm::EclipseState es(deck);
+
+    Opm::GridManager gridM(es.getInputGrid());
+    const UnstructuredGrid* cgrid1 = gridM.c_grid();
+
+    const std::string binfile = "test_ug_roundtrip.bin";
+    BOOST_REQUIRE( write_grid_binary( cgrid1 , binfile.c_str() ));
+    struct UnstructuredGrid * cgrid2 = read_grid_binary( binfile.c_str() );
+    std::remove( binfile.c_str() );
+    BOOST_REQUIRE( cgrid2 != NULL );
+
+    BOOST_CHECK( grid_equal( cgrid1 , cgrid2 ));
+    BOOST_CHECK_EQUAL( (cgrid1->zcorn == NULL) , (cgrid2->zcorn == NULL) );
+    for (int d = 0; d < 3; ++d) {
+        BOOST_CHECK_EQUAL( cgrid1->cartdims[d] , cgrid2->cartdims[d] );
+    }
+    destroy_grid( cgrid2 );
+
+    BOOST_CHECK( read_grid_binary( "does_not_exist.bin" ) == NULL );
+}
+
+
+namespace {
+    // A 2x2x2 corner-point grid with sloping pillars, in which the
+    // column i = 1 is thrown down by half a cell (a fault along the
+    // pillars i = 1) and the cell (0, 1, 1) is inactive.
+    struct FaultedGrdecl
+    {
+        FaultedGrdecl()
+        {
+            const int nx = 2, ny = 2, nz = 2;
+            for (int j = 0; j <= ny; ++j) {
+                for (int i = 0; i <= nx; ++i) {
+                    const double pillar[6] = { double(i), double(j), 0.0,
+                                               i + 0.25*j, double(j), 3.0 };
+                    coord.insert(coord.end(), pillar, pillar + 6);
+                }
+            }
+            for (int k = 0; k < 2*nz; ++k) {
+                for (int j = 0; j < 2*ny; ++j) {
+                    for (int i = 0; i < 2*nx; ++i) {
+                        zcorn.push_back(((k + 1)/2) + (i >= 2 ? 0.5 : 0.0));
+                    }
+                }
+            }
+            actnum.assign(nx*ny*nz, 1);
+            actnum[6] = 0;
+            g.dims[0] = nx;
+            g.dims[1] = ny;
+            g.dims[2] = nz;
+            g.coord = coord.data();
+            g.zcorn = zcorn.data();
+            g.actnum = actnum.data();
+            g.mapaxes = nullptr;
+        }
+        std::vector<double> coord;
+        std::vector<double> zcorn;
+        std::vector<int> actnum;
+        grdecl g;
+    };
+
+    // Compare the processed FaultedGrdecl against the output of the
+    // original serial implementation of process_grdecl().
+    void checkFaultedProcessedGrid(const processed_grid& pg)
+    {
+        const int face_ptr[] = {
+            0, 4, 8, 12, 16, 20, 24, 28, 32, 36, 40, 44,
+            48, 52, 56, 60, 64, 68, 72, 76, 80, 84, 88, 92,
+            96, 100, 104, 108, 112, 116, 120, 124, 128, 132, 136, 140,
+            144, 148, 152
+        };
+        const int face_nodes[] = {
+            0, 12, 13, 1, 1, 13, 14, 2, 3, 15, 16, 4,
+            4, 16, 17, 5, 5, 17, 18, 6, 6, 18, 19, 7,
+            7, 19, 20, 8, 9, 21, 22, 10, 10, 22, 23, 11,
+            12, 24, 25, 13, 15, 26, 27, 16, 16, 27, 28, 17,
+            17, 28, 29, 18, 18, 29, 30, 20, 21, 31, 32, 22,
+            22, 32, 33, 23, 3, 0, 1, 5, 5, 1, 2, 7,
+            9, 4, 6, 10, 10, 6, 8, 11, 15, 12, 13, 17,
+            17, 13, 14, 19, 21, 16, 18, 22, 22, 18, 20, 23,
+            26, 24, 25, 28, 31, 27, 29, 32, 32, 29, 30, 33,
+            0, 3, 15, 12, 1, 5, 17, 13, 2, 7, 19, 14,
+            4, 9, 21, 16, 6, 10, 22, 18, 8, 11, 23, 20,
+            12, 15, 26, 24, 13, 17, 28, 25, 16, 21, 31, 27,
+            18, 22, 32, 29, 20, 23, 33, 30
+        };
+        const int face_neighbors[] = {
+            -1, 0, -1, 4, 0, -1, 0, 1, 4, 1, 4, 5,
+            -1, 5, 1, -1, 5, -1, -1, 2, 2, -1, 2, 3,
+            -1, 3, -1, 6, 3, -1, 6, -1, -1, 0, -1, 4,
+            -1, 1, -1, 5, 0, 2, 4, -1, 1, 3, 5, 6,
+            2, -1, 3, -1, 6, -1, -1, 0, 0, 4, 4, -1,
+            -1, 1, 1, 5, 5, -1, -1, 2, 2, -1, -1, 3,
+            3, 6, 6, -1
+        };
+        const double node_coordinates[] = {
+            0, 0, 0, 0, 0, 1,
+            0, 0, 2, 1, 0, 0,
+            1, 0, 0.5, 1, 0, 1,
+            1, 0, 1.5, 1, 0, 2,
+            1, 0, 2.5, 2, 0, 0.5,
+            2, 0, 1.5, 2, 0, 2.5,
+            0, 1, 0, 0.083333333333333329, 1, 1,
+            0.16666666666666666, 1, 2, 1, 1, 0,
+            1.0416666666666667, 1, 0.5, 1.0833333333333335, 1, 1,
+            1.125, 1, 1.5, 1.1666666666666665, 1, 2,
+            1.2083333333333335, 1, 2.5, 2.041666666666667, 1, 0.5,
+            2.125, 1, 1.5, 2.208333333333333, 1, 2.5,
+            0, 2, 0, 0.16666666666666666, 2, 1,
+            1, 2, 0, 1.0833333333333335, 2, 0.5,
+            1.1666666666666667, 2, 1, 1.25, 2, 1.5,
+            1.4166666666666665, 2, 2.5, 2.0833333333333335, 2, 0.5,
+            2.25, 2, 1.5, 2.416666666666667, 2, 2.5
+        };
+        const int local_cell_index[] = {
+            0, 1, 2, 3, 4, 5, 7
+        };
+        BOOST_REQUIRE_EQUAL( pg.number_of_faces, 38 );
+        BOOST_REQUIRE_EQUAL( pg.number_of_nodes, 34 );
+        BOOST_REQUIRE_EQUAL( pg.number_of_cells, 7 );
+        BOOST_CHECK_EQUAL_COLLECTIONS( pg.face_ptr, pg.face_ptr + pg.number_of_faces + 1,
+                                       std::begin(face_ptr), std::end(face_ptr) );
+        BOOST_REQUIRE_EQUAL( pg.face_ptr[pg.number_of_faces], 152 );
+        BOOST_CHECK_EQUAL_COLLECTIONS( pg.face_nodes, pg.face_nodes + pg.face_ptr[pg.number_of_faces],
+                                       std::begin(face_nodes), std::end(face_nodes) );
+        BOOST_CHECK_EQUAL_COLLECTIONS( pg.face_neighbors, pg.face_neighbors + 2*pg.number_of_faces,
+                                       std::begin(face_neighbors), std::end(face_neighbors) );
+        BOOST_CHECK_EQUAL_COLLECTIONS( pg.local_cell_index, pg.local_cell_index + pg.number_of_cells,
+                                       std::begin(local_cell_index), std::end(local_cell_index) );
+        for (int i = 0; i < 3*pg.number_of_nodes; ++i) {
+            BOOST_CHECK_SMALL( pg.node_coordinates[i] - node_coordinates[i], 1e-12 );
+        }
+        for (int f = 0; f < pg.number_of_faces; ++f) {
+            const enum face_tag expected = f < 16 ? I_FACE : (f < 27 ? J_FACE : K_FACE);
+            BOOST_CHECK_EQUAL( pg.face_tag[f], expected );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ProcessGrdeclFaulted) {
+    FaultedGrdecl input;
+    processed_grid pg;
+    process_grdecl(&input.g, 0.0, &pg);
+    checkFaultedProcessedGrid(pg);
+    free_processed_grid(&pg);
+}
+
+
+namespace {
+    template <class T>
+    void writeValues(std::ostream& os, const T* begin, const T* end)
+    {
+        for (const T* x = begin; x != end; ++x) {
+            os << *x << '\n';
+        }
+    }
+
+    // Writes a grid in the character representation parsed by read_grid().
+    std::string gridText(const UnstructuredGrid& g)
+    {
+        const int nc = g.number_of_cells;
+        const int nf = g.number_of_faces;
+        const int d = g.dimensions;
+        std::ostringstream os;
+        os.precision(std::numeric_limits<double>::max_digits10);
+        os << d << ' ' << nc << ' ' << nf << ' ' << g.number_of_nodes << ' '
+           << g.face_nodepos[nf] << ' ' << g.cell_facepos[nc] << '\n'
+           << (g.cell_facetag != NULL) << ' ' << (g.global_cell != NULL) << '\n';
+        writeValues(os, g.cartdims, g.cartdims + d);
+        writeValues(os, g.node_coordinates, g.node_coordinates + d*g.number_of_nodes);
+        writeValues(os, g.face_nodepos, g.face_nodepos + nf + 1);
+        writeValues(os, g.face_nodes, g.face_nodes + g.face_nodepos[nf]);
+        writeValues(os, g.face_cells, g.face_cells + 2*nf);
+        writeValues(os, g.face_areas, g.face_areas + nf);
+        writeValues(os, g.face_centroids, g.face_centroids + d*nf);
+        writeValues(os, g.face_normals, g.face_normals + d*nf);
+        writeValues(os, g.cell_facepos, g.cell_facepos + nc + 1);
+        for (int i = 0; i < g.cell_facepos[nc]; ++i) {
+            os << g.cell_faces[i];
+            if (g.cell_facetag != NULL) {
+                os << ' ' << g.cell_facetag[i];
+            }
+            os << '\n';
+        }
+        if (g.global_cell != NULL) {
+            writeValues(os, g.global_cell, g.global_cell + nc);
+        }
+        writeValues(os, g.cell_volumes, g.cell_volumes + nc);
+        writeValues(os, g.cell_centroids, g.cell_centroids + d*nc);
+        return os.str();
+    }
+
+    // Reads the grid from a file with the given contents.
+    UnstructuredGrid* readGridText(const std::string& text)
+    {
+        const std::string filename = "test_ug_roundtrip.txt";
+        {
+            std::ofstream os(filename);
+            os << text;
+        }
+        UnstructuredGrid* g = read_grid(filename.c_str());
+        std::remove(filename.c_str());
+        return g;
+    }
+
+    void checkTextRoundTrip(const UnstructuredGrid& g1)
+    {
+        const std::string text = gridText(g1);
+        UnstructuredGrid* g2 = readGridText(text);
+        BOOST_REQUIRE( g2 != NULL );
+
+        BOOST_CHECK( grid_equal( &g1 , g2 ));
+        BOOST_CHECK_EQUAL( (g1.cell_facetag == NULL) , (g2->cell_facetag == NULL) );
+        BOOST_CHECK_EQUAL( (g1.global_cell == NULL) , (g2->global_cell == NULL) );
+        BOOST_CHECK_EQUAL_COLLECTIONS( g1.cartdims, g1.cartdims + 3,
+                                       g2->cartdims, g2->cartdims + 3 );
+        destroy_grid( g2 );
+
+        // Files that end early or contain something else than a number
+        // where one is expected are rejected.
+        BOOST_CHECK( readGridText( text.substr(0, text.size() / 2) ) == NULL );
+        BOOST_CHECK( readGridText( text.substr(0, text.rfind('\n', text.size() - 2)) ) == NULL );
+        std::string malformed = text;
+        malformed.replace(malformed.find('\n', malformed.size() / 2) + 1, 1, "x");
+        BOOST_CHECK( readGridText( malformed ) == NULL );
+        BOOST_CHECK( readGridText( "3 1 6" ) == NULL );
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TextRoundTrip) {
+    // A corner-point grid with an inactive cell has face tags and a
+    // global cell map.
+    FaultedGrdecl input;
+    struct UnstructuredGrid * cpgrid = create_grid_cornerpoint( &input.g , 0.0 );
+    BOOST_REQUIRE( cpgrid != NULL );
+    BOOST_REQUIRE( cpgrid->cell_facetag != NULL );
+    BOOST_REQUIRE( cpgrid->global_cell != NULL );
+    checkTextRoundTrip( *cpgrid );
+    destroy_grid( cpgrid );
+
+    // A two-dimensional Cartesian grid has neither a global cell map
+    // nor a third Cartesian dimension. Without its face tags it has
+    // none of the optional arrays.
+    struct UnstructuredGrid * cartgrid = create_grid_cart2d( 3 , 2 , 1.0 , 0.5 );
+    BOOST_REQUIRE( cartgrid != NULL );
+    BOOST_REQUIRE( cartgrid->global_cell == NULL );
+    checkTextRoundTrip( *cartgrid );
+    free( cartgrid->cell_facetag );
+    cartgrid->cell_facetag = NULL;
+    checkTextRoundTrip( *cartgrid );
+    destroy_grid( cartgrid );
+
+    BOOST_CHECK( read_grid( "does_not_exist.txt" ) == NULL );
+}
+
+
+namespace {
+    // Serves the corner-point depths and the "active" map of a grid from
+    // separate per-row slabs, as a reader of a row-wise stored file would.
+    // Only the requested row is touched, and the requests are recorded.
+    struct RowSlabs
+    {
+        explicit RowSlabs(const grdecl& g)
+        {
+            const int nx = g.dims[0], ny = g.dims[1], nz = g.dims[2];
+            zcorn_rows.resize(2*ny);
+            for (int j = 0; j < 2*ny; ++j) {
+                for (int k = 0; k < 2*nz; ++k) {
+                    const double* row = g.zcorn + 2*nx*(j + 2*ny*k);
+                    zcorn_rows[j].insert(zcorn_rows[j].end(), row, row + 2*nx);
+                }
+            }
+            actnum_rows.resize(ny);
+            for (int j = 0; j < ny; ++j) {
+                for (int k = 0; k < nz; ++k) {
+                    const int* row = g.actnum + nx*(j + ny*k);
+                    actnum_rows[j].insert(actnum_rows[j].end(), row, row + nx);
+                }
+            }
+        }
+        std::vector<std::vector<double> > zcorn_rows;
+        std::vector<std::vector<int> > actnum_rows;
+        std::vector<int> zcorn_requests;
+        std::vector<int> actnum_requests;
+    };
+
+    int readZcornRow(void* data, int j, double* zcorn)
+    {
+        RowSlabs& slabs = *static_cast<RowSlabs*>(data);
+        if (j < 0 || j >= static_cast<int>(slabs.zcorn_rows.size())) {
+            return 0;
+        }
+        slabs.zcorn_requests.push_back(j);
+        std::copy(slabs.zcorn_rows[j].begin(), slabs.zcorn_rows[j].end(), zcorn);
+        return 1;
+    }
+
+    int readActnumRow(void* data, int j, int* actnum)
+    {
+        RowSlabs& slabs = *static_cast<RowSlabs*>(data);
+        if (j < 0 || j >= static_cast<int>(slabs.actnum_rows.size())) {
+            return 0;
+        }
+        slabs.actnum_requests.push_back(j);
+        std::copy(slabs.actnum_rows[j].begin(), slabs.actnum_rows[j].end(), actnum);
+        return 1;
+    }
+
+    // The number of runs of non-decreasing row indices.
+    int numTraversals(const std::vector<int>& requests)
+    {
+        int traversals = requests.empty() ? 0 : 1;
+        for (std::size_t i = 1; i < requests.size(); ++i) {
+            if (requests[i] < requests[i-1]) {
+                ++traversals;
+            }
+        }
+        return traversals;
+    }
+
+    int failingZcornRow(void*, int, double*)
+    {
+        return 0;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ProcessGrdeclRows) {
+    FaultedGrdecl input;
+    RowSlabs slabs(input.g);
+
+    grdecl_rows rows;
+    std::copy(input.g.dims, input.g.dims + 3, rows.dims);
+    rows.coord = input.g.coord;
+    rows.mapaxes = nullptr;
+    rows.read_zcorn_row = readZcornRow;
+    rows.read_actnum_row = readActnumRow;
+    rows.data = &slabs;
+
+    processed_grid pg;
+    BOOST_REQUIRE( process_grdecl_rows(&rows, 0.0, &pg) );
+    checkFaultedProcessedGrid(pg);
+    free_processed_grid(&pg);
+
+    // The input is traversed three times, each time with increasing J.
+    BOOST_CHECK_EQUAL( numTraversals(slabs.zcorn_requests), 3 );
+    BOOST_CHECK_EQUAL( numTraversals(slabs.actnum_requests), 3 );
+    for (int j = 0; j < 2*input.g.dims[1]; ++j) {
+        BOOST_CHECK( std::count(slabs.zcorn_requests.begin(), slabs.zcorn_requests.end(), j) >= 3 );
+    }
+
+    // A failing reader is reported.
+    rows.read_zcorn_row = failingZcornRow;
+    BOOST_CHECK( !process_grdecl_rows(&rows, 0.0, &pg) );
+}